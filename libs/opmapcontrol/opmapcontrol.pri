@@ -29,6 +29,7 @@ HEADERS += opmapcontrol.h \
            src/internals/core.h \
            src/internals/debugheader.h \
            src/internals/loadtask.h \
+           src/internals/tileprefetchtask.h \
            src/internals/mousewheelzoomtype.h \
            src/internals/pointlatlng.h \
            src/internals/pureprojection.h \
@@ -46,6 +47,7 @@ HEADERS += opmapcontrol.h \
            src/mapwidget/opmapwidget.h \
            src/mapwidget/trailitem.h \
            src/mapwidget/traillineitem.h \
+           src/mapwidget/trailpathitem.h \
            src/mapwidget/uavitem.h \
            src/mapwidget/uavmapfollowtype.h \
            src/mapwidget/uavtrailtype.h \
@@ -76,6 +78,7 @@ SOURCES += src/core/alllayersoftype.cpp \
            src/core/urlfactory.cpp \
            src/internals/core.cpp \
            src/internals/loadtask.cpp \
+           src/internals/tileprefetchtask.cpp \
            src/internals/MouseWheelZoomType.cpp \
            src/internals/pointlatlng.cpp \
            src/internals/pureprojection.cpp \
@@ -93,6 +96,7 @@ SOURCES += src/core/alllayersoftype.cpp \
            src/mapwidget/opmapwidget.cpp \
            src/mapwidget/trailitem.cpp \
            src/mapwidget/traillineitem.cpp \
+           src/mapwidget/trailpathitem.cpp \
            src/mapwidget/uavitem.cpp \
            src/mapwidget/waypointitem.cpp \
            src/internals/projections/lks94projection.cpp \
@@ -35,6 +35,7 @@ HEADERS += libs/opmapcontrol/opmapcontrol.h \
            libs/opmapcontrol/src/internals/core.h \
            libs/opmapcontrol/src/internals/debugheader.h \
            libs/opmapcontrol/src/internals/loadtask.h \
+           libs/opmapcontrol/src/internals/tileprefetchtask.h \
            libs/opmapcontrol/src/internals/mousewheelzoomtype.h \
            libs/opmapcontrol/src/internals/pointlatlng.h \
            libs/opmapcontrol/src/internals/pureprojection.h \
@@ -51,6 +52,7 @@ HEADERS += libs/opmapcontrol/opmapcontrol.h \
            libs/opmapcontrol/src/mapwidget/opmapwidget.h \
            libs/opmapcontrol/src/mapwidget/trailitem.h \
            libs/opmapcontrol/src/mapwidget/traillineitem.h \
+           libs/opmapcontrol/src/mapwidget/trailpathitem.h \
            libs/opmapcontrol/src/mapwidget/uavitem.h \
            libs/opmapcontrol/src/mapwidget/uavmapfollowtype.h \
            libs/opmapcontrol/src/mapwidget/uavtrailtype.h \
@@ -82,6 +84,7 @@ SOURCES += libs/opmapcontrol/src/core/alllayersoftype.cpp \
            libs/opmapcontrol/src/core/urlfactory.cpp \
            libs/opmapcontrol/src/internals/core.cpp \
            libs/opmapcontrol/src/internals/loadtask.cpp \
+           libs/opmapcontrol/src/internals/tileprefetchtask.cpp \
            libs/opmapcontrol/src/internals/MouseWheelZoomType.cpp \
            libs/opmapcontrol/src/internals/pointlatlng.cpp \
            libs/opmapcontrol/src/internals/pureprojection.cpp \
@@ -99,6 +102,7 @@ SOURCES += libs/opmapcontrol/src/core/alllayersoftype.cpp \
            libs/opmapcontrol/src/mapwidget/opmapwidget.cpp \
            libs/opmapcontrol/src/mapwidget/trailitem.cpp \
            libs/opmapcontrol/src/mapwidget/traillineitem.cpp \
+           libs/opmapcontrol/src/mapwidget/trailpathitem.cpp \
            libs/opmapcontrol/src/mapwidget/uavitem.cpp \
            libs/opmapcontrol/src/mapwidget/waypointitem.cpp \
            libs/opmapcontrol/src/internals/projections/lks94projection.cpp \
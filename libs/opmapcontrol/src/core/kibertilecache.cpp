@@ -26,44 +26,54 @@
 */
 #include "kibertilecache.h"
 
-//TODO add readwrite lock
-
 namespace core {
     KiberTileCache::KiberTileCache()
     {
-        memoryCacheSize = 0;
-        _MemoryCacheCapacity = 22;
+        // Capacity in MB, a decoded 256x256 tile takes 256KB
+        setMemoryCacheCapacity(128);
     }
 
     void KiberTileCache::setMemoryCacheCapacity(const int &value)
     {
-        kiberCacheLock.lockForWrite();
-        _MemoryCacheCapacity=value;
-        kiberCacheLock.unlock();
+        QMutexLocker locker(&mutex);
+        cache.setMaxCost(value*1048576);
     }
     int KiberTileCache::MemoryCacheCapacity()
     {
-        kiberCacheLock.lockForRead();
-        return _MemoryCacheCapacity;
-        kiberCacheLock.unlock();
+        QMutexLocker locker(&mutex);
+        return cache.maxCost()/1048576;
     }
-
-    void KiberTileCache::RemoveMemoryOverload()
+    double KiberTileCache::MemoryCacheSize()
     {
-        while(MemoryCacheSize()>MemoryCacheCapacity())
-        {
-            if(cachequeue.count()>0 && list.count()>0)
-            {
-#ifdef DEBUG_MEMORY_CACHE
-                qDebug()<<"Cleaning Memory cache="<<" started with "<<cachequeue.count()<<" tile "<<"ocupying "<<memoryCacheSize<<" bytes";
-#endif
-                RawTile first=list.dequeue();
-                memoryCacheSize-=cachequeue.value(first).size();
-                cachequeue.remove(first);
-            }
-        }
+        QMutexLocker locker(&mutex);
+        return cache.totalCost()/1048576.0;
+    }
+    bool KiberTileCache::Find(const RawTile &tile, QImage &image)
+    {
+        // QCache::object() also moves the tile to the front of the LRU list
+        QMutexLocker locker(&mutex);
+        QImage *cached=cache.object(tile);
+        if(!cached)
+            return false;
+        image=*cached;
+        return true;
+    }
+    bool KiberTileCache::Contains(const RawTile &tile)
+    {
+        QMutexLocker locker(&mutex);
+        return cache.contains(tile);
+    }
+    void KiberTileCache::Insert(const RawTile &tile, const QImage &image)
+    {
+        QMutexLocker locker(&mutex);
+        cache.insert(tile,new QImage(image),image.byteCount());
 #ifdef DEBUG_MEMORY_CACHE
-        qDebug()<<"Cleaning Memory cache="<<" ended with "<<cachequeue.count()<<" tile "<<"ocupying "<<memoryCacheSize<<" bytes";
+        qDebug()<<"Current memory="<<cache.totalCost()<<" in "<<cache.count()<<" tiles";
 #endif
     }
+    void KiberTileCache::Clear()
+    {
+        QMutexLocker locker(&mutex);
+        cache.clear();
+    }
 }
@@ -29,11 +29,15 @@
 
 #include "rawtile.h"
 #include <QMutex>
-#include <QReadWriteLock>
-#include <QQueue>
+#include <QCache>
+#include <QImage>
 #include <QDebug>
 #include "debugheader.h"
 namespace core {
+    /**
+    * @brief Least recently used cache of decoded tiles, sized by the bytes
+    *        of image data it holds. All methods are thread safe.
+    */
     class KiberTileCache
     {
     public:
@@ -41,15 +45,16 @@ namespace core {
 
         void setMemoryCacheCapacity(const int &value);
         int MemoryCacheCapacity();
-        double MemoryCacheSize(){return memoryCacheSize/1048576.0;}
-        void RemoveMemoryOverload();
-        QReadWriteLock kiberCacheLock;
-        QHash <RawTile,QByteArray> cachequeue;
-        QQueue <RawTile> list;
-        long memoryCacheSize;
+        double MemoryCacheSize();
+        /** @brief Looks up a tile and marks it as most recently used */
+        bool Find(const RawTile &tile,QImage &image);
+        bool Contains(const RawTile &tile);
+        /** @brief Adds a tile, evicting the least recently used ones over capacity */
+        void Insert(const RawTile &tile,const QImage &image);
+        void Clear();
     private:
-        int _MemoryCacheCapacity;
-
+        QMutex mutex;
+        QCache <RawTile,QImage> cache;
     };
 
 
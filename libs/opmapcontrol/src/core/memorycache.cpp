@@ -25,7 +25,6 @@
 * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 */
 #include "memorycache.h"
-//TODO add readwrite lock
 
 namespace core {
     MemoryCache::MemoryCache()
@@ -34,27 +33,13 @@ namespace core {
     }
 
 
-    QByteArray MemoryCache::GetTileFromMemoryCache(const RawTile &tile)
+    bool MemoryCache::GetTileFromMemoryCache(const RawTile &tile,QImage &pic)
     {
-        kiberCacheLock.lockForRead();
-        QByteArray pic;
-        pic=TilesInMemory.cachequeue.value(tile);
-        // TilesInMemory.find(key,&pic);
-        kiberCacheLock.unlock();
-        return pic;
+        return TilesInMemory.Find(tile,pic);
     }
-    void MemoryCache::AddTileToMemoryCache(const RawTile &tile, const QByteArray &pic)
+    void MemoryCache::AddTileToMemoryCache(const RawTile &tile, const QImage &pic)
     {
-        kiberCacheLock.lockForWrite();
-        // QPixmapCache::Key key=TilesInMemory.insert(pic);
-        TilesInMemory.memoryCacheSize +=pic.size();
-#ifdef DEBUG_MEMORY_CACHE
-        qDebug()<<"Current memory="<<TilesInMemory.memoryCacheSize<<" in "<<TilesInMemory.cachequeue.count()<<" tiles";
-#endif
-        TilesInMemory.cachequeue.insert(tile,pic);
-        TilesInMemory.list.enqueue(tile);
-
-        kiberCacheLock.unlock();
+        TilesInMemory.Insert(tile,pic);
     }
 
 }
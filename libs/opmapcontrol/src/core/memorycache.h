@@ -28,9 +28,7 @@
 #define MEMORYCACHE_H
 
 #include "rawtile.h"
-#include <QMutex>
-#include <QReadWriteLock>
-#include <QQueue>
+#include <QImage>
 #include "kibertilecache.h"
 #include <QDebug>
 #include "debugheader.h"
@@ -41,9 +39,8 @@ namespace core {
         MemoryCache();
 
         KiberTileCache TilesInMemory;
-        QByteArray GetTileFromMemoryCache(const RawTile &tile);
-        void AddTileToMemoryCache(const RawTile &tile, const QByteArray &pic);
-        QReadWriteLock kiberCacheLock;
+        bool GetTileFromMemoryCache(const RawTile &tile,QImage &pic);
+        void AddTileToMemoryCache(const RawTile &tile, const QImage &pic);
     };
 
 
@@ -64,20 +64,6 @@ namespace core {
 #endif //DEBUG_GMAPS
         QByteArray ret;
 
-        if(useMemoryCache)
-        {
-#ifdef DEBUG_GMAPS
-            qDebug()<<"Try Tile from memory:Size="<<TilesInMemory.MemoryCacheSize();
-#endif //DEBUG_GMAPS
-            ret=GetTileFromMemoryCache(RawTile(type,pos,zoom));
-            if(!ret.isEmpty())
-            {
-                errorvars.lock();
-                ++diag.tilesFromMem;
-                errorvars.unlock();
-            }
-
-        }
         if(ret.isEmpty())
         {
 #ifdef DEBUG_GMAPS
@@ -97,13 +83,6 @@ namespace core {
 #ifdef DEBUG_GMAPS
                     qDebug()<<"Tile found in Database";
 #endif //DEBUG_GMAPS
-                    if(useMemoryCache)
-                    {
-#ifdef DEBUG_GMAPS
-                        qDebug()<<"Add Tile to memory";
-#endif //DEBUG_GMAPS
-                        AddTileToMemoryCache(RawTile(type,pos,zoom),ret);
-                    }
                     return ret;
                 }
             }
@@ -247,13 +226,6 @@ namespace core {
                 errorvars.lock();
                 ++diag.tilesFromNet;
                 errorvars.unlock();
-                if (useMemoryCache)
-                {
-#ifdef DEBUG_GMAPS
-                    qDebug()<<"Add Tile to memory cache";
-#endif //DEBUG_GMAPS
-                    AddTileToMemoryCache(RawTile(type,pos,zoom),ret);
-                }
                 if(accessmode!=AccessMode::ServerOnly)
                 {
 #ifdef DEBUG_GMAPS
@@ -272,6 +244,38 @@ namespace core {
         return ret;
     }
 
+    QImage OPMaps::GetTileImage(const MapType::Types &type,const Point &pos,const int &zoom)
+    {
+        QImage image;
+        if(useMemoryCache)
+        {
+#ifdef DEBUG_GMAPS
+            qDebug()<<"Try Tile from memory:Size="<<TilesInMemory.MemoryCacheSize();
+#endif //DEBUG_GMAPS
+            if(GetTileFromMemoryCache(RawTile(type,pos,zoom),image))
+            {
+                errorvars.lock();
+                ++diag.tilesFromMem;
+                errorvars.unlock();
+                return image;
+            }
+        }
+        QByteArray ret=GetImageFrom(type,pos,zoom);
+        if(ret.isEmpty())
+            return image;
+        // Decode once, in the loader thread, to the format the painter
+        // draws fastest
+        image=PureImageProxy::Decode(ret);
+        if(useMemoryCache && !image.isNull())
+        {
+#ifdef DEBUG_GMAPS
+            qDebug()<<"Add Tile to memory cache";
+#endif //DEBUG_GMAPS
+            AddTileToMemoryCache(RawTile(type,pos,zoom),image);
+        }
+        return image;
+    }
+
     bool OPMaps::ExportToGMDB(const QString &file)
     {
         return Cache::Instance()->ImageCache.ExportMapDataToDB(Cache::Instance()->ImageCache.GtileCache()+QDir::separator()+"Data.qmdb",file);
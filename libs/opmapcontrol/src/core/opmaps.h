@@ -40,6 +40,7 @@
 #include "alllayersoftype.h"
 #include "urlfactory.h"
 #include "diagnostics.h"
+#include "pureimage.h"
 
 //#include "point.h"
 
@@ -62,6 +63,11 @@ namespace core {
 
 
         QByteArray GetImageFrom(const MapType::Types &type,const core::Point &pos,const int &zoom);
+        /**
+        * @brief Returns the decoded tile, from the memory cache when possible
+        */
+        QImage GetTileImage(const MapType::Types &type,const core::Point &pos,const int &zoom);
+        bool IsTileInMemory(const MapType::Types &type,const core::Point &pos,const int &zoom){return TilesInMemory.Contains(RawTile(type,pos,zoom));}
         bool UseMemoryCache(){return useMemoryCache;}//TODO
         void setUseMemoryCache(const bool& value){useMemoryCache=value;}
         void setLanguage(const LanguageType::Types& language){Language=language;}//TODO
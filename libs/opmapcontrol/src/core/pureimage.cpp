@@ -38,6 +38,10 @@ QPixmap PureImageProxy::FromStream(const QByteArray &array)
 {
     return QPixmap::fromImage(QImage::fromData(array));
 }
+QImage PureImageProxy::Decode(const QByteArray &array)
+{
+    return QImage::fromData(array).convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
 bool PureImageProxy::Save(const QByteArray &array, QPixmap &pic)
 {
     pic=QPixmap::fromImage(QImage::fromData(array));
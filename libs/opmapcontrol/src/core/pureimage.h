@@ -28,6 +28,7 @@
 #define PUREIMAGE_H
 
 #include <QPixmap>
+#include <QImage>
 #include <QByteArray>
 
 
@@ -37,6 +38,8 @@ namespace core {
     public:
         PureImageProxy();
         static QPixmap FromStream(const QByteArray &array);
+        /** @brief Decodes a tile to premultiplied ARGB, safe outside the GUI thread */
+        static QImage Decode(const QByteArray &array);
         static bool Save(const QByteArray &array,QPixmap &pic);
     };
 
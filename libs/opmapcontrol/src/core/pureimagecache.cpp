@@ -57,6 +57,20 @@ namespace core {
 #endif //DEBUG_PUREIMAGECACHE
                 CreateEmptyDB(db);
             }
+            else
+            {
+                // Caches created by older versions lack the tile index
+                {
+                    QSqlDatabase cn = QSqlDatabase::addDatabase("QSQLITE",QLatin1String("UpdateConn"));
+                    cn.setDatabaseName(db);
+                    if(cn.open())
+                    {
+                        CreateIndex(cn);
+                        cn.close();
+                    }
+                }
+                QSqlDatabase::removeDatabase(QLatin1String("UpdateConn"));
+            }
         }
         lock.unlock();
     }
@@ -165,10 +179,97 @@ namespace core {
             db.close();
             return false;
         }
+        if(!CreateIndex(db))
+        {
+            db.close();
+            return false;
+        }
         db.close();
         QSqlDatabase::removeDatabase(QLatin1String("CreateConn"));
         return true;
     }
+    bool PureImageCache::CreateIndex(QSqlDatabase &db)
+    {
+        // Every lookup is by position, zoom and map type
+        QSqlQuery query(db);
+        if(!query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)"))
+        {
+#ifdef DEBUG_PUREIMAGECACHE
+            qDebug()<<"CreateIndex: "<<query.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+            return false;
+        }
+        return true;
+    }
+
+    PureImageCache::Connection::Connection(const QString &name, const QString &file) :
+        name(name),
+        file(file),
+        insertTile(0),
+        insertTileData(0),
+        selectTile(0)
+    {
+    }
+    PureImageCache::Connection::~Connection()
+    {
+        delete insertTile;
+        delete insertTileData;
+        delete selectTile;
+        if(db.isOpen())
+            db.close();
+        db=QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+    bool PureImageCache::Connection::open()
+    {
+        db = QSqlDatabase::addDatabase("QSQLITE",name);
+        db.setDatabaseName(file);
+        db.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
+        if(!db.open())
+            return false;
+        insertTile=new QSqlQuery(db);
+        insertTileData=new QSqlQuery(db);
+        selectTile=new QSqlQuery(db);
+        return insertTile->prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)")
+                && insertTileData->prepare("INSERT INTO TilesData(id, Tile) VALUES(?, ?)")
+                && selectTile->prepare("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=?)");
+    }
+    bool PureImageCache::Connection::insert(const QByteArray &tile, const MapType::Types &type,const Point &pos,const int &zoom)
+    {
+        insertTile->addBindValue(pos.X());
+        insertTile->addBindValue(pos.Y());
+        insertTile->addBindValue(zoom);
+        insertTile->addBindValue((int)type);
+        insertTile->addBindValue(QDateTime::currentDateTime().toString());
+        if(!insertTile->exec())
+            return false;
+        insertTileData->addBindValue(insertTile->lastInsertId());
+        insertTileData->addBindValue(tile);
+        return insertTileData->exec();
+    }
+    PureImageCache::Connection* PureImageCache::GetConnection()
+    {
+        // Called with lock held for reading
+        QString db=gtilecache+"Data.qmdb";
+        Connection *cn=connections.localData();
+        if(cn && cn->file==db)
+            return cn;
+        Mcounter.lock();
+        qlonglong id=++ConnCounter;
+        Mcounter.unlock();
+        cn=new Connection("PureImageCache"+QString::number(id),db);
+        if(!cn->open())
+        {
+#ifdef DEBUG_PUREIMAGECACHE
+            qDebug()<<"GetConnection: "<<cn->db.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+            delete cn;
+            cn=0;
+        }
+        // Deletes the connection of the old cache location, if any
+        connections.setLocalData(cn);
+        return cn;
+    }
     bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Types &type,const Point &pos,const int &zoom)
     {
         if(gtilecache.isEmpty()|gtilecache.isNull())
@@ -177,76 +278,63 @@ namespace core {
 #ifdef DEBUG_PUREIMAGECACHE
         qDebug()<<"PutImageToCache Start:";//<<pos;
 #endif //DEBUG_PUREIMAGECACHE
-        Mcounter.lock();
-        qlonglong id=++ConnCounter;
-        Mcounter.unlock();
+        Connection *cn=GetConnection();
+        if(cn)
         {
-            QSqlDatabase cn;
-            cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-            QString db=gtilecache+"Data.qmdb";
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if(cn.open())
+            cn->insert(tile,type,pos,zoom);
+        }
+        lock.unlock();
+        return true;
+    }
+    bool PureImageCache::PutImagesToCache(const QList<CacheItemQueue*> &tiles)
+    {
+        if(gtilecache.isEmpty()|gtilecache.isNull())
+            return false;
+        lock.lockForRead();
+        bool ret=false;
+        Connection *cn=GetConnection();
+        if(cn)
+        {
+            // One commit, and one journal sync, for the whole batch
+            cn->db.transaction();
+            foreach(CacheItemQueue *task,tiles)
             {
-                {
-                    QSqlQuery query(cn);
-                    query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
-                    query.addBindValue(pos.X());
-                    query.addBindValue(pos.Y());
-                    query.addBindValue(zoom);
-
-                    query.addBindValue((int)type);
-                    query.addBindValue(QDateTime::currentDateTime().toString());
-                    query.exec();
-                }
-                {
-                    QSqlQuery query(cn);
-                    query.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
-                    query.addBindValue(tile);
-                    query.exec();
-                }
-                cn.close();
+                cn->insert(task->GetImg(),task->GetMapType(),task->GetPosition(),task->GetZoom());
             }
+            ret=cn->db.commit();
+#ifdef DEBUG_PUREIMAGECACHE
+            qDebug()<<"PutImagesToCache:"<<tiles.count()<<"tiles"<<ret;
+#endif //DEBUG_PUREIMAGECACHE
         }
-        QSqlDatabase::removeDatabase(QString::number(id));
         lock.unlock();
-        return true;
+        return ret;
     }
     QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
     {
         lock.lockForRead();
         QByteArray ar;
         if(gtilecache.isEmpty()|gtilecache.isNull())
+        {
+            lock.unlock();
             return ar;
-        QString dir=gtilecache;
-        Mcounter.lock();
-        qlonglong id=++ConnCounter;
-        Mcounter.unlock();
+        }
 #ifdef DEBUG_PUREIMAGECACHE
-        qDebug()<<"Cache dir="<<dir<<" Try to GET:"<<pos.X()+","+pos.Y();
+        qDebug()<<"Cache dir="<<gtilecache<<" Try to GET:"<<pos.X()+","+pos.Y();
 #endif //DEBUG_PUREIMAGECACHE
-
-            QString db=dir+"Data.qmdb";
-			{
-				QSqlDatabase cn;
-			
-				cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-
-	            cn.setDatabaseName(db);
-		        cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-			    if(cn.open())
-				{
-					QSqlQuery query(cn);
-					query.exec(QString("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4)").arg(pos.X()).arg(pos.Y()).arg(zoom).arg((int) type));
-					query.next();
-					if(query.isValid())
-					{
-						ar=query.value(0).toByteArray();
-					}
-					cn.close();
-				}
-			}
-			QSqlDatabase::removeDatabase(QString::number(id));
+        Connection *cn=GetConnection();
+        if(cn)
+        {
+            QSqlQuery *query=cn->selectTile;
+            query->addBindValue(pos.X());
+            query->addBindValue(pos.Y());
+            query->addBindValue(zoom);
+            query->addBindValue((int) type);
+            if(query->exec() && query->next())
+            {
+                ar=query->value(0).toByteArray();
+            }
+            query->finish();
+        }
         lock.unlock();
         return ar;
     }
@@ -255,41 +343,31 @@ namespace core {
         if(gtilecache.isEmpty()|gtilecache.isNull())
             return;
         QList<long> add;
-        bool ret=true;
-        QString dir=gtilecache;
+        lock.lockForRead();
+        if(QFileInfo(gtilecache+"Data.qmdb").exists())
         {
-            QString db=dir+"Data.qmdb";
-            ret=QFileInfo(db).exists();
-            if(ret)
+            Connection *cn=GetConnection();
+            if(cn)
             {
-                QSqlDatabase cn;
-                Mcounter.lock();
-                qlonglong id=++ConnCounter;
-                Mcounter.unlock();
-                cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-                cn.setDatabaseName(db);
-                cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-                if(cn.open())
+                QSqlQuery query(cn->db);
+                query.exec(QString("SELECT id, X, Y, Zoom, Type, Date FROM Tiles"));
+                while(query.next())
                 {
-                    {
-                        QSqlQuery query(cn);
-                        query.exec(QString("SELECT id, X, Y, Zoom, Type, Date FROM Tiles"));
-                        while(query.next())
-                        {
-                            if(QDateTime::fromString(query.value(5).toString()).daysTo(QDateTime::currentDateTime())>days)
-                                add.append(query.value(0).toLongLong());
-                        }
-                        foreach(long i,add)
-                        {
-                            query.exec(QString("DELETE FROM Tiles WHERE id = %1;").arg(i));
-                        }
-                    }
-
-                    cn.close();
+                    if(QDateTime::fromString(query.value(5).toString()).daysTo(QDateTime::currentDateTime())>days)
+                        add.append(query.value(0).toLongLong());
                 }
-                QSqlDatabase::removeDatabase(QString::number(id));
+                query.finish();
+                cn->db.transaction();
+                query.prepare("DELETE FROM Tiles WHERE id = ?");
+                foreach(long i,add)
+                {
+                    query.addBindValue((qlonglong)i);
+                    query.exec();
+                }
+                cn->db.commit();
             }
         }
+        lock.unlock();
     }
     // PureImageCache::ExportMapDataToDB("C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data.qmdb","C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data2.qmdb");
     bool PureImageCache::ExportMapDataToDB(QString sourceFile, QString destFile)
@@ -42,6 +42,8 @@
 #include <QList>
 #include <QMutex>
 #include <QReadWriteLock>
+#include <QThreadStorage>
+#include "cacheitemqueue.h"
 namespace core {
     class PureImageCache
     {
@@ -50,16 +52,44 @@ namespace core {
         PureImageCache();
         static bool CreateEmptyDB(const QString &file);
         bool PutImageToCache(const QByteArray &tile,const MapType::Types &type,const core::Point &pos, const int &zoom);
+        /**
+         * @brief Stores all tiles in a single transaction
+         */
+        bool PutImagesToCache(const QList<CacheItemQueue*> &tiles);
         QByteArray GetImageFromCache(MapType::Types type, core::Point pos, int zoom);
         QString GtileCache();
         void setGtileCache(const QString &value);
         static bool ExportMapDataToDB(QString sourceFile, QString destFile);
         void deleteOlderTiles(int const& days);
     private:
+        /**
+         * @brief An open database connection with its prepared statements.
+         *        SQLite connections may only be used by the thread that opened
+         *        them, so every thread keeps its own for as long as it lives.
+         */
+        class Connection
+        {
+        public:
+            Connection(const QString &name, const QString &file);
+            ~Connection();
+            bool open();
+            bool insert(const QByteArray &tile,const MapType::Types &type,const core::Point &pos, const int &zoom);
+
+            QString name;
+            QString file;
+            QSqlDatabase db;
+            QSqlQuery *insertTile;
+            QSqlQuery *insertTileData;
+            QSqlQuery *selectTile;
+        };
+        Connection* GetConnection();
+        static bool CreateIndex(QSqlDatabase &db);
+
         QString gtilecache;
         QMutex Mcounter;
         QReadWriteLock lock;
         static qlonglong ConnCounter;
+        QThreadStorage<Connection*> connections;
 
     };
 
@@ -79,23 +79,25 @@ void TileCacheQueue::run()
 #endif //DEBUG_TILECACHEQUEUE
     while(true)
     {
-        CacheItemQueue *task;
+        QList<CacheItemQueue*> batch;
 #ifdef DEBUG_TILECACHEQUEUE
         qDebug()<<"Cache";
 #endif //DEBUG_TILECACHEQUEUE
-        if(tileCacheQueue.count()>0)
+        mutex.lock();
+        while(!tileCacheQueue.isEmpty() && batch.count()<MaxBatchSize)
+            batch.append(tileCacheQueue.dequeue());
+        mutex.unlock();
+        if(batch.count()>0)
         {
-            mutex.lock();
-            task=tileCacheQueue.dequeue();
-            mutex.unlock();
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug()<<"Cache engine Put:"<<task->GetPosition().X()<<","<<task->GetPosition().Y();
+            qDebug()<<"Cache engine Put:"<<batch.count()<<"tiles";
 #endif //DEBUG_TILECACHEQUEUE
-            Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(),task->GetMapType(),task->GetPosition(),task->GetZoom());
-            usleep(44);
-            delete task;
+            // A whole batch is written in a single transaction
+            Cache::Instance()->ImageCache.PutImagesToCache(batch);
+            qDeleteAll(batch);
+            // Tiles usually arrive in bursts, give the next batch time to fill
+            msleep(BatchInterval);
         }
-
         else
         {
             #ifdef DEBUG_TILECACHEQUEUE
@@ -103,9 +105,10 @@ void TileCacheQueue::run()
             #endif //DEBUG_TILECACHEQUEUE
             waitmutex.lock();
             int tout=4000;
-            if(!waitc.wait(&waitmutex,tout))
+            bool woken=waitc.wait(&waitmutex,tout);
+            waitmutex.unlock();
+            if(!woken)
             {
-                waitmutex.unlock();
 #ifdef DEBUG_TILECACHEQUEUE
                 qDebug()<<"Cache Engine TimeOut";
 #endif //DEBUG_TILECACHEQUEUE
@@ -117,10 +120,6 @@ void TileCacheQueue::run()
                 }
                 mutex.unlock();
             }
-            #ifdef DEBUG_TILECACHEQUEUE
-            qDebug()<<"Cache Engine DID NOT TimeOut";
-            #endif //DEBUG_TILECACHEQUEUE
-            waitmutex.unlock();
         }
     }
 #ifdef DEBUG_TILECACHEQUEUE
@@ -128,5 +127,4 @@ void TileCacheQueue::run()
 #endif //DEBUG_TILECACHEQUEUE
 }
 
-
 }
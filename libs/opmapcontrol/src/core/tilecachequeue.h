@@ -51,6 +51,8 @@ namespace core {
         QQueue<CacheItemQueue*> tileCacheQueue;
     private:
         void run();
+        static const int MaxBatchSize = 128;    // Tiles written per transaction
+        static const int BatchInterval = 100;   // msecs to let a batch accumulate
         QMutex mutex;
         QMutex waitmutex;
         QWaitCondition waitc;
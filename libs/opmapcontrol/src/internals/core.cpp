@@ -53,6 +53,7 @@ namespace internals {
         SetProjection(new MercatorProjection());
         this->setAutoDelete(false);
         ProcessLoadTaskCallback.setMaxThreadCount(10);
+        PrefetchCallback.setMaxThreadCount(2);
         renderOffset=Point(0,0);
         dragPoint=Point(0,0);
         CanDragMap=true;
@@ -61,6 +62,8 @@ namespace internals {
     }
     Core::~Core()
     {
+        CancelPrefetch();
+        PrefetchCallback.waitForDone();
         ProcessLoadTaskCallback.waitForDone();
     }
 
@@ -128,31 +131,31 @@ namespace internals {
                             int retry = 0;
                             do
                             {
-                                QByteArray img;
+                                QImage img;
 
                                 // tile number inversion(BottomLeft -> TopLeft) for pergo maps
                                 if(tl == MapType::PergoTurkeyMap)
                                 {
-                                    img = OPMaps::Instance()->GetImageFrom(tl, Point(task.Pos.X(), maxOfTiles.Height() - task.Pos.Y()), task.Zoom);
+                                    img = OPMaps::Instance()->GetTileImage(tl, Point(task.Pos.X(), maxOfTiles.Height() - task.Pos.Y()), task.Zoom);
                                 }
                                 else // ok
                                 {
 #ifdef DEBUG_CORE
                                     qDebug()<<"start getting image"<<" ID="<<debug;
 #endif //DEBUG_CORE
-                                    img = OPMaps::Instance()->GetImageFrom(tl, task.Pos, task.Zoom);
+                                    img = OPMaps::Instance()->GetTileImage(tl, task.Pos, task.Zoom);
 #ifdef DEBUG_CORE
-                                    qDebug()<<"Core::run:gotimage size:"<<img.count()<<" ID="<<debug<<" time="<<t.elapsed();
+                                    qDebug()<<"Core::run:gotimage size:"<<img.byteCount()<<" ID="<<debug<<" time="<<t.elapsed();
 #endif //DEBUG_CORE
                                 }
 
-                                if(img.length()!=0)
+                                if(!img.isNull())
                                 {
                                     Moverlays.lock();
                                     {
                                         t->Overlays.append(img);
 #ifdef DEBUG_CORE
-                                        qDebug()<<"Core::run append img:"<<img.length()<<" to tile:"<<t->GetPos().ToString()<<" now has "<<t->Overlays.count()<<" overlays"<<" ID="<<debug;
+                                        qDebug()<<"Core::run append img:"<<img.byteCount()<<" to tile:"<<t->GetPos().ToString()<<" now has "<<t->Overlays.count()<<" overlays"<<" ID="<<debug;
 #endif //DEBUG_CORE
 
                                     }
@@ -204,10 +207,6 @@ namespace internals {
                     // last buddy cleans stuff ;}
                     if(last)
                     {
-                        OPMaps::Instance()->kiberCacheLock.lockForWrite();
-                        OPMaps::Instance()->TilesInMemory.RemoveMemoryOverload();
-                        OPMaps::Instance()->kiberCacheLock.unlock();
-
                         MtileDrawingList.lock();
                         {
                             Matrix.ClearPointsNotIn(tileDrawingList);
@@ -217,6 +216,8 @@ namespace internals {
 
                         emit OnTileLoadComplete();
 
+                        SchedulePrefetch();
+
 
                         emit OnNeedInvalidation();
 
@@ -255,6 +256,7 @@ namespace internals {
             currentPositionPixel=Projection()->FromLatLngToPixel(currentPosition,value);
             if(started)
             {
+                CancelPrefetch();
                 MtileLoadQueue.lock();
                 tileLoadQueue.clear();
                 MtileLoadQueue.unlock();
@@ -503,6 +505,7 @@ namespace internals {
             qDebug()<<"------------------";
 #endif //DEBUG_CORE
 
+            CancelPrefetch();
             MtileLoadQueue.lock();
             {
                 tileLoadQueue.clear();
@@ -610,6 +613,7 @@ namespace internals {
     {
         if(started)
         {
+            CancelPrefetch();
             ProcessLoadTaskCallback.waitForDone();
             MtileLoadQueue.lock();
             {
@@ -694,6 +698,64 @@ namespace internals {
         }
 
 
+    }
+    void Core::SchedulePrefetch()
+    {
+        if(!OPMaps::Instance()->UseMemoryCache())
+            return;
+        // Anything still queued from an older view is no longer useful
+        CancelPrefetch();
+        QList<LoadTask> tasks;
+
+        // The ring of tiles around the drawn area, where panning goes next
+        int w=sizeOfMapArea.Width()+1;
+        int h=sizeOfMapArea.Height()+1;
+        for(int i = -w; i <= w; i++)
+        {
+            for(int j = -h; j <= h; j++)
+            {
+                if(qAbs(i)!=w && qAbs(j)!=h)
+                    continue;
+                Point p(centerTileXYLocation.X()+i,centerTileXYLocation.Y()+j);
+                if(p.X() >= minOfTiles.Width() && p.Y() >= minOfTiles.Height() && p.X() <= maxOfTiles.Width() && p.Y() <= maxOfTiles.Height())
+                    tasks.append(LoadTask(p,zoom));
+            }
+        }
+
+        // The next zoom level under the centre of the view
+        if(zoom < maxzoom)
+        {
+            Size min=Projection()->GetTileMatrixMinXY(zoom+1);
+            Size max=Projection()->GetTileMatrixMaxXY(zoom+1);
+            for(int i = -1; i <= 1; i++)
+            {
+                for(int j = -1; j <= 1; j++)
+                {
+                    for(int k = 0; k < 4; k++)
+                    {
+                        Point p((centerTileXYLocation.X()+i)*2+k%2,(centerTileXYLocation.Y()+j)*2+k/2);
+                        if(p.X() >= min.Width() && p.Y() >= min.Height() && p.X() <= max.Width() && p.Y() <= max.Height())
+                            tasks.append(LoadTask(p,zoom+1));
+                    }
+                }
+            }
+        }
+
+        QVector<MapType::Types> layers= OPMaps::Instance()->GetAllLayersOfType(GetMapType());
+        foreach(LoadTask task,tasks)
+        {
+            foreach(MapType::Types tl,layers)
+            {
+                Point pos=task.Pos;
+                // tile number inversion(BottomLeft -> TopLeft) for pergo maps
+                if(tl == MapType::PergoTurkeyMap)
+                    pos.SetY(Projection()->GetTileMatrixMaxXY(task.Zoom).Height() - pos.Y());
+                PrefetchCallback.start(new TilePrefetchTask(tl,pos,task.Zoom,&prefetchGeneration));
+            }
+        }
+#ifdef DEBUG_CORE
+        qDebug()<<"Core::SchedulePrefetch "<<tasks.count()<<" tiles";
+#endif //DEBUG_CORE
     }
     void Core::UpdateGroundResolution()
     {
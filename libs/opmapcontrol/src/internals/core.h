@@ -40,6 +40,7 @@
 #include "tilematrix.h"
 #include <QQueue>
 #include "loadtask.h"
+#include "tileprefetchtask.h"
 #include "copyrightstrings.h"
 #include "rectlatlng.h"
 #include "../internals/projections/lks94projection.h"
@@ -52,6 +53,7 @@
 #include "../core/diagnostics.h"
 
 #include <QSemaphore>
+#include <QAtomicInt>
 #include <QThread>
 #include <QDateTime>
 
@@ -186,6 +188,17 @@ namespace internals {
 
         void FindTilesAround(QList<core::Point> &list);
 
+        /**
+        * @brief Queues the tiles just outside the view and the next zoom level
+        *        under its centre for background loading into the memory cache
+        */
+        void SchedulePrefetch();
+
+        /**
+        * @brief Drops all prefetch tasks that have not started yet
+        */
+        void CancelPrefetch(){prefetchGeneration.ref();}
+
         void UpdateGroundResolution();
 
         TileMatrix Matrix;
@@ -255,6 +268,8 @@ namespace internals {
         QSemaphore loaderLimit;
 
         QThreadPool ProcessLoadTaskCallback;
+        QThreadPool PrefetchCallback;
+        QAtomicInt prefetchGeneration;
         QMutex MtileToload;
         int tilesToload;
 
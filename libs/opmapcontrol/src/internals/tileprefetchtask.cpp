@@ -0,0 +1,47 @@
+/**
+******************************************************************************
+*
+* @file       tileprefetchtask.cpp
+* @author     The APM Planner Team, Copyright (C) 2014.
+* @brief      Loads a tile into the memory cache in the background
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   OPMapWidget
+* @{
+* 
+*****************************************************************************/
+/* 
+* This program is free software; you can redistribute it and/or modify 
+* it under the terms of the GNU General Public License as published by 
+* the Free Software Foundation; either version 3 of the License, or 
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful, but 
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY 
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License 
+* for more details.
+* 
+* You should have received a copy of the GNU General Public License along 
+* with this program; if not, write to the Free Software Foundation, Inc., 
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+#include "tileprefetchtask.h"
+#include "../core/opmaps.h"
+
+namespace internals {
+TilePrefetchTask::TilePrefetchTask(const core::MapType::Types &type, const core::Point &pos, const int &zoom, QAtomicInt *generation):
+    type(type),
+    pos(pos),
+    zoom(zoom),
+    generation(generation),
+    queuedGeneration(generation->loadAcquire())
+{
+}
+void TilePrefetchTask::run()
+{
+    if(generation->loadAcquire()!=queuedGeneration)
+        return;
+    if(core::OPMaps::Instance()->IsTileInMemory(type,pos,zoom))
+        return;
+    core::OPMaps::Instance()->GetTileImage(type,pos,zoom);
+}
+}
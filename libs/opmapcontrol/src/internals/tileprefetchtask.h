@@ -0,0 +1,55 @@
+/**
+******************************************************************************
+*
+* @file       tileprefetchtask.h
+* @author     The APM Planner Team, Copyright (C) 2014.
+* @brief      Loads a tile into the memory cache in the background
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   OPMapWidget
+* @{
+* 
+*****************************************************************************/
+/* 
+* This program is free software; you can redistribute it and/or modify 
+* it under the terms of the GNU General Public License as published by 
+* the Free Software Foundation; either version 3 of the License, or 
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful, but 
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY 
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License 
+* for more details.
+* 
+* You should have received a copy of the GNU General Public License along 
+* with this program; if not, write to the Free Software Foundation, Inc., 
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+#ifndef TILEPREFETCHTASK_H
+#define TILEPREFETCHTASK_H
+
+#include <QRunnable>
+#include <QAtomicInt>
+#include "../core/maptype.h"
+#include "../core/point.h"
+
+namespace internals
+{
+/**
+* @brief Fetches and decodes one tile that is likely to be shown soon, so
+*        panning or zooming finds it in the memory cache. Stale tasks (the
+*        generation changed since they were queued) do nothing.
+*/
+class TilePrefetchTask : public QRunnable
+{
+public:
+    TilePrefetchTask(const core::MapType::Types &type,const core::Point &pos,const int &zoom,QAtomicInt *generation);
+    void run();
+private:
+    core::MapType::Types type;
+    core::Point pos;
+    int zoom;
+    QAtomicInt *generation;
+    int queuedGeneration;
+};
+}
+#endif // TILEPREFETCHTASK_H
@@ -14,7 +14,8 @@ SOURCES += mapgraphicitem.cpp \
     homeitem.cpp \
     mapripform.cpp \
     mapripper.cpp \
-    traillineitem.cpp
+    traillineitem.cpp \
+    trailpathitem.cpp
 
 LIBS += -L../build \
     -lcore \
@@ -39,7 +40,8 @@ HEADERS += mapgraphicitem.h \
     homeitem.h \
     mapripform.h \
     mapripper.h \
-    traillineitem.h
+    traillineitem.h \
+    trailpathitem.h
 QT += opengl
 QT += network
 QT += sql
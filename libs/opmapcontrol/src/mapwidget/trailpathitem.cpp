@@ -0,0 +1,209 @@
+/**
+******************************************************************************
+*
+* @file       trailpathitem.cpp
+* @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+* @brief      A graphicsItem drawing a bounded UAV trail as one path
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   OPMapWidget
+* @{
+*
+*****************************************************************************/
+/*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+#include "trailpathitem.h"
+#include <QStyleOptionGraphicsItem>
+
+namespace mapcontrol
+{
+    /// Samples closer than this to the previous kept one (in pixels) are not drawn
+    static const qreal TRAIL_LINE_MIN_SPACING = 2.0;
+    /// Minimal spacing between two drawn trail dots, in pixels
+    static const qreal TRAIL_DOT_MIN_SPACING = 6.0;
+    /// Default number of samples kept, about 14 hours at one sample every 5 seconds
+    static const int TRAIL_DEFAULT_LENGTH = 10000;
+
+    TrailPathItem::TrailPathItem(MapGraphicItem* map):QGraphicsItem(map),map(map),head(0),count(0),dropped(0),color(Qt::red),
+        showdots(true),showline(true),projectedzoom(-1)
+    {
+        samples.resize(TRAIL_DEFAULT_LENGTH);
+        this->setFlag(QGraphicsItem::ItemUsesExtendedStyleOption,true);
+    }
+
+    void TrailPathItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+    {
+        Q_UNUSED(widget);
+        QPen pen(color);
+        pen.setWidth(1);
+        pen.setCosmetic(true);
+        painter->setPen(pen);
+        if(showline)
+        {
+            painter->setBrush(Qt::NoBrush);
+            painter->drawPath(line);
+        }
+        if(showdots)
+        {
+            QRectF exposed=option->exposedRect.adjusted(-2,-2,2,2);
+            painter->setPen(Qt::black);
+            painter->setBrush(color);
+            foreach(const QPointF& p,dots)
+            {
+                if(exposed.contains(p))
+                    painter->drawEllipse(p,2,2);
+            }
+        }
+    }
+    QRectF TrailPathItem::boundingRect()const
+    {
+        return bounds;
+    }
+    int TrailPathItem::type()const
+    {
+        return Type;
+    }
+
+    void TrailPathItem::AddSample(const internals::PointLatLng &coord, const QColor &color)
+    {
+        if(this->color!=color)
+        {
+            this->color=color;
+            update();
+        }
+        if(samples.isEmpty())
+            return;
+        if(count<samples.size())
+        {
+            samples[(head+count)%samples.size()]=coord;
+            ++count;
+        }
+        else
+        {
+            // Overwrite the oldest sample; the cached geometry keeps it until enough
+            // samples were dropped to be worth a rebuild
+            samples[head]=coord;
+            head=(head+1)%samples.size();
+            ++dropped;
+        }
+        if(count==1||projectedzoom!=map->ZoomTotal()||dropped>samples.size()/20)
+            Rebuild();
+        else
+        {
+            QPointF last=line.currentPosition();
+            QPointF point=Project(coord)-pos();
+            if(AppendProjected(point))
+            {
+                QRectF dirty=QRectF(last,point).normalized().adjusted(-3,-3,3,3);
+                if(!bounds.contains(dirty))
+                {
+                    prepareGeometryChange();
+                    bounds=bounds.united(dirty);
+                }
+                update(dirty);
+            }
+        }
+    }
+    void TrailPathItem::Clear()
+    {
+        head=0;
+        count=0;
+        Rebuild();
+    }
+    void TrailPathItem::SetTrailLength(const int &value)
+    {
+        int length=qMax(1,value);
+        if(length==samples.size())
+            return;
+        // Keep the newest samples that still fit
+        QVector<internals::PointLatLng> resized(length);
+        int kept=qMin(count,length);
+        for(int i=0;i<kept;++i)
+            resized[i]=samples[(head+count-kept+i)%samples.size()];
+        samples=resized;
+        head=0;
+        count=kept;
+        Rebuild();
+    }
+    void TrailPathItem::SetShowDots(const bool &value)
+    {
+        showdots=value;
+        update();
+    }
+    void TrailPathItem::SetShowLine(const bool &value)
+    {
+        showline=value;
+        update();
+    }
+
+    void TrailPathItem::RefreshPos()
+    {
+        if(count==0)
+            return;
+        if(projectedzoom!=map->ZoomTotal())
+        {
+            Rebuild();
+            return;
+        }
+        // Same zoom: the map only moved, so the cached geometry just follows the anchor
+        QPointF offset=Project(anchor)-anchorlocal;
+        if(offset!=pos())
+            setPos(offset);
+    }
+
+    QPointF TrailPathItem::Project(const internals::PointLatLng &coord)const
+    {
+        core::Point p=map->FromLatLngToLocal(coord);
+        return QPointF(p.X(),p.Y());
+    }
+    bool TrailPathItem::AppendProjected(const QPointF &point)
+    {
+        if(line.elementCount()==0)
+        {
+            line.moveTo(point);
+            dots.append(point);
+            return true;
+        }
+        QPointF last=line.currentPosition();
+        if(qAbs(point.x()-last.x())+qAbs(point.y()-last.y())<TRAIL_LINE_MIN_SPACING)
+            return false;
+        line.lineTo(point);
+        QPointF lastdot=dots.last();
+        if(qAbs(point.x()-lastdot.x())+qAbs(point.y()-lastdot.y())>=TRAIL_DOT_MIN_SPACING)
+            dots.append(point);
+        return true;
+    }
+    void TrailPathItem::Rebuild()
+    {
+        prepareGeometryChange();
+        line=QPainterPath();
+        dots.clear();
+        bounds=QRectF();
+        dropped=0;
+        setPos(0,0);
+        projectedzoom=map->ZoomTotal();
+        if(count>0)
+        {
+            anchor=samples[head];
+            anchorlocal=Project(anchor);
+            dots.reserve(count);
+            for(int i=0;i<count;++i)
+                AppendProjected(Project(samples[(head+i)%samples.size()]));
+            dots.squeeze();
+            bounds=line.boundingRect().adjusted(-3,-3,3,3);
+        }
+        update();
+    }
+}
@@ -0,0 +1,119 @@
+/**
+******************************************************************************
+*
+* @file       trailpathitem.h
+* @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+* @brief      A graphicsItem drawing a bounded UAV trail as one path
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   OPMapWidget
+* @{
+*
+*****************************************************************************/
+/*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, write to the Free Software Foundation, Inc.,
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+#ifndef TRAILPATHITEM_H
+#define TRAILPATHITEM_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPainterPath>
+#include <QVector>
+#include "../internals/pointlatlng.h"
+#include "mapgraphicitem.h"
+
+namespace mapcontrol
+{
+    /**
+* @brief A single QGraphicsItem holding a UAV trail
+*
+* Samples are kept in a fixed-size ring buffer of coordinates, so a long flight
+* costs a bounded amount of memory instead of one item per sample. The drawn
+* geometry is cached in local pixel coordinates: panning only moves the item,
+* and the samples are projected again only when the zoom changes. Samples that
+* fall closer than a couple of pixels to the previous kept one are skipped, so
+* the number of drawn vertices depends on the zoom level and not on the flight
+* length.
+*
+* @class TrailPathItem trailpathitem.h "mapwidget/trailpathitem.h"
+*/
+    class TrailPathItem:public QGraphicsItem
+    {
+    public:
+                enum { Type = UserType + 8 };
+        TrailPathItem(MapGraphicItem* map);
+        void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+                    QWidget *widget);
+        QRectF boundingRect() const;
+        int type() const;
+        /**
+        * @brief Appends a sample to the trail, dropping the oldest one if the trail is full
+        *
+        * @param coord sample position
+        * @param color color used to draw the trail
+        */
+        void AddSample(internals::PointLatLng const& coord, QColor const& color);
+        /**
+        * @brief Removes all samples
+        */
+        void Clear();
+        /**
+        * @brief Sets the maximum number of samples kept, older samples are dropped first
+        *
+        * @param value number of samples
+        */
+        void SetTrailLength(int const& value);
+        /**
+        * @brief Returns the maximum number of samples kept
+        *
+        * @return int
+        */
+        int TrailLength()const{return samples.size();}
+        /**
+        * @brief Returns the number of samples currently kept
+        *
+        * @return int
+        */
+        int SampleCount()const{return count;}
+        void SetShowDots(bool const& value);
+        void SetShowLine(bool const& value);
+        /**
+        * @brief Follows a map move or zoom, reprojecting the samples only if the zoom changed
+        */
+        void RefreshPos();
+
+    private:
+        MapGraphicItem* map;
+        QVector<internals::PointLatLng> samples;    ///< Ring buffer of trail samples
+        int head;                                    ///< Index of the oldest sample
+        int count;                                   ///< Number of valid samples
+        int dropped;                                 ///< Samples overwritten since the geometry was built
+        QColor color;
+        bool showdots;
+        bool showline;
+
+        double projectedzoom;                        ///< Zoom the cached geometry was built for
+        internals::PointLatLng anchor;               ///< Coordinate used to follow panning
+        QPointF anchorlocal;                         ///< Local position of the anchor when the geometry was built
+        QPainterPath line;                           ///< Decimated trail line, in item coordinates
+        QVector<QPointF> dots;                       ///< Decimated trail dots, in item coordinates
+        QRectF bounds;
+
+        QPointF Project(internals::PointLatLng const& coord)const;
+        bool AppendProjected(QPointF const& point);
+        void Rebuild();
+    };
+}
+#endif // TRAILPATHITEM_H
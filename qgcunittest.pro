@@ -30,6 +30,7 @@ QT += network \
     webkit \
     sql \
     testlib \
+    serialport \
 
 TEMPLATE = app
 TARGET = qgcunittest
@@ -168,6 +169,7 @@ FORMS += src/ui/MainWindow.ui \
     src/ui/UASControl.ui \
     src/ui/UASList.ui \
     src/ui/UASInfo.ui \
+    src/uas/LogDownloadDialog.ui \
     src/ui/Linechart.ui \
     src/ui/UASView.ui \
     src/ui/ParameterInterface.ui \
@@ -237,6 +239,7 @@ INCLUDEPATH += src \
     src/ui/mavlink \
     src/ui/param \
     src/ui/watchdog \
+    src/ui/configuration \
     src/ui/map3D \
     src/ui/mission \
     src/ui/designer
@@ -245,12 +248,20 @@ HEADERS += src/MG.h \
     src/uas/UASInterface.h \
     src/uas/UAS.h \
     src/uas/UASManager.h \
+    src/uas/LogDownloadDialog.h \
     src/comm/LinkManager.h \
     src/comm/LinkInterface.h \
     src/comm/SerialLinkInterface.h \
     src/comm/SerialLink.h \
     src/comm/ProtocolInterface.h \
     src/comm/MAVLinkProtocol.h \
+    src/comm/MAVLinkProtocolWorker.h \
+    src/comm/MAVLinkFrameScanner.h \
+    src/comm/TLogIndex.h \
+    src/comm/TLogReplayLink.h \
+    src/comm/TelemetryBus.h \
+    src/comm/SPSCRingBuffer.h \
+    src/comm/TLogWriter.h \
     src/comm/QGCFlightGearLink.h \
     src/ui/CommConfigurationWindow.h \
     src/ui/SerialConfigurationWindow.h \
@@ -261,6 +272,7 @@ HEADERS += src/MG.h \
     src/ui/HUD.h \
     src/ui/linechart/LinechartWidget.h \
     src/ui/linechart/LinechartPlot.h \
+    src/ui/linechart/RollingStatistics.h \
     src/ui/linechart/Scrollbar.h \
     src/ui/linechart/ScrollZoomer.h \
     src/configuration.h \
@@ -292,7 +304,10 @@ HEADERS += src/MG.h \
     src/ui/watchdog/WatchdogView.h \
     src/uas/UASWaypointManager.h \
     src/ui/HSIDisplay.h \
+    src/ui/PrimaryFlightDisplay.h \
+    src/ui/configuration/PX4FirmwareUploader.h \
     src/QGC.h \
+    src/globalobject.h \
     src/ui/QGCFirmwareUpdate.h \
     src/ui/QGCPxImuFirmwareUpdate.h \
     src/ui/QGCDataPlot2D.h \
@@ -347,7 +362,7 @@ HEADERS += src/MG.h \
     src/QGCGeo.h \
     src/ui/QGCToolBar.h \
     src/ui/QGCMAVLinkInspector.h \
-    src/ui/MAVLinkDecoder.h \
+    src/comm/MAVLinkDecoder.h \
     src/ui/WaypointViewOnlyView.h \
     src/ui/WaypointViewOnlyView.h \
     src/ui/WaypointEditableView.h \    
@@ -368,7 +383,16 @@ HEADERS += src/MG.h \
     src/ui/mission/QGCMissionNavLand.h \
     src/ui/mission/QGCMissionNavTakeoff.h \
     $$TESTDIR/AutoTest.h \
+    $$TESTDIR/MockLink.h \
     $$TESTDIR/UASUnitTest.h \
+    $$TESTDIR/MAVLinkProtocolTest.h \
+    $$TESTDIR/RollingStatisticsTest.h \
+    $$TESTDIR/LogDownloadDialogTest.h \
+    $$TESTDIR/InstrumentPaintTest.h \
+    $$TESTDIR/MockBootloader.h \
+    $$TESTDIR/PX4FirmwareUploaderTest.h \
+    $$TESTDIR/MAVLinkFrameScannerTest.h \
+    $$TESTDIR/TelemetryBusTest.h \
 
 # Google Earth is only supported on Mac OS and Windows with Visual Studio Compiler
 macx|macx-g++|macx-g++42|win32-msvc2008|win32-msvc2010::HEADERS += src/ui/map3D/QGCGoogleEarthView.h
@@ -417,11 +441,18 @@ contains(DEPENDENCIES_PRESENT, libfreenect) {
 
 SOURCES += src/QGCCore.cc \
     src/uas/UASManager.cc \
+    src/uas/LogDownloadDialog.cc \
     src/uas/UAS.cc \
     src/comm/LinkManager.cc \
     src/comm/LinkInterface.cpp \
     src/comm/SerialLink.cc \
     src/comm/MAVLinkProtocol.cc \
+    src/comm/MAVLinkProtocolWorker.cc \
+    src/comm/MAVLinkFrameScanner.cc \
+    src/comm/TLogIndex.cc \
+    src/comm/TLogReplayLink.cc \
+    src/comm/TelemetryBus.cc \
+    src/comm/TLogWriter.cc \
     src/comm/QGCFlightGearLink.cc \
     src/ui/CommConfigurationWindow.cc \
     src/ui/SerialConfigurationWindow.cc \
@@ -432,6 +463,7 @@ SOURCES += src/QGCCore.cc \
     src/ui/HUD.cc \
     src/ui/linechart/LinechartWidget.cc \
     src/ui/linechart/LinechartPlot.cc \
+    src/ui/linechart/RollingStatistics.cc \
     src/ui/linechart/Scrollbar.cc \
     src/ui/linechart/ScrollZoomer.cc \
     src/ui/uas/UASView.cc \
@@ -462,7 +494,10 @@ SOURCES += src/QGCCore.cc \
     src/ui/watchdog/WatchdogView.cc \
     src/uas/UASWaypointManager.cc \
     src/ui/HSIDisplay.cc \
+    src/ui/PrimaryFlightDisplay.cc \
+    src/ui/configuration/PX4FirmwareUploader.cc \
     src/QGC.cc \
+    src/globalobject.cc \
     src/ui/QGCFirmwareUpdate.cc \
     src/ui/QGCPxImuFirmwareUpdate.cc \
     src/ui/QGCDataPlot2D.cc \
@@ -513,7 +548,7 @@ SOURCES += src/QGCCore.cc \
     src/ui/mission/QGCMissionNavLoiterTime.cc \
     src/ui/QGCToolBar.cc \
     src/ui/QGCMAVLinkInspector.cc \
-    src/ui/MAVLinkDecoder.cc \
+    src/comm/MAVLinkDecoder.cc \
     src/ui/WaypointViewOnlyView.cc \
     src/ui/WaypointEditableView.cc \
     src/ui/UnconnectedUASInfoWidget.cc \
@@ -523,7 +558,14 @@ SOURCES += src/QGCCore.cc \
     src/ui/QGCPluginHost.cc \
     src/ui/firmwareupdate/QGCPX4FirmwareUpdate.cc \
     $$TESTDIR/testSuite.cc \
-    $$TESTDIR/UASUnitTest.cc
+    $$TESTDIR/UASUnitTest.cc \
+    $$TESTDIR/MAVLinkProtocolTest.cc \
+    $$TESTDIR/RollingStatisticsTest.cc \
+    $$TESTDIR/LogDownloadDialogTest.cc \
+    $$TESTDIR/InstrumentPaintTest.cc \
+    $$TESTDIR/PX4FirmwareUploaderTest.cc \
+    $$TESTDIR/MAVLinkFrameScannerTest.cc \
+    $$TESTDIR/TelemetryBusTest.cc
 
 # Enable Google Earth only on Mac OS and Windows with Visual Studio compiler
 macx|macx-g++|macx-g++42|win32-msvc2008|win32-msvc2010::SOURCES += src/ui/map3D/QGCGoogleEarthView.cc
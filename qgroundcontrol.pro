@@ -644,6 +644,7 @@ HEADERS += \
     src/output/logdata.h \
     src/ui/AP2DataPlot2D.h \
     src/ui/AP2DataPlotThread.h \
+    src/ui/AP2DataPlotGraph.h \
     src/ui/dataselectionscreen.h \
     src/ui/qcustomplot.h \
     src/globalobject.h \
@@ -658,10 +659,16 @@ HEADERS += \
     src/ui/AutoUpdateDialog.h \
     src/uas/LogDownloadDialog.h \
     src/comm/TLogReplayLink.h \
+    src/comm/TLogIndex.h \
+    src/comm/MAVLinkFrameScanner.h \
+    src/comm/TelemetryBus.h \
     src/ui/PrimaryFlightDisplayQML.h \
     src/ui/configuration/CompassMotorCalibrationDialog.h \
     src/comm/MAVLinkDecoder.h \
     src/comm/MAVLinkProtocol.h \
+    src/comm/MAVLinkProtocolWorker.h \
+    src/comm/SPSCRingBuffer.h \
+    src/comm/TLogWriter.h \
     src/ui/MissionElevationDisplay.h \
     src/ui/GoogleElevationData.h \
     src/ui/DroneshareUploadDialog.h \
@@ -866,6 +873,7 @@ SOURCES += src/main.cc \
     src/output/logdata.cc \
     src/ui/AP2DataPlot2D.cpp \
     src/ui/AP2DataPlotThread.cc \
+    src/ui/AP2DataPlotGraph.cc \
     src/ui/dataselectionscreen.cpp \
     src/ui/qcustomplot.cpp \
     src/globalobject.cc \
@@ -880,10 +888,15 @@ SOURCES += src/main.cc \
     src/ui/AutoUpdateDialog.cc \
     src/uas/LogDownloadDialog.cc \
     src/comm/TLogReplayLink.cc \
+    src/comm/TLogIndex.cc \
+    src/comm/MAVLinkFrameScanner.cc \
+    src/comm/TelemetryBus.cc \
     src/ui/PrimaryFlightDisplayQML.cpp \
     src/ui/configuration/CompassMotorCalibrationDialog.cpp \
     src/comm/MAVLinkDecoder.cc \
     src/comm/MAVLinkProtocol.cc \
+    src/comm/MAVLinkProtocolWorker.cc \
+    src/comm/TLogWriter.cc \
     src/ui/MissionElevationDisplay.cpp \
     src/ui/GoogleElevationData.cpp \
     src/ui/DroneshareUploadDialog.cpp \
@@ -23,6 +23,7 @@ This file is part of the QGROUNDCONTROL project
 
 #include "QGC.h"
 #include <qmath.h>
+#include <QElapsedTimer>
 #include <float.h>
 
 namespace QGC
@@ -55,6 +56,16 @@ qreal groundTimeSeconds()
     return static_cast<qreal>(seconds + (time.time().msec() / 1000.0));
 }
 
+qint64 applicationUptimeMilliseconds()
+{
+    static QElapsedTimer uptime;
+    if (!uptime.isValid())
+    {
+        uptime.start();
+    }
+    return uptime.elapsed();
+}
+
 float limitAngleToPMPIf(float angle)
 {
     if (angle > -20*M_PI && angle < 20*M_PI)
@@ -81,6 +81,8 @@ quint64 groundTimeUsecs();
 quint64 groundTimeMilliseconds();
 /** @brief Get the current ground time in seconds */
 qreal groundTimeSeconds();
+/** @brief Milliseconds since the first call, which QGCCore makes on launch to time the startup phases */
+qint64 applicationUptimeMilliseconds();
 /** @brief Returns the angle limited to -pi - pi */
 float limitAngleToPMPIf(float angle);
 /** @brief Returns the angle limited to -pi - pi */
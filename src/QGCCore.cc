@@ -34,6 +34,7 @@ This file is part of the QGROUNDCONTROL project
 #include "configuration.h"
 #include "QGC.h"
 #include "MainWindow.h"
+#include "TelemetryBus.h"
 #include "GAudioOutput.h"
 
 #ifdef OPAL_RT
@@ -65,6 +66,9 @@ This file is part of the QGROUNDCONTROL project
 
 QGCCore::QGCCore(int &argc, char* argv[]) : QApplication(argc, argv)
 {
+    // Start the uptime clock the startup phase timings are measured against
+    QGC::applicationUptimeMilliseconds();
+
     // Set settings format
     QSettings::setDefaultFormat(QSettings::IniFormat);
 
@@ -153,10 +157,12 @@ void QGCCore::initialize()
     // Start the comm link manager
     splashScreen->showMessage(tr("Starting Communication Links"), Qt::AlignLeft | Qt::AlignBottom, QColor(62, 93, 141));
     startLinkManager();
+    QLOG_INFO() << "Startup: link manager ready after" << QGC::applicationUptimeMilliseconds() << "ms";
 
     // Start the UAS Manager
     splashScreen->showMessage(tr("Starting UAS Manager"), Qt::AlignLeft | Qt::AlignBottom, QColor(62, 93, 141));
     startUASManager();
+    QLOG_INFO() << "Startup: UAS manager ready after" << QGC::applicationUptimeMilliseconds() << "ms";
 
     // Start the user interface
     splashScreen->showMessage(tr("Starting User Interface"), Qt::AlignLeft | Qt::AlignBottom, QColor(62, 93, 141));
@@ -187,6 +193,7 @@ void QGCCore::initialize()
 
     // Remove splash screen
     splashScreen->finish(mainWindow);
+    QLOG_INFO() << "Startup: main window shown after" << QGC::applicationUptimeMilliseconds() << "ms";
 
     if (upgraded) mainWindow->showInfoMessage(tr("Default Settings Loaded"),
                                               tr("APM Planner has been upgraded from version %1 to version %2. Some of your user preferences have been reset to defaults for safety reasons. Please adjust them where needed.").arg(lastApplicationVersion).arg(QGC_APPLICATION_VERSION));
@@ -220,6 +227,9 @@ QGCCore::~QGCCore()
 void QGCCore::startLinkManager()
 {
     QLOG_INFO() << "Start Link Manager";
+    // Links publish to the telemetry bus from their own threads, create it
+    // here on the GUI thread before the first link starts
+    TelemetryBus::instance();
     LinkManager::instance();
 }
 
@@ -85,13 +85,13 @@ bool Waypoint::isNavigationType()
 
 bool Waypoint::visibleOnMapWidget()
 {
-    QList<int> extraVisibleWaypoints;
     // add waypoints here,to be visible on map
-    extraVisibleWaypoints << MAV_CMD_DO_SET_ROI;
-    if(extraVisibleWaypoints.contains(action))
+    switch (action) {
+    case MAV_CMD_DO_SET_ROI:
         return true;
-    else
+    default:
         return false;
+    }
 }
 
 void Waypoint::save(QTextStream &saveStream)
@@ -61,6 +61,7 @@ LinkManager::LinkManager(QObject *parent) :
 {
     m_mavlinkLoggingEnabled = true;
     m_mavlinkDecoder = new MAVLinkDecoder(this);
+    m_mavlinkDecoder->setPublishToBus(true);
     m_mavlinkProtocol = new MAVLinkProtocol();
     m_mavlinkProtocol->setConnectionManager(this);
     connect(m_mavlinkProtocol,SIGNAL(messageReceived(LinkInterface*,mavlink_message_t)),m_mavlinkDecoder,SLOT(receiveMessage(LinkInterface*,mavlink_message_t)));
@@ -40,7 +40,7 @@ This file is part of the APM_PLANNER project
  * and emit signals upwards when mavlink messages come in.
  * This class lives in the UI thread
  * The Serial Link lives in the UI Thread
- * The mavlink decoder lives in its own thread
+ * The mavlink byte parser lives in one thread per link (see MAVLinkProtocolWorker)
  * the UAS Class lives in the UI thread
  */
 #include "MAVLinkDecoder.h"
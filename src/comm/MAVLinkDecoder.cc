@@ -35,9 +35,11 @@ This file is part of the APM_PLANNER project
 #include "MAVLinkDecoder.h"
 #include "QGC.h"
 #include <QDataStream>
+#include <QMetaMethod>
 #include "LinkManager.h"
 #include "UASManager.h"
 #include "UASInterface.h"
+#include "TelemetryBus.h"
 MAVLinkDecoder::MAVLinkDecoder(QObject *parent) : QObject(parent)
 {
     QLOG_DEBUG() << "Create MAVLinkDecoder: " << this;
@@ -46,32 +48,70 @@ MAVLinkDecoder::MAVLinkDecoder(QObject *parent) : QObject(parent)
     memcpy(messageInfo, msg, sizeof(mavlink_message_info_t)*256);
     memset(receivedMessages, 0, sizeof(mavlink_message_t)*256);
 
+    memset(componentID, -1, sizeof(componentID));
+    memset(componentMulti, 0, sizeof(componentMulti));
+    memset(messageFilter, 0, sizeof(messageFilter));
+    memset(textMessageFilter, 0, sizeof(textMessageFilter));
+    m_publishToBus = false;
+
+    // Precompute the per message/field name and type strings once, so the
+    // receive path never has to format them
+    for (int i=0;i<256;i++)
+    {
+        for (unsigned int j=0;j<messageInfo[i].num_fields;j++)
+        {
+            const mavlink_field_info_t &info = messageInfo[i].fields[j];
+            m_fieldBaseNames[i].append(QString("%1.%2").arg(messageInfo[i].name).arg(info.name));
+            QString type;
+            switch (info.type)
+            {
+            case MAVLINK_TYPE_CHAR: type = "char"; break;
+            case MAVLINK_TYPE_UINT8_T: type = "uint8_t"; break;
+            case MAVLINK_TYPE_INT8_T: type = "int8_t"; break;
+            case MAVLINK_TYPE_UINT16_T: type = "uint16_t"; break;
+            case MAVLINK_TYPE_INT16_T: type = "int16_t"; break;
+            case MAVLINK_TYPE_UINT32_T: type = "uint32_t"; break;
+            case MAVLINK_TYPE_INT32_T: type = "int32_t"; break;
+            case MAVLINK_TYPE_FLOAT: type = "float"; break;
+            case MAVLINK_TYPE_DOUBLE: type = "double"; break;
+            case MAVLINK_TYPE_UINT64_T: type = "uint64_t"; break;
+            case MAVLINK_TYPE_INT64_T: type = "int64_t"; break;
+            default: break;
+            }
+            if (info.array_length > 0 || info.type == MAVLINK_TYPE_CHAR)
+            {
+                type = QString("%1[%2]").arg(type).arg(info.array_length);
+            }
+            m_fieldTypeNames[i].append(type);
+        }
+    }
+
     // Allow system status
-//    messageFilter.insert(MAVLINK_MSG_ID_HEARTBEAT, false);
-//    messageFilter.insert(MAVLINK_MSG_ID_SYS_STATUS, false);
-    messageFilter.insert(MAVLINK_MSG_ID_STATUSTEXT, false);
-    messageFilter.insert(MAVLINK_MSG_ID_COMMAND_LONG, false);
-    messageFilter.insert(MAVLINK_MSG_ID_COMMAND_ACK, false);
-    messageFilter.insert(MAVLINK_MSG_ID_PARAM_SET, false);
-    messageFilter.insert(MAVLINK_MSG_ID_PARAM_VALUE, false);
-    messageFilter.insert(MAVLINK_MSG_ID_MISSION_ITEM, false);
-    messageFilter.insert(MAVLINK_MSG_ID_MISSION_COUNT, false);
-    messageFilter.insert(MAVLINK_MSG_ID_MISSION_ACK, false);
-    messageFilter.insert(MAVLINK_MSG_ID_DATA_STREAM, false);
-    messageFilter.insert(MAVLINK_MSG_ID_GPS_STATUS, false);
+//    messageFilter[MAVLINK_MSG_ID_HEARTBEAT] = true;
+//    messageFilter[MAVLINK_MSG_ID_SYS_STATUS] = true;
+    messageFilter[MAVLINK_MSG_ID_STATUSTEXT] = true;
+    messageFilter[MAVLINK_MSG_ID_COMMAND_LONG] = true;
+    messageFilter[MAVLINK_MSG_ID_COMMAND_ACK] = true;
+    messageFilter[MAVLINK_MSG_ID_PARAM_SET] = true;
+    messageFilter[MAVLINK_MSG_ID_PARAM_VALUE] = true;
+    messageFilter[MAVLINK_MSG_ID_MISSION_ITEM] = true;
+    messageFilter[MAVLINK_MSG_ID_MISSION_COUNT] = true;
+    messageFilter[MAVLINK_MSG_ID_MISSION_ACK] = true;
+    messageFilter[MAVLINK_MSG_ID_DATA_STREAM] = true;
+    messageFilter[MAVLINK_MSG_ID_GPS_STATUS] = true;
     #ifdef MAVLINK_MSG_ID_ENCAPSULATED_DATA
-    messageFilter.insert(MAVLINK_MSG_ID_ENCAPSULATED_DATA, false);
+    messageFilter[MAVLINK_MSG_ID_ENCAPSULATED_DATA] = true;
     #endif
     #ifdef MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE
-    messageFilter.insert(MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE, false);
+    messageFilter[MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE] = true;
     #endif
-    messageFilter.insert(MAVLINK_MSG_ID_EXTENDED_MESSAGE, false);
+    messageFilter[MAVLINK_MSG_ID_EXTENDED_MESSAGE] = true;
 
-    textMessageFilter.insert(MAVLINK_MSG_ID_DEBUG, false);
-    textMessageFilter.insert(MAVLINK_MSG_ID_DEBUG_VECT, false);
-    textMessageFilter.insert(MAVLINK_MSG_ID_NAMED_VALUE_FLOAT, false);
-    textMessageFilter.insert(MAVLINK_MSG_ID_NAMED_VALUE_INT, false);
-//    textMessageFilter.insert(MAVLINK_MSG_ID_HIGHRES_IMU, false);
+    textMessageFilter[MAVLINK_MSG_ID_DEBUG] = true;
+    textMessageFilter[MAVLINK_MSG_ID_DEBUG_VECT] = true;
+    textMessageFilter[MAVLINK_MSG_ID_NAMED_VALUE_FLOAT] = true;
+    textMessageFilter[MAVLINK_MSG_ID_NAMED_VALUE_INT] = true;
+//    textMessageFilter[MAVLINK_MSG_ID_HIGHRES_IMU] = true;
 
 }
 
@@ -80,6 +120,17 @@ MAVLinkDecoder::~MAVLinkDecoder()
     QLOG_DEBUG() << "Destroy MAVLinkDecoder: " << this;
 }
 
+void MAVLinkDecoder::setPublishToBus(bool publish)
+{
+    m_publishToBus = publish;
+    // Fields seen before publishing was turned on have no channel yet
+    for (int i=0;i<m_fieldDescriptors.size();i++)
+    {
+        FieldDescriptor &desc = m_fieldDescriptors[i];
+        desc.busChannel = publish ? TelemetryBus::instance()->channel(desc.name, desc.unit) : -1;
+    }
+}
+
 mavlink_field_info_t MAVLinkDecoder::getFieldInfo(QString msgname,QString fieldname)
 {
     mavlink_field_info_t fieldInfo;
@@ -127,6 +178,75 @@ void MAVLinkDecoder::sendMessage(mavlink_message_t msg)
 }
 
 
+QString MAVLinkDecoder::getFieldName(int fieldId) const
+{
+    if (fieldId < 0 || fieldId >= m_fieldDescriptors.size())
+    {
+        return QString();
+    }
+    return m_fieldDescriptors.at(fieldId).name;
+}
+
+QString MAVLinkDecoder::getFieldUnit(int fieldId) const
+{
+    if (fieldId < 0 || fieldId >= m_fieldDescriptors.size())
+    {
+        return QString();
+    }
+    return m_fieldDescriptors.at(fieldId).unit;
+}
+
+int MAVLinkDecoder::internField(const QString& name, const QString& unit)
+{
+    QHash<QString,int>::const_iterator it = m_fieldIdsByName.constFind(name);
+    if (it != m_fieldIdsByName.constEnd())
+    {
+        return it.value();
+    }
+    FieldDescriptor desc;
+    desc.name = name;
+    desc.unit = unit;
+    desc.busChannel = m_publishToBus ? TelemetryBus::instance()->channel(name, unit) : -1;
+    int fieldId = m_fieldDescriptors.size();
+    m_fieldDescriptors.append(desc);
+    m_fieldIdsByName.insert(name, fieldId);
+    emit fieldRegistered(fieldId, name, unit);
+    return fieldId;
+}
+
+int MAVLinkDecoder::internField(int sysid, int compid, uint8_t msgid, int fieldid, int arrayIndex)
+{
+    // compid < 0 means the message is not prefixed with its component.
+    // arrayIndex < 0 means a scalar field.
+    quint64 key = (static_cast<quint64>(sysid & 0xFF) << 48)
+                | (static_cast<quint64>(compid < 0 ? 0x100 : (compid & 0xFF)) << 32)
+                | (static_cast<quint64>(msgid) << 24)
+                | (static_cast<quint64>(fieldid & 0xFF) << 16)
+                | static_cast<quint64>((arrayIndex + 1) & 0xFFFF);
+
+    QHash<quint64,int>::const_iterator it = m_fieldIds.constFind(key);
+    if (it != m_fieldIds.constEnd())
+    {
+        return it.value();
+    }
+
+    // First sight of this field, build its name once
+    QString name = m_fieldBaseNames[msgid].at(fieldid);
+    if (arrayIndex >= 0)
+    {
+        name = QString("%1.%2").arg(name).arg(arrayIndex);
+    }
+    if (compid >= 0)
+    {
+        name.prepend(QString("C%1:").arg(compid));
+    }
+    name.prepend(QString("M%1:").arg(sysid));
+
+    int fieldId = internField(name, m_fieldTypeNames[msgid].at(fieldid));
+    m_fieldIds.insert(key, fieldId);
+    return fieldId;
+}
+
 QList<QPair<QString,QVariant> > MAVLinkDecoder::receiveMessage(LinkInterface* link, mavlink_message_t message)
 {
     Q_UNUSED(link);
@@ -150,44 +270,46 @@ QList<QPair<QString,QVariant> > MAVLinkDecoder::receiveMessage(LinkInterface* li
     }
     else
     {
+        if (messageInfo[msgid].num_fields == 0)
+        {
+            return QList<QPair<QString,QVariant> >();
+        }
 
-        QString messageName("%1 (#%2)");
-        messageName = messageName.arg(messageInfo[msgid].name).arg(msgid);
+        // Look the UAS up once per message, not once per field
+        UASInterface *uas = UASManager::instance()->getUASForId(message.sysid);
 
         // See if first value is a time value
         quint64 time = 0;
         uint8_t fieldid = 0;
         uint8_t* m = ((uint8_t*)(receivedMessages+msgid))+8;
+        const mavlink_field_info_t &timeField = messageInfo[msgid].fields[fieldid];
         QList<QPair<QString,QVariant> > retval;
-        if (QString(messageInfo[msgid].fields[fieldid].name) == QString("time_boot_ms") && messageInfo[msgid].fields[fieldid].type == MAVLINK_TYPE_UINT32_T)
+        if (strcmp(timeField.name, "time_boot_ms") == 0 && timeField.type == MAVLINK_TYPE_UINT32_T)
         {
-            time = *((quint32*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
+            quint32 boottime;
+            memcpy(&boottime, m+timeField.wire_offset, sizeof(boottime));
+            time = boottime;
 
             QPair<QString,QVariant> fieldval;
-            fieldval.first = QString("M%1:%2.%3")
-                             .arg(message.sysid)
-                             .arg(messageInfo[msgid].name)
-                             .arg(messageInfo[msgid].fields[fieldid].name);
+            fieldval.first = m_fieldDescriptors.at(internField(message.sysid, -1, msgid, fieldid, -1)).name;
             fieldval.second = time;
             retval.append(fieldval);
         }
-        else if (QString(messageInfo[msgid].fields[fieldid].name).contains("usec") && messageInfo[msgid].fields[fieldid].type == MAVLINK_TYPE_UINT64_T)
+        else if (strstr(timeField.name, "usec") != NULL && timeField.type == MAVLINK_TYPE_UINT64_T)
         {
-            time = *((quint64*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            time = (time+500)/1000; // Scale to milliseconds, round up/down correctly
+            quint64 usec;
+            memcpy(&usec, m+timeField.wire_offset, sizeof(usec));
+            time = (usec+500)/1000; // Scale to milliseconds, round up/down correctly
 
             QPair<QString,QVariant> fieldval;
-            fieldval.first = QString("M%1:%2.%3")
-                             .arg(message.sysid)
-                             .arg(messageInfo[msgid].name)
-                             .arg(messageInfo[msgid].fields[fieldid].name);
-            fieldval.second = *((quint64*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
+            fieldval.first = m_fieldDescriptors.at(internField(message.sysid, -1, msgid, fieldid, -1)).name;
+            fieldval.second = usec;
             retval.append(fieldval);
         }
         else
         {
             // First value is not time, send out value 0
-            QPair<QString,QVariant> fieldval = emitFieldValue(&message, fieldid, getUnixTimeFromMs(message.sysid, 0));
+            QPair<QString,QVariant> fieldval = emitFieldValue(uas, &message, fieldid, getUnixTimeFromMs(message.sysid, 0));
             if (fieldval.second.isValid())
             {
                 retval.append(fieldval);
@@ -201,7 +323,7 @@ QList<QPair<QString,QVariant> > MAVLinkDecoder::receiveMessage(LinkInterface* li
 
         for (unsigned int i = 1; i < messageInfo[msgid].num_fields; ++i)
         {
-            QPair<QString,QVariant> fieldval = emitFieldValue(&message, i, time);
+            QPair<QString,QVariant> fieldval = emitFieldValue(uas, &message, i, time);
             if (fieldval.second.isValid())
             {
                 retval.append(fieldval);
@@ -212,45 +334,70 @@ QList<QPair<QString,QVariant> > MAVLinkDecoder::receiveMessage(LinkInterface* li
     return QList<QPair<QString,QVariant> >();
 }
 
-
 QPair<QString,QVariant> MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time)
 {
-    UASInterface *uas = UASManager::instance()->getUASForId(msg->sysid);
-    bool localemit = false;
+    return emitFieldValue(UASManager::instance()->getUASForId(msg->sysid), msg, fieldid, time);
+}
+
+void MAVLinkDecoder::emitValue(UASInterface *uas, int sysid, int fieldId, const QVariant& value, double raw, quint64 time)
+{
+    const FieldDescriptor &desc = m_fieldDescriptors.at(fieldId);
+    emit fieldValueChanged(sysid, fieldId, raw, time);
+    if (m_publishToBus)
+    {
+        TelemetryBus::instance()->publish(desc.busChannel, sysid, raw, time);
+    }
     if (!uas)
     {
         //No active UAS for the incomign message.
-        localemit = true;
+        static const QMetaMethod signal = QMetaMethod::fromSignal(&MAVLinkDecoder::valueChanged);
+        if (isSignalConnected(signal))
+        {
+            emit valueChanged(sysid, desc.name, desc.unit, value, time);
+        }
+    }
+    else if (uas->hasValueChangedReceivers())
+    {
+        // Only widgets still on the QVariant path need this, the typed
+        // consumers read fieldValueChanged or the TelemetryBus.
+        uas->valueChangedRec(sysid, desc.name, desc.unit, value, time);
     }
-    bool multiComponentSourceDetected = false;
+}
+
+template <typename T>
+static inline T readField(const uint8_t *payload, const mavlink_field_info_t &info, unsigned int index)
+{
+    // memcpy, as array members of packed messages are not necessarily aligned
+    T value;
+    memcpy(&value, payload + info.wire_offset + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+QPair<QString,QVariant> MAVLinkDecoder::emitFieldValue(UASInterface *uas, mavlink_message_t* msg, int fieldid, quint64 time)
+{
     QPair<QString,QVariant> retval;
+    uint8_t msgid = msg->msgid;
 
     // Store component ID
-    if (!componentID.contains(msg->msgid))
+    if (componentID[msgid] == -1)
     {
-        componentID[msg->msgid] = msg->compid;
+        componentID[msgid] = msg->compid;
     }
-    else
+    else if (componentID[msgid] != msg->compid)
     {
         // Got this message already
-        if (componentID[msg->msgid] != msg->compid)
-        {
-            componentMulti[msg->msgid] = true;
-        }
+        componentMulti[msgid] = true;
     }
 
-    if (componentMulti[msg->msgid] == true) multiComponentSourceDetected = true;
+    if (messageFilter[msgid]) return retval;
 
-    // Add field tree widget item
-    uint8_t msgid = msg->msgid;
-    if (messageFilter.contains(msgid)) return QPair<QString,QVariant>();
-    QString fieldName(messageInfo[msgid].fields[fieldid].name);
-    QString fieldType;
+    const mavlink_field_info_t &info = messageInfo[msgid].fields[fieldid];
     uint8_t* m = ((uint8_t*)(receivedMessages+msgid))+8;
-    QString name("%1.%2");
-    QString unit("");
+    int compid = componentMulti[msgid] ? msg->compid : -1;
 
-    // Debug vector messages
+    // Debug and named value messages carry their name in the payload, so
+    // they cannot use the precomputed names.
+    QString namedValue;
     if (msgid == MAVLINK_MSG_ID_DEBUG_VECT)
     {
         mavlink_debug_vect_t debug;
@@ -258,14 +405,14 @@ QPair<QString,QVariant> MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, i
         char buf[11];
         strncpy(buf, debug.name, 10);
         buf[10] = '\0';
-        name = QString("%1.%2").arg(buf).arg(fieldName);
+        namedValue = QString("%1.%2").arg(buf).arg(info.name);
         time = getUnixTimeFromMs(msg->sysid, (debug.time_usec+500)/1000); // Scale to milliseconds, round up/down correctly
     }
     else if (msgid == MAVLINK_MSG_ID_DEBUG)
     {
         mavlink_debug_t debug;
         mavlink_msg_debug_decode(msg, &debug);
-        name = name.arg(QString("debug")).arg(debug.ind);
+        namedValue = QString("debug.%1").arg(debug.ind);
         time = getUnixTimeFromMs(msg->sysid, debug.time_boot_ms);
     }
     else if (msgid == MAVLINK_MSG_ID_NAMED_VALUE_FLOAT)
@@ -275,7 +422,7 @@ QPair<QString,QVariant> MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, i
         char buf[11];
         strncpy(buf, debug.name, 10);
         buf[10] = '\0';
-        name = QString(buf);
+        namedValue = QString(buf);
         time = getUnixTimeFromMs(msg->sysid, debug.time_boot_ms);
     }
     else if (msgid == MAVLINK_MSG_ID_NAMED_VALUE_INT)
@@ -285,381 +432,106 @@ QPair<QString,QVariant> MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, i
         char buf[11];
         strncpy(buf, debug.name, 10);
         buf[10] = '\0';
-        name = QString(buf);
+        namedValue = QString(buf);
         time = getUnixTimeFromMs(msg->sysid, debug.time_boot_ms);
     }
-    else
+    if (!namedValue.isEmpty())
     {
-        name = name.arg(messageInfo[msgid].name).arg(fieldName);
+        if (compid >= 0)
+        {
+            namedValue.prepend(QString("C%1:").arg(compid));
+        }
+        namedValue.prepend(QString("M%1:").arg(msg->sysid));
     }
 
-    if (multiComponentSourceDetected)
+    if (info.type == MAVLINK_TYPE_CHAR && info.array_length > 0)
     {
-        name = name.prepend(QString("C%1:").arg(msg->compid));
+        char* str = (char*)(m+info.wire_offset);
+        // Enforce null termination
+        str[info.array_length-1] = '\0';
+        if (!textMessageFilter[msgid])
+        {
+            QString name = namedValue.isEmpty() ? m_fieldDescriptors.at(internField(msg->sysid, compid, msgid, fieldid, -1)).name : namedValue;
+            emit textMessageReceived(msg->sysid, msg->compid, 0, name + ": " + str);
+        }
+        return retval;
     }
 
-    name = name.prepend(QString("M%1:").arg(msg->sysid));
-    retval.first = name;
-
-    switch (messageInfo[msgid].fields[fieldid].type)
+    // Scalars are emitted once, arrays once per element
+    const bool isArray = info.array_length > 0;
+    const unsigned int count = isArray ? info.array_length : 1;
+    for (unsigned int j = 0; j < count; ++j)
     {
-    case MAVLINK_TYPE_CHAR:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            char* str = (char*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            // Enforce null termination
-            str[messageInfo[msgid].fields[fieldid].array_length-1] = '\0';
-            QString string(name + ": " + str);
-            if (!textMessageFilter.contains(msgid)) emit textMessageReceived(msg->sysid, msg->compid, 0, string);
-        }
-        else
-        {
-            // Single char
-            char b = *((char*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            unit = QString("char[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            if (localemit)
-            {
-                emit valueChanged(msg->sysid, name, unit, b, time);
-            }
-            else
-            {
-                uas->valueChangedRec(msg->sysid,name,unit,b,time);
-            }
-            retval.second = b;
-        }
-        break;
-    case MAVLINK_TYPE_UINT8_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
+        QVariant value;
+        double raw = 0.0;
+        switch (info.type)
         {
-            uint8_t* nums = m+messageInfo[msgid].fields[fieldid].wire_offset;
-            fieldType = QString("uint8_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                if (localemit)
-                {
-                    emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-                else
-                {
-                    uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-            }
-        }
-        else
-        {
-            // Single value
-            uint8_t u = *(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = "uint8_t";
-            if (localemit)
-            {
-                emit valueChanged(msg->sysid, name, fieldType, u, time);
-            }
-            else
-            {
-                uas->valueChangedRec(msg->sysid, name, fieldType, u, time);
-            }
-            retval.second = u;
-        }
-        break;
-    case MAVLINK_TYPE_INT8_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            int8_t* nums = (int8_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("int8_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                if (localemit)
-                {
-                    emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-                else
-                {
-                    uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-            }
-        }
-        else
-        {
-            // Single value
-            int8_t n = *((int8_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "int8_t";
-            if (localemit)
-            {
-                emit valueChanged(msg->sysid, name, fieldType, n, time);
-            }
-            else
-            {
-                uas->valueChangedRec(msg->sysid, name, fieldType, n, time);
-            }
-            retval.second = n;
-        }
-        break;
-    case MAVLINK_TYPE_UINT16_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            uint16_t* nums = (uint16_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("uint16_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                if (localemit)
-                {
-                    emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-                else
-                {
-                    uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-            }
-        }
-        else
-        {
-            // Single value
-            uint16_t n = *((uint16_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "uint16_t";
-            if (localemit)
-            {
-                emit valueChanged(msg->sysid, name, fieldType, n, time);
-            }
-            else
-            {
-                uas->valueChangedRec(msg->sysid, name, fieldType, n, time);
-            }
-            retval.second = n;
-        }
-        break;
-    case MAVLINK_TYPE_INT16_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            int16_t* nums = (int16_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("int16_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                if (localemit)
-                {
-                    emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-                else
-                {
-                    uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-            }
-        }
-        else
-        {
-            // Single value
-            int16_t n = *((int16_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "int16_t";
-            if (localemit)
-            {
-                emit valueChanged(msg->sysid, name, fieldType, n, time);
-            }
-            else
-            {
-                uas->valueChangedRec(msg->sysid, name, fieldType, n, time);
-            }
-            retval.second = n;
-        }
-        break;
-    case MAVLINK_TYPE_UINT32_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            uint32_t* nums = (uint32_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("uint32_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                if (localemit)
-                {
-                    emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-                else
-                {
-                    uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-            }
-        }
-        else
-        {
-            // Single value
-            uint32_t n = *((uint32_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "uint32_t";
-            if (localemit)
-            {
-                emit valueChanged(msg->sysid, name, fieldType, n, time);
-            }
-            else
-            {
-                uas->valueChangedRec(msg->sysid, name, fieldType, n, time);
-            }
-            retval.second = n;
-        }
-        break;
-    case MAVLINK_TYPE_INT32_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            int32_t* nums = (int32_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("int32_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                if (localemit)
-                {
-                    emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-                else
-                {
-                    uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-            }
-        }
-        else
-        {
-            // Single value
-            int32_t n = *((int32_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "int32_t";
-            if (localemit)
-            {
-                emit valueChanged(msg->sysid, name, fieldType, n, time);
-            }
-            else
-            {
-                uas->valueChangedRec(msg->sysid, name, fieldType, n, time);
-            }
-            retval.second = n;
-        }
-        break;
-    case MAVLINK_TYPE_FLOAT:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            float* nums = (float*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("float[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                if (localemit)
-                {
-                    emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (float)(nums[j]), time);
-                }
-                else
-                {
-                    uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (float)(nums[j]), time);
-                }
-            }
-        }
-        else
-        {
-            // Single value
-            float f = *((float*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "float";
-            if (localemit)
-            {
-                emit valueChanged(msg->sysid, name, fieldType, f, time);
-            }
-            else
-            {
-                uas->valueChangedRec(msg->sysid, name, fieldType, f, time);
-            }
-            retval.second = f;
-        }
-        break;
-    case MAVLINK_TYPE_DOUBLE:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            double* nums = (double*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("double[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                if (localemit)
-                {
-                    emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-                else
-                {
-                    uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-                }
-            }
-        }
-        else
-        {
-            // Single value
-            double f = *((double*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "double";
-            if (localemit)
-            {
-                emit valueChanged(msg->sysid, name, fieldType, f, time);
-            }
-            else
-            {
-                uas->valueChangedRec(msg->sysid, name, fieldType, f, time);
-            }
-            retval.second = f;
+        case MAVLINK_TYPE_CHAR:
+            raw = readField<char>(m, info, j);
+            value = static_cast<int>(readField<char>(m, info, j));
+            break;
+        case MAVLINK_TYPE_UINT8_T:
+            raw = readField<uint8_t>(m, info, j);
+            value = static_cast<int>(readField<uint8_t>(m, info, j));
+            break;
+        case MAVLINK_TYPE_INT8_T:
+            raw = readField<int8_t>(m, info, j);
+            value = static_cast<int>(readField<int8_t>(m, info, j));
+            break;
+        case MAVLINK_TYPE_UINT16_T:
+            raw = readField<uint16_t>(m, info, j);
+            value = static_cast<int>(readField<uint16_t>(m, info, j));
+            break;
+        case MAVLINK_TYPE_INT16_T:
+            raw = readField<int16_t>(m, info, j);
+            value = static_cast<int>(readField<int16_t>(m, info, j));
+            break;
+        case MAVLINK_TYPE_UINT32_T:
+            raw = readField<uint32_t>(m, info, j);
+            value = static_cast<uint>(readField<uint32_t>(m, info, j));
+            break;
+        case MAVLINK_TYPE_INT32_T:
+            raw = readField<int32_t>(m, info, j);
+            value = static_cast<int>(readField<int32_t>(m, info, j));
+            break;
+        case MAVLINK_TYPE_FLOAT:
+            raw = readField<float>(m, info, j);
+            value = readField<float>(m, info, j);
+            break;
+        case MAVLINK_TYPE_DOUBLE:
+            raw = readField<double>(m, info, j);
+            value = readField<double>(m, info, j);
+            break;
+        case MAVLINK_TYPE_UINT64_T:
+            raw = static_cast<double>(readField<uint64_t>(m, info, j));
+            value = static_cast<quint64>(readField<uint64_t>(m, info, j));
+            break;
+        case MAVLINK_TYPE_INT64_T:
+            raw = static_cast<double>(readField<int64_t>(m, info, j));
+            value = static_cast<qint64>(readField<int64_t>(m, info, j));
+            break;
+        default:
+            QLOG_DEBUG() << "WARNING: UNKNOWN MAVLINK TYPE";
+            return retval;
         }
-        break;
-    case MAVLINK_TYPE_UINT64_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
+
+        int fieldId;
+        if (namedValue.isEmpty())
         {
-            uint64_t* nums = (uint64_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("uint64_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                if (localemit)
-                {
-                    emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (quint64) nums[j], time);
-                }
-                else
-                {
-                    uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (quint64) nums[j], time);
-                }
-            }
+            fieldId = internField(msg->sysid, compid, msgid, fieldid, isArray ? static_cast<int>(j) : -1);
         }
         else
         {
-            // Single value
-            qulonglong n = *((uint64_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "uint64_t";
-            if (localemit)
-            {
-                emit valueChanged(msg->sysid, name, fieldType, (quint64) n, time);
-            }
-            else
-            {
-                uas->valueChangedRec(msg->sysid, name, fieldType, (quint64) n, time);
-            }
-            retval.second = n;
+            fieldId = internField(isArray ? QString("%1.%2").arg(namedValue).arg(j) : namedValue,
+                                  m_fieldTypeNames[msgid].at(fieldid));
         }
-        break;
-    case MAVLINK_TYPE_INT64_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            int64_t* nums = (int64_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("int64_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                if (localemit)
-                {
-                    emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (qint64) nums[j], time);
-                }
-                else
-                {
-                    uas->valueChangedRec(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (qint64) nums[j], time);
-                }
-            }
-        }
-        else
+        emitValue(uas, msg->sysid, fieldId, value, raw, time);
+
+        if (!isArray)
         {
-            // Single value
-            qulonglong n = *((int64_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "int64_t";
-            if (localemit)
-            {
-                emit valueChanged(msg->sysid, name, fieldType, (qint64) n, time);
-            }
-            else
-            {
-                uas->valueChangedRec(msg->sysid, name, fieldType, (qint64) n, time);
-            }
-            retval.second = n;
+            retval.first = m_fieldDescriptors.at(fieldId).name;
+            retval.second = value;
         }
-        break;
-    default:
-        QLOG_DEBUG() << "WARNING: UNKNOWN MAVLINK TYPE";
     }
     return retval;
 }
@@ -43,9 +43,11 @@ This file is part of the APM_PLANNER project
 #include <QThread>
 #include <QFile>
 #include <QMap>
+#include <QHash>
 #include <QVector>
 
 class ConnectionManager;
+class UASInterface;
 
 class MAVLinkDecoder : public QObject
 {
@@ -60,9 +62,26 @@ public:
     QString getMessageName(uint8_t msgid);
     quint64 getUnixTimeFromMs(int systemID, quint64 time);
 
+    /** @brief Fully qualified name of an interned field, e.g. "M1:ATTITUDE.roll" */
+    QString getFieldName(int fieldId) const;
+    /** @brief Type/unit string of an interned field, e.g. "float" or "uint16_t[4]" */
+    QString getFieldUnit(int fieldId) const;
+    /** @brief Look up the id of an already interned field by name, -1 if it was never seen */
+    int getFieldId(const QString& name) const { return m_fieldIdsByName.value(name, -1); }
+
+    /** @brief Publish decoded values to the TelemetryBus, off by default.
+     *  Only the live decoder of the LinkManager turns it on, decoders of logs
+     *  and replays would otherwise overwrite the live values. */
+    void setPublishToBus(bool publish);
+    bool publishToBus() const { return m_publishToBus; }
+
 signals:
     void protocolStatusMessage(const QString& title, const QString& message);
     void valueChanged(const int uasId, const QString& name, const QString& unit, const QVariant& value, const quint64 msec);
+    /** @brief Emitted once the first time a field is seen, so subscribers can resolve its name */
+    void fieldRegistered(const int fieldId, const QString& name, const QString& unit);
+    /** @brief Typed, allocation free value path. Resolve fieldId with getFieldName() */
+    void fieldValueChanged(const int uasId, const int fieldId, const double value, const quint64 msec);
     void textMessageReceived(int uasid, int componentid, int severity, const QString& text);
     void receiveLossChanged(int id,float value);
 
@@ -75,6 +94,18 @@ private:
     int getSystemId() { return 252; }
     int getComponentId() { return 1; }
 
+    struct FieldDescriptor
+    {
+        QString name;   ///< Fully qualified name, including system (and component) prefix
+        QString unit;   ///< Type string, as passed on in valueChanged()
+        int busChannel; ///< TelemetryBus channel, -1 if not publishing or the bus is full
+    };
+
+    int internField(int sysid, int compid, uint8_t msgid, int fieldid, int arrayIndex);
+    int internField(const QString& name, const QString& unit);
+    QPair<QString,QVariant> emitFieldValue(UASInterface *uas, mavlink_message_t* msg, int fieldid, quint64 time);
+    void emitValue(UASInterface *uas, int sysid, int fieldId, const QVariant& value, double raw, quint64 time);
+
 private:
     bool m_loggingEnabled;
     QFile *m_logfile;
@@ -88,11 +119,17 @@ private:
     QMap<int,qint64> totalLossCounter;
     QMap<int,qint64> currLossCounter;
     bool m_multiplexingEnabled;
-
-    QMap<int,int> componentID;
-    QMap<int,bool> componentMulti;
-    QMap<uint16_t, bool> messageFilter;               ///< Message/field names not to emit
-    QMap<uint16_t, bool> textMessageFilter;           ///< Message/field names not to emit in text mode
+    bool m_publishToBus;
+
+    int componentID[256];                       ///< First component id seen per message id, -1 if none yet
+    bool componentMulti[256];                   ///< Message id was seen from more than one component
+    bool messageFilter[256];                    ///< Message ids not to emit
+    bool textMessageFilter[256];                ///< Message ids not to emit in text mode
+    QVector<QString> m_fieldBaseNames[256];     ///< Precomputed "MESSAGE.field" per message id and field
+    QVector<QString> m_fieldTypeNames[256];     ///< Precomputed type string per message id and field
+    QVector<FieldDescriptor> m_fieldDescriptors;///< Interned fields, indexed by field id
+    QHash<quint64,int> m_fieldIds;              ///< Packed (sysid, compid, msgid, field, index) key to field id
+    QHash<QString,int> m_fieldIdsByName;        ///< Fully qualified name to field id
     mavlink_message_t receivedMessages[256];    ///< Available / known messages
     mavlink_message_info_t messageInfo[256];    ///< Message information
     QMap<int,quint64> onboardTimeOffset;
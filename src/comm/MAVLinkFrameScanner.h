@@ -0,0 +1,71 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkFrameScanner
+ *          Finds MAVLink frames in a block of received bytes at once:
+ *          looks for STX, checks the length and validates the CRC over
+ *          the whole frame with a table driven CRC16/X25. Only frames cut
+ *          by the end of a block go through the byte-wise mavlink_parse_char().
+ *
+ */
+
+#ifndef MAVLINKFRAMESCANNER_H
+#define MAVLINKFRAMESCANNER_H
+
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include <QtGlobal>
+
+class MAVLinkFrameScanner
+{
+public:
+    /**
+     * @param channel The mavlink_parse_char() channel used for frames split
+     *                across blocks, usually the link id
+     */
+    explicit MAVLinkFrameScanner(int channel);
+
+    /** @brief Start scanning a new block of received bytes, which must stay valid while scanning */
+    void setData(const uchar *data, int size);
+    /** @brief Decode the next valid message of the block, false once the block is used up */
+    bool next(mavlink_message_t *message);
+    /** @brief Number of bytes of the current block consumed so far */
+    int position() const { return m_position; }
+    /** @brief Step over bytes that follow a frame but are not MAVLink frames themselves */
+    void skip(int bytes) { m_position = qMin(m_size, m_position + qMax(bytes, 0)); }
+
+    /** @brief Accumulate the MAVLink CRC16/X25 over a buffer */
+    static quint16 crc16(const uchar *data, int size, quint16 crc = X25_INIT_CRC);
+    /** @brief Check STX, length and CRC of the frame starting at data */
+    static bool isValidFrame(const uchar *data, qint64 available);
+    /** @brief Decode an already validated frame without the byte-wise parser */
+    static void decodeFrame(const uchar *data, mavlink_message_t *message);
+
+private:
+    int m_channel;
+    const uchar *m_data;
+    int m_size;
+    int m_position;
+};
+
+#endif // MAVLINKFRAMESCANNER_H
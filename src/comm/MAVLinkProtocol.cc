@@ -34,18 +34,28 @@ This file is part of the APM_PLANNER project
 
 
 #include "MAVLinkProtocol.h"
+#include "MAVLinkProtocolWorker.h"
+#include "TLogWriter.h"
 #include "LinkManager.h"
+#if defined(QGC_PROTOBUF_ENABLED)
+#include "UASManager.h"
+#endif
 
 MAVLinkProtocol::MAVLinkProtocol():
     m_isOnline(true),
-    m_loggingEnabled(false),
-    m_logfile(NULL),
+    m_tlogWriter(new TLogWriter(this)),
+    m_queueCapacity(4096),
     m_connectionManager(NULL)
 {
+    connect(m_tlogWriter,SIGNAL(writeError(QString)),this,SLOT(logWriteError(QString)));
 }
 
 MAVLinkProtocol::~MAVLinkProtocol()
 {
+    while (!m_workers.isEmpty())
+    {
+        removeLink(m_workers.begin().value()->getLink());
+    }
     stopLogging();
     m_connectionManager = NULL;
 }
@@ -55,185 +65,131 @@ void MAVLinkProtocol::sendMessage(mavlink_message_t msg)
     Q_UNUSED(msg);
 }
 
-void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
+void MAVLinkProtocol::addLink(LinkInterface *link)
 {
-    mavlink_message_t message;
-    mavlink_status_t status;
-
-    // Cache the link ID for common use.
-    int linkId = link->getId();
-
-    static int mavlink09Count = 0;
-    static int nonmavlinkCount = 0;
-    static bool decodedFirstPacket = false;
-    static bool warnedUser = false;
-    static bool checkedUserNonMavlink = false;
-    static bool warnedUserNonMavlink = false;
+    if (m_workers.contains(link->getId()))
+    {
+        return;
+    }
+    QThread *thread = new QThread();
+    MAVLinkProtocolWorker *worker = new MAVLinkProtocolWorker(this, link, m_queueCapacity);
+    worker->moveToThread(thread);
+
+    connect(link,SIGNAL(bytesReceived(LinkInterface*,QByteArray)),worker,SLOT(receiveBytes(LinkInterface*,QByteArray)));
+    connect(worker,SIGNAL(protocolStatusMessage(QString,QString)),this,SIGNAL(protocolStatusMessage(QString,QString)));
+    connect(worker,SIGNAL(receiveLossChanged(int,float)),this,SIGNAL(receiveLossChanged(int,float)));
+    connect(worker,SIGNAL(resetRequested(LinkInterface*)),this,SLOT(resetLink(LinkInterface*)));
+#if defined(QGC_PROTOBUF_ENABLED)
+    qRegisterMetaType<std::tr1::shared_ptr<google::protobuf::Message> >("std::tr1::shared_ptr<google::protobuf::Message>");
+    connect(worker,SIGNAL(extendedMessageReceived(LinkInterface*,std::tr1::shared_ptr<google::protobuf::Message>,int)),
+            this,SLOT(receiveExtendedMessage(LinkInterface*,std::tr1::shared_ptr<google::protobuf::Message>,int)));
+#endif
+    connect(link,SIGNAL(destroyed(QObject*)),this,SLOT(linkDestroyed(QObject*)));
 
-    // FIXME: Add check for if link->getId() >= MAVLINK_COMM_NUM_BUFFERS
-    for (int position = 0; position < b.size(); position++) {
-        unsigned int decodeState = mavlink_parse_char(linkId, (uint8_t)(b[position]), &message, &status);
+    m_workers.insert(link->getId(), worker);
+    m_workerThreads.insert(link->getId(), thread);
+    thread->start();
+}
 
-        if ((uint8_t)b[position] == 0x55) mavlink09Count++;
-        if ((mavlink09Count > 100) && !decodedFirstPacket && !warnedUser)
+void MAVLinkProtocol::removeLink(LinkInterface *link)
+{
+    for (QMap<int,MAVLinkProtocolWorker*>::iterator i = m_workers.begin(); i != m_workers.end(); ++i)
+    {
+        if (i.value()->getLink() == link)
         {
-            warnedUser = true;
-            // Obviously the user tries to use a 0.9 autopilot
-            // with QGroundControl built for version 1.0
-            emit protocolStatusMessage("MAVLink Version or Baud Rate Mismatch", "Your MAVLink device seems to use the deprecated version 0.9, while APM Planner only supports version 1.0+. Please upgrade the MAVLink version of your autopilot. If your autopilot is using version 1.0, check if the baud rates of APM Planner and your autopilot are the same.");
+            int linkId = i.key();
+            QThread *thread = m_workerThreads.take(linkId);
+            thread->quit();
+            thread->wait();
+            delete i.value();
+            delete thread;
+            m_workers.erase(i);
+            return;
         }
+    }
+}
 
-        if (decodeState == 0 && !decodedFirstPacket)
-        {
-            nonmavlinkCount++;
-            if (nonmavlinkCount > 2000 && !warnedUserNonMavlink)
-            {
-                //500 bytes with no mavlink message. Are we connected to a mavlink capable device?
-                if (!checkedUserNonMavlink)
-                {
-                    link->requestReset();
-                    nonmavlinkCount=0;
-                    checkedUserNonMavlink = true;
-                }
-                else
-                {
-                    warnedUserNonMavlink = true;
-                    emit protocolStatusMessage("MAVLink Baud Rate Mismatch", "Please check if the baud rates of APM Planner and your autopilot are the same.");
-                }
-            }
-        }
-        if (decodeState == 1)
-        {
-            decodedFirstPacket = true;
+void MAVLinkProtocol::linkDestroyed(QObject *link)
+{
+    // Only the pointer value is compared, the link is already half destroyed
+    removeLink(static_cast<LinkInterface*>(link));
+}
 
-            if(message.msgid == MAVLINK_MSG_ID_PING)
-            {
-                // process ping requests (tgt_system and tgt_comp must be zero)
-                mavlink_ping_t ping;
-                mavlink_msg_ping_decode(&message, &ping);
-                if(!ping.target_system && !ping.target_component && m_isOnline)
-                {
-                    mavlink_message_t msg;
-                    mavlink_msg_ping_pack(getSystemId(), getComponentId(), &msg, ping.time_usec, ping.seq, message.sysid, message.compid);
-                    sendMessage(msg);
-                }
-            }
+void MAVLinkProtocol::resetLink(LinkInterface *link)
+{
+    link->requestReset();
+}
 
-#if defined(QGC_PROTOBUF_ENABLED)
+int MAVLinkProtocol::getQueueDepth(int linkId) const
+{
+    MAVLinkProtocolWorker *worker = m_workers.value(linkId, NULL);
+    return worker ? worker->getQueueDepth() : 0;
+}
 
-            if (message.msgid == MAVLINK_MSG_ID_EXTENDED_MESSAGE)
-            {
-                mavlink_extended_message_t extended_message;
-
-                extended_message.base_msg = message;
-
-                // read extended header
-                uint8_t* payload = reinterpret_cast<uint8_t*>(message.payload64);
-
-                memcpy(&extended_message.extended_payload_len, payload + 3, 4);
-
-                // Check if message is valid
-                if
-                 (b.size() != MAVLINK_NUM_NON_PAYLOAD_BYTES+MAVLINK_EXTENDED_HEADER_LEN+ extended_message.extended_payload_len)
-                {
-                    //invalid message
-                    QLOG_DEBUG() << "GOT INVALID EXTENDED MESSAGE, ABORTING";
-                    return;
-                }
-
-                const uint8_t* extended_payload = reinterpret_cast<const uint8_t*>(b.constData()) + MAVLINK_NUM_NON_PAYLOAD_BYTES + MAVLINK_EXTENDED_HEADER_LEN;
-
-                // copy extended payload data
-                memcpy(extended_message.extended_payload, extended_payload, extended_message.extended_payload_len);
-
-#if defined(QGC_USE_PIXHAWK_MESSAGES)
-
-                if (protobufManager.cacheFragment(extended_message))
-                {
-                    std::tr1::shared_ptr<google::protobuf::Message> protobuf_msg;
-
-                    if (protobufManager.getMessage(protobuf_msg))
-                    {
-                        const google::protobuf::Descriptor* descriptor = protobuf_msg->GetDescriptor();
-                        if (!descriptor)
-                        {
-                            continue;
-                        }
-
-                        const google::protobuf::FieldDescriptor* headerField = descriptor->FindFieldByName("header");
-                        if (!headerField)
-                        {
-                            continue;
-                        }
-
-                        const google::protobuf::Descriptor* headerDescriptor = headerField->message_type();
-                        if (!headerDescriptor)
-                        {
-                            continue;
-                        }
-
-                        const google::protobuf::FieldDescriptor* sourceSysIdField = headerDescriptor->FindFieldByName("source_sysid");
-                        if (!sourceSysIdField)
-                        {
-                            continue;
-                        }
-
-                        const google::protobuf::Reflection* reflection = protobuf_msg->GetReflection();
-                        const google::protobuf::Message& headerMsg = reflection->GetMessage(*protobuf_msg, headerField);
-                        const google::protobuf::Reflection* headerReflection = headerMsg.GetReflection();
-
-                        int source_sysid = headerReflection->GetInt32(headerMsg, sourceSysIdField);
-
-                        UASInterface* uas = UASManager::instance()->getUASForId(source_sysid);
-
-                        if (uas != NULL)
-                        {
-                            emit extendedMessageReceived(link, protobuf_msg);
-                        }
-                    }
-                }
-#endif
+qint64 MAVLinkProtocol::getDroppedMessages(int linkId) const
+{
+    MAVLinkProtocolWorker *worker = m_workers.value(linkId, NULL);
+    return worker ? worker->getDroppedMessages() : 0;
+}
 
-                position += extended_message.extended_payload_len;
+void MAVLinkProtocol::logWriteError(const QString& error)
+{
+    emit protocolStatusMessage(tr("MAVLink Logging failed"),
+                               tr("Could not write to file %1 (%2), disabling logging.")
+                               .arg(m_tlogWriter->fileName()).arg(error));
+    // Stop logging
+    stopLogging();
+}
 
-                continue;
-            }
+#if defined(QGC_PROTOBUF_ENABLED)
+void MAVLinkProtocol::receiveExtendedMessage(LinkInterface *link, std::tr1::shared_ptr<google::protobuf::Message> message, int sysid)
+{
+    UASInterface* uas = UASManager::instance()->getUASForId(sysid);
+
+    if (uas != NULL)
+    {
+        emit extendedMessageReceived(link, message);
+    }
+}
 #endif
 
-            // Log data
-            if (m_loggingEnabled && m_logfile)
-            {
-                quint64 time = QGC::groundTimeUsecs();
-
-                QDataStream outStream(m_logfile);
-                outStream.setByteOrder(QDataStream::BigEndian);
-                outStream << time; // write time stamp
-                // write headers, payload (incs CRC)
-                int bytesWritten = outStream.writeRawData((const char*)&message.magic,
-                                     static_cast<uint>(MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len));
-
-                if(bytesWritten != (MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len))
-                {
-                    emit protocolStatusMessage(tr("MAVLink Logging failed"),
-                                               tr("Could not write to file %1, disabling logging.")
-                                               .arg(m_logfile->fileName()));
-                    // Stop logging
-                    stopLogging();
-                }
-            }
-            quint64 time = QGC::groundTimeUsecs();
-            m_mavlinkMsgBuffer[time] = message;
-            if (m_isOnline)
+void MAVLinkProtocol::drainWorker(int linkId)
+{
+    MAVLinkProtocolWorker *worker = m_workers.value(linkId, NULL);
+    if (!worker)
+    {
+        return;
+    }
+    // Clear first, so a packet pushed while draining schedules another drain
+    worker->clearDrainPending();
+
+    LinkInterface *link = worker->getLink();
+    MAVLinkProtocolWorker::QueuedMessage item;
+    while (worker->takeMessage(item))
+    {
+        const mavlink_message_t &message = item.message;
+        if(message.msgid == MAVLINK_MSG_ID_PING)
+        {
+            // process ping requests (tgt_system and tgt_comp must be zero)
+            mavlink_ping_t ping;
+            mavlink_msg_ping_decode(&message, &ping);
+            if(!ping.target_system && !ping.target_component && m_isOnline)
             {
-                handleMessage(time,link);
+                mavlink_message_t msg;
+                mavlink_msg_ping_pack(getSystemId(), getComponentId(), &msg, ping.time_usec, ping.seq, message.sysid, message.compid);
+                sendMessage(msg);
             }
         }
+
+        if (m_isOnline)
+        {
+            handleMessage(message,link);
+        }
     }
 }
-void MAVLinkProtocol::handleMessage(quint64 timeid,LinkInterface *link)
+
+void MAVLinkProtocol::handleMessage(const mavlink_message_t &message,LinkInterface *link)
 {
-    mavlink_message_t message = m_mavlinkMsgBuffer.value(timeid);
-    unsigned int linkId = link->getId();
     // ORDER MATTERS HERE!
     // If the matching UAS object does not yet exist, it has to be created
     // before emitting the packetReceived signal
@@ -297,74 +253,6 @@ void MAVLinkProtocol::handleMessage(quint64 timeid,LinkInterface *link)
     if (uas != NULL)
     {
 
-        // Increase receive counter
-        totalReceiveCounter[linkId]++;
-        currReceiveCounter[linkId]++;
-
-        // Update last message sequence ID
-        uint8_t expectedIndex;
-        if (lastIndex.contains(message.sysid))
-        {
-            if (lastIndex.value(message.sysid).contains(message.compid))
-            {
-                if (lastIndex.value(message.sysid).value(message.compid) == static_cast<uint8_t>(-1))
-                {
-                    lastIndex[message.sysid][message.compid] = message.seq;
-                    expectedIndex = message.seq;
-                }
-                else
-                {
-                    expectedIndex = lastIndex[message.sysid][message.compid] + 1;
-                }
-            }
-            else
-            {
-                lastIndex[message.sysid].insert(message.compid,message.seq);
-                expectedIndex = message.seq;
-            }
-        }
-        else
-        {
-            lastIndex.insert(message.sysid,QMap<int,uint8_t>());
-            lastIndex[message.sysid].insert(message.compid,message.seq);
-            expectedIndex = message.seq;
-        }
-
-        // Make some noise if a message was skipped
-        //QLOG_DEBUG() << "SYSID" << message.sysid << "COMPID" << message.compid << "MSGID" << message.msgid << "EXPECTED INDEX:" << expectedIndex << "SEQ" << message.seq;
-        if (message.seq != expectedIndex)
-        {
-            // Determine how many messages were skipped accounting for 0-wraparound
-            int16_t lostMessages = message.seq - expectedIndex;
-            if (lostMessages < 0)
-            {
-                // Usually, this happens in the case of an out-of order packet
-                lostMessages = 0;
-            }
-            else
-            {
-                // Console generates excessive load at high loss rates, needs better GUI visualization
-                //QLOG_DEBUG() << QString("Lost %1 messages for comp %4: expected sequence ID %2 but received %3.").arg(lostMessages).arg(expectedIndex).arg(message.seq).arg(message.compid);
-            }
-            totalLossCounter[linkId] += lostMessages;
-            currLossCounter[linkId] += lostMessages;
-        }
-
-        // Update the last sequence ID
-        lastIndex[message.sysid][message.compid] = message.seq;
-
-        // Update on every 32th packet
-        if (totalReceiveCounter[linkId] % 32 == 0)
-        {
-            // Calculate new loss ratio
-            // Receive loss
-            float receiveLoss = (double)currLossCounter[linkId]/(double)(currReceiveCounter[linkId]+currLossCounter[linkId]);
-            receiveLoss *= 100.0f;
-            currLossCounter[linkId] = 0;
-            currReceiveCounter[linkId] = 0;
-            emit receiveLossChanged(message.sysid, receiveLoss);
-        }
-
         // The packet is emitted as a whole, as it is only 255 - 261 bytes short
         // kind of inefficient, but no issue for a groundstation pc.
         // It buys as reentrancy for the whole code over all threads
@@ -389,38 +277,33 @@ void MAVLinkProtocol::handleMessage(quint64 timeid,LinkInterface *link)
 
 void MAVLinkProtocol::stopLogging()
 {
-    if (m_logfile && m_logfile->isOpen()){
-        QLOG_DEBUG() << "Stop MAVLink logging" << m_logfile->fileName();
-        // Close the current open file
-        m_logfile->close();
-        delete m_logfile;
-        m_logfile = NULL;
+    if (m_tlogWriter->isOpen())
+    {
+        QLOG_DEBUG() << "Stop MAVLink logging" << m_tlogWriter->fileName();
     }
-    m_loggingEnabled = false;
+    // Writes out and syncs everything still queued
+    m_tlogWriter->close();
+}
+
+bool MAVLinkProtocol::loggingEnabled() const
+{
+    return m_tlogWriter->isOpen();
 }
 
 bool MAVLinkProtocol::startLogging(const QString& filename)
 {
-    if (m_logfile && m_logfile->isOpen())
+    if (m_tlogWriter->isOpen())
     {
         return true;
     }
-    stopLogging();
     QLOG_DEBUG() << "Start MAVLink logging" << filename;
 
-    Q_ASSERT_X(m_logfile == NULL, "startLogging", "m_logFile == NULL");
-
-    m_logfile = new QFile(filename);
-    if (m_logfile->open(QIODevice::WriteOnly | QIODevice::Append)){
-         m_loggingEnabled = true;
-
-    } else {
+    if (!m_tlogWriter->open(filename))
+    {
         emit protocolStatusMessage(tr("Started MAVLink logging"),
-                                   tr("FAILED: MAVLink cannot start logging to.").arg(m_logfile->fileName()));
-        m_loggingEnabled = false;
-        delete m_logfile;
-        m_logfile = NULL;
+                                   tr("FAILED: MAVLink cannot start logging to %1.").arg(filename));
+        return false;
     }
-    //emit loggingChanged(m_loggingEnabled);
-    return m_loggingEnabled; // reflects if logging started or not.
+    //emit loggingChanged(true);
+    return true; // reflects if logging started or not.
 }
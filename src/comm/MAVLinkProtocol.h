@@ -26,6 +26,8 @@ This file is part of the APM_PLANNER project
  *          This class handles incoming mavlink_message_t packets.
  *          It will create a UAS class if one does not exist for a particular heartbeat systemid
  *          It will pass mavlink_message_t on to the UAS class for further parsing
+ *          Byte parsing, loss accounting and logging run in one MAVLinkProtocolWorker
+ *          thread per link, this class only dispatches the decoded packets.
  *
  *   @author Michael Carpenter <malcom2073@gmail.com>
  *   @author QGROUNDCONTROL PROJECT - This code has GPLv3+ snippets from QGROUNDCONTROL, (c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
@@ -45,7 +47,13 @@ This file is part of the APM_PLANNER project
 #include <QDataStream>
 #include "UASInterface.h"
 //#include "MAVLinkDecoder.h"
+#if defined(QGC_PROTOBUF_ENABLED)
+#include <tr1/memory>
+#include <google/protobuf/message.h>
+#endif
 class LinkManager;
+class MAVLinkProtocolWorker;
+class TLogWriter;
 class MAVLinkProtocol : public QObject
 {
     Q_OBJECT
@@ -57,25 +65,37 @@ public:
     void sendMessage(mavlink_message_t msg);
     void stopLogging();
     bool startLogging(const QString& filename);
-    bool loggingEnabled() { return m_loggingEnabled; }
+    bool loggingEnabled() const;
+    /** @brief The background tlog writer, for sync settings and throughput/backlog statistics */
+    TLogWriter* getTLogWriter() const { return m_tlogWriter; }
     void setOnline(bool isonline) { m_isOnline = isonline; }
+
+    /** @brief Start a parser thread for the link and route its bytes to it */
+    void addLink(LinkInterface *link);
+    /** @brief Stop the parser thread of the link, pending packets are discarded */
+    void removeLink(LinkInterface *link);
+
+    /** @brief Number of decoded packets waiting to be dispatched for a link */
+    int getQueueDepth(int linkId) const;
+    /** @brief Number of packets dropped because the dispatch queue of a link was full */
+    qint64 getDroppedMessages(int linkId) const;
+    /** @brief Queue capacity used for links added after this call */
+    void setQueueCapacity(int capacity) { m_queueCapacity = capacity; }
+
 private:
-    QMap<quint64,mavlink_message_t> m_mavlinkMsgBuffer;
-    void handleMessage(quint64 timeid,LinkInterface *link);
+    void handleMessage(const mavlink_message_t &message,LinkInterface *link);
     bool m_isOnline;
     int getSystemId() { return 252; }
     int getComponentId() { return 1; }
-    bool m_loggingEnabled;
-    QFile *m_logfile;
+    TLogWriter *m_tlogWriter;
+
+    QMap<int,MAVLinkProtocolWorker*> m_workers;
+    QMap<int,QThread*> m_workerThreads;
+    int m_queueCapacity;
 
     bool m_throwAwayGCSPackets;
     LinkManager *m_connectionManager;
     bool versionMismatchIgnore;
-    QMap<int,qint64> totalReceiveCounter;
-    QMap<int,qint64> currReceiveCounter;
-    QMap<int,QMap<int,uint8_t> > lastIndex;
-    QMap<int,qint64> totalLossCounter;
-    QMap<int,qint64> currLossCounter;
     bool m_enable_version_check;
 
 signals:
@@ -84,9 +104,18 @@ signals:
     void textMessageReceived(int uasid, int componentid, int severity, const QString& text);
     void receiveLossChanged(int id,float value);
     void messageReceived(LinkInterface *link,mavlink_message_t message);
+#if defined(QGC_PROTOBUF_ENABLED)
+    void extendedMessageReceived(LinkInterface *link, std::tr1::shared_ptr<google::protobuf::Message> message);
+#endif
 
-public slots:
-    void receiveBytes(LinkInterface* link, QByteArray b);
+private slots:
+    void drainWorker(int linkId);
+    void linkDestroyed(QObject *link);
+    void resetLink(LinkInterface *link);
+    void logWriteError(const QString& error);
+#if defined(QGC_PROTOBUF_ENABLED)
+    void receiveExtendedMessage(LinkInterface *link, std::tr1::shared_ptr<google::protobuf::Message> message, int sysid);
+#endif
 };
 
 #endif // NEW_MAVLINKPARSER_H
@@ -0,0 +1,272 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkProtocolWorker
+ *          Parses the raw byte stream of a single link into mavlink_message_t
+ *          packets, off the UI thread.
+ *
+ */
+
+#include "MAVLinkProtocolWorker.h"
+#include "MAVLinkProtocol.h"
+#include "LinkInterface.h"
+#include "QGC.h"
+#include "QsLog.h"
+
+MAVLinkProtocolWorker::MAVLinkProtocolWorker(MAVLinkProtocol *protocol, LinkInterface *link, int queueCapacity) :
+    QObject(NULL),
+    m_protocol(protocol),
+    m_tlogWriter(protocol->getTLogWriter()),
+    m_logQueue(m_tlogWriter->addProducer()),
+    m_link(link),
+    m_linkId(link->getId()),
+    m_queue(queueCapacity),
+    m_scanner(m_linkId),
+    m_mavlink09Count(0),
+    m_nonmavlinkCount(0),
+    m_decodedFirstPacket(false),
+    m_warnedUser(false),
+    m_checkedUserNonMavlink(false),
+    m_warnedUserNonMavlink(false),
+    m_totalReceiveCounter(0),
+    m_currReceiveCounter(0),
+    m_totalLossCounter(0),
+    m_currLossCounter(0)
+{
+    QLOG_DEBUG() << "Create MAVLinkProtocolWorker for link" << m_linkId;
+    memset(m_lastIndex, 0xFF, sizeof(m_lastIndex));
+}
+
+MAVLinkProtocolWorker::~MAVLinkProtocolWorker()
+{
+    QLOG_DEBUG() << "Destroy MAVLinkProtocolWorker for link" << m_linkId;
+    m_tlogWriter->removeProducer(m_logQueue);
+}
+
+void MAVLinkProtocolWorker::receiveBytes(LinkInterface* link, QByteArray b)
+{
+    Q_UNUSED(link);
+    mavlink_message_t message;
+    bool queued = false;
+
+    if (!m_decodedFirstPacket)
+    {
+        m_mavlink09Count += b.count(static_cast<char>(0x55));
+        if ((m_mavlink09Count > 100) && !m_warnedUser)
+        {
+            m_warnedUser = true;
+            // Obviously the user tries to use a 0.9 autopilot
+            // with QGroundControl built for version 1.0
+            emit protocolStatusMessage("MAVLink Version or Baud Rate Mismatch", "Your MAVLink device seems to use the deprecated version 0.9, while APM Planner only supports version 1.0+. Please upgrade the MAVLink version of your autopilot. If your autopilot is using version 1.0, check if the baud rates of APM Planner and your autopilot are the same.");
+        }
+    }
+
+    // FIXME: Add check for if link->getId() >= MAVLINK_COMM_NUM_BUFFERS
+    // Frames are picked out of the whole block, only frames split between
+    // two reads go through the byte-wise parser
+    m_scanner.setData(reinterpret_cast<const uchar*>(b.constData()), b.size());
+    while (m_scanner.next(&message))
+    {
+        m_decodedFirstPacket = true;
+
+#if defined(QGC_PROTOBUF_ENABLED)
+        if (message.msgid == MAVLINK_MSG_ID_EXTENDED_MESSAGE)
+        {
+            handleExtendedMessage(b, message);
+            continue;
+        }
+#endif
+        quint64 time = QGC::groundTimeUsecs();
+
+        // Log data, queued for the tlog writer thread
+        if (m_tlogWriter->isOpen())
+        {
+            m_tlogWriter->write(m_logQueue, time, message);
+        }
+
+        updateLoss(message);
+
+        QueuedMessage item;
+        item.time = time;
+        item.message = message;
+        if (m_queue.push(item))
+        {
+            queued = true;
+        }
+        else
+        {
+            // The UI thread is not keeping up, drop rather than block parsing
+            m_droppedMessages.fetchAndAddRelaxed(1);
+        }
+    }
+
+    if (!m_decodedFirstPacket)
+    {
+        m_nonmavlinkCount += b.size();
+        if (m_nonmavlinkCount > 2000 && !m_warnedUserNonMavlink)
+        {
+            //500 bytes with no mavlink message. Are we connected to a mavlink capable device?
+            if (!m_checkedUserNonMavlink)
+            {
+                // The link lives in the UI thread, let it reset itself there
+                emit resetRequested(m_link);
+                m_nonmavlinkCount=0;
+                m_checkedUserNonMavlink = true;
+            }
+            else
+            {
+                m_warnedUserNonMavlink = true;
+                emit protocolStatusMessage("MAVLink Baud Rate Mismatch", "Please check if the baud rates of APM Planner and your autopilot are the same.");
+            }
+        }
+    }
+
+    // Only wake the UI thread if it is not already scheduled to drain,
+    // so a burst of packets costs a single queued event
+    if (queued && m_drainPending.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(m_protocol, "drainWorker", Qt::QueuedConnection, Q_ARG(int, m_linkId));
+    }
+}
+
+#if defined(QGC_PROTOBUF_ENABLED)
+void MAVLinkProtocolWorker::handleExtendedMessage(const QByteArray &b, const mavlink_message_t &message)
+{
+    mavlink_extended_message_t extended_message;
+
+    extended_message.base_msg = message;
+
+    // read extended header
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(message.payload64);
+
+    memcpy(&extended_message.extended_payload_len, payload + 3, 4);
+
+    // The extended payload directly follows the base frame, which the
+    // scanner has just consumed
+    int start = m_scanner.position();
+    if (message.len != MAVLINK_EXTENDED_HEADER_LEN
+            || extended_message.extended_payload_len < 0
+            || extended_message.extended_payload_len > MAVLINK_MAX_EXTENDED_PAYLOAD_LEN
+            || start + extended_message.extended_payload_len > b.size())
+    {
+        //invalid message, or its payload is split across reads
+        QLOG_DEBUG() << "GOT INVALID EXTENDED MESSAGE, ABORTING";
+        return;
+    }
+
+    // copy extended payload data
+    memcpy(extended_message.extended_payload, b.constData() + start, extended_message.extended_payload_len);
+    m_scanner.skip(extended_message.extended_payload_len);
+
+#if defined(QGC_USE_PIXHAWK_MESSAGES)
+    if (!m_protobufManager.cacheFragment(extended_message))
+    {
+        return;
+    }
+    std::tr1::shared_ptr<google::protobuf::Message> protobuf_msg;
+    if (!m_protobufManager.getMessage(protobuf_msg))
+    {
+        return;
+    }
+
+    const google::protobuf::Descriptor* descriptor = protobuf_msg->GetDescriptor();
+    if (!descriptor)
+    {
+        return;
+    }
+    const google::protobuf::FieldDescriptor* headerField = descriptor->FindFieldByName("header");
+    if (!headerField)
+    {
+        return;
+    }
+    const google::protobuf::Descriptor* headerDescriptor = headerField->message_type();
+    if (!headerDescriptor)
+    {
+        return;
+    }
+    const google::protobuf::FieldDescriptor* sourceSysIdField = headerDescriptor->FindFieldByName("source_sysid");
+    if (!sourceSysIdField)
+    {
+        return;
+    }
+
+    const google::protobuf::Reflection* reflection = protobuf_msg->GetReflection();
+    const google::protobuf::Message& headerMsg = reflection->GetMessage(*protobuf_msg, headerField);
+    const google::protobuf::Reflection* headerReflection = headerMsg.GetReflection();
+
+    int source_sysid = headerReflection->GetInt32(headerMsg, sourceSysIdField);
+
+    // The UAS lookup happens in the UI thread, see MAVLinkProtocol::receiveExtendedMessage()
+    emit extendedMessageReceived(m_link, protobuf_msg, source_sysid);
+#endif
+}
+#endif
+
+void MAVLinkProtocolWorker::updateLoss(const mavlink_message_t &message)
+{
+    // Increase receive counter
+    m_totalReceiveCounter++;
+    m_currReceiveCounter++;
+
+    // Update last message sequence ID
+    quint16 &lastIndex = m_lastIndex[(message.sysid << 8) | message.compid];
+    uint8_t expectedIndex;
+    if (lastIndex != 0xFFFF)
+    {
+        expectedIndex = static_cast<uint8_t>(lastIndex + 1);
+    }
+    else
+    {
+        expectedIndex = message.seq;
+    }
+
+    // Make some noise if a message was skipped
+    if (message.seq != expectedIndex)
+    {
+        // Determine how many messages were skipped accounting for 0-wraparound
+        int16_t lostMessages = message.seq - expectedIndex;
+        if (lostMessages < 0)
+        {
+            // Usually, this happens in the case of an out-of order packet
+            lostMessages = 0;
+        }
+        m_totalLossCounter += lostMessages;
+        m_currLossCounter += lostMessages;
+    }
+
+    // Update the last sequence ID
+    lastIndex = message.seq;
+
+    // Update on every 32th packet
+    if (m_totalReceiveCounter % 32 == 0)
+    {
+        // Calculate new loss ratio
+        // Receive loss
+        float receiveLoss = (double)m_currLossCounter/(double)(m_currReceiveCounter+m_currLossCounter);
+        receiveLoss *= 100.0f;
+        m_currLossCounter = 0;
+        m_currReceiveCounter = 0;
+        emit receiveLossChanged(message.sysid, receiveLoss);
+    }
+}
@@ -0,0 +1,126 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief MAVLinkProtocolWorker
+ *          Parses the raw byte stream of a single link into mavlink_message_t
+ *          packets. One worker exists per link and lives in its own thread,
+ *          so a stalled UI never stalls telemetry parsing. Decoded packets are
+ *          handed to MAVLinkProtocol in the UI thread through a lock-free ring.
+ *
+ */
+
+#ifndef MAVLINKPROTOCOLWORKER_H
+#define MAVLINKPROTOCOLWORKER_H
+
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "MAVLinkFrameScanner.h"
+#include "SPSCRingBuffer.h"
+#include "TLogWriter.h"
+#include <QObject>
+#include <QByteArray>
+#include <QAtomicInt>
+
+#if defined(QGC_PROTOBUF_ENABLED)
+#include <tr1/memory>
+#if defined(QGC_USE_PIXHAWK_MESSAGES)
+#include <mavlink_protobuf_manager.hpp>
+#endif
+#endif
+
+class LinkInterface;
+class MAVLinkProtocol;
+
+class MAVLinkProtocolWorker : public QObject
+{
+    Q_OBJECT
+public:
+    struct QueuedMessage
+    {
+        quint64 time;               ///< Ground time the packet was decoded, in usecs
+        mavlink_message_t message;
+    };
+
+    MAVLinkProtocolWorker(MAVLinkProtocol *protocol, LinkInterface *link, int queueCapacity);
+    ~MAVLinkProtocolWorker();
+
+    LinkInterface *getLink() const { return m_link; }
+    int getLinkId() const { return m_linkId; }
+
+    /** @brief Consumer side, UI thread only */
+    bool takeMessage(QueuedMessage &item) { return m_queue.pop(item); }
+    /** @brief Clear the notification flag before draining, see receiveBytes() */
+    void clearDrainPending() { m_drainPending.storeRelease(0); }
+
+    int getQueueDepth() const { return m_queue.size(); }
+    int getQueueCapacity() const { return m_queue.capacity(); }
+    qint64 getDroppedMessages() const { return m_droppedMessages.loadAcquire(); }
+
+signals:
+    void protocolStatusMessage(const QString& title, const QString& message);
+    void receiveLossChanged(int id,float value);
+    void resetRequested(LinkInterface *link);
+#if defined(QGC_PROTOBUF_ENABLED)
+    /** @brief A complete protobuf message arrived, sysid is the source system from its header */
+    void extendedMessageReceived(LinkInterface *link, std::tr1::shared_ptr<google::protobuf::Message> message, int sysid);
+#endif
+
+public slots:
+    void receiveBytes(LinkInterface* link, QByteArray b);
+
+private:
+    void updateLoss(const mavlink_message_t &message);
+#if defined(QGC_PROTOBUF_ENABLED)
+    void handleExtendedMessage(const QByteArray &b, const mavlink_message_t &message);
+#endif
+
+private:
+    MAVLinkProtocol *m_protocol;
+    TLogWriter *m_tlogWriter;
+    TLogWriter::PacketQueue *m_logQueue;   ///< This worker's queue into the tlog writer
+    LinkInterface *m_link;
+    int m_linkId;
+
+    SPSCRingBuffer<QueuedMessage> m_queue;
+    QAtomicInt m_drainPending;
+    QAtomicInt m_droppedMessages;
+    MAVLinkFrameScanner m_scanner;
+
+    int m_mavlink09Count;
+    int m_nonmavlinkCount;
+    bool m_decodedFirstPacket;
+    bool m_warnedUser;
+    bool m_checkedUserNonMavlink;
+    bool m_warnedUserNonMavlink;
+
+    qint64 m_totalReceiveCounter;
+    qint64 m_currReceiveCounter;
+    qint64 m_totalLossCounter;
+    qint64 m_currLossCounter;
+    quint16 m_lastIndex[256*256];   ///< Last sequence number per sysid/compid, 0xFFFF if none yet
+#if defined(QGC_PROTOBUF_ENABLED) && defined(QGC_USE_PIXHAWK_MESSAGES)
+    mavlink::ProtobufManager m_protobufManager;
+#endif
+};
+
+#endif // MAVLINKPROTOCOLWORKER_H
@@ -0,0 +1,101 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief SPSCRingBuffer
+ *          Fixed capacity, lock-free ring buffer for exactly one producer
+ *          thread and one consumer thread. push() never blocks, it fails
+ *          when the buffer is full so the producer can count the drop.
+ *
+ */
+
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <QAtomicInt>
+#include <QVector>
+
+template <typename T>
+class SPSCRingBuffer
+{
+public:
+    /** @param capacity Requested number of slots, rounded up to a power of two */
+    explicit SPSCRingBuffer(int capacity)
+    {
+        int size = 2;
+        while (size < capacity + 1)
+        {
+            size <<= 1;
+        }
+        m_buffer.resize(size);
+        m_data = m_buffer.data();
+        m_mask = size - 1;
+    }
+
+    /** @brief Producer side. Returns false if the buffer is full */
+    bool push(const T &item)
+    {
+        const int head = m_head.load();
+        const int next = (head + 1) & m_mask;
+        if (next == m_tail.loadAcquire())
+        {
+            return false;
+        }
+        m_data[head] = item;
+        m_head.storeRelease(next);
+        return true;
+    }
+
+    /** @brief Consumer side. Returns false if the buffer is empty */
+    bool pop(T &item)
+    {
+        const int tail = m_tail.load();
+        if (tail == m_head.loadAcquire())
+        {
+            return false;
+        }
+        item = m_data[tail];
+        m_tail.storeRelease((tail + 1) & m_mask);
+        return true;
+    }
+
+    /** @brief Number of queued items. Exact only when called from one of the two sides */
+    int size() const
+    {
+        return (m_head.loadAcquire() - m_tail.loadAcquire()) & m_mask;
+    }
+
+    bool isEmpty() const { return size() == 0; }
+    int capacity() const { return m_mask; }
+
+private:
+    Q_DISABLE_COPY(SPSCRingBuffer)
+
+    QVector<T> m_buffer;
+    T *m_data;          ///< Detached once in the constructor, never reallocated
+    int m_mask;
+    QAtomicInt m_head;  ///< Next slot to write, owned by the producer
+    QAtomicInt m_tail;  ///< Next slot to read, owned by the consumer
+};
+
+#endif // SPSCRINGBUFFER_H
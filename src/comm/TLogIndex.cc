@@ -0,0 +1,158 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TLogIndex
+ *          Index of the packets in a .tlog file.
+ *
+ */
+
+#include "TLogIndex.h"
+#include "MAVLinkFrameScanner.h"
+#include "QGC.h"
+#include "QsLog.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+#include <algorithm>
+
+// Bump when the cache layout changes
+static const quint32 TLOG_INDEX_MAGIC = 0x544c4931; // "TLI1"
+
+// Each tlog record is a big endian usec timestamp followed by the frame
+static const int TLOG_TIMESTAMP_SIZE = sizeof(quint64);
+
+TLogIndex::TLogIndex()
+{
+}
+
+void TLogIndex::clear()
+{
+    m_offsets.clear();
+    m_times.clear();
+}
+
+bool TLogIndex::load(const QString& filename, const uchar *data, qint64 size)
+{
+    clear();
+    if (!data)
+    {
+        return false;
+    }
+    QFileInfo info(filename);
+    qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    QString cacheFile = cacheFileName(info.absoluteFilePath());
+
+    if (loadCache(cacheFile, size, modified))
+    {
+        QLOG_DEBUG() << "TLogIndex: loaded" << m_offsets.size() << "packets from cache" << cacheFile;
+        return true;
+    }
+
+    build(data, size);
+    saveCache(cacheFile, size, modified);
+    QLOG_DEBUG() << "TLogIndex: indexed" << m_offsets.size() << "packets in" << filename;
+    return true;
+}
+
+int TLogIndex::findTime(quint64 usecs) const
+{
+    // Logged times are monotonic for a single ground station, so a binary
+    // search is exact
+    QVector<quint64>::const_iterator it = std::lower_bound(m_times.constBegin(), m_times.constEnd(), usecs);
+    return it - m_times.constBegin();
+}
+
+void TLogIndex::build(const uchar *data, qint64 size)
+{
+    // Rough guess of the packet count, to avoid repeated reallocation
+    m_offsets.reserve(size / 40);
+    m_times.reserve(size / 40);
+
+    qint64 pos = 0;
+    while (pos + TLOG_TIMESTAMP_SIZE + MAVLINK_NUM_NON_PAYLOAD_BYTES <= size)
+    {
+        const uchar *frame = data + pos + TLOG_TIMESTAMP_SIZE;
+        if (MAVLinkFrameScanner::isValidFrame(frame, size - pos - TLOG_TIMESTAMP_SIZE))
+        {
+            m_offsets.append(pos + TLOG_TIMESTAMP_SIZE);
+            m_times.append(qFromBigEndian<quint64>(data + pos));
+            pos += TLOG_TIMESTAMP_SIZE + MAVLINK_NUM_NON_PAYLOAD_BYTES + frame[1];
+        }
+        else
+        {
+            // Corrupt or truncated record, resynchronise one byte at a time
+            pos++;
+        }
+    }
+    m_offsets.squeeze();
+    m_times.squeeze();
+}
+
+QString TLogIndex::cacheFileName(const QString& filename) const
+{
+    QString dir = QGC::appDataDirectory() + "/tlogindex";
+    QGC::makeDirectory(dir);
+    QByteArray hash = QCryptographicHash::hash(filename.toUtf8(), QCryptographicHash::Md5).toHex();
+    return dir + "/" + QString(hash) + ".idx";
+}
+
+bool TLogIndex::loadCache(const QString& cacheFile, qint64 size, qint64 modified)
+{
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    QDataStream stream(&file);
+    quint32 magic;
+    qint64 cachedSize;
+    qint64 cachedModified;
+    stream >> magic >> cachedSize >> cachedModified;
+    if (magic != TLOG_INDEX_MAGIC || cachedSize != size || cachedModified != modified)
+    {
+        return false;
+    }
+    stream >> m_offsets >> m_times;
+    if (stream.status() != QDataStream::Ok || m_offsets.size() != m_times.size())
+    {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void TLogIndex::saveCache(const QString& cacheFile, qint64 size, qint64 modified) const
+{
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        QLOG_WARN() << "TLogIndex: unable to write index cache" << cacheFile;
+        return;
+    }
+    QDataStream stream(&file);
+    stream << TLOG_INDEX_MAGIC << size << modified << m_offsets << m_times;
+}
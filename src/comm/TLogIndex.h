@@ -0,0 +1,74 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TLogIndex
+ *          Index of the packets in a .tlog file: the file offset of every
+ *          valid MAVLink frame and the ground timestamp logged before it.
+ *          Built in a single pass over the file and cached on disk, so
+ *          replays can seek to an exact time and read frames directly.
+ *
+ */
+
+#ifndef TLOGINDEX_H
+#define TLOGINDEX_H
+
+#include <QString>
+#include <QVector>
+
+class TLogIndex
+{
+public:
+    TLogIndex();
+
+    /**
+     * @brief Load the index of a tlog from the cache, or build (and cache) it
+     * @param data The contents of the tlog, usually memory mapped
+     */
+    bool load(const QString& filename, const uchar *data, qint64 size);
+    void clear();
+
+    int size() const { return m_offsets.size(); }
+    bool isEmpty() const { return m_offsets.isEmpty(); }
+    /** @brief File offset of the frame (STX byte) of packet i */
+    qint64 offset(int i) const { return m_offsets.at(i); }
+    /** @brief Logged ground time of packet i, in usecs */
+    quint64 time(int i) const { return m_times.at(i); }
+    quint64 startTime() const { return m_times.isEmpty() ? 0 : m_times.first(); }
+    quint64 endTime() const { return m_times.isEmpty() ? 0 : m_times.last(); }
+
+    /** @brief Index of the first packet logged at or after usecs */
+    int findTime(quint64 usecs) const;
+
+private:
+    void build(const uchar *data, qint64 size);
+    QString cacheFileName(const QString& filename) const;
+    bool loadCache(const QString& cacheFile, qint64 size, qint64 modified);
+    void saveCache(const QString& cacheFile, qint64 size, qint64 modified) const;
+
+private:
+    QVector<qint64> m_offsets;
+    QVector<quint64> m_times;
+};
+
+#endif // TLOGINDEX_H
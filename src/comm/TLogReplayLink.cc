@@ -2,18 +2,23 @@
 #include <QFile>
 #include <QDebug>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include "UASManager.h"
 #include "UAS.h"
 #include "MainWindow.h"
 #include "QGCMAVLinkUASFactory.h"
+#include "MAVLinkFrameScanner.h"
 TLogReplayLink::TLogReplayLink(QObject *parent) :
     LinkInterface(),
     m_toBeDeleted(false),
     m_threadRun(false),
     m_speedVar(50),
     m_posVar(0),
+    m_pause(false),
     m_mavlinkDecoder(new MAVLinkDecoder()),
-    m_mavlinkInspector(NULL)
+    m_mavlinkInspector(NULL),
+    m_seekTime(0),
+    m_seekPending(false)
 {
     Q_UNUSED(parent);
 }
@@ -105,196 +110,190 @@ void TLogReplayLink::setMavlinkInspector(QGCMAVLinkInspector *inspector)
     m_mavlinkInspector = inspector;
 }
 
+void TLogReplayLink::seekToTime(quint64 usecs)
+{
+    m_variableAccessMutex.lock();
+    m_seekTime = usecs;
+    m_seekPending = true;
+    m_variableAccessMutex.unlock();
+}
+
+void TLogReplayLink::dispatchMessage(const mavlink_message_t &message)
+{
+    if (message.sysid == 255)
+    {
+        //GCS packet, ignore it
+        return;
+    }
+    UASInterface* uas = UASManager::instance()->getUASForId(message.sysid);
+    if (!uas && message.msgid == MAVLINK_MSG_ID_HEARTBEAT)
+    {
+        mavlink_heartbeat_t heartbeat;
+        // Reset version field to 0
+        heartbeat.mavlink_version = 0;
+        mavlink_msg_heartbeat_decode(&message, &heartbeat);
+
+
+        // Create a new UAS object
+        if (heartbeat.autopilot == MAV_AUTOPILOT_ARDUPILOTMEGA)
+        {
+            ArduPilotMegaMAV* mav = new ArduPilotMegaMAV(0, message.sysid);
+            mav->setSystemType((int)heartbeat.type);
+            uas = mav;
+            // Make UAS aware that this link can be used to communicate with the actual robot
+            uas->addLink(this);
+            UASObject *obj = new UASObject();
+            LinkManager::instance()->addSimObject(message.sysid,obj);
+
+            // Now add UAS to "official" list, which makes the whole application aware of it
+            UASManager::instance()->addUAS(uas);
+
+        }
+    }
+    else if (uas)
+    {
+        uas->receiveMessage(this,message);
+        LinkManager::instance()->getUasObject(message.sysid)->messageReceived(this,message);
+        m_mavlinkDecoder->receiveMessage(this,message);
+        if (m_mavlinkInspector)
+        {
+            m_mavlinkInspector->receiveMessage(this,message);
+        }
+    }
+    else
+    {
+        //no UAS, and not a heartbeat
+    }
+}
+
 void TLogReplayLink::run()
 {
     m_pause = false;
     m_threadRun = true;
+    QFile file(m_logFile);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        QLOG_ERROR() << "TLogReplayLink: could not open" << m_logFile << file.errorString();
+        emit communicationError(getName(), tr("Could not open log file %1: %2").arg(m_logFile).arg(file.errorString()));
+        m_toBeDeleted = true;
+        emit disconnected(this);
+        emit disconnected();
+        emit connected(false);
+        return;
+    }
     emit connected(this);
     emit connected(true);
     emit connected();
-    QFile file(m_logFile);
-    file.open(QIODevice::ReadOnly);
-    int bytesize = 0;
-    qint64 msecs = QDateTime::currentMSecsSinceEpoch();
+
+    // Files that can not be mapped (e.g. on some network shares) are read
+    // into memory instead
+    QByteArray fileContents;
+    const uchar *data = file.map(0, file.size());
+    const bool mapped = (data != NULL);
+    qint64 size = file.size();
+    if (!mapped)
+    {
+        QLOG_WARN() << "TLogReplayLink: could not map" << m_logFile << file.errorString() << ", reading it instead";
+        fileContents = file.readAll();
+        data = reinterpret_cast<const uchar*>(fileContents.constData());
+        size = fileContents.size();
+    }
+    m_index.load(m_logFile, data, size);
     MainWindow::instance()->toolBar().disableConnectWidget(true);
     MainWindow::instance()->toolBar().overrideDisableConnectWidget(true);
-    int privSpeedVar = 100;
+
     mavlink_message_t message;
-    mavlink_status_t status;
-    QByteArray timebuf;
-    bool firsttime = true;
-    int delay = 0;
-    qint64 lastLogTime = 0;
-    qint64 lastPcTime = 0;
-    bool nexttime = false;
+    int current = 0;
+    int privSpeedVar = -1;
     qint64 privatepos = 0;
-    while (!file.atEnd() && m_threadRun)
+
+    // Packets are due when their logged time is before the log time the
+    // replay clock has reached. The clock is rebased on every speed change,
+    // seek, pause and long gap in the log.
+    QElapsedTimer wallclock;
+    wallclock.start();
+    QElapsedTimer progressTimer;
+    progressTimer.start();
+    qint64 baseWall = 0;
+    quint64 baseLogTime = m_index.startTime();
+
+    while (current < m_index.size() && m_threadRun)
     {
-        if (QDateTime::currentMSecsSinceEpoch() - msecs > 1000)
+        m_variableAccessMutex.lock();
+        if (privSpeedVar != m_speedVar)
         {
-            msecs = QDateTime::currentMSecsSinceEpoch();
-            m_variableAccessMutex.lock();
-
-            //m_speedVar is a value, between 25 and 175. These are speed percentages.
-            privSpeedVar = m_speedVar; //50 - ((m_speedVar) / 4);
-            if (privatepos != m_posVar)
+            privSpeedVar = m_speedVar;
+            baseWall = wallclock.elapsed();
+            baseLogTime = m_index.time(current);
+        }
+        if (privatepos != m_posVar)
+        {
+            privatepos = m_posVar;
+            if (privatepos > 0 && privatepos < 100)
             {
-                privatepos = m_posVar;
-                if (privatepos > 0 && privatepos < 100)
-                {
-                    file.seek((privatepos / 100.0) * file.size());
-                }
+                m_seekTime = m_index.startTime() + (m_index.endTime() - m_index.startTime()) * (privatepos / 100.0);
+                m_seekPending = true;
             }
-            m_variableAccessMutex.unlock();
         }
-        emit logProgress(file.pos(),file.size());
-        QByteArray bytes = file.read(128);
-        bytesize+=128;
+        if (m_seekPending)
+        {
+            m_seekPending = false;
+            current = qMin(m_index.findTime(m_seekTime), m_index.size() - 1);
+            baseWall = wallclock.elapsed();
+            baseLogTime = m_index.time(current);
+        }
+        m_variableAccessMutex.unlock();
 
-        for (int i=0;i<bytes.size();i++)
+        if (privSpeedVar <= 0)
         {
-            unsigned int decodeState = mavlink_parse_char(14, (uint8_t)(bytes[i]), &message, &status);
-            if (decodeState != 1)
+            //As fast as possible, in batches so pause/stop/seek stay responsive
+            int end = qMin(current + FastReplayBatch, m_index.size());
+            for (;current < end;current++)
             {
-                //Not a mavlink byte!
-                if (nexttime)
-                {
-                    timebuf.append(bytes[i]);
-                }
-                if (timebuf.size() == 8)
-                {
-                    nexttime = false;
-
-                    //Should be a timestamp for the next packet.
-                    quint64 logmsecs = quint64(static_cast<unsigned char>(timebuf.at(0))) << 56;
-                    logmsecs += quint64(static_cast<unsigned char>(timebuf.at(1))) << 48;
-                    logmsecs += quint64(static_cast<unsigned char>(timebuf.at(2))) << 40;
-                    logmsecs += quint64(static_cast<unsigned char>(timebuf.at(3))) << 32;
-                    logmsecs += quint64(static_cast<unsigned char>(timebuf.at(4))) << 24;
-                    logmsecs += quint64(static_cast<unsigned char>(timebuf.at(5))) << 16;
-                    logmsecs += quint64(static_cast<unsigned char>(timebuf.at(6))) << 8;
-                    logmsecs += quint64(static_cast<unsigned char>(timebuf.at(7))) << 0;
-
-                    timebuf.clear();
-
-                    if (firsttime)
-                    {
-                        firsttime = false;
-                        lastLogTime = logmsecs;
-                        lastPcTime = QDateTime::currentMSecsSinceEpoch();
-                    }
-                    else
-                    {
-                        //Difference in time between the last time we read a timestamp, and this time
-                        qint64 pcdiff = QDateTime::currentMSecsSinceEpoch() - lastPcTime;
-                        lastPcTime = QDateTime::currentMSecsSinceEpoch();
-
-                        //Difference in time between the last timestamp we fired off, and this one
-                        qint64 logdiff = logmsecs - lastLogTime;
-                        lastLogTime = logmsecs;
-                        logdiff /= 1000;
-
-                        if (logdiff < pcdiff)
-                        {
-                            //The next mavlink packet was fired faster than our loop is running, send it immediatly
-                            //Fire immediatly
-                            delay = 0;
-                        }
-                        else
-                        {
-                            //The next mavlink packet was sent logdiff-pcdiff millseconds after the current time
-                            delay = logdiff-pcdiff;
-
-                        }
-                    }
-
-                }
+                MAVLinkFrameScanner::decodeFrame(data + m_index.offset(current), &message);
+                dispatchMessage(message);
+            }
+        }
+        else
+        {
+            quint64 dueTime = baseLogTime + (wallclock.elapsed() - baseWall) * 10 * privSpeedVar; // usecs
+            if (m_index.time(current) > dueTime + 10000000)
+            {
+                //Skip gaps of more than 10 seconds in the log
+                baseWall = wallclock.elapsed();
+                baseLogTime = m_index.time(current);
+                dueTime = baseLogTime;
             }
-            else if (decodeState == 1)
+            while (current < m_index.size() && m_index.time(current) <= dueTime)
             {
-                nexttime = true;
-                //Good decode
-                if (message.sysid == 255)
-                {
-                    //GCS packet, ignore it
-                }
-                else
-                {
-                    UASInterface* uas = UASManager::instance()->getUASForId(message.sysid);
-                    if (!uas && message.msgid == MAVLINK_MSG_ID_HEARTBEAT)
-                    {
-                        mavlink_heartbeat_t heartbeat;
-                        // Reset version field to 0
-                        heartbeat.mavlink_version = 0;
-                        mavlink_msg_heartbeat_decode(&message, &heartbeat);
-
-
-                        // Create a new UAS object
-                        if (heartbeat.autopilot == MAV_AUTOPILOT_ARDUPILOTMEGA)
-                        {
-                            ArduPilotMegaMAV* mav = new ArduPilotMegaMAV(0, message.sysid);
-                            mav->setSystemType((int)heartbeat.type);
-                            uas = mav;
-                            // Make UAS aware that this link can be used to communicate with the actual robot
-                            uas->addLink(this);
-                            UASObject *obj = new UASObject();
-                            LinkManager::instance()->addSimObject(message.sysid,obj);
-
-                            // Now add UAS to "official" list, which makes the whole application aware of it
-                            UASManager::instance()->addUAS(uas);
-
-                        }
-                    }
-                    else if (uas)
-                    {
-                        if (delay > 0 && delay < 10000)
-                        {
-                            //Split the delay into 100msec chunks, to allow for canceling.
-                            int realdelay = delay / ((double)privSpeedVar / 100.0);
-                            int repeat = realdelay / 100;
-                            for (int i=0;i<repeat;i++)
-                            {
-                                msleep(100);
-                                if (!m_threadRun)
-                                {
-                                    //Break out
-                                    MainWindow::instance()->toolBar().overrideDisableConnectWidget(false);
-                                    MainWindow::instance()->toolBar().disableConnectWidget(false);
-                                    emit disconnected(this);
-                                    emit disconnected();
-                                    emit connected(false);
-                                    UASManager::instance()->removeUAS(UASManager::instance()->getActiveUAS());
-                                    return;
-                                }
-                            }
-                            msleep(realdelay - repeat);
-                            //msleep(delay / ((double)privSpeedVar / 100.0));
-                        }
-                        else
-                        {
-                            msleep(1);
-                        }
-                        uas->receiveMessage(this,message);
-                        LinkManager::instance()->getUasObject(message.sysid)->messageReceived(this,message);
-                        m_mavlinkDecoder->receiveMessage(this,message);
-                        if (m_mavlinkInspector)
-                        {
-                            m_mavlinkInspector->receiveMessage(this,message);
-                        }
-                    }
-                    else
-                    {
-                        //no UAS, and not a heartbeat
-                    }
-                }
-
+                MAVLinkFrameScanner::decodeFrame(data + m_index.offset(current), &message);
+                dispatchMessage(message);
+                current++;
             }
+            msleep(ReplaySliceMsecs);
         }
-        while (m_pause)
+
+        if (progressTimer.elapsed() > 100 && current < m_index.size())
+        {
+            progressTimer.restart();
+            emit logProgress(m_index.offset(current),size);
+        }
+
+        if (m_pause)
         {
-            msleep(100);
+            while (m_pause && m_threadRun)
+            {
+                msleep(100);
+            }
+            baseWall = wallclock.elapsed();
+            baseLogTime = current < m_index.size() ? m_index.time(current) : 0;
         }
     }
+    emit logProgress(size,size);
+    if (mapped)
+    {
+        file.unmap(const_cast<uchar*>(data));
+    }
     if (m_threadRun)
     {
         m_toBeDeleted = true;
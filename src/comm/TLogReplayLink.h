@@ -4,6 +4,7 @@
 #include "LinkInterface.h"
 #include "MAVLinkDecoder.h"
 #include "QGCMAVLinkInspector.h"
+#include "TLogIndex.h"
 #include <QMutex>
 
 class TLogReplayLink : public LinkInterface
@@ -32,9 +33,12 @@ public:
     void stop();
     bool toBeDeleted();
 
-    //Speed is 1-100, being slowest to fastest
+    //Speed is a percentage of real time, 0 replays as fast as possible
     void setSpeed(int speed);
+    //Position is 0-100 percent of the logged time span
     void setPosition(qint64 pos);
+    //Seek to the first packet logged at or after usecs (ground time)
+    void seekToTime(quint64 usecs);
     void disableTimeouts() { }
     void enableTimeouts() { }
 signals:
@@ -54,6 +58,11 @@ private slots:
     void run();
     void readBytes();
 private:
+    void dispatchMessage(const mavlink_message_t &message);
+
+    static const int ReplaySliceMsecs = 10;     ///< Wall time covered by one batch at normal speeds
+    static const int FastReplayBatch = 1000;    ///< Packets per batch when replaying as fast as possible
+
     QString m_logFile;
     bool m_toBeDeleted;
     bool m_threadRun;
@@ -63,6 +72,9 @@ private:
     bool m_pause;
     MAVLinkDecoder *m_mavlinkDecoder;
     QGCMAVLinkInspector *m_mavlinkInspector;
+    TLogIndex m_index;
+    quint64 m_seekTime;
+    bool m_seekPending;
 };
 
 #endif // TLOGREPLYLINK_H
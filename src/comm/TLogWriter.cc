@@ -0,0 +1,260 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TLogWriter
+ *          Writes MAVLink packets to a .tlog file from a background thread.
+ *
+ */
+
+#include "TLogWriter.h"
+#include "QsLog.h"
+#include <QElapsedTimer>
+#include <QtEndian>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+TLogWriter::TLogWriter(QObject *parent) :
+    QThread(parent),
+    m_syncInterval(5000),
+    m_bytesWritten(0),
+    m_writeRate(0.0)
+{
+    m_buffer.reserve(BlockSize * 2);
+}
+
+TLogWriter::~TLogWriter()
+{
+    close();
+    QMutexLocker locker(&m_producerMutex);
+    qDeleteAll(m_producers);
+    m_producers.clear();
+}
+
+bool TLogWriter::open(const QString& filename)
+{
+    close();
+
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered))
+    {
+        return false;
+    }
+
+    // The writer thread is not running, so this thread may act as consumer
+    // and throw away anything queued while logging was off
+    {
+        QMutexLocker locker(&m_producerMutex);
+        Packet packet;
+        foreach (PacketQueue *queue, m_producers)
+        {
+            while (queue->pop(packet));
+        }
+    }
+    m_buffer.clear();
+    m_droppedPackets.storeRelease(0);
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_bytesWritten = 0;
+        m_writeRate = 0.0;
+    }
+
+    m_stop.storeRelease(0);
+    m_open.storeRelease(1);
+    start(QThread::LowPriority);
+    return true;
+}
+
+void TLogWriter::close()
+{
+    if (!m_file.isOpen())
+    {
+        return;
+    }
+    m_open.storeRelease(0);
+    m_stop.storeRelease(1);
+    wait();
+    m_file.close();
+    QLOG_DEBUG() << "TLogWriter closed" << m_file.fileName() << "bytes written:" << getBytesWritten()
+                 << "dropped packets:" << getDroppedPackets();
+}
+
+TLogWriter::PacketQueue* TLogWriter::addProducer()
+{
+    PacketQueue *queue = new PacketQueue(QueueCapacity);
+    QMutexLocker locker(&m_producerMutex);
+    m_producers.append(queue);
+    return queue;
+}
+
+void TLogWriter::removeProducer(PacketQueue *queue)
+{
+    QMutexLocker locker(&m_producerMutex);
+    m_producers.removeOne(queue);
+    delete queue;
+}
+
+bool TLogWriter::write(PacketQueue *queue, quint64 time, const mavlink_message_t &message)
+{
+    Packet packet;
+    packet.time = time;
+    packet.message = message;
+    if (!queue->push(packet))
+    {
+        m_droppedPackets.fetchAndAddRelaxed(1);
+        return false;
+    }
+    return true;
+}
+
+qint64 TLogWriter::getBytesWritten() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    return m_bytesWritten;
+}
+
+double TLogWriter::getWriteRate() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    return m_writeRate;
+}
+
+int TLogWriter::getBacklog() const
+{
+    QMutexLocker locker(&m_producerMutex);
+    int backlog = 0;
+    foreach (PacketQueue *queue, m_producers)
+    {
+        backlog += queue->size();
+    }
+    return backlog;
+}
+
+int TLogWriter::drainQueues()
+{
+    QMutexLocker locker(&m_producerMutex);
+    int count = 0;
+    Packet packet;
+    foreach (PacketQueue *queue, m_producers)
+    {
+        while (queue->pop(packet))
+        {
+            uchar time[sizeof(quint64)];
+            qToBigEndian<quint64>(packet.time, time);
+            m_buffer.append(reinterpret_cast<const char*>(time), sizeof(time));
+            // write headers, payload (incs CRC)
+            m_buffer.append(reinterpret_cast<const char*>(&packet.message.magic),
+                            MAVLINK_NUM_NON_PAYLOAD_BYTES + packet.message.len);
+            count++;
+        }
+    }
+    return count;
+}
+
+bool TLogWriter::writeBuffer(bool all)
+{
+    // Only write whole blocks, unless told to write everything
+    int size = all ? m_buffer.size() : (m_buffer.size() / BlockSize) * BlockSize;
+    if (size == 0)
+    {
+        return true;
+    }
+    if (m_file.write(m_buffer.constData(), size) != size)
+    {
+        return false;
+    }
+    m_buffer.remove(0, size);
+    QMutexLocker locker(&m_statsMutex);
+    m_bytesWritten += size;
+    return true;
+}
+
+void TLogWriter::syncFile()
+{
+    m_file.flush();
+#ifdef Q_OS_WIN
+    _commit(m_file.handle());
+#else
+    fsync(m_file.handle());
+#endif
+}
+
+void TLogWriter::run()
+{
+    QElapsedTimer syncTimer;
+    QElapsedTimer statsTimer;
+    syncTimer.start();
+    statsTimer.start();
+    qint64 lastBytesWritten = 0;
+
+    while (!m_stop.loadAcquire())
+    {
+        int drained = drainQueues();
+        if (!writeBuffer(false))
+        {
+            m_open.storeRelease(0);
+            emit writeError(m_file.errorString());
+            return;
+        }
+        int syncInterval = m_syncInterval.loadAcquire();
+        if (syncInterval > 0 && syncTimer.elapsed() >= syncInterval)
+        {
+            if (!writeBuffer(true))
+            {
+                m_open.storeRelease(0);
+                emit writeError(m_file.errorString());
+                return;
+            }
+            syncFile();
+            syncTimer.restart();
+        }
+        if (statsTimer.elapsed() >= 1000)
+        {
+            qint64 bytesWritten = getBytesWritten();
+            double rate = (bytesWritten - lastBytesWritten) * 1000.0 / statsTimer.elapsed();
+            lastBytesWritten = bytesWritten;
+            {
+                QMutexLocker locker(&m_statsMutex);
+                m_writeRate = rate;
+            }
+            statsTimer.restart();
+            emit statisticsUpdated(bytesWritten, rate, getBacklog(), getDroppedPackets());
+        }
+        if (drained == 0)
+        {
+            msleep(PollInterval);
+        }
+    }
+
+    // Final pass, write out everything that was queued before close()
+    drainQueues();
+    if (!writeBuffer(true))
+    {
+        emit writeError(m_file.errorString());
+    }
+    syncFile();
+}
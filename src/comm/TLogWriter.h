@@ -0,0 +1,115 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TLogWriter
+ *          Writes MAVLink packets to a .tlog file from a background thread.
+ *          Every producer (one per link parser) pushes into its own lock-free
+ *          queue, so logging never blocks telemetry. The writer thread drains
+ *          all queues, coalesces packets into large block aligned writes and
+ *          syncs the file to disk at a configurable interval.
+ *
+ */
+
+#ifndef TLOGWRITER_H
+#define TLOGWRITER_H
+
+#include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
+#include "SPSCRingBuffer.h"
+#include <QThread>
+#include <QFile>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QList>
+
+class TLogWriter : public QThread
+{
+    Q_OBJECT
+public:
+    struct Packet
+    {
+        quint64 time;   ///< Ground time in usecs, written big endian before the packet
+        mavlink_message_t message;
+    };
+    typedef SPSCRingBuffer<Packet> PacketQueue;
+
+    explicit TLogWriter(QObject *parent = 0);
+    ~TLogWriter();
+
+    bool open(const QString& filename);
+    void close();
+    bool isOpen() const { return m_open.loadAcquire() != 0; }
+    QString fileName() const { return m_file.fileName(); }
+
+    /** @brief Create a queue for one producer thread. Owned by the writer */
+    PacketQueue* addProducer();
+    /** @brief Remove a producer queue. The producer thread must no longer use it */
+    void removeProducer(PacketQueue *queue);
+    /** @brief Producer side, never blocks. Returns false if the packet was dropped */
+    bool write(PacketQueue *queue, quint64 time, const mavlink_message_t &message);
+
+    /** @brief Interval in msecs between fsyncs of the file, 0 only syncs on close */
+    void setSyncInterval(int msecs) { m_syncInterval.storeRelease(msecs); }
+    int getSyncInterval() const { return m_syncInterval.loadAcquire(); }
+
+    qint64 getBytesWritten() const;
+    qint64 getDroppedPackets() const { return m_droppedPackets.loadAcquire(); }
+    /** @brief Packets queued by producers but not yet written */
+    int getBacklog() const;
+    /** @brief Write throughput over the last second, in bytes per second */
+    double getWriteRate() const;
+
+signals:
+    void writeError(const QString& message);
+    void statisticsUpdated(qint64 bytesWritten, double bytesPerSecond, int backlog, qint64 droppedPackets);
+
+protected:
+    void run();
+
+private:
+    int drainQueues();
+    bool writeBuffer(bool all);
+    void syncFile();
+
+private:
+    static const int BlockSize = 64 * 1024;     ///< Size of a single coalesced write
+    static const int QueueCapacity = 4096;      ///< Packets per producer queue
+    static const int PollInterval = 20;         ///< Msecs to sleep when all queues are empty
+
+    QFile m_file;
+    QByteArray m_buffer;
+    QAtomicInt m_open;
+    QAtomicInt m_stop;
+    QAtomicInt m_droppedPackets;
+    QAtomicInt m_syncInterval;  ///< Set from the GUI thread, read by the writer thread
+
+    mutable QMutex m_producerMutex;
+    QList<PacketQueue*> m_producers;
+
+    mutable QMutex m_statsMutex;
+    qint64 m_bytesWritten;
+    double m_writeRate;
+};
+
+#endif // TLOGWRITER_H
@@ -0,0 +1,220 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TelemetryBus
+ *          Lock-free latest-value table for telemetry channels, see TelemetryBus.h
+ *
+ */
+
+#include "TelemetryBus.h"
+#include "QsLog.h"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QThread>
+
+TelemetryBus* TelemetryBus::instance()
+{
+    static TelemetryBus* _instance = 0;
+    if(_instance == 0) {
+        // Not locked: QGCCore creates the bus on the GUI thread before any
+        // link thread starts, later calls only read the pointer.
+        Q_ASSERT(!qApp || QThread::currentThread() == qApp->thread());
+        _instance = new TelemetryBus();
+
+        // Set the application as parent to ensure that this object
+        // will be destroyed when the main application exits
+        _instance->setParent(qApp);
+    }
+    return _instance;
+}
+
+TelemetryBus::TelemetryBus(QObject *parent) :
+    QObject(parent),
+    m_slots(new Slot[MaxChannels]),
+    m_channelCount(0)
+{
+    for (int i = 0; i < MaxChannels; ++i)
+    {
+        m_slots[i].uasId = 0;
+        m_slots[i].value = 0.0;
+        m_slots[i].msec = 0;
+    }
+}
+
+TelemetryBus::~TelemetryBus()
+{
+    delete[] m_slots;
+}
+
+int TelemetryBus::channel(const QString& name, const QString& unit)
+{
+    int id;
+    {
+        QMutexLocker locker(&m_registryMutex);
+        QHash<QString,int>::const_iterator it = m_channelIds.constFind(name);
+        if (it != m_channelIds.constEnd())
+        {
+            return it.value();
+        }
+        id = m_channelNames.size();
+        if (id >= MaxChannels)
+        {
+            QLOG_WARN() << "TelemetryBus: channel table full, not publishing" << name;
+            m_channelIds.insert(name, -1);
+            return -1;
+        }
+        m_channelIds.insert(name, id);
+        m_channelNames.append(name);
+        m_channelUnits.append(unit);
+        m_channelCount.storeRelease(id + 1);
+    }
+    emit channelRegistered(id, name, unit);
+    return id;
+}
+
+void TelemetryBus::publish(int channel, int uasId, double value, quint64 msec)
+{
+    if (channel < 0 || channel >= MaxChannels)
+    {
+        return;
+    }
+    Slot &slot = m_slots[channel];
+
+    // Claim the slot by making its sequence odd, several link threads may
+    // publish the same channel.
+    int seq;
+    for (;;)
+    {
+        seq = slot.sequence.loadAcquire();
+        if (!(seq & 1) && slot.sequence.testAndSetAcquire(seq, seq + 1))
+        {
+            break;
+        }
+    }
+    slot.uasId = uasId;
+    slot.value = value;
+    slot.msec = msec;
+
+    int next = seq + 2;
+    if (next == 0)
+    {
+        next = 2; // 0 is reserved for "never published"
+    }
+    slot.sequence.storeRelease(next);
+}
+
+bool TelemetryBus::latest(int channel, Sample *sample) const
+{
+    if (channel < 0 || channel >= MaxChannels || !sample)
+    {
+        return false;
+    }
+    const Slot &slot = m_slots[channel];
+    for (;;)
+    {
+        int before = slot.sequence.loadAcquire();
+        if (before == 0)
+        {
+            return false;
+        }
+        if (before & 1)
+        {
+            continue;
+        }
+        sample->uasId = slot.uasId;
+        sample->value = slot.value;
+        sample->msec = slot.msec;
+
+        // Full barrier, so the copy above can not be reordered past the re-check
+        int after = const_cast<QAtomicInt&>(slot.sequence).fetchAndAddOrdered(0);
+        if (after == before)
+        {
+            sample->sequence = before;
+            return true;
+        }
+    }
+}
+
+int TelemetryBus::sequence(int channel) const
+{
+    if (channel < 0 || channel >= MaxChannels)
+    {
+        return 0;
+    }
+    return m_slots[channel].sequence.loadAcquire() & ~1;
+}
+
+QString TelemetryBus::channelName(int channel) const
+{
+    QMutexLocker locker(&m_registryMutex);
+    return m_channelNames.value(channel);
+}
+
+QString TelemetryBus::channelUnit(int channel) const
+{
+    QMutexLocker locker(&m_registryMutex);
+    return m_channelUnits.value(channel);
+}
+
+TelemetrySubscriber::TelemetrySubscriber(int intervalMs, QObject *parent) :
+    QObject(parent)
+{
+    connect(&m_timer,SIGNAL(timeout()),this,SLOT(tick()));
+    m_timer.start(intervalMs);
+}
+
+void TelemetrySubscriber::watch(int channel)
+{
+    if (channel < 0 || m_lastSequence.contains(channel))
+    {
+        return;
+    }
+    // 0 guarantees a value that is already there shows up on the next tick
+    m_lastSequence.insert(channel, 0);
+}
+
+void TelemetrySubscriber::unwatch(int channel)
+{
+    m_lastSequence.remove(channel);
+}
+
+void TelemetrySubscriber::tick()
+{
+    TelemetryBus *bus = TelemetryBus::instance();
+    m_changed.clear();
+    for (QHash<int,int>::iterator i = m_lastSequence.begin(); i != m_lastSequence.end(); ++i)
+    {
+        int seq = bus->sequence(i.key());
+        if (seq != i.value())
+        {
+            i.value() = seq;
+            m_changed.append(i.key());
+        }
+    }
+    if (!m_changed.isEmpty())
+    {
+        emit updated();
+    }
+}
@@ -0,0 +1,146 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2014 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief TelemetryBus
+ *          Typed publish/subscribe path for telemetry values. Every value name
+ *          is interned to an integer channel the first time it is seen, after
+ *          that publishing is a lock-free write of a double into the channel's
+ *          latest-value slot. Widgets read the slots at their own rate, either
+ *          directly with latest() or through a TelemetrySubscriber that hands
+ *          out one coalesced update per tick.
+ *
+ */
+
+#ifndef TELEMETRYBUS_H
+#define TELEMETRYBUS_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include <QTimer>
+
+class TelemetryBus : public QObject
+{
+    Q_OBJECT
+public:
+    /** @brief Latest value of a channel */
+    struct Sample
+    {
+        int uasId;
+        double value;
+        quint64 msec;
+        int sequence;   ///< Changes on every publish, 0 if never published
+    };
+
+    enum { MaxChannels = 8192 };
+
+    /** @brief The bus, first created by QGCCore on the GUI thread before the links start */
+    static TelemetryBus* instance();
+
+    /**
+     * @brief Channel id for a value name, registering it on first sight
+     *
+     * Takes a lock, so callers on a hot path should look the id up once and
+     * keep it. Returns -1 once MaxChannels names have been registered.
+     */
+    int channel(const QString& name, const QString& unit);
+
+    /** @brief Store the latest value of a channel. Lock-free, safe from any thread */
+    void publish(int channel, int uasId, double value, quint64 msec);
+
+    /** @brief Read the latest value of a channel. Returns false if nothing was published yet */
+    bool latest(int channel, Sample *sample) const;
+
+    /** @brief Publish counter of a channel, cheap check for changes without reading the value */
+    int sequence(int channel) const;
+
+    int channelCount() const { return m_channelCount.loadAcquire(); }
+    QString channelName(int channel) const;
+    QString channelUnit(int channel) const;
+
+signals:
+    /** @brief Emitted once per channel, from the registering thread */
+    void channelRegistered(int channel, const QString& name, const QString& unit);
+
+private:
+    TelemetryBus(QObject *parent = 0);
+    ~TelemetryBus();
+    Q_DISABLE_COPY(TelemetryBus)
+
+    struct Slot
+    {
+        QAtomicInt sequence;    ///< Odd while a writer owns the slot
+        int uasId;
+        double value;
+        quint64 msec;
+    };
+
+    Slot *m_slots;                      ///< MaxChannels slots, allocated once
+    QAtomicInt m_channelCount;
+    mutable QMutex m_registryMutex;     ///< Guards the name registry only, never the slots
+    QHash<QString,int> m_channelIds;
+    QVector<QString> m_channelNames;
+    QVector<QString> m_channelUnits;
+};
+
+/**
+ * @brief Pulls changed channels from the bus at a fixed rate
+ *
+ * Emits updated() at most once per interval, and only when one of the
+ * watched channels was published since the previous tick.
+ */
+class TelemetrySubscriber : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TelemetrySubscriber(int intervalMs, QObject *parent = 0);
+
+    void watch(int channel);
+    void unwatch(int channel);
+    bool isWatching(int channel) const { return m_lastSequence.contains(channel); }
+
+    void setInterval(int intervalMs) { m_timer.setInterval(intervalMs); }
+    void start() { m_timer.start(); }
+    void stop() { m_timer.stop(); }
+    int interval() const { return m_timer.interval(); }
+
+    /** @brief Channels that changed in the last tick, valid inside updated() */
+    const QList<int>& changedChannels() const { return m_changed; }
+
+signals:
+    void updated();
+
+private slots:
+    void tick();
+
+private:
+    QTimer m_timer;
+    QHash<int,int> m_lastSequence;  ///< Watched channel to the sequence seen at the last tick
+    QList<int> m_changed;
+};
+
+#endif // TELEMETRYBUS_H
@@ -8,6 +8,7 @@
 #define AUTOTEST_H
 
 #include <QTest>
+#include <QApplication>
 #include <QList>
 #include <QString>
 #include <QSharedPointer>
@@ -51,7 +52,8 @@ namespace AutoTest
     inline int run(int argc, char *argv[])
     { 
 	int ret = 0;
-	QCoreApplication t(argc, argv);
+	// A full QApplication, some of the tests create widgets
+	QApplication t(argc, argv);
 	foreach (QObject* test, testList())
 	{  
             ret += QTest::qExec(test, argc, argv);
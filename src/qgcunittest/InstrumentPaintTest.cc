@@ -0,0 +1,62 @@
+#include "InstrumentPaintTest.h"
+#include "PrimaryFlightDisplay.h"
+#include "HSIDisplay.h"
+#include <QPixmap>
+
+InstrumentPaintTest::InstrumentPaintTest()
+{
+}
+
+void InstrumentPaintTest::addSizes()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::newRow("320x240") << QSize(320, 240);
+    QTest::newRow("640x480") << QSize(640, 480);
+    QTest::newRow("1280x960") << QSize(1280, 960);
+}
+
+void InstrumentPaintTest::primaryFlightDisplay_benchmark_data()
+{
+    addSizes();
+}
+
+void InstrumentPaintTest::primaryFlightDisplay_benchmark()
+{
+    QFETCH(QSize, size);
+
+    PrimaryFlightDisplay pfd;
+    pfd.resize(size);
+    QPixmap target(size);
+
+    // Turn a little every frame so the compass disk and the tapes are redrawn
+    double yaw = 0.0;
+    QBENCHMARK
+    {
+        yaw += 0.01;
+        pfd.updateAttitude(NULL, 0.1, 0.05, yaw, 0);
+        pfd.altitudeChanged(NULL, 100.0 + yaw, 50.0 + yaw, 0.5, 0);
+        pfd.render(&target);
+    }
+}
+
+void InstrumentPaintTest::hsiDisplay_benchmark_data()
+{
+    addSizes();
+}
+
+void InstrumentPaintTest::hsiDisplay_benchmark()
+{
+    QFETCH(QSize, size);
+
+    HSIDisplay hsi;
+    hsi.resize(size);
+    QPixmap target(size);
+
+    double yaw = 0.0;
+    QBENCHMARK
+    {
+        yaw += 0.01;
+        hsi.updateAttitude(NULL, 0.1, 0.05, yaw, 0);
+        hsi.render(&target);
+    }
+}
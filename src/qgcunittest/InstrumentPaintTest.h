@@ -0,0 +1,27 @@
+#ifndef INSTRUMENTPAINTTEST_H
+#define INSTRUMENTPAINTTEST_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+#include "AutoTest.h"
+
+class InstrumentPaintTest : public QObject
+{
+    Q_OBJECT
+public:
+    InstrumentPaintTest();
+
+private slots:
+    void primaryFlightDisplay_benchmark_data();
+    void primaryFlightDisplay_benchmark();
+    void hsiDisplay_benchmark_data();
+    void hsiDisplay_benchmark();
+
+private:
+    /** @brief Widget sizes every benchmark is run at */
+    static void addSizes();
+};
+
+DECLARE_TEST(InstrumentPaintTest)
+#endif // INSTRUMENTPAINTTEST_H
@@ -0,0 +1,141 @@
+#include "LogDownloadDialogTest.h"
+#include "LogDownloadDialog.h"
+#include "globalobject.h"
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QSet>
+
+static const int LOG_UAS_ID = 1;
+static const uint16_t LOG_ID = 3;
+static const uint32_t LOG_TIME = 1234567890;
+static const uint LOG_BLOCK = 90;   // bytes per LOG_DATA, as sent by ArduPilot
+
+LogServingUAS::LogServingUAS(MAVLinkProtocol* protocol, int id) :
+    UAS(protocol, id),
+    pending(false),
+    requestId(0),
+    requestOfs(0),
+    requestCount(0),
+    requests(0),
+    ended(false)
+{
+}
+
+void LogServingUAS::logRequestData(uint16_t id, uint32_t ofs, uint32_t count)
+{
+    // Like the vehicle, a new request replaces the one being served
+    pending = true;
+    requestId = id;
+    requestOfs = ofs;
+    requestCount = count;
+    requests++;
+}
+
+void LogServingUAS::logRequestEnd()
+{
+    ended = true;
+}
+
+LogDownloadDialogTest::LogDownloadDialogTest() :
+    mav(NULL),
+    uas(NULL)
+{
+}
+
+void LogDownloadDialogTest::init()
+{
+    mav = new MAVLinkProtocol();
+    uas = new LogServingUAS(mav, LOG_UAS_ID);
+    logDirectory = GlobalObject::sharedInstance()->logDirectory();
+}
+
+void LogDownloadDialogTest::cleanup()
+{
+    GlobalObject::sharedInstance()->setLogDirectory(logDirectory);
+    delete uas;
+    uas = NULL;
+    delete mav;
+    mav = NULL;
+}
+
+void LogDownloadDialogTest::droppedPackets_test()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    GlobalObject::sharedInstance()->setLogDirectory(directory.path());
+
+    // 200 full blocks and a short one at the end
+    const uint logSize = LOG_BLOCK * 200 + 37;
+    QByteArray log(logSize, 0);
+    for (uint i = 0; i < logSize; i++)
+    {
+        log[i] = static_cast<char>((i * 31 + i / LOG_BLOCK) & 0xff);
+    }
+
+    LogDownloadDialog dialog;
+    dialog.setDownloadWindow(32);
+    dialog.setActiveUAS(uas);
+    dialog.logEntry(LOG_UAS_ID, LOG_TIME, logSize, LOG_ID, 1, LOG_ID);
+    dialog.getSelectedLogs();
+
+    // Every 7th block is lost the first time it is sent. A gap inside a
+    // window is asked for again as soon as the window is drained, a lost
+    // last block of a window only comes back through the retry timer.
+    QSet<uint> dropped;
+    QSet<uint> delivered;
+    int duplicates = 0;
+    int retries = 0;
+    QElapsedTimer timeout;
+    timeout.start();
+    while (!uas->ended && timeout.elapsed() < 30000)
+    {
+        if (!uas->pending)
+        {
+            QTest::qWait(10);
+            // Apart from the first one, only the retry timer requests
+            // blocks while no LOG_DATA is coming in
+            if (uas->pending && uas->requests > 1)
+            {
+                retries++;
+            }
+            continue;
+        }
+        uas->pending = false;
+        QCOMPARE(uas->requestId, LOG_ID);
+        const uint32_t end = qMin(uas->requestOfs + uas->requestCount, static_cast<uint32_t>(logSize));
+        for (uint32_t ofs = uas->requestOfs; ofs < end && !uas->pending; ofs += LOG_BLOCK)
+        {
+            uint block = ofs / LOG_BLOCK;
+            if (block % 7 == 0 && !dropped.contains(block))
+            {
+                dropped.insert(block);
+                continue;
+            }
+            if (delivered.contains(block))
+            {
+                duplicates++;
+            }
+            delivered.insert(block);
+            uint8_t count = static_cast<uint8_t>(qMin(LOG_BLOCK, logSize - ofs));
+            dialog.logData(LOG_UAS_ID, ofs, LOG_ID, count, log.constData() + ofs);
+        }
+    }
+    QVERIFY2(uas->ended, "Download did not complete");
+    const double elapsed = qMax(timeout.elapsed(), static_cast<qint64>(1));
+    qDebug("%u bytes with %d lost blocks in %.0f ms (%.1f KB/s), %d requests, %d retries, %d duplicate blocks",
+           logSize, dropped.size(), elapsed, logSize / elapsed,
+           uas->requests, retries, duplicates);
+    // Only the missing runs are requested again, nothing arrives twice
+    QCOMPARE(duplicates, 0);
+    QVERIFY(dropped.size() >= 200 / 7);
+    QVERIFY(retries > 0);
+    // One request per window is the minimum, the lost blocks add to that
+    QVERIFY(uas->requests > static_cast<int>(logSize / (LOG_BLOCK * 32)));
+
+    LogDownloadDescriptor descriptor(LOG_ID, LOG_TIME, logSize);
+    QFile file(directory.path() + "/" + descriptor.logFilename());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray downloaded = file.readAll();
+    QCOMPARE(downloaded.size(), log.size());
+    QVERIFY(downloaded == log);
+}
@@ -0,0 +1,47 @@
+#ifndef LOGDOWNLOADDIALOGTEST_H
+#define LOGDOWNLOADDIALOGTEST_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+#include "AutoTest.h"
+#include "UAS.h"
+#include "MAVLinkProtocol.h"
+
+/** @brief A vehicle that keeps the log requests of the dialog for the test to serve */
+class LogServingUAS : public UAS
+{
+public:
+    LogServingUAS(MAVLinkProtocol* protocol, int id);
+
+    void logRequestData(uint16_t id, uint32_t ofs, uint32_t count);
+    void logRequestEnd();
+
+    bool pending;       ///< A LOG_REQUEST_DATA arrived that has not been served
+    uint16_t requestId;
+    uint32_t requestOfs;
+    uint32_t requestCount;
+    int requests;
+    bool ended;
+};
+
+class LogDownloadDialogTest : public QObject
+{
+    Q_OBJECT
+public:
+    LogDownloadDialogTest();
+
+private slots:
+    void init();
+    void cleanup();
+
+    void droppedPackets_test();
+
+private:
+    MAVLinkProtocol* mav;
+    LogServingUAS* uas;
+    QString logDirectory;
+};
+
+DECLARE_TEST(LogDownloadDialogTest)
+#endif // LOGDOWNLOADDIALOGTEST_H
@@ -0,0 +1,259 @@
+#include "MAVLinkFrameScannerTest.h"
+#include <QElapsedTimer>
+
+// Not used by the ground station itself, so split frames do not collide
+static const int SCANNER_CHANNEL = MAVLINK_COMM_NUM_BUFFERS - 2;
+
+MAVLinkFrameScannerTest::MAVLinkFrameScannerTest()
+{
+}
+
+quint16 MAVLinkFrameScannerTest::bytewiseCrc(const uchar *data, int size, quint16 crc)
+{
+    for (int i = 0; i < size; i++)
+    {
+        crc_accumulate(data[i], &crc);
+    }
+    return crc;
+}
+
+QByteArray MAVLinkFrameScannerTest::randomBytes(int size)
+{
+    QByteArray bytes(size, 0);
+    for (int i = 0; i < size; i++)
+    {
+        bytes[i] = static_cast<char>(qrand() & 0xff);
+    }
+    return bytes;
+}
+
+QByteArray MAVLinkFrameScannerTest::tlogBuffer(int records)
+{
+    QByteArray tlog;
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    quint64 timestamp = Q_UINT64_C(1420070400000000);
+    for (int i = 0; i < records; i++)
+    {
+        mavlink_message_t msg;
+        switch (i % 5)
+        {
+        case 0:
+            mavlink_msg_heartbeat_pack(1, 1, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_ARDUPILOTMEGA, 0, i, MAV_STATE_ACTIVE);
+            break;
+        case 1:
+            mavlink_msg_attitude_pack(1, 1, &msg, i, 0.01f * i, -0.2f, 1.5f, 0.01f, 0.02f, 0.03f);
+            break;
+        case 2:
+            mavlink_msg_gps_raw_int_pack(1, 1, &msg, timestamp, 3, -353632610 + i, 1491652440 - i, 584070 + i, 121, 65535, 1200, 9000, 10);
+            break;
+        case 3:
+            mavlink_msg_vfr_hud_pack(1, 1, &msg, 12.5f, 13.0f, 90, 55, 584.07f, 0.5f);
+            break;
+        default:
+            mavlink_msg_sys_status_pack(1, 1, &msg, 0, 0, 0, 500, 12600, -1, 87, 0, 0, 0, 0, 0, 0);
+            break;
+        }
+
+        // A timestamp byte that looks like STX would make the two decoders
+        // disagree on the frames found, the link never produces those
+        timestamp += 20000;
+        while (true)
+        {
+            bool stx = false;
+            for (int b = 0; b < 8; b++)
+            {
+                stx |= ((timestamp >> (8 * b)) & 0xff) == MAVLINK_STX;
+            }
+            if (!stx)
+            {
+                break;
+            }
+            timestamp++;
+        }
+        for (int b = 7; b >= 0; b--)
+        {
+            tlog.append(static_cast<char>((timestamp >> (8 * b)) & 0xff));
+        }
+        tlog.append(reinterpret_cast<const char*>(buffer), mavlink_msg_to_send_buffer(buffer, &msg));
+    }
+    return tlog;
+}
+
+int MAVLinkFrameScannerTest::scanFrames(const QByteArray &bytes, int blockSize)
+{
+    mavlink_get_channel_status(SCANNER_CHANNEL)->parse_state = MAVLINK_PARSE_STATE_IDLE;
+    MAVLinkFrameScanner scanner(SCANNER_CHANNEL);
+    int frames = 0;
+    int step = blockSize > 0 ? blockSize : bytes.size();
+    for (int pos = 0; pos < bytes.size(); pos += step)
+    {
+        scanner.setData(reinterpret_cast<const uchar*>(bytes.constData()) + pos, qMin(step, bytes.size() - pos));
+        mavlink_message_t msg;
+        while (scanner.next(&msg))
+        {
+            frames++;
+        }
+    }
+    return frames;
+}
+
+int MAVLinkFrameScannerTest::parseFrames(const QByteArray &bytes, int blockSize)
+{
+    mavlink_get_channel_status(SCANNER_CHANNEL)->parse_state = MAVLINK_PARSE_STATE_IDLE;
+    int frames = 0;
+    int step = blockSize > 0 ? blockSize : bytes.size();
+    for (int pos = 0; pos < bytes.size(); pos += step)
+    {
+        int end = qMin(pos + step, bytes.size());
+        for (int i = pos; i < end; i++)
+        {
+            mavlink_message_t msg;
+            mavlink_status_t status;
+            if (mavlink_parse_char(SCANNER_CHANNEL, static_cast<uint8_t>(bytes.at(i)), &msg, &status))
+            {
+                frames++;
+            }
+        }
+    }
+    return frames;
+}
+
+void MAVLinkFrameScannerTest::crc16_test()
+{
+    qsrand(1);
+    for (int i = 0; i < 2000; i++)
+    {
+        // Every length up to a full frame and beyond, at every alignment
+        int size = i % 300;
+        int offset = (i / 300) % 4;
+        quint16 init = (i % 7 == 0) ? static_cast<quint16>(qrand()) : static_cast<quint16>(X25_INIT_CRC);
+        QByteArray bytes = randomBytes(offset + size);
+        const uchar *data = reinterpret_cast<const uchar*>(bytes.constData()) + offset;
+
+        QCOMPARE(MAVLinkFrameScanner::crc16(data, size, init), bytewiseCrc(data, size, init));
+    }
+}
+
+void MAVLinkFrameScannerTest::blocks_test_data()
+{
+    QTest::addColumn<int>("blockSize");
+    QTest::newRow("1 byte") << 1;
+    QTest::newRow("7 bytes") << 7;
+    QTest::newRow("64 bytes") << 64;
+    QTest::newRow("whole stream") << 0;
+}
+
+void MAVLinkFrameScannerTest::blocks_test()
+{
+    QFETCH(int, blockSize);
+
+    // Frames of different lengths with noise in between
+    qsrand(2);
+    QList<mavlink_message_t> sent;
+    QByteArray stream;
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    for (int i = 0; i < 200; i++)
+    {
+        mavlink_message_t msg;
+        if (i % 2)
+        {
+            mavlink_msg_heartbeat_pack(1, 1, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_ARDUPILOTMEGA, 0, i, MAV_STATE_ACTIVE);
+        }
+        else
+        {
+            mavlink_msg_attitude_pack(1, 1, &msg, i, 0.1f * i, 0.2f, 0.3f, 0.0f, 0.0f, 0.0f);
+        }
+        sent.append(msg);
+        stream.append(reinterpret_cast<const char*>(buffer), mavlink_msg_to_send_buffer(buffer, &msg));
+        if (i % 5 == 0)
+        {
+            QByteArray noise = randomBytes(i % 11);
+            noise.replace(static_cast<char>(MAVLINK_STX), static_cast<char>(0));
+            stream.append(noise);
+        }
+    }
+
+    mavlink_get_channel_status(SCANNER_CHANNEL)->parse_state = MAVLINK_PARSE_STATE_IDLE;
+    MAVLinkFrameScanner scanner(SCANNER_CHANNEL);
+    QList<mavlink_message_t> received;
+    int step = blockSize > 0 ? blockSize : stream.size();
+    for (int pos = 0; pos < stream.size(); pos += step)
+    {
+        scanner.setData(reinterpret_cast<const uchar*>(stream.constData()) + pos, qMin(step, stream.size() - pos));
+        mavlink_message_t msg;
+        while (scanner.next(&msg))
+        {
+            received.append(msg);
+        }
+    }
+
+    // Frames split across blocks go through mavlink_parse_char(), none may be lost
+    QCOMPARE(received.size(), sent.size());
+    for (int i = 0; i < sent.size(); i++)
+    {
+        QCOMPARE(received.at(i).seq, sent.at(i).seq);
+        QCOMPARE(received.at(i).msgid, sent.at(i).msgid);
+        QCOMPARE(received.at(i).len, sent.at(i).len);
+        QCOMPARE(received.at(i).checksum, sent.at(i).checksum);
+        QVERIFY(memcmp(_MAV_PAYLOAD(&received.at(i)), _MAV_PAYLOAD(&sent.at(i)), sent.at(i).len) == 0);
+    }
+}
+
+void MAVLinkFrameScannerTest::crc16_benchmark_data()
+{
+    QTest::addColumn<bool>("sliced");
+    QTest::newRow("slice-by-4") << true;
+    QTest::newRow("crc_accumulate") << false;
+}
+
+void MAVLinkFrameScannerTest::crc16_benchmark()
+{
+    QFETCH(bool, sliced);
+
+    qsrand(3);
+    QByteArray bytes = randomBytes(64 * 1024);
+    const uchar *data = reinterpret_cast<const uchar*>(bytes.constData());
+    quint16 crc = X25_INIT_CRC;
+    QBENCHMARK
+    {
+        crc = sliced ? MAVLinkFrameScanner::crc16(data, bytes.size(), crc) : bytewiseCrc(data, bytes.size(), crc);
+    }
+    // Keep the result alive, so the loop is not optimised away
+    volatile quint16 result = crc;
+    Q_UNUSED(result);
+}
+
+void MAVLinkFrameScannerTest::scan_benchmark_data()
+{
+    QTest::addColumn<bool>("scanner");
+    QTest::addColumn<int>("blockSize");
+    QTest::newRow("scanner, 4 KB blocks") << true << 4096;
+    QTest::newRow("scanner, whole buffer") << true << 0;
+    QTest::newRow("mavlink_parse_char, 4 KB blocks") << false << 4096;
+    QTest::newRow("mavlink_parse_char, whole buffer") << false << 0;
+}
+
+void MAVLinkFrameScannerTest::scan_benchmark()
+{
+    QFETCH(bool, scanner);
+    QFETCH(int, blockSize);
+
+    // About 1 MB of telemetry, 4 KB is what a serial or UDP read returns
+    const int records = 30000;
+    QByteArray tlog = tlogBuffer(records);
+    int frames = 0;
+    qint64 nsecs = 0;
+    int runs = 0;
+    QBENCHMARK
+    {
+        QElapsedTimer timer;
+        timer.start();
+        frames = scanner ? scanFrames(tlog, blockSize) : parseFrames(tlog, blockSize);
+        nsecs += timer.nsecsElapsed();
+        runs++;
+    }
+    QCOMPARE(frames, records);
+    // Bytes per microsecond is MB/s
+    qDebug("%s: %d bytes, %.1f MB/s", QTest::currentDataTag(), tlog.size(),
+           static_cast<double>(tlog.size()) * runs / qMax(nsecs / 1000.0, 1.0));
+}
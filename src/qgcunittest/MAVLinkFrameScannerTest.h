@@ -0,0 +1,37 @@
+#ifndef MAVLINKFRAMESCANNERTEST_H
+#define MAVLINKFRAMESCANNERTEST_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+#include "AutoTest.h"
+#include "MAVLinkFrameScanner.h"
+
+class MAVLinkFrameScannerTest : public QObject
+{
+    Q_OBJECT
+public:
+    MAVLinkFrameScannerTest();
+
+private slots:
+    void crc16_test();
+    void blocks_test_data();
+    void blocks_test();
+    void crc16_benchmark_data();
+    void crc16_benchmark();
+    void scan_benchmark_data();
+    void scan_benchmark();
+
+private:
+    /** @brief The reference CRC, one crc_accumulate() per byte */
+    static quint16 bytewiseCrc(const uchar *data, int size, quint16 crc);
+    static QByteArray randomBytes(int size);
+    /** @brief A tlog as written by the ground station, timestamps and a typical telemetry mix */
+    static QByteArray tlogBuffer(int records);
+    /** @brief Decode a buffer in blocks of blockSize bytes (0 for all at once), returns the frames found */
+    static int scanFrames(const QByteArray &bytes, int blockSize);
+    static int parseFrames(const QByteArray &bytes, int blockSize);
+};
+
+DECLARE_TEST(MAVLinkFrameScannerTest)
+#endif // MAVLINKFRAMESCANNERTEST_H
@@ -0,0 +1,141 @@
+#include "MAVLinkProtocolTest.h"
+#include <QFile>
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+/** @brief Resident set size of this process in bytes, -1 where it can not be read */
+static qint64 residentBytes()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly))
+    {
+        return -1;
+    }
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2)
+    {
+        return -1;
+    }
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+MAVLinkProtocolTest::MAVLinkProtocolTest() :
+    mav(NULL),
+    link(NULL)
+{
+}
+
+void MAVLinkProtocolTest::initTestCase()
+{
+    mav = new MAVLinkProtocol();
+    mav->setOnline(false);
+    link = new MockLink();
+}
+
+void MAVLinkProtocolTest::cleanupTestCase()
+{
+    delete link;
+    link = NULL;
+    delete mav;
+    mav = NULL;
+}
+
+QByteArray MAVLinkProtocolTest::heartbeats(int count, int systems, int keepEvery)
+{
+    QByteArray stream;
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    for (int i = 0; i < count; i++)
+    {
+        mavlink_message_t msg;
+        int system = i % systems;
+        mavlink_msg_heartbeat_pack(1 + system % 250, 1 + system / 250, &msg,
+                                   MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_ARDUPILOTMEGA, 0, 0, MAV_STATE_ACTIVE);
+        uint16_t len = mavlink_msg_to_send_buffer(buffer, &msg);
+        if (i % keepEvery == 0)
+        {
+            stream.append(reinterpret_cast<const char*>(buffer), len);
+        }
+    }
+    return stream;
+}
+
+void MAVLinkProtocolTest::drain(MAVLinkProtocolWorker &worker)
+{
+    MAVLinkProtocolWorker::QueuedMessage item;
+    while (worker.takeMessage(item))
+    {
+    }
+}
+
+void MAVLinkProtocolTest::receiveLoss_test()
+{
+    // Start the sequence numbers at 0, so the test does not depend on wrap around
+    mavlink_get_channel_status(MAVLINK_COMM_0)->current_tx_seq = 0;
+
+    MAVLinkProtocolWorker worker(mav, link, 256);
+    QSignalSpy lossSpy(&worker, SIGNAL(receiveLossChanged(int,float)));
+
+    // A clean stream from one system reports no loss every 32 packets
+    worker.receiveBytes(link, heartbeats(64, 1));
+    QCOMPARE(lossSpy.count(), 2);
+    QCOMPARE(lossSpy.at(1).at(1).toFloat(), 0.0f);
+    QCOMPARE(worker.getQueueDepth(), 64);
+    drain(worker);
+
+    // Every other packet lost: the first 32 received ones see 31 gaps.
+    // The first packet of the burst continues the sequence of the clean
+    // stream above, so it does not count as a gap.
+    lossSpy.clear();
+    worker.receiveBytes(link, heartbeats(64, 1, 2));
+    QCOMPARE(lossSpy.count(), 1);
+    QVERIFY(qAbs(lossSpy.at(0).at(1).toFloat() - 100.0f * 31.0f / 63.0f) < 0.01f);
+}
+
+void MAVLinkProtocolTest::constantMemory_test()
+{
+    // 10 million packets from 1000 sysid/compid pairs, drained like the UI
+    // thread does. The parser and loss tracking must not grow with the
+    // stream: only the first blocks may allocate.
+    const int packetsPerBlock = 1000;
+    const int blocks = 10000;
+    QByteArray block = heartbeats(packetsPerBlock, 1000);
+
+    MAVLinkProtocolWorker worker(mav, link, 4096);
+    qint64 warmResident = -1;
+    for (int i = 0; i < blocks; i++)
+    {
+        worker.receiveBytes(link, block);
+        QVERIFY(worker.getQueueDepth() <= worker.getQueueCapacity());
+        drain(worker);
+        if (i == 100)
+        {
+            warmResident = residentBytes();
+        }
+    }
+    QCOMPARE(worker.getDroppedMessages(), qint64(0));
+
+    qint64 endResident = residentBytes();
+    if (warmResident < 0 || endResident < 0)
+    {
+        QSKIP("Resident memory can not be read on this platform");
+    }
+    qDebug() << "Resident memory after" << 101 * packetsPerBlock << "packets:" << warmResident / 1024 << "KiB,"
+             << "after" << qint64(blocks) * packetsPerBlock << "packets:" << endResident / 1024 << "KiB";
+    QVERIFY(endResident - warmResident < 1024 * 1024);
+}
+
+void MAVLinkProtocolTest::parseThroughput_benchmark()
+{
+    QByteArray block = heartbeats(1000, 16);
+    MAVLinkProtocolWorker worker(mav, link, 4096);
+    QBENCHMARK
+    {
+        worker.receiveBytes(link, block);
+        drain(worker);
+    }
+}
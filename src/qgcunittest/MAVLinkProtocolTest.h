@@ -0,0 +1,36 @@
+#ifndef MAVLINKPROTOCOLTEST_H
+#define MAVLINKPROTOCOLTEST_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+#include "AutoTest.h"
+#include "MAVLinkProtocol.h"
+#include "MAVLinkProtocolWorker.h"
+#include "MockLink.h"
+
+class MAVLinkProtocolTest : public QObject
+{
+    Q_OBJECT
+public:
+    MAVLinkProtocolTest();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void receiveLoss_test();
+    void constantMemory_test();
+    void parseThroughput_benchmark();
+
+private:
+    /** @brief count heartbeats spread over many sysid/compid pairs, keeping every keepEvery-th one */
+    static QByteArray heartbeats(int count, int systems, int keepEvery = 1);
+    static void drain(MAVLinkProtocolWorker &worker);
+
+    MAVLinkProtocol* mav;
+    MockLink* link;
+};
+
+DECLARE_TEST(MAVLinkProtocolTest)
+#endif // MAVLINKPROTOCOLTEST_H
@@ -0,0 +1,285 @@
+#ifndef MOCKBOOTLOADER_H
+#define MOCKBOOTLOADER_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
+
+/**
+ * @brief In-memory PX4 bootloader for the firmware uploader tests
+ *
+ * Commands written by the uploader are answered like the bootloader does.
+ * Replies are held back until the event loop runs, so packets the uploader
+ * queues in one go are seen in flight together, and can be handed out a few
+ * bytes at a time to split them over several readyRead() signals. A reply
+ * latency stands in for the round trip over USB or a serial link.
+ *
+ * The results live in a Stats struct owned by the test, since the uploader
+ * deletes its device when it is done.
+ */
+class MockBootloader : public QIODevice
+{
+    Q_OBJECT
+public:
+    struct Stats
+    {
+        Stats() : programPackets(0), programBytes(0), programMsecs(0), maxInFlight(0), largestPacket(0), smallestPacket(0), crcRequested(false), rebooted(false) {}
+        int programPackets;     ///< PROG_MULTI packets received
+        int programBytes;       ///< PROG_MULTI payload bytes received
+        qint64 programMsecs;    ///< From the first PROG_MULTI until the last answer was readable
+        int maxInFlight;        ///< Most PROG_MULTI packets received but not yet answered
+        int largestPacket;      ///< Largest PROG_MULTI payload
+        int smallestPacket;     ///< Smallest PROG_MULTI payload
+        bool crcRequested;
+        bool rebooted;
+        QByteArray flash;       ///< Flash contents after programming
+    };
+
+    MockBootloader(Stats *stats, int bootloaderRev, int flashSize, int replyChunk = 0, int rejectPacket = -1) :
+        m_stats(stats),
+        m_bootloaderRev(bootloaderRev),
+        m_flashSize(flashSize),
+        m_replyChunk(replyChunk),
+        m_rejectPacket(rejectPacket),
+        m_replyLatency(0),
+        m_programAddress(0),
+        m_programStart(0),
+        m_inFlight(0),
+        m_queuedBytes(0),
+        m_deliveredBytes(0)
+    {
+        m_stats->flash = QByteArray(flashSize, static_cast<char>(0xFF));
+        connect(&m_deliverTimer, SIGNAL(timeout()), this, SLOT(deliver()));
+        m_deliverTimer.setSingleShot(true);
+        m_deliverTimer.setTimerType(Qt::PreciseTimer);
+        m_clock.start();
+        open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+    }
+
+    /** @brief Hold every reply back for msecs after its command was written */
+    void setReplyLatency(int msecs) { m_replyLatency = qMax(0, msecs); }
+
+    bool isSequential() const { return true; }
+    qint64 bytesAvailable() const { return m_readable.size() + QIODevice::bytesAvailable(); }
+
+    /** @brief The CRC the bootloader reports, a plain crc32 over the whole flash */
+    static quint32 crc32(const QByteArray &data)
+    {
+        quint32 state = 0;
+        for (int i = 0; i < data.size(); i++)
+        {
+            state ^= static_cast<unsigned char>(data[i]);
+            for (int bit = 0; bit < 8; bit++)
+            {
+                state = (state & 1) ? (state >> 1) ^ 0xedb88320 : state >> 1;
+            }
+        }
+        return state;
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize)
+    {
+        int count = static_cast<int>(qMin<qint64>(maxSize, m_readable.size()));
+        memcpy(data, m_readable.constData(), count);
+        m_readable.remove(0, count);
+        return count;
+    }
+
+    qint64 writeData(const char *data, qint64 size)
+    {
+        m_command.append(data, static_cast<int>(size));
+        while (parseCommand())
+        {
+        }
+        return size;
+    }
+
+private slots:
+    void deliver()
+    {
+        if (!isOpen())
+        {
+            return;
+        }
+        // Only replies whose latency has passed can be read
+        qint64 now = m_clock.elapsed();
+        qint64 dueEnd = m_deliveredBytes;
+        for (int i = 0; i < m_replyEnds.size() && m_replyDue.at(i) <= now; i++)
+        {
+            dueEnd = m_replyEnds.at(i);
+        }
+        int count = static_cast<int>(dueEnd - m_deliveredBytes);
+        if (m_replyChunk > 0)
+        {
+            count = qMin(m_replyChunk, count);
+        }
+        m_readable.append(m_pending.left(count));
+        m_pending.remove(0, count);
+        m_deliveredBytes += count;
+        while (!m_replyEnds.isEmpty() && m_replyEnds.first() <= m_deliveredBytes)
+        {
+            m_replyEnds.removeFirst();
+            m_replyDue.removeFirst();
+        }
+        while (!m_programReplyEnds.isEmpty() && m_programReplyEnds.first() <= m_deliveredBytes)
+        {
+            m_programReplyEnds.removeFirst();
+            m_inFlight--;
+            m_stats->programMsecs = now - m_programStart;
+        }
+        scheduleDelivery();
+        if (count > 0)
+        {
+            emit readyRead();
+        }
+    }
+
+private:
+    static int byteAt(const QByteArray &bytes, int offset)
+    {
+        return static_cast<unsigned char>(bytes[offset]);
+    }
+
+    void reply(const QByteArray &bytes)
+    {
+        m_pending.append(bytes);
+        m_queuedBytes += bytes.size();
+        m_replyEnds.append(m_queuedBytes);
+        m_replyDue.append(m_clock.elapsed() + m_replyLatency);
+        scheduleDelivery();
+    }
+
+    /** @brief Run deliver() once the oldest reply not yet readable is due */
+    void scheduleDelivery()
+    {
+        if (m_replyDue.isEmpty() || m_deliverTimer.isActive())
+        {
+            return;
+        }
+        m_deliverTimer.start(static_cast<int>(qMax<qint64>(0, m_replyDue.first() - m_clock.elapsed())));
+    }
+
+    void replyValue(quint32 value)
+    {
+        QByteArray bytes;
+        bytes.append(static_cast<char>(value & 0xFF));
+        bytes.append(static_cast<char>((value >> 8) & 0xFF));
+        bytes.append(static_cast<char>((value >> 16) & 0xFF));
+        bytes.append(static_cast<char>((value >> 24) & 0xFF));
+        reply(bytes);
+    }
+
+    void replySync(bool ok = true)
+    {
+        reply(QByteArray().append(0x12).append(static_cast<char>(ok ? 0x10 : 0x13)));
+    }
+
+    /** @brief Handle one complete command from the front of m_command, false if there is none */
+    bool parseCommand()
+    {
+        if (m_command.isEmpty())
+        {
+            return false;
+        }
+        int length;
+        switch (static_cast<unsigned char>(m_command[0]))
+        {
+        case 0x22: length = 3; break;                   // GET_DEVICE param EOC
+        case 0x2A: length = 5; break;                   // GET_OTP address, sent without EOC
+        case 0x2B: length = 6; break;                   // GET_SN address EOC
+        case 0x27:                                      // PROG_MULTI length data EOC
+            if (m_command.size() < 2)
+            {
+                return false;
+            }
+            length = byteAt(m_command, 1) + 3;
+            break;
+        default: length = 2; break;                     // command EOC
+        }
+        if (m_command.size() < length)
+        {
+            return false;
+        }
+        QByteArray command = m_command.left(length);
+        m_command.remove(0, length);
+
+        switch (static_cast<unsigned char>(command[0]))
+        {
+        case 0x21:  // GET_SYNC
+            replySync();
+            break;
+        case 0x22:  // GET_DEVICE
+            switch (command[1])
+            {
+            case 0x01: replyValue(m_bootloaderRev); break;
+            case 0x04: replyValue(m_flashSize); break;
+            default: replyValue(9); break;
+            }
+            replySync();
+            break;
+        case 0x2A:  // GET_OTP
+        case 0x2B:  // GET_SN
+            replyValue(0x01020304);
+            replySync();
+            break;
+        case 0x23:  // CHIP_ERASE
+            m_stats->flash.fill(static_cast<char>(0xFF));
+            m_programAddress = 0;
+            replySync();
+            break;
+        case 0x27:  // PROG_MULTI
+        {
+            int size = length - 3;
+            if (m_stats->programPackets == 0)
+            {
+                m_programStart = m_clock.elapsed();
+            }
+            m_stats->programBytes += size;
+            m_stats->flash.replace(m_programAddress, size, command.mid(2, size));
+            m_programAddress += size;
+            m_stats->largestPacket = qMax(m_stats->largestPacket, size);
+            m_stats->smallestPacket = m_stats->programPackets ? qMin(m_stats->smallestPacket, size) : size;
+            m_inFlight++;
+            m_stats->maxInFlight = qMax(m_stats->maxInFlight, m_inFlight);
+            replySync(m_stats->programPackets != m_rejectPacket);
+            m_stats->programPackets++;
+            m_programReplyEnds.append(m_queuedBytes);
+            break;
+        }
+        case 0x29:  // GET_CRC
+            m_stats->crcRequested = true;
+            replyValue(crc32(m_stats->flash));
+            replySync();
+            break;
+        case 0x30:  // REBOOT
+            m_stats->rebooted = true;
+            break;
+        }
+        return true;
+    }
+
+    Stats *m_stats;
+    int m_bootloaderRev;
+    int m_flashSize;
+    int m_replyChunk;       ///< Reply bytes handed out per readyRead(), 0 for all
+    int m_rejectPacket;     ///< PROG_MULTI packet answered with INVALID, -1 for none
+    int m_replyLatency;     ///< msecs from a command to its reply being readable
+    int m_programAddress;
+    qint64 m_programStart;
+    int m_inFlight;
+    QByteArray m_command;
+    QByteArray m_pending;   ///< Replies not yet readable
+    QByteArray m_readable;
+    qint64 m_queuedBytes;
+    qint64 m_deliveredBytes;
+    QList<qint64> m_replyEnds;          ///< End of each pending reply, in queued bytes
+    QList<qint64> m_replyDue;           ///< When each pending reply becomes readable
+    QList<qint64> m_programReplyEnds;
+    QElapsedTimer m_clock;
+    QTimer m_deliverTimer;
+};
+
+#endif // MOCKBOOTLOADER_H
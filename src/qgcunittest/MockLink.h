@@ -0,0 +1,50 @@
+#ifndef MOCKLINK_H
+#define MOCKLINK_H
+
+#include <QByteArray>
+#include "LinkInterface.h"
+
+/**
+ * @brief In-memory link for the unit tests
+ *
+ * Bytes written by the ground station are emitted as bytesSent(), so a test
+ * can play the vehicle side, and receive() injects bytes as if they arrived
+ * from the vehicle.
+ */
+class MockLink : public LinkInterface
+{
+    Q_OBJECT
+public:
+    MockLink() : m_id(getNextLinkId()), m_connected(true) {}
+
+    void disableTimeouts() {}
+    void enableTimeouts() {}
+    int getId() const { return m_id; }
+    QString getName() const { return "Mock Link"; }
+    QString getShortName() const { return "Mock"; }
+    QString getDetail() const { return QString(); }
+    void requestReset() {}
+    bool isConnected() const { return m_connected; }
+    qint64 getConnectionSpeed() const { return 0; }
+    qint64 bytesAvailable() { return 0; }
+
+    /** @brief Deliver bytes to the ground station as if the vehicle had sent them */
+    void receive(const QByteArray &bytes) { emit bytesReceived(this, bytes); }
+
+public slots:
+    bool connect() { m_connected = true; emit connected(); return true; }
+    bool disconnect() { m_connected = false; emit disconnected(); return true; }
+    void writeBytes(const char *bytes, qint64 length) { emit bytesSent(QByteArray(bytes, static_cast<int>(length))); }
+
+signals:
+    void bytesSent(const QByteArray &bytes);
+
+protected slots:
+    void readBytes() {}
+
+private:
+    int m_id;
+    bool m_connected;
+};
+
+#endif // MOCKLINK_H
@@ -0,0 +1,187 @@
+#include "PX4FirmwareUploaderTest.h"
+#include "PX4FirmwareUploader.h"
+#include "MockBootloader.h"
+#include <QElapsedTimer>
+
+static const int FLASH_SIZE = 64 * 1024;
+static const int IMAGE_SIZE = 10001;    // not a multiple of 4, the uploader pads it
+
+PX4FirmwareUploaderTest::PX4FirmwareUploaderTest()
+{
+}
+
+bool PX4FirmwareUploaderTest::writePx4File(QTemporaryFile &file, const QByteArray &image)
+{
+    // The image is a zlib stream without the size prefix qCompress() adds
+    QByteArray compressed = qCompress(image).mid(4);
+    QString json = QString("{\"board_id\": 9, \"image_size\": %1, \"description\": \"unit test\", \"image\": \"%2\"}")
+            .arg(image.size()).arg(QString(compressed.toBase64()));
+    if (!file.open())
+    {
+        return false;
+    }
+    file.write(json.toUtf8());
+    file.close();
+    return true;
+}
+
+QByteArray PX4FirmwareUploaderTest::testImage()
+{
+    QByteArray image(IMAGE_SIZE, 0);
+    for (int i = 0; i < IMAGE_SIZE; i++)
+    {
+        image[i] = static_cast<char>((i * 7 + i / 251) & 0xff);
+    }
+    return image;
+}
+
+bool PX4FirmwareUploaderTest::waitForComplete(QSignalSpy &completeSpy)
+{
+    // The erase is polled every 250 ms, the rest only waits for the event loop
+    QElapsedTimer timer;
+    timer.start();
+    while (completeSpy.isEmpty() && timer.elapsed() < 10000)
+    {
+        QTest::qWait(10);
+    }
+    return !completeSpy.isEmpty();
+}
+
+void PX4FirmwareUploaderTest::upload_test_data()
+{
+    QTest::addColumn<int>("bootloaderRev");
+    QTest::addColumn<int>("packetsInFlight");
+    QTest::addColumn<int>("replyChunk");
+    QTest::addColumn<int>("packetSize");
+
+    QTest::newRow("pipelined") << 4 << 4 << 0 << 252;
+    QTest::newRow("pipelined, replies split") << 4 << 4 << 1 << 252;
+    QTest::newRow("pipelined, replies in threes") << 4 << 4 << 3 << 252;
+    QTest::newRow("one in flight") << 4 << 1 << 0 << 252;
+    QTest::newRow("old bootloader") << 2 << 4 << 0 << 60;
+}
+
+void PX4FirmwareUploaderTest::upload_test()
+{
+    QFETCH(int, bootloaderRev);
+    QFETCH(int, packetsInFlight);
+    QFETCH(int, replyChunk);
+    QFETCH(int, packetSize);
+
+    QByteArray image = testImage();
+    QTemporaryFile px4;
+    QVERIFY(writePx4File(px4, image));
+
+    PX4FirmwareUploader uploader;
+    uploader.setMaxPacketsInFlight(packetsInFlight);
+    QSignalSpy completeSpy(&uploader, SIGNAL(complete()));
+    QSignalSpy errorSpy(&uploader, SIGNAL(error(QString)));
+    QSignalSpy statusSpy(&uploader, SIGNAL(statusUpdate(QString)));
+    uploader.loadFile(px4.fileName());
+
+    MockBootloader::Stats stats;
+    uploader.startOnDevice(new MockBootloader(&stats, bootloaderRev, FLASH_SIZE, replyChunk));
+    QVERIFY(waitForComplete(completeSpy));
+
+    // Padded to 4 bytes with erased flash, and the rest of the flash stays erased
+    QByteArray padded = image;
+    while (padded.size() % 4)
+    {
+        padded.append(static_cast<char>(0xFF));
+    }
+    QCOMPARE(stats.flash, padded + QByteArray(FLASH_SIZE - padded.size(), static_cast<char>(0xFF)));
+
+    // Old bootloaders get the small packets, and every packet is a multiple of 4
+    QCOMPARE(stats.programPackets, (padded.size() + packetSize - 1) / packetSize);
+    QCOMPARE(stats.largestPacket, packetSize);
+    QCOMPARE(stats.smallestPacket, padded.size() % packetSize);
+    QCOMPARE(stats.smallestPacket % 4, 0);
+
+    // The pipeline is filled, but never past the limit, however the replies arrive
+    QCOMPARE(stats.maxInFlight, packetsInFlight);
+
+    // The CRC built while sending and padded to the flash size matches the
+    // bootloader's CRC over the whole flash
+    QVERIFY(stats.crcRequested);
+    bool verified = false;
+    for (int i = 0; i < statusSpy.count(); i++)
+    {
+        verified |= statusSpy.at(i).at(0).toString() == "Verify successful, rebooting";
+    }
+    QVERIFY(verified);
+    QVERIFY(stats.rebooted);
+
+    // The certificate check fails against the mock, nothing else may
+    for (int i = 0; i < errorSpy.count(); i++)
+    {
+        QVERIFY(!errorSpy.at(i).at(0).toString().contains("Firmware write failed"));
+    }
+}
+
+void PX4FirmwareUploaderTest::rejectedPacket_test()
+{
+    QTemporaryFile px4;
+    QVERIFY(writePx4File(px4, testImage()));
+
+    PX4FirmwareUploader uploader;
+    QSignalSpy completeSpy(&uploader, SIGNAL(complete()));
+    QSignalSpy errorSpy(&uploader, SIGNAL(error(QString)));
+    uploader.loadFile(px4.fileName());
+
+    MockBootloader::Stats stats;
+    uploader.startOnDevice(new MockBootloader(&stats, 4, FLASH_SIZE, 0, 2));
+    QVERIFY(waitForComplete(completeSpy));
+
+    bool rejected = false;
+    for (int i = 0; i < errorSpy.count(); i++)
+    {
+        rejected |= errorSpy.at(i).at(0).toString().contains("Bootloader rejected firmware data");
+    }
+    QVERIFY(rejected);
+    QVERIFY(!stats.crcRequested);
+    QVERIFY(!stats.rebooted);
+}
+
+void PX4FirmwareUploaderTest::programming_benchmark_data()
+{
+    QTest::addColumn<int>("packetsInFlight");
+    QTest::addColumn<int>("latency");
+
+    // 0 keeps the uploader's default
+    QTest::newRow("one in flight, 2 ms") << 1 << 2;
+    QTest::newRow("default, 2 ms") << 0 << 2;
+    QTest::newRow("one in flight, 10 ms") << 1 << 10;
+    QTest::newRow("default, 10 ms") << 0 << 10;
+}
+
+void PX4FirmwareUploaderTest::programming_benchmark()
+{
+    QFETCH(int, packetsInFlight);
+    QFETCH(int, latency);
+
+    QTemporaryFile px4;
+    QVERIFY(writePx4File(px4, testImage()));
+
+    MockBootloader::Stats stats;
+    QBENCHMARK_ONCE
+    {
+        PX4FirmwareUploader uploader;
+        if (packetsInFlight > 0)
+        {
+            uploader.setMaxPacketsInFlight(packetsInFlight);
+        }
+        QSignalSpy completeSpy(&uploader, SIGNAL(complete()));
+        uploader.loadFile(px4.fileName());
+
+        MockBootloader *bootloader = new MockBootloader(&stats, 4, FLASH_SIZE);
+        bootloader->setReplyLatency(latency);
+        uploader.startOnDevice(bootloader);
+        QVERIFY(waitForComplete(completeSpy));
+    }
+    QVERIFY(stats.rebooted);
+
+    // Only the programming phase, the erase is polled and would swamp it
+    qDebug("%s: %d bytes in %d packets, %lld ms, %.1f KB/s", QTest::currentDataTag(),
+           stats.programBytes, stats.programPackets, stats.programMsecs,
+           stats.programBytes / static_cast<double>(qMax<qint64>(stats.programMsecs, 1)));
+}
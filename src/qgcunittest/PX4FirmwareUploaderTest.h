@@ -0,0 +1,31 @@
+#ifndef PX4FIRMWAREUPLOADERTEST_H
+#define PX4FIRMWAREUPLOADERTEST_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+#include <QTemporaryFile>
+
+#include "AutoTest.h"
+
+class PX4FirmwareUploaderTest : public QObject
+{
+    Q_OBJECT
+public:
+    PX4FirmwareUploaderTest();
+
+private slots:
+    void upload_test_data();
+    void upload_test();
+    void rejectedPacket_test();
+    void programming_benchmark_data();
+    void programming_benchmark();
+
+private:
+    /** @brief Pack image into a .px4 file the way the firmware build does */
+    static bool writePx4File(QTemporaryFile &file, const QByteArray &image);
+    static QByteArray testImage();
+    static bool waitForComplete(QSignalSpy &completeSpy);
+};
+
+DECLARE_TEST(PX4FirmwareUploaderTest)
+#endif // PX4FIRMWAREUPLOADERTEST_H
@@ -0,0 +1,98 @@
+#include "RollingStatisticsTest.h"
+#include <qnumeric.h>
+#include <algorithm>
+#include <limits>
+
+RollingStatisticsTest::RollingStatisticsTest()
+{
+}
+
+void RollingStatisticsTest::verify(const RollingStatistics &stats, const QVector<double> &samples)
+{
+    int count = qMin(stats.getWindowSize(), samples.size());
+    QVector<double> window = samples.mid(samples.size() - count);
+    QCOMPARE(stats.count(), count);
+
+    double mean = 0.0;
+    foreach (double value, window)
+    {
+        mean += value;
+    }
+    mean /= count;
+    double variance = 0.0;
+    foreach (double value, window)
+    {
+        variance += (value - mean) * (value - mean);
+    }
+    variance /= count;
+
+    std::sort(window.begin(), window.end());
+    double median = count % 2 ? window.at(count / 2) : (window.at(count / 2 - 1) + window.at(count / 2)) / 2.0;
+
+    QVERIFY(qAbs(stats.mean() - mean) < 1e-9);
+    QVERIFY(qAbs(stats.variance() - variance) < 1e-6);
+    QCOMPARE(stats.median(), median);
+    QCOMPARE(stats.min(), window.first());
+    QCOMPARE(stats.max(), window.last());
+}
+
+void RollingStatisticsTest::slidingWindow_test()
+{
+    qsrand(1);
+    RollingStatistics stats(50);
+    QVector<double> samples;
+    for (int i = 0; i < 500; i++)
+    {
+        double value = (qrand() % 2000) / 10.0 - 100.0;
+        samples.append(value);
+        stats.append(value);
+        verify(stats, samples);
+    }
+}
+
+void RollingStatisticsTest::nonFinite_test()
+{
+    RollingStatistics stats(4);
+    QVector<double> samples;
+    samples << 1.0 << 2.0 << 3.0;
+    foreach (double value, samples)
+    {
+        stats.append(value);
+    }
+    stats.append(std::numeric_limits<double>::quiet_NaN());
+    stats.append(std::numeric_limits<double>::infinity());
+    stats.append(-std::numeric_limits<double>::infinity());
+
+    // The window is untouched and the skipped samples are counted
+    QCOMPARE(stats.nonFiniteCount(), 3);
+    verify(stats, samples);
+    QVERIFY(!qIsNaN(stats.mean()));
+
+    // Samples after the NaN still slide through the window cleanly
+    for (int i = 0; i < 10; i++)
+    {
+        samples.append(i * 0.5);
+        stats.append(i * 0.5);
+        verify(stats, samples);
+    }
+
+    stats.clear();
+    QCOMPARE(stats.nonFiniteCount(), 0);
+    QCOMPARE(stats.count(), 0);
+}
+
+void RollingStatisticsTest::shrinkWindow_test()
+{
+    RollingStatistics stats(20);
+    QVector<double> samples;
+    for (int i = 0; i < 30; i++)
+    {
+        samples.append((i * 7) % 11);
+        stats.append(samples.last());
+    }
+    stats.setWindowSize(5);
+    verify(stats, samples);
+    samples.append(42.0);
+    stats.append(42.0);
+    verify(stats, samples);
+}
@@ -0,0 +1,27 @@
+#ifndef ROLLINGSTATISTICSTEST_H
+#define ROLLINGSTATISTICSTEST_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+#include "AutoTest.h"
+#include "RollingStatistics.h"
+
+class RollingStatisticsTest : public QObject
+{
+    Q_OBJECT
+public:
+    RollingStatisticsTest();
+
+private slots:
+    void slidingWindow_test();
+    void nonFinite_test();
+    void shrinkWindow_test();
+
+private:
+    /** @brief Compare stats with a brute force pass over the last samples */
+    static void verify(const RollingStatistics &stats, const QVector<double> &samples);
+};
+
+DECLARE_TEST(RollingStatisticsTest)
+#endif // ROLLINGSTATISTICSTEST_H
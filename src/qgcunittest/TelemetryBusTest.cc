@@ -0,0 +1,148 @@
+#include "TelemetryBusTest.h"
+#include <QThread>
+
+// The bus is a singleton shared by all tests, every test uses its own channel names
+
+/** @brief Publishes samples whose fields all hold the same counter */
+class PublishThread : public QThread
+{
+public:
+    PublishThread(int channel, int count) : m_channel(channel), m_count(count) {}
+
+protected:
+    void run()
+    {
+        TelemetryBus *bus = TelemetryBus::instance();
+        for (int i = 1; i <= m_count; i++)
+        {
+            bus->publish(m_channel, i, i, i);
+        }
+    }
+
+private:
+    int m_channel;
+    int m_count;
+};
+
+TelemetryBusTest::TelemetryBusTest()
+{
+}
+
+void TelemetryBusTest::roundTrip_test()
+{
+    TelemetryBus *bus = TelemetryBus::instance();
+    int channel = bus->channel("roundTrip.altitude", "m");
+    QVERIFY(channel >= 0);
+    QCOMPARE(bus->channel("roundTrip.altitude", "m"), channel);
+    QCOMPARE(bus->channelName(channel), QString("roundTrip.altitude"));
+    QCOMPARE(bus->channelUnit(channel), QString("m"));
+    QVERIFY(bus->channelCount() > channel);
+
+    TelemetryBus::Sample sample;
+    QVERIFY(!bus->latest(channel, &sample));
+    QCOMPARE(bus->sequence(channel), 0);
+
+    bus->publish(channel, 7, 12.5, 1000);
+    QVERIFY(bus->latest(channel, &sample));
+    QCOMPARE(sample.uasId, 7);
+    QCOMPARE(sample.value, 12.5);
+    QCOMPARE(sample.msec, quint64(1000));
+    QVERIFY(sample.sequence != 0);
+    QCOMPARE(sample.sequence % 2, 0);
+    QCOMPARE(bus->sequence(channel), sample.sequence);
+
+    // Every publish moves the sequence on, even with the same value
+    int first = sample.sequence;
+    bus->publish(channel, 7, 12.5, 1000);
+    QVERIFY(bus->latest(channel, &sample));
+    QVERIFY(sample.sequence != first);
+
+    bus->publish(channel, 8, -3.25, 2000);
+    QVERIFY(bus->latest(channel, &sample));
+    QCOMPARE(sample.uasId, 8);
+    QCOMPARE(sample.value, -3.25);
+    QCOMPARE(sample.msec, quint64(2000));
+
+    // Out of range channels are ignored
+    bus->publish(-1, 1, 1.0, 1);
+    bus->publish(TelemetryBus::MaxChannels, 1, 1.0, 1);
+    QVERIFY(!bus->latest(-1, &sample));
+    QVERIFY(!bus->latest(TelemetryBus::MaxChannels, &sample));
+}
+
+void TelemetryBusTest::concurrentPublish_test()
+{
+    TelemetryBus *bus = TelemetryBus::instance();
+    int channel = bus->channel("concurrentPublish.value", "");
+    QVERIFY(channel >= 0);
+
+    // Two writers race on one slot while this thread reads it. A torn read
+    // would mix the fields of two samples.
+    const int count = 200000;
+    PublishThread first(channel, count);
+    PublishThread second(channel, count);
+    first.start();
+    second.start();
+
+    int reads = 0;
+    int torn = 0;
+    int lastSequence = 0;
+    while (!first.isFinished() || !second.isFinished())
+    {
+        TelemetryBus::Sample sample;
+        if (bus->latest(channel, &sample) && sample.sequence != lastSequence)
+        {
+            if (sample.value != sample.uasId || sample.msec != static_cast<quint64>(sample.uasId) || sample.sequence % 2)
+            {
+                torn++;
+            }
+            reads++;
+            lastSequence = sample.sequence;
+        }
+    }
+    QVERIFY(first.wait());
+    QVERIFY(second.wait());
+    QCOMPARE(torn, 0);
+
+    // Every publish was counted, so the slot ends two steps per publish on
+    TelemetryBus::Sample sample;
+    QVERIFY(bus->latest(channel, &sample));
+    QCOMPARE(sample.sequence, 2 * 2 * count);
+    QCOMPARE(sample.value, static_cast<double>(count));
+    QVERIFY(reads > 0);
+}
+
+void TelemetryBusTest::subscriber_test()
+{
+    TelemetryBus *bus = TelemetryBus::instance();
+    int watched = bus->channel("subscriber.watched", "");
+    int other = bus->channel("subscriber.other", "");
+
+    TelemetrySubscriber subscriber(10);
+    QSignalSpy updatedSpy(&subscriber, SIGNAL(updated()));
+    subscriber.watch(watched);
+    QVERIFY(subscriber.isWatching(watched));
+    QVERIFY(!subscriber.isWatching(other));
+
+    // Nothing published yet, and channels that are not watched do not count
+    bus->publish(other, 1, 1.0, 1);
+    QTest::qWait(50);
+    QCOMPARE(updatedSpy.count(), 0);
+
+    // Many publishes between two ticks are coalesced into one update
+    subscriber.stop();
+    for (int i = 0; i < 100; i++)
+    {
+        bus->publish(watched, 1, i, i);
+    }
+    subscriber.start();
+    QVERIFY(updatedSpy.wait(1000));
+    QCOMPARE(subscriber.changedChannels(), QList<int>() << watched);
+    QTest::qWait(50);
+    QCOMPARE(updatedSpy.count(), 1);
+
+    subscriber.unwatch(watched);
+    bus->publish(watched, 1, 1.0, 1);
+    QTest::qWait(50);
+    QCOMPARE(updatedSpy.count(), 1);
+}
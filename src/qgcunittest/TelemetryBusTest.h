@@ -0,0 +1,23 @@
+#ifndef TELEMETRYBUSTEST_H
+#define TELEMETRYBUSTEST_H
+
+#include <QObject>
+#include <QtTest/QtTest>
+
+#include "AutoTest.h"
+#include "TelemetryBus.h"
+
+class TelemetryBusTest : public QObject
+{
+    Q_OBJECT
+public:
+    TelemetryBusTest();
+
+private slots:
+    void roundTrip_test();
+    void concurrentPublish_test();
+    void subscriber_test();
+};
+
+DECLARE_TEST(TelemetryBusTest)
+#endif // TELEMETRYBUSTEST_H
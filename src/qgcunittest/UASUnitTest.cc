@@ -407,3 +407,124 @@ void UASUnitTest::signalIdUASLink_test()
 
     QCOMPARE(LinkManager::instance()->getLinks().count(), 0);
 }
+
+void UASUnitTest::vehicleBytesReceived(const QByteArray& bytes)
+{
+    // A channel none of the links in this test parses on
+    const mavlink_channel_t channel = static_cast<mavlink_channel_t>(MAVLINK_COMM_NUM_BUFFERS - 1);
+    for (int i = 0; i < bytes.size(); i++)
+    {
+        if (!mavlink_parse_char(channel, static_cast<uint8_t>(bytes.at(i)), &vehicleMessage, &vehicleStatus))
+        {
+            continue;
+        }
+        VehicleReply reply;
+        reply.due = vehicleClock.elapsed() + vehicleLatency;
+        switch (vehicleMessage.msgid)
+        {
+        case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+            mavlink_msg_mission_count_pack(UASID, MAV_COMP_ID_MISSIONPLANNER, &reply.message,
+                                           vehicleMessage.sysid, vehicleMessage.compid, vehicleMissionCount);
+            vehicleReplies.append(reply);
+            break;
+        case MAVLINK_MSG_ID_MISSION_REQUEST:
+        {
+            mavlink_mission_request_t request;
+            mavlink_msg_mission_request_decode(&vehicleMessage, &request);
+            mavlink_msg_mission_item_pack(UASID, MAV_COMP_ID_MISSIONPLANNER, &reply.message,
+                                          vehicleMessage.sysid, vehicleMessage.compid, request.seq,
+                                          MAV_FRAME_GLOBAL_RELATIVE_ALT, MAV_CMD_NAV_WAYPOINT, 0, 1,
+                                          0, 0, 0, 0, 47.0f + request.seq * 0.001f, 8.0f, 50.0f);
+            vehicleReplies.append(reply);
+            break;
+        }
+        case MAVLINK_MSG_ID_MISSION_ACK:
+            vehicleAcked = true;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void UASUnitTest::deliverVehicleReplies(LinkInterface* link)
+{
+    while (!vehicleReplies.isEmpty() && vehicleReplies.first().due <= vehicleClock.elapsed())
+    {
+        uas->receiveMessage(link, vehicleReplies.takeFirst().message);
+    }
+}
+
+void UASUnitTest::autopilotVersion_test()
+{
+    MockLink link;
+    QSignalSpy spy(uas, SIGNAL(autopilotVersionChanged(int)));
+    mavlink_autopilot_version_t version;
+
+    // Command acks, such as the ack of the version request itself, must not
+    // be taken for a version
+    mavlink_message_t ack;
+    mavlink_msg_command_ack_pack(UASID, MAV_COMP_ID_ALL, &ack, MAV_CMD_COMPONENT_ARM_DISARM, MAV_RESULT_ACCEPTED);
+    uas->receiveMessage(&link, ack);
+    QVERIFY(!uas->getAutopilotVersion(version));
+    QCOMPARE(spy.count(), 0);
+
+    const uint8_t custom[8] = {0};
+    mavlink_message_t message;
+    mavlink_msg_autopilot_version_pack(UASID, MAV_COMP_ID_ALL, &message, 0, 0x03020100, 0, 0, 0x00000009,
+                                       custom, custom, custom, 0, 0, 0x1122334455667788ULL);
+    uas->receiveMessage(&link, message);
+    QVERIFY(uas->getAutopilotVersion(version));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(version.uid, 0x1122334455667788ULL);
+    QCOMPARE(version.board_version, 9u);
+
+    // A later ack leaves the known version alone
+    uas->receiveMessage(&link, ack);
+    QVERIFY(uas->getAutopilotVersion(version));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(version.uid, 0x1122334455667788ULL);
+}
+
+void UASUnitTest::waypointReadLatency_benchmark_data()
+{
+    QTest::addColumn<int>("autopilot");
+    QTest::newRow("ArduPilot") << static_cast<int>(MAV_AUTOPILOT_ARDUPILOTMEGA);
+    QTest::newRow("Generic") << static_cast<int>(MAV_AUTOPILOT_GENERIC);
+}
+
+void UASUnitTest::waypointReadLatency_benchmark()
+{
+    QFETCH(int, autopilot);
+
+    // A 50 waypoint mission over a link with 20 ms one way latency
+    vehicleLatency = 20;
+    vehicleMissionCount = 50;
+    memset(&vehicleStatus, 0, sizeof(vehicleStatus));
+    vehicleReplies.clear();
+    vehicleClock.start();
+
+    MockLink* link = new MockLink();
+    uas->addLink(link);
+    uas->setAutopilotType(autopilot);
+    connect(link, SIGNAL(bytesSent(QByteArray)), this, SLOT(vehicleBytesReceived(QByteArray)));
+    UASWaypointManager* manager = uas->getWaypointManager();
+
+    QBENCHMARK
+    {
+        vehicleAcked = false;
+        manager->readWaypoints(true);
+        QElapsedTimer timeout;
+        timeout.start();
+        while (!vehicleAcked && timeout.elapsed() < 30000)
+        {
+            deliverVehicleReplies(link);
+            QTest::qWait(1);
+        }
+        QVERIFY(vehicleAcked);
+    }
+    QCOMPARE(manager->getWaypointEditableList().count(), vehicleMissionCount);
+    QCOMPARE(manager->getWaypointViewOnlyList().count(), vehicleMissionCount);
+
+    delete link;
+}
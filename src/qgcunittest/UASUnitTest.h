@@ -15,6 +15,8 @@
 #include "UASWaypointManager.h"
 #include "SerialLink.h"
 #include "LinkInterface.h"
+#include "MockLink.h"
+#include <QElapsedTimer>
 
 class UASUnitTest : public QObject
 {
@@ -55,6 +57,30 @@ private slots:
   void getWaypoint_test();
   void signalUASLink_test();
   void signalIdUASLink_test();
+  void autopilotVersion_test();
+  void waypointReadLatency_benchmark_data();
+  void waypointReadLatency_benchmark();
+
+protected slots:
+  /** @brief Vehicle side of the mission protocol, queues the answers with the simulated latency */
+  void vehicleBytesReceived(const QByteArray& bytes);
+
+private:
+  /** @brief Hand the queued vehicle answers that are due to the UAS */
+  void deliverVehicleReplies(LinkInterface* link);
+
+  struct VehicleReply
+  {
+      qint64 due;
+      mavlink_message_t message;
+  };
+  QList<VehicleReply> vehicleReplies;
+  QElapsedTimer vehicleClock;
+  int vehicleLatency;
+  int vehicleMissionCount;
+  bool vehicleAcked;
+  mavlink_status_t vehicleStatus;
+  mavlink_message_t vehicleMessage;
 };
 
 DECLARE_TEST(UASUnitTest)
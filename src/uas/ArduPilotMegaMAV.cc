@@ -46,7 +46,6 @@ This file is part of the QGROUNDCONTROL project
 #include <QDir>
 #include <QDesktopServices>
 #include <QSettings>
-#include <QSqlRecord>
 
 CustomMode::CustomMode()
 {
@@ -699,7 +698,7 @@ quint8 ErrorType::getErrorCode()
     return ErrorCode;
 }
 
-bool ErrorType::setFromSqlRecord(const QSqlRecord &record)
+bool ErrorType::setFromVariantMap(const QVariantMap &record)
 {
     bool returnCode = true;
 
@@ -34,7 +34,7 @@ This file is part of the QGROUNDCONTROL project
 
 #include "UAS.h"
 #include <QString>
-#include <QSqlDatabase>
+#include <QVariantMap>
 
 //
 // Auto Pilot modes
@@ -213,15 +213,15 @@ public:
     quint8 getErrorCode();
 
     /**
-     * @brief Reads an QSqlRecord and sets the internal data.
-     *        The record should contain the colums "TimeUS",
+     * @brief Reads a log record and sets the internal data.
+     *        The record should contain the fields "TimeUS",
      *        "Subsys" and "ECode" in order to get an apropriate
      *        returnvalue.
-     * @param record[in] - Filled QSqlRecord
+     * @param record[in] - Field names mapped to their values
      * @return true - all Fields could be read
      *         false - not all data could be read
      */
-    bool setFromSqlRecord(const QSqlRecord &record);
+    bool setFromVariantMap(const QVariantMap &record);
 
     /**
      * @brief Converts the ErrorCode into an uninterpreted string.
@@ -36,6 +36,8 @@ This file is part of the APM_PLANNER project
 
 static const uint32_t LOG_PACKET_SIZE = 90;
 static const int LOG_RETRY_TIMER = 700; //msecs
+static const int LOG_PROGRESS_TIMER = 250; //msecs
+static const uint LOG_WINDOW_BLOCKS = 1024; // blocks per LOG_REQUEST_DATA
 
 LogDownloadDescriptor::LogDownloadDescriptor(uint logID, uint time_utc,
                                              uint logSize)
@@ -73,13 +75,21 @@ LogDownloadDialog::LogDownloadDialog(QWidget *parent) :
     QDialog(parent),
     ui(new Ui::LogDownloadDialog),
     m_uas(NULL),
-    m_downloadSet(NULL),
+    m_downloadBlockCount(0),
+    m_downloadReceivedCount(0),
+    m_downloadMissingCursor(0),
+    m_downloadRequestEnd(0),
+    m_downloadHighWater(0),
+    m_downloadDuplicateCount(0),
+    m_downloadWindow(LOG_WINDOW_BLOCKS),
     m_downloadFile(NULL),
+    m_downloadMap(NULL),
+    m_downloadMapSize(0),
     m_downloadID(0),
     m_downloadLastTimestamp(0),
-    m_downloadOffset(0),
-    m_lastDownloadOffset(0),
-    m_downloadMaxSize(100)
+    m_downloadMaxSize(100),
+    m_downloadCount(0),
+    m_downloadCountMax(0)
 {
     ui->setupUi(this); 
 
@@ -97,6 +107,8 @@ LogDownloadDialog::LogDownloadDialog(QWidget *parent) :
 
     // configure retransimission timer.
     connect(&m_timer, SIGNAL(timeout()), this, SLOT(processDownloadedLogData()));
+    // Progress is shown at a fixed rate instead of on every packet
+    connect(&m_progressTimer, SIGNAL(timeout()), this, SLOT(updateProgress()));
 
     QStringList headerList;
     headerList << tr("ID") << tr("Time") << tr("Size") << tr("Download?");
@@ -112,22 +124,41 @@ LogDownloadDialog::LogDownloadDialog(QWidget *parent) :
 
 void LogDownloadDialog::resetDownload()
 {
-    if (m_downloadSet){
-        delete m_downloadSet;
-        m_downloadSet = NULL;
-    }
+    m_timer.stop();
+    m_progressTimer.stop();
 
     if (m_downloadFile){
+        if (m_downloadMap){
+            m_downloadFile->unmap(m_downloadMap);
+        }
         m_downloadFile->close();
         m_downloadFile->deleteLater();
         m_downloadFile = NULL;
     }
-
+    m_downloadMap = NULL;
+    m_downloadMapSize = 0;
+
+    m_downloadBlocks.clear();
+    m_downloadBlockCount = 0;
+    m_downloadReceivedCount = 0;
+    m_downloadMissingCursor = 0;
+    m_downloadRequestEnd = 0;
+    m_downloadHighWater = 0;
+    m_downloadDuplicateCount = 0;
     m_downloadID = 0;
     m_downloadFilename.clear();
     m_downloadStart = QTime();
     m_downloadLastTimestamp = 0;
-    m_downloadOffset = 0;
+}
+
+void LogDownloadDialog::setDownloadWindow(uint blocks)
+{
+    m_downloadWindow = qMax(1u, blocks);
+}
+
+uint LogDownloadDialog::downloadWindow() const
+{
+    return m_downloadWindow;
 }
 
 void LogDownloadDialog::cancelButtonClicked()
@@ -147,6 +178,7 @@ void LogDownloadDialog::doneButtonClicked()
 LogDownloadDialog::~LogDownloadDialog()
 {
     removeConnections(m_uas);
+    resetDownload();
     delete ui;
 }
 
@@ -277,20 +309,88 @@ void LogDownloadDialog::issueDownloadRequest()
             }
         }
     }
-    if(m_downloadFile && m_downloadFile->open(QIODevice::WriteOnly)){
+    if(m_downloadFile && m_downloadFile->open(QIODevice::ReadWrite | QIODevice::Truncate)){
         QLOG_INFO() << "Log file ready for writing:" << m_downloadFilename << " size:" << m_downloadMaxSize;
-        Q_ASSERT(m_downloadOffset == 0);
-        m_lastDownloadOffset = 0;
-        m_uas->logRequestData(m_downloadID, m_downloadOffset, LOG_PACKET_SIZE);
-        updateProgress();
+        // Map the whole log so blocks can be copied into place in any order,
+        // plain seek and write is used if the mapping is not available
+        if (m_downloadMaxSize > 0 && m_downloadFile->resize(m_downloadMaxSize)){
+            m_downloadMap = m_downloadFile->map(0, m_downloadMaxSize);
+            m_downloadMapSize = m_downloadMap ? m_downloadMaxSize : 0;
+        }
+        m_downloadBlockCount = (m_downloadMaxSize + LOG_PACKET_SIZE - 1) / LOG_PACKET_SIZE;
+        m_downloadBlocks.fill(false, m_downloadBlockCount);
         m_downloadStart.start();
+        if (m_downloadBlockCount == 0){
+            finishDownload();
+            return;
+        }
+        requestNextBlocks();
+        updateProgress();
         m_timer.start(LOG_RETRY_TIMER);
-        m_downloadSet = new QSet<uint>();
+        m_progressTimer.start(LOG_PROGRESS_TIMER);
     } else {
         QLOG_ERROR() << "failed to open file to save log:" << m_downloadFilename;
     }
 }
 
+void LogDownloadDialog::requestNextBlocks()
+{
+    // Skip the blocks that have all been received
+    while (m_downloadMissingCursor < m_downloadBlockCount
+           && m_downloadBlocks.testBit(m_downloadMissingCursor)){
+        ++m_downloadMissingCursor;
+    }
+    if (m_downloadMissingCursor >= m_downloadBlockCount)
+        return;
+
+    // A new LOG_REQUEST_DATA replaces the one the vehicle is serving, so only
+    // one range is asked for at a time. Holes behind the high-water mark go
+    // first, one contiguous missing run per request so that no received
+    // block is sent twice, then new data continues from the high-water mark.
+    uint start;
+    uint end;
+    if (m_downloadMissingCursor < m_downloadHighWater){
+        start = m_downloadMissingCursor;
+        end = start + 1;
+        uint limit = qMin(start + m_downloadWindow, m_downloadHighWater);
+        while (end < limit && !m_downloadBlocks.testBit(end)){
+            ++end;
+        }
+    } else {
+        start = m_downloadHighWater;
+        end = qMin(start + m_downloadWindow, m_downloadBlockCount);
+        m_downloadHighWater = end;
+    }
+    m_downloadRequestEnd = end;
+    m_downloadLastTimestamp = m_downloadStart.elapsed();
+    m_uas->logRequestData(m_downloadID, start * LOG_PACKET_SIZE, (end - start) * LOG_PACKET_SIZE);
+}
+
+bool LogDownloadDialog::writeLogData(uint32_t ofs, const char *data, uint8_t count)
+{
+    if (m_downloadMap && (ofs + count) <= m_downloadMapSize){
+        memcpy(m_downloadMap + ofs, data, count);
+        return true;
+    }
+    // Outside of the mapped region, QFile buffers sequential writes
+    if (m_downloadFile->pos() != static_cast<qint64>(ofs) && !m_downloadFile->seek(ofs))
+        return false;
+    return m_downloadFile->write(data, count) == count;
+}
+
+void LogDownloadDialog::setDownloadSize(uint size)
+{
+    uint blockCount = (size + LOG_PACKET_SIZE - 1) / LOG_PACKET_SIZE;
+    for (uint block = blockCount; block < m_downloadBlockCount; ++block){
+        if (m_downloadBlocks.testBit(block))
+            --m_downloadReceivedCount;
+    }
+    m_downloadBlocks.resize(blockCount);
+    m_downloadBlockCount = blockCount;
+    m_downloadHighWater = qMin(m_downloadHighWater, blockCount);
+    m_downloadRequestEnd = qMin(m_downloadRequestEnd, blockCount);
+    m_downloadMaxSize = size;
+}
 
 void LogDownloadDialog::logEntry(int uasId, uint32_t time_utc, uint32_t size, uint16_t id,
                                  uint16_t num_logs, uint16_t last_log_num)
@@ -335,20 +435,15 @@ void LogDownloadDialog::logEntry(int uasId, uint32_t time_utc, uint32_t size, ui
 void LogDownloadDialog::logData(uint32_t uasId, uint32_t ofs, uint16_t id,
                                      uint8_t count, const char *data)
 {
-    Q_UNUSED(id);
 //#define SIMULATE_PACKET_LOSS
 #ifdef SIMULATE_PACKET_LOSS
     QLOG_DEBUG() << "logData ofs:" << ofs << " id:" << id << " count:" << count
                  /*<< " data:" << data*/;
 #endif
-    if (m_uas == NULL || m_downloadSet == NULL)
-        return;
-    if (m_uas->getUASID() != static_cast<int>(uasId))
+    if (m_uas == NULL || m_downloadFile == NULL)
         return;
-    if(m_downloadFile == NULL){
-        QLOG_ERROR() << "No file open to save log info";
+    if (m_uas->getUASID() != static_cast<int>(uasId) || id != m_downloadID)
         return;
-    }
 #ifdef SIMULATE_PACKET_LOSS
     //Simulate packet loss for testing in debug mode
     if ((rand() % 100) < 20){
@@ -356,127 +451,94 @@ void LogDownloadDialog::logData(uint32_t uasId, uint32_t ofs, uint16_t id,
         return;
     }
 #endif
-    if (ofs != m_downloadOffset){
-        QLOG_DEBUG() << "seek to " << ofs;
-        m_downloadFile->seek(ofs);
-        m_downloadOffset = ofs;
-        updateProgress();
-    }
-    if (count != 0){
-        int bytesWritten = m_downloadFile->write(data, count);
-        if ((bytesWritten == -1)||(bytesWritten != count)){
-            QLOG_ERROR() << "Log File write bytesWritten:" << bytesWritten << "out of: count=" << count;
-//            QMessageBox::critical(this,tr("Corrupt File")
-//                                  ,tr("Error saving %1.\n file save is corupt."),QMessageBox::Ok);
-            // [TODO] Abort.
-        }
-        m_downloadFile->flush();
-        m_downloadSet->insert(static_cast<uint>(floor(ofs / LOG_PACKET_SIZE)));
-        m_downloadOffset += count;
-        updateProgress();
+    m_downloadLastTimestamp = m_downloadStart.elapsed();
+
+    if (count < LOG_PACKET_SIZE && (ofs + count) < m_downloadMaxSize){
+        // A short or empty packet marks the end of the log
+        setDownloadSize(ofs + count);
     }
-    m_downloadLastTimestamp = QDateTime::currentDateTime().toMSecsSinceEpoch();
-    if ( count==0 || (count<LOG_PACKET_SIZE
-                      && (static_cast<uint>(m_downloadSet->count()) == 1+(static_cast<uint>( floor(ofs / LOG_PACKET_SIZE) ))))){
-        double dt = m_downloadStart.elapsed()/1000.0;
-        double speed = (static_cast<double>(m_downloadFile->size())/dt)/1000.0;
-        QLOG_INFO() << "Finished downloading "<< m_downloadFilename
-                    << "(" << dt << " seconds, "<< speed <<"kbyte/sec)";
-        m_downloadFile->flush();
-        m_timer.stop();
-        updateProgress();
-        m_uas->logRequestEnd();
-        QCoreApplication::processEvents();
-
-        if (m_downloadFile->size() == 0) {
-            // If the file size is zero, retry
-            QLOG_DEBUG() << "File Size is zero, retry";
-            m_downloadOffset = 0;
-            m_lastDownloadOffset = 0;
-            delete m_downloadSet;
-            m_downloadSet = new QSet<uint>();
-            m_timer.start(LOG_RETRY_TIMER);
-            m_downloadStart.start();
-            m_downloadFile->close();
-            delete m_downloadFile;
-            m_downloadFile = NULL;
-            issueDownloadRequest();
-            return;
-        }
-        m_downloadFile->close();
-        QCoreApplication::processEvents();
-        ui->progressBar->setValue(m_downloadMaxSize);
-        if (!(m_downloadCount == m_downloadCountMax)){
-            m_downloadCount++;
-            startNextDownloadRequest();
+
+    uint block = ofs / LOG_PACKET_SIZE;
+    if (count != 0 && block < m_downloadBlockCount){
+        if (m_downloadBlocks.testBit(block)){
+            ++m_downloadDuplicateCount;
         } else {
-            ui->statusLabel->setText("Finished");
-            QTimer::singleShot(500, ui->progressBar, SLOT(hide()));
-            QTimer::singleShot(500, ui->statusLabel, SLOT(hide()));
-            resetDownload();
+            if (!writeLogData(ofs, data, count)){
+                QLOG_ERROR() << "Log File write failed at ofs:" << ofs << "count=" << count;
+                // [TODO] Abort.
+            }
+            m_downloadBlocks.setBit(block);
+            ++m_downloadReceivedCount;
         }
     }
-    QCoreApplication::processEvents();
+
+    if (m_downloadReceivedCount >= m_downloadBlockCount){
+        finishDownload();
+    } else if (count == 0 || block + 1 == m_downloadRequestEnd){
+        // The outstanding request is drained, ask for the next blocks
+        // right away rather than waiting for the retry timer. Late blocks
+        // of a replaced request lie elsewhere and do not trigger this.
+        requestNextBlocks();
+    }
 }
 
-void LogDownloadDialog::processDownloadedLogData()
+void LogDownloadDialog::finishDownload()
 {
-    // Process incoming log data and trigger next request for more
-    if (m_downloadSet==NULL || m_downloadSet->size() == 0)
-        return;
-
-    uint highest = 0;
-
-    QSet<uint>::const_iterator iter;
-    iter = m_downloadSet->constBegin();
-    while (iter != m_downloadSet->constEnd()){
-        uint value = *iter;
-        if (value > highest)
-            highest = value;
-        ++iter;
+    double dt = m_downloadStart.elapsed()/1000.0;
+    double speed = (static_cast<double>(m_downloadMaxSize)/dt)/1000.0;
+    QLOG_INFO() << "Finished downloading "<< m_downloadFilename
+                << "(" << dt << " seconds, "<< speed <<"kbyte/sec,"
+                << m_downloadDuplicateCount << "duplicate blocks)";
+    m_timer.stop();
+    m_progressTimer.stop();
+    m_uas->logRequestEnd();
+
+    if (m_downloadMap){
+        m_downloadFile->unmap(m_downloadMap);
+        m_downloadMap = NULL;
+        m_downloadMapSize = 0;
     }
+    m_downloadFile->resize(m_downloadMaxSize);
+    m_downloadFile->close();
 
-    QList<uint> diff;
-    for( uint count = 0; count < highest; count++){
-        if(!m_downloadSet->contains(count))
-            diff.append(count);
+    ui->progressBar->setMaximum(m_downloadMaxSize);
+    ui->progressBar->setValue(m_downloadMaxSize);
+    resetDownload();
+    if (!(m_downloadCount == m_downloadCountMax)){
+        m_downloadCount++;
+        startNextDownloadRequest();
+    } else {
+        ui->statusLabel->setText("Finished");
+        QTimer::singleShot(500, ui->progressBar, SLOT(hide()));
+        QTimer::singleShot(500, ui->statusLabel, SLOT(hide()));
     }
-    QLOG_DEBUG() << "highest:"<< highest << "Diff size:" << diff.size();
-    if(diff.size() == 0){
-        m_uas->logRequestData(m_downloadID, (highest+1)*LOG_PACKET_SIZE, 0xFFFFFFFF);
-        m_timer.start(LOG_RETRY_TIMER);
+}
 
-    } else {
-        int num_requests = 0;
-        while (num_requests < 20){
-            uint start = diff.takeFirst();
-            uint end = start;
-            while(diff.contains(end+1)){
-                end+=1;
-                diff.removeAt(end);
-            }
-            ui->statusLabel->setText(tr("Retransmitting %1").arg(start));
-            m_uas->logRequestData(m_downloadID, (start*LOG_PACKET_SIZE), (end+1-start)*LOG_PACKET_SIZE);
-            num_requests +=1;
-            if(diff.size() == 0)
-                break;
-            QCoreApplication::processEvents();
-        }
+void LogDownloadDialog::processDownloadedLogData()
+{
+    // Re-request missing blocks once the link has gone quiet
+    if (m_downloadFile == NULL)
+        return;
+    if (m_downloadStart.elapsed() - m_downloadLastTimestamp < static_cast<uint>(LOG_RETRY_TIMER))
+        return;
+
+    QLOG_DEBUG() << "Download stalled, received:" << m_downloadReceivedCount
+                 << "of" << m_downloadBlockCount << "blocks";
+    if (m_downloadMissingCursor > 0){
+        ui->statusLabel->setText(tr("Retransmitting %1").arg(m_downloadMissingCursor));
     }
-    QCoreApplication::processEvents();
+    requestNextBlocks();
 }
 
 void LogDownloadDialog::updateProgress()
 {
-    if ( m_downloadOffset > m_lastDownloadOffset + 720){
-        m_lastDownloadOffset = m_downloadOffset;
-        QString status =  QString("Downloading %1/%2").arg(m_downloadCount).arg(m_downloadCountMax);
-        ui->statusLabel->setText(status);
-        ui->statusLabel->show();
-        ui->progressBar->setMaximum(m_downloadMaxSize);
-        ui->progressBar->setValue(m_downloadOffset);
-        ui->progressBar->show();
-    }
+    uint received = qMin(m_downloadReceivedCount * LOG_PACKET_SIZE, m_downloadMaxSize);
+    QString status =  QString("Downloading %1/%2").arg(m_downloadCount).arg(m_downloadCountMax);
+    ui->statusLabel->setText(status);
+    ui->statusLabel->show();
+    ui->progressBar->setMaximum(m_downloadMaxSize);
+    ui->progressBar->setValue(received);
+    ui->progressBar->show();
 }
 
 void LogDownloadDialog::checkAll()
@@ -25,6 +25,7 @@ This file is part of the APM_PLANNER project
 
 #include "UASInterface.h"
 #include <QDialog>
+#include <QBitArray>
 
 namespace Ui {
 class LogDownloadDialog;
@@ -55,6 +56,10 @@ public:
     explicit LogDownloadDialog(QWidget *parent = 0);
     ~LogDownloadDialog();
 
+    /** @brief Set the number of LOG_DATA blocks asked for in one request */
+    void setDownloadWindow(uint blocks);
+    uint downloadWindow() const;
+
 public slots:
     void setActiveUAS(UASInterface* uas);
 
@@ -72,14 +77,18 @@ private slots:
     void cancelButtonClicked();
     void triggerNextDownloadRequest();
     void eraseAllLogs();
+    void updateProgress();
 
 private:
     void removeConnections(UASInterface* uas);
     void makeConnections(UASInterface* uas);
     void startNextDownloadRequest();
     void issueDownloadRequest();
+    void requestNextBlocks();
+    bool writeLogData(uint32_t ofs, const char* data, uint8_t count);
+    void setDownloadSize(uint size);
+    void finishDownload();
 
-    void updateProgress();
     void resetDownload();
 
 private:
@@ -88,18 +97,26 @@ private:
     QList<LogDownloadDescriptor*> m_logEntriesList; // id & filename to save data to.
     QList<LogDownloadDescriptor*> m_fileSaveList; // id & filename to save data to.
 
-    QSet<uint> *m_downloadSet;
+    QBitArray m_downloadBlocks; // one bit per received LOG_PACKET_SIZE block
+    uint m_downloadBlockCount;
+    uint m_downloadReceivedCount;
+    uint m_downloadMissingCursor; // all blocks before this one have been received
+    uint m_downloadRequestEnd; // block after the last one of the outstanding request
+    uint m_downloadHighWater; // all blocks before this one have been requested at least once
+    uint m_downloadDuplicateCount; // blocks received more than once
+    uint m_downloadWindow;
     QFile* m_downloadFile;
+    uchar* m_downloadMap;
+    uint m_downloadMapSize;
     uint m_downloadID;
     QString m_downloadFilename;
     QTime m_downloadStart;
-    uint m_downloadLastTimestamp;
-    uint m_downloadOffset;
-    uint m_lastDownloadOffset;
+    uint m_downloadLastTimestamp; // msecs since m_downloadStart
     uint m_downloadMaxSize;
     int m_downloadCount;
     int m_downloadCountMax;
     QTimer m_timer;
+    QTimer m_progressTimer;
 };
 
 #endif // LOGDOWNLOADDIALOG_H
@@ -1,15 +1,28 @@
+#include "QsLog.h"
 #include "QGCUASParamManager.h"
 #include "UASInterface.h"
+#include "QGC.h"
+
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QDataStream>
+
+static const quint32 PARAM_CACHE_MAGIC = 0x50434831; // "PCH1"
 
 QGCUASParamManager::QGCUASParamManager(UASInterface* uas, QWidget *parent) :
     QWidget(parent),
     mav(uas),
     transmissionListMode(false),
     transmissionActive(false),
+    transmissionBurstPending(0),
+    transmissionReceivedCount(0),
+    transmissionRetransmitCount(0),
+    transmissionFirstLatency(-1),
     transmissionTimeout(0),
     retransmissionTimeout(350),
     rewriteTimeout(500),
-    retransmissionBurstRequestSize(5)
+    retransmissionBurstRequestSize(10)
 {
     uas->setParamManager(this);
 }
@@ -72,4 +85,80 @@ void QGCUASParamManager::requestParameterListUpdate(int component)
 	Q_UNUSED(component);
 }
 
+/**
+ * The cache is keyed by the hardware UID, board and firmware version from
+ * AUTOPILOT_VERSION, so two airframes with the same system id never share a
+ * cache, and a firmware update starts a new one. Without a UID there is
+ * nothing that tells airframes apart, so such a vehicle is not cached.
+ */
+QString QGCUASParamManager::parameterCacheFileName() const
+{
+    mavlink_autopilot_version_t version;
+    if (!mav->getAutopilotVersion(version) || version.uid == 0)
+    {
+        return QString();
+    }
+    return QString("%1/paramcache/%2_board%3_fw%4.cache").arg(QGC::appDataDirectory())
+            .arg(version.uid, 16, 16, QChar('0'))
+            .arg(version.board_version, 8, 16, QChar('0'))
+            .arg(version.flight_sw_version, 8, 16, QChar('0'));
+}
 
+bool QGCUASParamManager::loadParameterCache(QMap<int, QMap<QString, QVariant> >& cache, QMap<int, int>& counts) const
+{
+    QString fileName = parameterCacheFileName();
+    if (fileName.isEmpty())
+    {
+        return false;
+    }
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    in >> magic;
+    if (magic != PARAM_CACHE_MAGIC)
+    {
+        QLOG_WARN() << "Ignoring invalid parameter cache" << file.fileName();
+        return false;
+    }
+    in >> counts >> cache;
+    if (in.status() != QDataStream::Ok)
+    {
+        QLOG_WARN() << "Ignoring corrupt parameter cache" << file.fileName();
+        cache.clear();
+        counts.clear();
+        return false;
+    }
+    return !cache.isEmpty();
+}
+
+void QGCUASParamManager::saveParameterCache(const QMap<int, int>& counts) const
+{
+    QString fileName = parameterCacheFileName();
+    if (fileName.isEmpty())
+    {
+        return;
+    }
+
+    QMap<int, QMap<QString, QVariant> > cache;
+    QMap<int, QMap<QString, QVariant>* >::const_iterator i;
+    for (i = parameters.constBegin(); i != parameters.constEnd(); ++i)
+    {
+        cache.insert(i.key(), *i.value());
+    }
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        QLOG_WARN() << "Unable to write parameter cache" << fileName;
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << PARAM_CACHE_MAGIC << counts << cache;
+}
@@ -4,7 +4,9 @@
 #include <QWidget>
 #include <QMap>
 #include <QTimer>
+#include <QTime>
 #include <QVariant>
+#include <QBitArray>
 
 class UASInterface;
 
@@ -41,6 +43,13 @@ public:
     /** @brief Request an update for this specific parameter */
     virtual void requestParameterUpdate(int component, const QString& parameter) = 0;
 
+    /** @brief File holding the parameters of this vehicle from the last complete download, empty while the vehicle is not identified */
+    QString parameterCacheFileName() const;
+    /** @brief Read the cached parameters and list sizes of this vehicle, false if there is no cache */
+    bool loadParameterCache(QMap<int, QMap<QString, QVariant> >& cache, QMap<int, int>& counts) const;
+    /** @brief Store the current parameters of this vehicle for the next connection */
+    void saveParameterCache(const QMap<int, int>& counts) const;
+
 signals:
     void parameterChanged(int component, QString parameter, QVariant value);
     void parameterChanged(int component, int parameterIndex, QVariant value);
@@ -57,11 +66,17 @@ protected:
     QMap<int, QMap<QString, QVariant>* > changedValues; ///< Changed values
     QMap<int, QMap<QString, QVariant>* > parameters; ///< All parameters
     QVector<bool> received; ///< Successfully received parameters
-    QMap<int, QList<int>* > transmissionMissingPackets; ///< Missing packets
+    QMap<int, QBitArray> transmissionReceivedPackets; ///< Received parameter indices, one bit per parameter of the component
+    QMap<int, int> transmissionMissingCount; ///< Number of parameters still missing per component
+    QMap<int, int> transmissionRequestCursor; ///< Next parameter index checked for retransmission per component
     QMap<int, QMap<QString, QVariant>* > transmissionMissingWriteAckPackets; ///< Missing write ACK packets
     bool transmissionListMode;       ///< Currently requesting list
-    QMap<int, bool> transmissionListSizeKnown;  ///< List size initialized?
     bool transmissionActive;         ///< Missing packets, working on list?
+    int transmissionBurstPending;    ///< Retransmission requests of the last burst not answered yet
+    int transmissionReceivedCount;   ///< Parameters received in the current list transfer
+    int transmissionRetransmitCount; ///< Parameters re-requested in the current list transfer
+    int transmissionFirstLatency;    ///< Time until the first parameter arrived, in milliseconds, -1 before that
+    QTime transmissionStart;         ///< Start of the current list transfer
     quint64 transmissionTimeout;     ///< Timeout
     QTimer retransmissionTimer;      ///< Timer handling parameter retransmission
     int retransmissionTimeout; ///< Retransmission request timeout, in milliseconds
@@ -15,6 +15,7 @@
 #include "UASManager.h"
 #include "QGC.h"
 #include "GAudioOutput.h"
+#include "TelemetryBus.h"
 //#include "MAVLinkProtocol.h"
 #include "QGCMAVLink.h"
 #include "LinkManager.h"
@@ -24,6 +25,7 @@
 #include <QMessageBox>
 #include <QTimer>
 #include <QSettings>
+#include <QMetaMethod>
 #include <iostream>
 #include <QDesktopServices>
 
@@ -58,6 +60,7 @@ UAS::UAS(MAVLinkProtocol* protocol, int id) : UASInterface(),
     type(-1),
     airframe(-1),
     autopilot(-1),
+    autopilotVersionKnown(false),
     systemIsArmed(false),
     base_mode(-1),
     // custom_mode not initialized
@@ -162,6 +165,7 @@ UAS::UAS(MAVLinkProtocol* protocol, int id) : UASInterface(),
 {
     Q_UNUSED(protocol);
 
+    memset(&autopilotVersion, 0, sizeof(autopilotVersion));
     for (unsigned int i = 0; i<255;++i)
     {
         componentID[i] = -1;
@@ -426,9 +430,9 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
 			// so the Ground Time checkbox must be ticked for these values to display
             quint64 time = getUnixTime();
 			QString name = QString("M%1:HEARTBEAT.%2").arg(message.sysid);
-			emit valueChanged(uasId, name.arg("base_mode"), "bits", state.base_mode, time);
-			emit valueChanged(uasId, name.arg("custom_mode"), "bits", state.custom_mode, time);
-			emit valueChanged(uasId, name.arg("system_status"), "-", state.system_status, time);
+			publishValue(uasId, name.arg("base_mode"), "bits", state.base_mode, time);
+			publishValue(uasId, name.arg("custom_mode"), "bits", state.custom_mode, time);
+			publishValue(uasId, name.arg("system_status"), "-", state.system_status, time);
 			
             // Set new type if it has changed
             if (this->type != state.type)
@@ -516,17 +520,17 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             // Prepare for sending data to the realtime plotter, which is every field excluding onboard_control_sensors_present.
             quint64 time = getUnixTime();
             QString name = QString("M%1:GCS Status.%2").arg(message.sysid);
-            emit valueChanged(uasId, name.arg("Sensors Enabled"), "bits", state.onboard_control_sensors_enabled, time);
-            emit valueChanged(uasId, name.arg("Sensors Health"), "bits", state.onboard_control_sensors_health, time);
-            emit valueChanged(uasId, name.arg("Comms Errors"), "-", state.errors_comm, time);
-            emit valueChanged(uasId, name.arg("Errors Count 1"), "-", state.errors_count1, time);
-            emit valueChanged(uasId, name.arg("Errors Count 2"), "-", state.errors_count2, time);
-            emit valueChanged(uasId, name.arg("Errors Count 3"), "-", state.errors_count3, time);
-            emit valueChanged(uasId, name.arg("Errors Count 4"), "-", state.errors_count4, time);
+            publishValue(uasId, name.arg("Sensors Enabled"), "bits", state.onboard_control_sensors_enabled, time);
+            publishValue(uasId, name.arg("Sensors Health"), "bits", state.onboard_control_sensors_health, time);
+            publishValue(uasId, name.arg("Comms Errors"), "-", state.errors_comm, time);
+            publishValue(uasId, name.arg("Errors Count 1"), "-", state.errors_count1, time);
+            publishValue(uasId, name.arg("Errors Count 2"), "-", state.errors_count2, time);
+            publishValue(uasId, name.arg("Errors Count 3"), "-", state.errors_count3, time);
+            publishValue(uasId, name.arg("Errors Count 4"), "-", state.errors_count4, time);
 
 			// Process CPU load.
             emit loadChanged(this,state.load/10.0);
-            emit valueChanged(uasId, name.arg("CPU Load"), "%", state.load/10.0, time);
+            publishValue(uasId, name.arg("CPU Load"), "%", state.load/10.0, time);
 
 			// Battery charge/time remaining/voltage calculations
             currentVoltage = state.voltage_battery/1000.0;
@@ -564,14 +568,14 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             emit batteryChanged(this, lpVoltage, currentCurrent, getChargeLevel(), timeRemaining);
             // emit voltageChanged(message.sysid, currentVoltage);
 
-            emit valueChanged(uasId, name.arg("Battery"), "%", state.battery_remaining, time);
-            emit valueChanged(uasId, name.arg("Voltage"), "V", state.voltage_battery/1000.0, time);
+            publishValue(uasId, name.arg("Battery"), "%", state.battery_remaining, time);
+            publishValue(uasId, name.arg("Voltage"), "V", state.voltage_battery/1000.0, time);
 
 			// And if the battery current draw is measured, log that also.
 			if (state.current_battery != -1)
 			{
                 currentCurrent = ((double)state.current_battery)/100.0;
-                emit valueChanged(uasId, name.arg("Current"), "A", currentCurrent, time);
+                publishValue(uasId, name.arg("Current"), "A", currentCurrent, time);
 			}
 
             // LOW BATTERY ALARM
@@ -601,7 +605,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
 				state.drop_rate_comm = 10000;
 			}
             emit dropRateChanged(this->getUASID(), state.drop_rate_comm/100.0);
-            emit valueChanged(uasId, name.arg("Comms Drop Rate"), "%", state.drop_rate_comm/100.0, time);
+            publishValue(uasId, name.arg("Comms Drop Rate"), "%", state.drop_rate_comm/100.0, time);
 		}
             break;
         case MAVLINK_MSG_ID_ATTITUDE:
@@ -625,9 +629,9 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 emit attitudeRotationRatesChanged(uasId, attitude.rollspeed, attitude.pitchspeed, attitude.yawspeed, time);
 
                 QString name = QString("M%1:GCS Status.%2").arg(message.sysid);
-                emit valueChanged(uasId,name.arg("Roll"),"deg",QVariant(getRoll() * (180.0/M_PI)),time);
-                emit valueChanged(uasId,name.arg("Pitch"),"deg",QVariant(getPitch() * (180.0/M_PI)),time);
-                emit valueChanged(uasId,name.arg("Yaw"),"deg",QVariant(getYaw() * (180.0/M_PI)),time);
+                publishValue(uasId,name.arg("Roll"),"deg",QVariant(getRoll() * (180.0/M_PI)),time);
+                publishValue(uasId,name.arg("Pitch"),"deg",QVariant(getPitch() * (180.0/M_PI)),time);
+                publishValue(uasId,name.arg("Yaw"),"deg",QVariant(getYaw() * (180.0/M_PI)),time);
             }
         }
             break;
@@ -794,12 +798,12 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
 			
             //valueChanged(uasId, str.arg(vect.address+(i*2)), "ui16", mem1[i], time);
             QString name = QString("M%1:GCS Status.%2").arg(message.sysid);
-            emit valueChanged(uasId,name.arg("Latitude"),"deg",QVariant((double)pos.lat / (double(1E7))),time);
-            emit valueChanged(uasId,name.arg("Longitude"),"deg",QVariant((double)pos.lon / (double(1E7))),time);
-            emit valueChanged(uasId,name.arg("Altitude (GPS)"),"m",QVariant((double)pos.alt / 1000.0),time);
-            emit valueChanged(uasId,name.arg("Altitude (REL)"),"m",QVariant((double)pos.relative_alt / 1000.0),time);
-            emit valueChanged(uasId,name.arg("Heading (GPS)"),"degs",QVariant((double)pos.hdg),time);
-            emit valueChanged(uasId,name.arg("Climb"),"m/s",QVariant((double)pos.vz / 100.0),time);
+            publishValue(uasId,name.arg("Latitude"),"deg",QVariant((double)pos.lat / (double(1E7))),time);
+            publishValue(uasId,name.arg("Longitude"),"deg",QVariant((double)pos.lon / (double(1E7))),time);
+            publishValue(uasId,name.arg("Altitude (GPS)"),"m",QVariant((double)pos.alt / 1000.0),time);
+            publishValue(uasId,name.arg("Altitude (REL)"),"m",QVariant((double)pos.relative_alt / 1000.0),time);
+            publishValue(uasId,name.arg("Heading (GPS)"),"degs",QVariant((double)pos.hdg),time);
+            publishValue(uasId,name.arg("Climb"),"m/s",QVariant((double)pos.vz / 100.0),time);
 
             globalEstimatorActive = true;
 
@@ -875,7 +879,7 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                     {
                         setGroundSpeed(vel);
                         emit speedChanged(this, groundSpeed, airSpeed, time);
-                        emit valueChanged(uasId,name.arg("GPS Velocity"),"m/s",QVariant(vel),time);
+                        publishValue(uasId,name.arg("GPS Velocity"),"m/s",QVariant(vel),time);
                     }
                     else
                     {
@@ -884,10 +888,10 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 }
             }
 
-            emit valueChanged(uasId,name.arg("GPS Fix"),"",pos.fix_type,time);
-            emit valueChanged(uasId,name.arg("GPS Sats"),"",pos.satellites_visible,time);
-            emit valueChanged(uasId,name.arg("GPS HDOP"),"m", pos.eph/100.0,time);
-            emit valueChanged(uasId,name.arg("GPS COG"),"",pos.cog/100.0,time);
+            publishValue(uasId,name.arg("GPS Fix"),"",pos.fix_type,time);
+            publishValue(uasId,name.arg("GPS Sats"),"",pos.satellites_visible,time);
+            publishValue(uasId,name.arg("GPS HDOP"),"m", pos.eph/100.0,time);
+            publishValue(uasId,name.arg("GPS COG"),"",pos.cog/100.0,time);
 
         }
             break;
@@ -1010,6 +1014,16 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
                 break;
             }
         }
+            break;
+
+        case MAVLINK_MSG_ID_AUTOPILOT_VERSION:
+        {
+            mavlink_msg_autopilot_version_decode(&message, &autopilotVersion);
+            autopilotVersionKnown = true;
+            emit autopilotVersionChanged(uasId);
+        }
+            break;
+
         case MAVLINK_MSG_ID_MISSION_COUNT:
         {
             mavlink_mission_count_t wpc;
@@ -1296,10 +1310,10 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             mavlink_msg_radio_decode(&message, &radio);
             emit radioMessageUpdate(this, radio);
             QString name = QString("M%1:GCS Status.%2").arg(message.sysid);
-            emit valueChanged(uasId, name.arg("Radio RSSI"), "", radio.rssi, time);
-            emit valueChanged(uasId, name.arg("Radio REM RSSI"), "", radio.remrssi, time);
-            emit valueChanged(uasId, name.arg("Radio noise"), "", radio.noise, time);
-            emit valueChanged(uasId, name.arg("Radio REM noise"), "", radio.remnoise, time);
+            publishValue(uasId, name.arg("Radio RSSI"), "", radio.rssi, time);
+            publishValue(uasId, name.arg("Radio REM RSSI"), "", radio.remrssi, time);
+            publishValue(uasId, name.arg("Radio noise"), "", radio.noise, time);
+            publishValue(uasId, name.arg("Radio REM noise"), "", radio.remnoise, time);
         }
             break;
         // MAVLink Log donwload messages
@@ -2160,6 +2174,18 @@ void UAS::requestParameters()
     QLOG_DEBUG() << __FILE__ << __LINE__ << "LOADING PARAM LIST";
 }
 
+void UAS::requestAutopilotVersion()
+{
+#ifdef MAVLINK_MSG_ID_AUTOPILOT_VERSION_REQUEST
+    mavlink_message_t msg;
+    mavlink_msg_autopilot_version_request_pack(systemId, componentId, &msg, uasId, MAV_COMP_ID_PRIMARY);
+    sendMessage(msg);
+#else
+    // Only the ArduPilot dialect has a request for it, otherwise the
+    // version is only known if the system sends it by itself
+#endif
+}
+
 void UAS::writeParametersToStorage()
 {
     mavlink_message_t msg;
@@ -3254,24 +3280,24 @@ void UAS::sendHilGroundTruth(quint64 time_us, float roll, float pitch, float yaw
     Q_UNUSED(zacc);
     
         // Emit attitude for cross-check
-        emit valueChanged(uasId, "roll sim", "rad", roll, getUnixTime());
-        emit valueChanged(uasId, "pitch sim", "rad", pitch, getUnixTime());
-        emit valueChanged(uasId, "yaw sim", "rad", yaw, getUnixTime());
+        publishValue(uasId, "roll sim", "rad", roll, getUnixTime());
+        publishValue(uasId, "pitch sim", "rad", pitch, getUnixTime());
+        publishValue(uasId, "yaw sim", "rad", yaw, getUnixTime());
 
-        emit valueChanged(uasId, "roll rate sim", "rad/s", rollspeed, getUnixTime());
-        emit valueChanged(uasId, "pitch rate sim", "rad/s", pitchspeed, getUnixTime());
-        emit valueChanged(uasId, "yaw rate sim", "rad/s", yawspeed, getUnixTime());
+        publishValue(uasId, "roll rate sim", "rad/s", rollspeed, getUnixTime());
+        publishValue(uasId, "pitch rate sim", "rad/s", pitchspeed, getUnixTime());
+        publishValue(uasId, "yaw rate sim", "rad/s", yawspeed, getUnixTime());
 
-        emit valueChanged(uasId, "lat sim", "deg", lat*1e7, getUnixTime());
-        emit valueChanged(uasId, "lon sim", "deg", lon*1e7, getUnixTime());
-        emit valueChanged(uasId, "alt sim", "deg", alt*1e3, getUnixTime());
+        publishValue(uasId, "lat sim", "deg", lat*1e7, getUnixTime());
+        publishValue(uasId, "lon sim", "deg", lon*1e7, getUnixTime());
+        publishValue(uasId, "alt sim", "deg", alt*1e3, getUnixTime());
 
-        emit valueChanged(uasId, "vx sim", "m/s", vx*1e2, getUnixTime());
-        emit valueChanged(uasId, "vy sim", "m/s", vy*1e2, getUnixTime());
-        emit valueChanged(uasId, "vz sim", "m/s", vz*1e2, getUnixTime());
+        publishValue(uasId, "vx sim", "m/s", vx*1e2, getUnixTime());
+        publishValue(uasId, "vy sim", "m/s", vy*1e2, getUnixTime());
+        publishValue(uasId, "vz sim", "m/s", vz*1e2, getUnixTime());
 
-        emit valueChanged(uasId, "IAS sim", "m/s", ind_airspeed, getUnixTime());
-        emit valueChanged(uasId, "TAS sim", "m/s", true_airspeed, getUnixTime());
+        publishValue(uasId, "IAS sim", "m/s", ind_airspeed, getUnixTime());
+        publishValue(uasId, "TAS sim", "m/s", true_airspeed, getUnixTime());
 }
 
 /**
@@ -3652,6 +3678,16 @@ QMap<int, QString> UAS::getComponents()
     return components;
 }
 
+bool UAS::getAutopilotVersion(mavlink_autopilot_version_t& version) const
+{
+    if (!autopilotVersionKnown)
+    {
+        return false;
+    }
+    version = autopilotVersion;
+    return true;
+}
+
 /**
 * Set the battery type and the  number of cells.
 * @param type of the battery
@@ -3889,6 +3925,24 @@ void UAS::protocolStatusMessageRec(const QString& title, const QString& message)
 
 void UAS::valueChangedRec(const int uasId, const QString& name, const QString& unit, const QVariant& value, const quint64 msec)
 {
+    // Decoded values are already on the TelemetryBus, only forward them to the legacy signal
+    emit valueChanged(uasId,name,unit,value,msec);
+}
+
+bool UAS::hasValueChangedReceivers() const
+{
+    static const QMetaMethod signal = QMetaMethod::fromSignal(&UASInterface::valueChanged);
+    return isSignalConnected(signal);
+}
+
+void UAS::publishValue(const int uasId, const QString& name, const QString& unit, const QVariant& value, const quint64 msec)
+{
+    QHash<QString,int>::const_iterator it = m_busChannels.constFind(name);
+    if (it == m_busChannels.constEnd())
+    {
+        it = m_busChannels.insert(name, TelemetryBus::instance()->channel(name, unit));
+    }
+    TelemetryBus::instance()->publish(it.value(), uasId, value.toDouble(), msec);
     emit valueChanged(uasId,name,unit,value,msec);
 }
 
@@ -35,6 +35,7 @@ This file is part of the QGROUNDCONTROL project
 #include "UASInterface.h"
 #include <MAVLinkProtocol.h>
 #include <QVector3D>
+#include <QHash>
 #include "QGCMAVLink.h"
 #include "QGCHilLink.h"
 #include "QGCFlightGearLink.h"
@@ -84,11 +85,14 @@ public:
     }
     /** @brief Get the components */
     QMap<int, QString> getComponents();
+    /** @brief Get the AUTOPILOT_VERSION, false until the system has sent one */
+    bool getAutopilotVersion(mavlink_autopilot_version_t& version) const;
 
     /** @brief The time interval the robot is switched on */
     quint64 getUptime() const;
     /** @brief Get the status flag for the communication */
     int getCommunicationStatus() const;
+    bool hasValueChangedReceivers() const;
     /** @brief Add one measurement and get low-passed voltage */
     double filterVoltage(double value) const;
     /** @brief Get the links associated with this robot */
@@ -117,7 +121,7 @@ public:
     {
         groundSpeed = val;
         emit groundSpeedChanged(val,"groundSpeed");
-        emit valueChanged(this->uasId,"groundSpeed","m/s",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"groundSpeed","m/s",QVariant(val),getUnixTime());
     }
     double getGroundSpeed() const
     {
@@ -128,7 +132,7 @@ public:
     {
         airSpeed = val;
         emit airSpeedChanged(val,"airSpeed");
-        emit valueChanged(this->uasId,"airSpeed","m/s",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"airSpeed","m/s",QVariant(val),getUnixTime());
     }
 
     double getAirSpeed() const
@@ -140,7 +144,7 @@ public:
     {
         localX = val;
         emit localXChanged(val,"localX");
-        emit valueChanged(this->uasId,"localX","m",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"localX","m",QVariant(val),getUnixTime());
     }
 
     double getLocalX() const
@@ -152,7 +156,7 @@ public:
     {
         localY = val;
         emit localYChanged(val,"localY");
-        emit valueChanged(this->uasId,"localY","m",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"localY","m",QVariant(val),getUnixTime());
     }
     double getLocalY() const
     {
@@ -163,7 +167,7 @@ public:
     {
         localZ = val;
         emit localZChanged(val,"localZ");
-        emit valueChanged(this->uasId,"localZ","m",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"localZ","m",QVariant(val),getUnixTime());
     }
     double getLocalZ() const
     {
@@ -174,7 +178,7 @@ public:
     {
         latitude = val;
         emit latitudeChanged(val,"latitude");
-        emit valueChanged(this->uasId,"latitude","deg",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"latitude","deg",QVariant(val),getUnixTime());
     }
 
     double getLatitude() const
@@ -186,7 +190,7 @@ public:
     {
         longitude = val;
         emit longitudeChanged(val,"longitude");
-        emit valueChanged(this->uasId,"longitude","deg",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"longitude","deg",QVariant(val),getUnixTime());
     }
 
     double getLongitude() const
@@ -198,7 +202,7 @@ public:
     {
         altitudeAMSL = val;
         emit altitudeAMSLChanged(val, "altitudeAMSL");
-        emit valueChanged(this->uasId,"altitudeAMSL","m",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"altitudeAMSL","m",QVariant(val),getUnixTime());
     }
 
     double getAltitudeAMSL() const
@@ -210,7 +214,7 @@ public:
     {
         altitudeRelative = val;
         emit altitudeRelativeChanged(val, "altitudeRelative");
-        emit valueChanged(this->uasId,"altitudeRelative","m",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"altitudeRelative","m",QVariant(val),getUnixTime());
     }
 
     double getAltitudeRelative() const
@@ -222,7 +226,7 @@ public:
     {
         m_satelliteCount = val;
         emit satelliteCountChanged(val,"satelliteCount");
-        emit valueChanged(this->uasId,"satelliteCount","m",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"satelliteCount","m",QVariant(val),getUnixTime());
     }
 
     int getSatelliteCount() const
@@ -234,7 +238,7 @@ public:
     {
         m_gps_hdop = val;
         emit gpsHdopChanged(val,"GPS HDOP");
-        emit valueChanged(this->uasId,"GPS HDOP","m",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"GPS HDOP","m",QVariant(val),getUnixTime());
     }
 
     double getGpsHdop() const
@@ -246,7 +250,7 @@ public:
     {
         m_gps_fix = val;
         emit gpsFixChanged(val,"GPS FIX");
-        emit valueChanged(this->uasId,"GPS FIX","",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"GPS FIX","",QVariant(val),getUnixTime());
     }
 
     double getGpsFix() const
@@ -286,7 +290,7 @@ public:
     {
         distToWaypoint = val;
         emit distToWaypointChanged(val,"distToWaypoint");
-        emit valueChanged(this->uasId,"distToWaypoint","m",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"distToWaypoint","m",QVariant(val),getUnixTime());
     }
 
     double getDistToWaypoint() const
@@ -298,7 +302,7 @@ public:
     {
         bearingToWaypoint = val;
         emit bearingToWaypointChanged(val,"bearingToWaypoint");
-        emit valueChanged(this->uasId,"bearingToWaypoint","deg",QVariant(val),getUnixTime());
+        publishValue(this->uasId,"bearingToWaypoint","deg",QVariant(val),getUnixTime());
     }
 
     double getBearingToWaypoint() const
@@ -431,6 +435,8 @@ protected: //COMMENTS FOR TEST UNIT
     unsigned char type;           ///< UAS type (from type enum)
     int airframe;                 ///< The airframe type
     int autopilot;                ///< Type of the Autopilot: -1: None, 0: Generic, 1: PIXHAWK, 2: SLUGS, 3: Ardupilot (up to 15 types), defined in MAV_AUTOPILOT_TYPE ENUM
+    bool autopilotVersionKnown;   ///< If autopilotVersion has been received
+    mavlink_autopilot_version_t autopilotVersion; ///< Firmware, board and hardware UID of the system
     bool systemIsArmed;           ///< If the system is armed
     uint8_t base_mode;                 ///< The current mode of the MAV
     uint32_t custom_mode;         ///< The current mode of the MAV
@@ -942,6 +948,8 @@ public slots:
 
     /** @brief Request all parameters */
     void requestParameters();
+    /** @brief Ask the system to send its AUTOPILOT_VERSION */
+    void requestAutopilotVersion();
 
     /** @brief Request a single parameter by name */
     void requestParameter(int component, const QString& parameter);
@@ -1053,6 +1061,8 @@ protected:
     quint64 getUnixTimeFromMs(quint64 time);
     /** @brief Get the UNIX timestamp in milliseconds, ignore attitudeStamped mode */
     quint64 getUnixReferenceTime(quint64 time);
+    /** @brief Emit valueChanged() and store the value on the TelemetryBus */
+    void publishValue(const int uasId, const QString& name, const QString& unit, const QVariant& value, const quint64 msec);
 
     /** @brief convert Joystick input ([-1.0, +1.0]) to RC PPM value ([1000, 2000]) for channel */
     uint16_t scaleJoystickToRC(double pct, int channel) const;
@@ -1074,6 +1084,7 @@ protected:
     QList< QPair<int, QString> >  paramRequestQueue;
 
     QTimer m_parameterSendTimer;
+    QHash<QString,int> m_busChannels; ///< Value name to TelemetryBus channel, filled on first publish
 
 
 protected slots:
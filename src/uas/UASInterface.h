@@ -128,6 +128,8 @@ public:
     virtual quint64 getUptime() const = 0;
     /** @brief Get the status flag for the communication **/
     virtual int getCommunicationStatus() const = 0;
+    /** @brief True if anything is connected to valueChanged(), so producers can skip unused values **/
+    virtual bool hasValueChangedReceivers() const = 0;
 
     virtual double getLocalX() const = 0;
     virtual double getLocalY() const = 0;
@@ -282,6 +284,8 @@ public:
     virtual void setAutopilotType(int apType) = 0;
 
     virtual QMap<int, QString> getComponents() = 0;
+    /** @brief AUTOPILOT_VERSION of the system, false until the system has sent one */
+    virtual bool getAutopilotVersion(mavlink_autopilot_version_t& version) const = 0;
 
     QColor getColor()
     {
@@ -361,6 +365,8 @@ public slots:
     virtual void setHomePosition(double lat, double lon, double alt) = 0;
     /** @brief Request all onboard parameters of all components */
     virtual void requestParameters() = 0;
+    /** @brief Ask the system to send its AUTOPILOT_VERSION */
+    virtual void requestAutopilotVersion() = 0;
     /** @brief Request one specific onboard parameter */
     virtual void requestParameter(int component, const QString& parameter) = 0;
     /** @brief Write parameter to permanent storage */
@@ -676,6 +682,8 @@ signals:
     void systemSelected(bool selected);
     /** @brief Core specifications have changed */
     void systemSpecsChanged(int uasId);
+    /** @brief The system sent its AUTOPILOT_VERSION */
+    void autopilotVersionChanged(int uasId);
 
     /** @brief Object detected */
     void objectDetected(unsigned int time, int id, int type, const QString& name, int quality, float bearing, float distance);
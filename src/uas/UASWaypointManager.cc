@@ -39,6 +39,7 @@ This file is part of the QGROUNDCONTROL project
 #define PROTOCOL_TIMEOUT_MS 2000    ///< maximum time to wait for pending messages until timeout
 #define PROTOCOL_DELAY_MS 20        ///< minimum delay between sent messages
 #define PROTOCOL_MAX_RETRIES 5      ///< maximum number of send retries (after timeout)
+#define PROTOCOL_REQUEST_WINDOW 8   ///< maximum number of outstanding waypoint requests while reading
 
 static const QString DEFAULT_REL_ALT = "defaultRelAltitude";
 
@@ -51,6 +52,12 @@ UASWaypointManager::UASWaypointManager(UAS* _uas)
       current_partner_systemid(0),
       current_partner_compid(MAV_COMP_ID_PRIMARY),
       currentWaypointEditable(NULL),
+      request_window(1),
+      next_request_id(0),
+      outstanding_requests(0),
+      received_count(0),
+      waypoint_index_valid(false),
+      local_frame_count(0),
       protocol_timer(this),
       m_defaultAcceptanceRadius(5.0f),
       m_defaultRelativeAlt(0.0f)
@@ -72,7 +79,7 @@ UASWaypointManager::UASWaypointManager(UAS* _uas)
 
 UASWaypointManager::~UASWaypointManager()
 {
-
+    clearWaypointBuffer();
 }
 
 void UASWaypointManager::timeout()
@@ -85,7 +92,7 @@ void UASWaypointManager::timeout()
         if (current_state == WP_GETLIST) {
             sendWaypointRequestList();
         } else if (current_state == WP_GETLIST_GETWPS) {
-            sendWaypointRequest(current_wp_id);
+            requestMissingWaypoints();
         } else if (current_state == WP_SENDLIST) {
             sendWaypointCount();
         } else if (current_state == WP_SENDLIST_SENDWPS) {
@@ -147,6 +154,7 @@ void UASWaypointManager::handleWaypointCount(quint8 systemId, quint8 compId, qui
         if (read_to_edit == true){
             qDeleteAll(waypointsEditable);
             waypointsEditable.clear();
+            invalidateWaypointIndex();
             emit waypointEditableListChanged();
         }
 
@@ -154,7 +162,18 @@ void UASWaypointManager::handleWaypointCount(quint8 systemId, quint8 compId, qui
             current_count = count;
             current_wp_id = 0;
             current_state = WP_GETLIST_GETWPS;
-            sendWaypointRequest(current_wp_id);
+
+            // ArduPilot answers every MISSION_REQUEST on its own, so several
+            // requests can be in flight. Other autopilots expect stop-and-wait.
+            request_window = (uas && uas->getAutopilotType() == MAV_AUTOPILOT_ARDUPILOTMEGA) ? PROTOCOL_REQUEST_WINDOW : 1;
+            clearWaypointBuffer();
+            for (int i = 0; i < count; i++) {
+                waypoint_buffer.append(NULL);
+            }
+            next_request_id = 0;
+            outstanding_requests = 0;
+            received_count = 0;
+            requestWaypointWindow();
         } else {
             protocol_timer.stop();
             emit updateStatusString("done.");
@@ -178,47 +197,37 @@ void UASWaypointManager::handleWaypointCount(quint8 systemId, quint8 compId, qui
 
 void UASWaypointManager::handleWaypoint(quint8 systemId, quint8 compId, mavlink_mission_item_t *wp)
 {
-    if (systemId == current_partner_systemid && current_state == WP_GETLIST_GETWPS && wp->seq == current_wp_id) {
+    if (systemId == current_partner_systemid && current_state == WP_GETLIST_GETWPS && wp->seq < next_request_id) {
         protocol_timer.start(PROTOCOL_TIMEOUT_MS);
         current_retries = PROTOCOL_MAX_RETRIES;
 
-        if(wp->seq == current_wp_id) {
-
-            Waypoint *lwp_vo = new Waypoint(wp->seq, wp->x, wp->y, wp->z, wp->param1, wp->param2, wp->param3, wp->param4, wp->autocontinue, wp->current, (MAV_FRAME) wp->frame, (MAV_CMD) wp->command);
-            addWaypointViewOnly(lwp_vo);
-
-
-            if (read_to_edit == true) {
-                Waypoint *lwp_ed = new Waypoint(wp->seq, wp->x, wp->y, wp->z, wp->param1, wp->param2, wp->param3, wp->param4, wp->autocontinue, wp->current, (MAV_FRAME) wp->frame, (MAV_CMD) wp->command);
-                addWaypointEditable(lwp_ed, false);
-                if (wp->current == 1) currentWaypointEditable = lwp_ed;
-            }
-
-
-            //get next waypoint
-            current_wp_id++;
-
-            if(current_wp_id < current_count) {
-                sendWaypointRequest(current_wp_id);
-            } else {
-                sendWaypointAck(0);
+        if (waypoint_buffer.at(wp->seq) == NULL) {
+            // Items may arrive in any order, keep them until the list is complete
+            mavlink_mission_item_t *item = new mavlink_mission_item_t;
+            memcpy(item, wp, sizeof(mavlink_mission_item_t));
+            waypoint_buffer[wp->seq] = item;
+            outstanding_requests--;
+            received_count++;
+        }
 
-                // all waypoints retrieved, change state to idle
-                current_state = WP_IDLE;
-                current_count = 0;
-                current_wp_id = 0;
-                current_partner_systemid = 0;
-                current_partner_compid = MAV_COMP_ID_PRIMARY;
+        if (received_count < current_count) {
+            requestWaypointWindow();
+        } else {
+            sendWaypointAck(0);
 
-                protocol_timer.stop();
-                emit readGlobalWPFromUAS(false);
-                QTime time = QTime::currentTime();
-                QString timeString = time.toString();
-                emit updateStatusString(tr("done. (updated at %1)").arg(timeString));
+            // all waypoints retrieved, change state to idle
+            current_state = WP_IDLE;
+            current_count = 0;
+            current_wp_id = 0;
+            current_partner_systemid = 0;
+            current_partner_compid = MAV_COMP_ID_PRIMARY;
 
-            }
-        } else {
-            emit updateStatusString(tr("Waypoint ID mismatch, rejecting waypoint"));
+            protocol_timer.stop();
+            applyReceivedWaypoints();
+            emit readGlobalWPFromUAS(false);
+            QTime time = QTime::currentTime();
+            QString timeString = time.toString();
+            emit updateStatusString(tr("done. (updated at %1)").arg(timeString));
         }
     } else {
         QLOG_DEBUG() << "Rejecting message, check mismatch: current_state: " << current_state
@@ -230,6 +239,62 @@ void UASWaypointManager::handleWaypoint(quint8 systemId, quint8 compId, mavlink_
     }
 }
 
+void UASWaypointManager::requestWaypointWindow()
+{
+    while (outstanding_requests < request_window && next_request_id < current_count) {
+        sendWaypointRequest(next_request_id);
+        next_request_id++;
+        outstanding_requests++;
+    }
+}
+
+void UASWaypointManager::requestMissingWaypoints()
+{
+    for (int i = 0; i < next_request_id; i++) {
+        if (waypoint_buffer.at(i) == NULL) {
+            sendWaypointRequest(i);
+        }
+    }
+}
+
+void UASWaypointManager::applyReceivedWaypoints()
+{
+    // Build both lists first and signal the change once, instead of once per waypoint
+    for (int i = 0; i < waypoint_buffer.count(); i++) {
+        const mavlink_mission_item_t *wp = waypoint_buffer.at(i);
+
+        Waypoint *lwp_vo = new Waypoint(wp->seq, wp->x, wp->y, wp->z, wp->param1, wp->param2, wp->param3, wp->param4, wp->autocontinue, wp->current, (MAV_FRAME) wp->frame, (MAV_CMD) wp->command);
+        waypointsViewOnly.append(lwp_vo);
+        connect(lwp_vo, SIGNAL(changed(Waypoint*)), this, SLOT(notifyOfChangeViewOnly(Waypoint*)));
+
+        if (read_to_edit == true) {
+            Waypoint *lwp_ed = new Waypoint(wp->seq, wp->x, wp->y, wp->z, wp->param1, wp->param2, wp->param3, wp->param4, wp->autocontinue, wp->current, (MAV_FRAME) wp->frame, (MAV_CMD) wp->command);
+            lwp_ed->setId(waypointsEditable.count());
+            waypointsEditable.append(lwp_ed);
+            connect(lwp_ed, SIGNAL(changed(Waypoint*)), this, SLOT(notifyOfChangeEditable(Waypoint*)));
+            if (wp->current == 1) currentWaypointEditable = lwp_ed;
+        }
+    }
+    clearWaypointBuffer();
+
+    emit waypointViewOnlyListChanged();
+    emit waypointViewOnlyListChanged(uasid);
+    if (read_to_edit == true) {
+        invalidateWaypointIndex();
+        emit waypointEditableListChanged();
+        emit waypointEditableListChanged(uasid);
+    }
+}
+
+void UASWaypointManager::clearWaypointBuffer()
+{
+    // Why not replace with waypoint_buffer.clear() ?
+    // because this will lead to memory leaks, the waypoint-structs
+    // have to be deleted, clear() would only delete the pointers.
+    qDeleteAll(waypoint_buffer);
+    waypoint_buffer.clear();
+}
+
 void UASWaypointManager::handleWaypointAck(quint8 systemId, quint8 compId, mavlink_mission_ack_t *wpa)
 {
     if (systemId == current_partner_systemid && (compId == current_partner_compid || compId == MAV_COMP_ID_PRIMARY)) {
@@ -308,6 +373,8 @@ void UASWaypointManager::handleWaypointCurrent(quint8 systemId, quint8 compId, m
 
 void UASWaypointManager::notifyOfChangeEditable(Waypoint* wp)
 {
+    // The frame or command of the waypoint may have changed
+    invalidateWaypointIndex();
     // If only one waypoint was changed, emit only WP signal
     if (wp != NULL) {
         emit waypointEditableChanged(uasid, wp);
@@ -404,6 +471,7 @@ void UASWaypointManager::addWaypointEditable(Waypoint *wp, bool enforceFirstActi
         waypointsEditable.insert(waypointsEditable.count(), wp);
         connect(wp, SIGNAL(changed(Waypoint*)), this, SLOT(notifyOfChangeEditable(Waypoint*)));
 
+        invalidateWaypointIndex();
         emit waypointEditableListChanged();
         emit waypointEditableListChanged(uasid);
     }
@@ -431,6 +499,7 @@ Waypoint* UASWaypointManager::createWaypoint(bool enforceFirstActive)
     waypointsEditable.append(wp);
     connect(wp, SIGNAL(changed(Waypoint*)), this, SLOT(notifyOfChangeEditable(Waypoint*)));
 
+    invalidateWaypointIndex();
     emit waypointEditableListChanged();
     emit waypointEditableListChanged(uasid);
     return wp;
@@ -463,6 +532,7 @@ int UASWaypointManager::removeWaypoint(quint16 seq)
             waypointsEditable[i]->setId(i);
         }
 
+        invalidateWaypointIndex();
         emit waypointEditableListChanged();
         emit waypointEditableListChanged(uasid);
         return 0;
@@ -493,6 +563,7 @@ void UASWaypointManager::moveWaypoint(quint16 cur_seq, quint16 new_seq)
         waypointsEditable[new_seq] = t;
         waypointsEditable[new_seq]->setId(new_seq);
 
+        invalidateWaypointIndex();
         emit waypointEditableListChanged();
         emit waypointEditableListChanged(uasid);
     }
@@ -526,6 +597,7 @@ void UASWaypointManager::loadWaypoints(const QString &loadFile)
     qDeleteAll(waypointsEditable);
     waypointsEditable.clear();
 
+    invalidateWaypointIndex();
     emit waypointEditableListChanged();
     emit waypointEditableListChanged(uasid);
 
@@ -565,6 +637,7 @@ void UASWaypointManager::loadWaypoints(const QString &loadFile)
     file.close();
 
     emit loadWPFile();
+    invalidateWaypointIndex();
     emit waypointEditableListChanged();
     emit waypointEditableListChanged(uasid);
 }
@@ -585,218 +658,150 @@ void UASWaypointManager::clearWaypointList()
     }
 }
 
-const QList<Waypoint *> UASWaypointManager::getGlobalFrameWaypointList()
+void UASWaypointManager::invalidateWaypointIndex()
 {
-    // TODO Keep this global frame list up to date
-    // with complete waypoint list
-    // instead of filtering on each request
-    QList<Waypoint*> wps;
+    waypoint_index_valid = false;
+}
+
+/**
+ * Rebuilds the frame and navigation type lists with one pass over the
+ * editable list. The queries below are called for every waypoint on redraw,
+ * so they must not scan the list themselves.
+ */
+void UASWaypointManager::updateWaypointIndex()
+{
+    if (waypoint_index_valid)
+        return;
+
+    waypoint_index.clear();
+    waypoint_index.reserve(waypointsEditable.count());
+    global_frame_waypoints.clear();
+    global_frame_nav_type_waypoints.clear();
+    global_frame_visible_waypoints.clear();
+    global_frame_path_waypoints.clear();
+    nav_type_waypoints.clear();
+    local_frame_count = 0;
+    int editable_count = 0;
+    int mission_frame_count = 0;
+
     foreach (Waypoint* wp, waypointsEditable)
     {
-        if (wp->getFrame() == MAV_FRAME_GLOBAL || wp->getFrame() == MAV_FRAME_GLOBAL_RELATIVE_ALT)
+        WaypointIndex index;
+        index.editable = editable_count++;
+        bool global = (wp->getFrame() == MAV_FRAME_GLOBAL || wp->getFrame() == MAV_FRAME_GLOBAL_RELATIVE_ALT);
+        bool navigation = wp->isNavigationType();
+        bool visible = wp->visibleOnMapWidget();
+
+        if (global)
+        {
+            index.globalFrame = global_frame_waypoints.count();
+            global_frame_waypoints.append(wp);
+            if (navigation)
+            {
+                index.globalFrameAndNavType = global_frame_nav_type_waypoints.count();
+                global_frame_nav_type_waypoints.append(wp);
+            }
+            if (navigation || visible)
+            {
+                global_frame_visible_waypoints.append(wp);
+                if (!visible) // we need waypoints only to draw the path on map
+                    global_frame_path_waypoints.append(wp);
+            }
+        }
+        if (navigation)
+        {
+            index.navType = nav_type_waypoints.count();
+            nav_type_waypoints.append(wp);
+        }
+        if (wp->getFrame() == MAV_FRAME_LOCAL_NED || wp->getFrame() == MAV_FRAME_LOCAL_ENU)
+        {
+            index.localFrame = local_frame_count++;
+        }
+        if (wp->getFrame() == MAV_FRAME_MISSION)
         {
-            wps.append(wp);
+            index.missionFrame = mission_frame_count++;
         }
+        waypoint_index.insert(wp, index);
     }
-    return wps;
+    waypoint_index_valid = true;
+}
+
+const QList<Waypoint *> UASWaypointManager::getGlobalFrameWaypointList()
+{
+    updateWaypointIndex();
+    return global_frame_waypoints;
 }
 
 const QList<Waypoint *> UASWaypointManager::getGlobalFrameAndNavTypeWaypointList(bool onlypath)
 {
-    // TODO Keep this global frame list up to date
-    // with complete waypoint list
-    // instead of filtering on each request
-    QList<Waypoint*> wps;
-    foreach (Waypoint* wp, waypointsEditable)
-    {
-        if ((wp->getFrame() == MAV_FRAME_GLOBAL || wp->getFrame() == MAV_FRAME_GLOBAL_RELATIVE_ALT) && (wp->isNavigationType() || (wp->visibleOnMapWidget())))
-        {
-            if(wp->visibleOnMapWidget() && onlypath) // we need waypoints only to draw the path on map
-                continue;
-            wps.append(wp);
-        }
-    }
-    return wps;
+    updateWaypointIndex();
+    return onlypath ? global_frame_path_waypoints : global_frame_visible_waypoints;
 }
 
 const QList<Waypoint *> UASWaypointManager::getNavTypeWaypointList()
 {
-    // TODO Keep this global frame list up to date
-    // with complete waypoint list
-    // instead of filtering on each request
-    QList<Waypoint*> wps;
-    foreach (Waypoint* wp, waypointsEditable)
-    {
-        if (wp->isNavigationType())
-        {
-            wps.append(wp);
-        }
-    }
-    return wps;
+    updateWaypointIndex();
+    return nav_type_waypoints;
 }
 
 int UASWaypointManager::getIndexOf(Waypoint* wp)
 {
-    return waypointsEditable.indexOf(wp);
+    updateWaypointIndex();
+    return waypoint_index.value(wp).editable;
 }
 
 int UASWaypointManager::getGlobalFrameIndexOf(Waypoint* wp)
 {
-    // Search through all waypointsEditable,
-    // counting only those in global frame
-    int i = 0;
-    foreach (Waypoint* p, waypointsEditable) {
-        if (p->getFrame() == MAV_FRAME_GLOBAL || wp->getFrame() == MAV_FRAME_GLOBAL_RELATIVE_ALT)
-        {
-            if (p == wp)
-            {
-                return i;
-            }
-            i++;
-        }
-    }
-
-    return -1;
+    updateWaypointIndex();
+    return waypoint_index.value(wp).globalFrame;
 }
 
 int UASWaypointManager::getGlobalFrameAndNavTypeIndexOf(Waypoint* wp)
 {
-    // Search through all waypointsEditable,
-    // counting only those in global frame
-    int i = 0;
-    foreach (Waypoint* p, waypointsEditable) {
-        if ((p->getFrame() == MAV_FRAME_GLOBAL || wp->getFrame() == MAV_FRAME_GLOBAL_RELATIVE_ALT) && p->isNavigationType())
-        {
-            if (p == wp)
-            {
-                return i;
-            }
-            i++;
-        }
-    }
-
-    return -1;
+    updateWaypointIndex();
+    return waypoint_index.value(wp).globalFrameAndNavType;
 }
 
 int UASWaypointManager::getNavTypeIndexOf(Waypoint* wp)
 {
-    // Search through all waypointsEditable,
-    // counting only those in global frame
-    int i = 0;
-    foreach (Waypoint* p, waypointsEditable)
-    {
-        if (p->isNavigationType())
-        {
-            if (p == wp)
-            {
-                return i;
-            }
-            i++;
-        }
-    }
-
-    return -1;
+    updateWaypointIndex();
+    return waypoint_index.value(wp).navType;
 }
 
 int UASWaypointManager::getGlobalFrameCount()
 {
-    // Search through all waypointsEditable,
-    // counting only those in global frame
-    int i = 0;
-    foreach (Waypoint* p, waypointsEditable)
-    {
-        if (p->getFrame() == MAV_FRAME_GLOBAL || p->getFrame() == MAV_FRAME_GLOBAL_RELATIVE_ALT)
-        {
-            i++;
-        }
-    }
-
-    return i;
+    updateWaypointIndex();
+    return global_frame_waypoints.count();
 }
 
 int UASWaypointManager::getGlobalFrameAndNavTypeCount()
 {
-    // Search through all waypointsEditable,
-    // counting only those in global frame
-    int i = 0;
-    foreach (Waypoint* p, waypointsEditable) {
-        if ((p->getFrame() == MAV_FRAME_GLOBAL || p->getFrame() == MAV_FRAME_GLOBAL_RELATIVE_ALT) && p->isNavigationType())
-        {
-            i++;
-        }
-    }
-
-    return i;
+    updateWaypointIndex();
+    return global_frame_nav_type_waypoints.count();
 }
 
 int UASWaypointManager::getNavTypeCount()
 {
-    // Search through all waypointsEditable,
-    // counting only those in global frame
-    int i = 0;
-    foreach (Waypoint* p, waypointsEditable) {
-        if (p->isNavigationType()) {
-            i++;
-        }
-    }
-
-    return i;
+    updateWaypointIndex();
+    return nav_type_waypoints.count();
 }
 
 int UASWaypointManager::getLocalFrameCount()
 {
-    // Search through all waypointsEditable,
-    // counting only those in global frame
-    int i = 0;
-    foreach (Waypoint* p, waypointsEditable)
-    {
-        if (p->getFrame() == MAV_FRAME_LOCAL_NED || p->getFrame() == MAV_FRAME_LOCAL_ENU)
-        {
-            i++;
-        }
-    }
-
-    return i;
+    updateWaypointIndex();
+    return local_frame_count;
 }
 
 int UASWaypointManager::getLocalFrameIndexOf(Waypoint* wp)
 {
-    // Search through all waypointsEditable,
-    // counting only those in local frame
-    int i = 0;
-    foreach (Waypoint* p, waypointsEditable)
-    {
-        if (p->getFrame() == MAV_FRAME_LOCAL_NED || p->getFrame() == MAV_FRAME_LOCAL_ENU)
-        {
-            if (p == wp)
-            {
-                return i;
-            }
-            i++;
-        }
-    }
-
-    return -1;
+    updateWaypointIndex();
+    return waypoint_index.value(wp).localFrame;
 }
 
 int UASWaypointManager::getMissionFrameIndexOf(Waypoint* wp)
 {
-    // Search through all waypointsEditable,
-    // counting only those in mission frame
-    int i = 0;
-    foreach (Waypoint* p, waypointsEditable)
-    {
-        if (p->getFrame() == MAV_FRAME_MISSION)
-        {
-            if (p == wp)
-            {
-                return i;
-            }
-            i++;
-        }
-    }
-
-    return -1;
+    updateWaypointIndex();
+    return waypoint_index.value(wp).missionFrame;
 }
 
 
@@ -890,13 +895,7 @@ void UASWaypointManager::writeWaypoints()
             current_partner_compid = MAV_COMP_ID_MISSIONPLANNER;
 
             //clear local buffer
-            // Why not replace with waypoint_buffer.clear() ?
-            // because this will lead to memory leaks, the waypoint-structs
-            // have to be deleted, clear() would only delete the pointers.
-            while(!waypoint_buffer.empty()) {
-                delete waypoint_buffer.back();
-                waypoint_buffer.pop_back();
-            }
+            clearWaypointBuffer();
 
             bool noCurrent = true;
 
@@ -1024,7 +1023,11 @@ void UASWaypointManager::sendWaypointRequest(quint16 seq)
 
     mavlink_msg_mission_request_encode(uas->getSystemId(), uas->getComponentId(), &message, &wpr);
     uas->sendMessage(message);
-    QGC::SLEEP::msleep(PROTOCOL_DELAY_MS);
+    // The request window paces ArduPilot, other stacks may still rely on
+    // the gap between messages
+    if (uas->getAutopilotType() != MAV_AUTOPILOT_ARDUPILOTMEGA) {
+        QGC::SLEEP::msleep(PROTOCOL_DELAY_MS);
+    }
 }
 
 void UASWaypointManager::sendWaypoint(quint16 seq)
@@ -1043,10 +1046,13 @@ void UASWaypointManager::sendWaypoint(quint16 seq)
 
         emit updateStatusString(QString("Sending waypoint ID %1 of %2 total").arg(wp->seq).arg(current_count));
 
-
         mavlink_msg_mission_item_encode(uas->getSystemId(), uas->getComponentId(), &message, wp);
         uas->sendMessage(message);
-        QGC::SLEEP::msleep(PROTOCOL_DELAY_MS);
+        // ArduPilot paces the upload with its requests, other stacks may
+        // still rely on the gap between messages
+        if (uas->getAutopilotType() != MAV_AUTOPILOT_ARDUPILOTMEGA) {
+            QGC::SLEEP::msleep(PROTOCOL_DELAY_MS);
+        }
     }
 }
 
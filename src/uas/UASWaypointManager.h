@@ -34,6 +34,7 @@ This file is part of the QGROUNDCONTROL project
 
 #include <QObject>
 #include <QList>
+#include <QHash>
 #include <QTimer>
 #include "Waypoint.h"
 #include "QGCMAVLink.h"
@@ -63,6 +64,17 @@ private:
         WP_SETCURRENT       ///< Setting new current waypoint on the MAV
     }; ///< The possible states for the waypoint protocol
 
+    /** @brief Position of a waypoint within the filtered waypoint lists, -1 if not part of a list */
+    struct WaypointIndex {
+        WaypointIndex() : editable(-1), globalFrame(-1), globalFrameAndNavType(-1), navType(-1), localFrame(-1), missionFrame(-1) {}
+        int editable;
+        int globalFrame;
+        int globalFrameAndNavType;
+        int navType;
+        int localFrame;
+        int missionFrame;
+    };
+
 public:
     UASWaypointManager(UAS* uas=NULL);   ///< Standard constructor
     ~UASWaypointManager();
@@ -132,6 +144,13 @@ private:
     void sendWaypointAck(quint8 type);              ///< Sends a waypoint ack
     /*@}*/
 
+    void requestWaypointWindow();                   ///< Keeps up to request_window waypoint requests outstanding
+    void requestMissingWaypoints();                 ///< Re-requests all outstanding waypoints
+    void applyReceivedWaypoints();                  ///< Moves the received waypoints into the waypoint lists
+    void clearWaypointBuffer();
+    void invalidateWaypointIndex();                 ///< Marks the filtered waypoint lists as outdated
+    void updateWaypointIndex();                     ///< Rebuilds the filtered waypoint lists if outdated
+
     const QVariant readSetting(const QString& key, const QVariant& value);
     void writeSetting(const QString& key, const QVariant& defaultValue);
 
@@ -181,7 +200,20 @@ private:
     QList<Waypoint *> waypointsViewOnly;                  ///< local copy of current waypoint list on MAV
     QList<Waypoint *> waypointsEditable;                  ///< local editable waypoint list
     Waypoint* currentWaypointEditable;                      ///< The currently used waypoint
-    QList<mavlink_mission_item_t *> waypoint_buffer;  ///< buffer for waypoints during communication
+    QList<mavlink_mission_item_t *> waypoint_buffer;  ///< buffer for waypoints during communication, NULL for waypoints not yet received
+    quint16 request_window;                         ///< Maximum number of outstanding waypoint requests while reading
+    quint16 next_request_id;                        ///< The next waypoint ID that has not been requested yet
+    quint16 outstanding_requests;                   ///< The number of requested waypoints that did not arrive yet
+    quint16 received_count;                         ///< The number of waypoints received in the current read
+
+    bool waypoint_index_valid;                      ///< False if waypointsEditable changed since the last index update
+    QHash<Waypoint*, WaypointIndex> waypoint_index; ///< Position of each editable waypoint in the filtered lists
+    QList<Waypoint *> global_frame_waypoints;       ///< Editable waypoints in global frame
+    QList<Waypoint *> global_frame_nav_type_waypoints; ///< Editable waypoints in global frame and of navigation type
+    QList<Waypoint *> global_frame_visible_waypoints;  ///< Editable waypoints in global frame shown on the map
+    QList<Waypoint *> global_frame_path_waypoints;  ///< Editable waypoints in global frame that make up the path on the map
+    QList<Waypoint *> nav_type_waypoints;           ///< Editable waypoints of navigation type
+    int local_frame_count;                          ///< Number of editable waypoints in local frame
     QTimer protocol_timer;                          ///< Timer to catch timeouts
     bool standalone;                                ///< If standalone is set, do not write to UAS
     quint16 uasid;
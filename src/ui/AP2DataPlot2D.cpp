@@ -69,6 +69,8 @@ AP2DataPlot2D::AP2DataPlot2D(QWidget *parent,bool isIndependant) : QWidget(paren
     m_tlogReplayEnabled(false),
     m_logDownloadDialog(NULL),
     m_droneshareUploadDialog(NULL),
+    m_onlineRetention(1800),
+    m_onlineDirty(false),
     m_loadedLogMavType(MAV_TYPE_ENUM_END),
     m_statusTextPos(0)
 {
@@ -303,8 +305,9 @@ void AP2DataPlot2D::showEvent(QShowEvent *evt)
         m_updateTimer = 0;
     }
     m_updateTimer = new QTimer(this);
-    connect(m_updateTimer,SIGNAL(timeout()),m_plot,SLOT(replot()));
-    m_updateTimer->start(500);
+    connect(m_updateTimer,SIGNAL(timeout()),this,SLOT(updateTimerTick()));
+    m_updateTimer->start(FrameInterval);
+    m_onlineDirty = true;
     QWidget::showEvent(evt);
 }
 
@@ -389,6 +392,19 @@ void AP2DataPlot2D::plotMouseMove(QMouseEvent *evt)
         {
             //Ignore ERR
         }
+        else if (qobject_cast<AP2DataPlotGraph*>(graph))
+        {
+            double value = 0;
+            if (qobject_cast<AP2DataPlotGraph*>(graph)->valueAt(key,value))
+            {
+                QString str = QString().sprintf( "%.9g", value);
+                newresult.append(m_graphClassMap.keys()[i] + ": " + str + ((i == m_graphClassMap.keys().size()-1) ? "" : "\n"));
+            }
+            else
+            {
+                newresult.append(m_graphClassMap.keys()[i] + ": " + "ERR" + ((i == m_graphClassMap.keys().size()-1) ? "" : "\n"));
+            }
+        }
         else if (graph->data()->contains(key))
         {
             QString str = QString().sprintf( "%.9g", graph->data()->value(key).value);
@@ -674,6 +690,7 @@ void AP2DataPlot2D::navModeChanged(int uasid, int mode, const QString& text)
     int index = newmsec / 1000.0;
     m_graphClassMap["MODE"].modeMap[index] = text;
     plotTextArrow(index, text, "MODE");
+    m_onlineDirty = true;
 
 }
 
@@ -690,82 +707,185 @@ void AP2DataPlot2D::updateValue(const int uasId, const QString& name, const QStr
         //If a log is currently loaded, we don't care about incoming data.
         return;
     }
-    QString propername  = name.mid(name.indexOf(":")+1);
-    if (!m_onlineValueMap.contains(propername))
+    int id = m_onlineSeriesIds.value(name,-1);
+    if (id < 0)
     {
-        ui.dataSelectionScreen->addItem(propername);
+        QString propername  = name.mid(name.indexOf(":")+1);
+        id = m_onlineSeriesNames.value(propername,-1);
+        if (id < 0)
+        {
+            id = m_onlineSeries.size();
+            m_onlineSeries.append(OnlineSeries(propername));
+            m_onlineSeriesNames.insert(propername,id);
+            ui.dataSelectionScreen->addItem(propername);
+        }
+        m_onlineSeriesIds.insert(name,id);
     }
 
-
+    // Only store the sample, the graphs are updated once per frame
     qint64 msec_current = QDateTime::currentMSecsSinceEpoch();
     m_currentIndex = msec_current;
     qint64 newmsec = (msec_current - m_startIndex);// + m_timeDiff;
-    if (m_graphCount > 0 && ui.autoScrollCheckBox->isChecked())
+    OnlineSeries &series = m_onlineSeries[id];
+    series.append(newmsec / 1000.0,value);
+    series.integer = integer;
+    m_onlineDirty = true;
+}
+
+void AP2DataPlot2D::updateTimerTick()
+{
+    if (!m_onlineDirty)
     {
-        double diff = (newmsec / 1000.0) - m_wideAxisRect->axis(QCPAxis::atBottom,0)->range().upper;
-        m_wideAxisRect->axis(QCPAxis::atBottom,0)->setRangeLower(m_wideAxisRect->axis(QCPAxis::atBottom,0)->range().lower + diff);
-        m_wideAxisRect->axis(QCPAxis::atBottom,0)->setRangeUpper((newmsec / 1000.0));
+        return;
     }
+    m_onlineDirty = false;
+    if (m_logLoaded)
+    {
+        m_plot->replot();
+        return;
+    }
+    qint64 newmsec = (QDateTime::currentMSecsSinceEpoch() - m_startIndex);// + m_timeDiff;
+    double cutoff = (newmsec / 1000.0) - m_onlineRetention;
+    bool graphUpdated = false;
 
-    if (m_graphClassMap.contains(propername))
+    for (QMap<QString,Graph>::iterator i = m_graphClassMap.begin();i!=m_graphClassMap.end();i++)
     {
-        m_graphClassMap[propername].axisIndex = newmsec / 1000.0;// + 18000000;
-        m_graphClassMap.value(propername).graph->addData(m_graphClassMap.value(propername).axisIndex,value);
-        m_scrollEndIndex = newmsec /  1000.0;
-        //ui.horizontalScrollBar->setMinimum(m_startIndex);
-        ui.horizontalScrollBar->setMaximum(m_scrollEndIndex);
-        //Set a timeout for 30 minutes from now, 1800 seconds.
-        qint64 current = QDateTime::currentMSecsSinceEpoch();
-        //This is 30 minutes
-        m_onlineValueTimeoutList.append(QPair<qint64,double>(current + 1800000,msec));
-        //This is 1 minute
-        //m_onlineValueTimeoutList.append(QPair<qint64,double>(current + 60000,m_currentIndex));
-        if (m_onlineValueTimeoutList[0].first <= current)
+        Graph &graph = i.value();
+        if (graph.seriesId < 0)
         {
-            for (QMap<QString,Graph>::const_iterator i = m_graphClassMap.constBegin();i!=m_graphClassMap.constEnd();i++)
-            {
-                i.value().graph->removeData(0,m_onlineValueTimeoutList[0].second);
-            }
-            m_onlineValueTimeoutList.removeAt(0);
+            continue;
+        }
+        graph.graph->removeDataBefore(cutoff);
+        OnlineSeries &series = m_onlineSeries[graph.seriesId];
+        if (series.pending == 0)
+        {
+            continue;
+        }
+        QVector<double> keys;
+        QVector<double> values;
+        series.copy(series.count - series.pending,keys,values);
+        series.pending = 0;
+        graph.graph->addData(keys,values);
+        graph.axisIndex = keys.last();
+        graphUpdated = true;
+
+        QCPRange batchRange(values.first(),values.first());
+        for (int j=1;j<values.size();j++)
+        {
+            batchRange.lower = qMin(batchRange.lower,values.at(j));
+            batchRange.upper = qMax(batchRange.upper,values.at(j));
         }
-        if (m_graphClassMap.value(propername).groupName != "" && m_graphClassMap.value(propername).groupName != "MANUAL")
+        if (graph.groupName != "" && graph.groupName != "MANUAL")
         {
             //Current graph is in a group
-            if (!m_graphGroupRanges[m_graphClassMap.value(propername).groupName].contains(value))
+            QCPRange &groupRange = m_graphGroupRanges[graph.groupName];
+            if (!groupRange.contains(batchRange.lower) || !groupRange.contains(batchRange.upper))
             {
                 //It's out of scale for the group, expand it.
-                if (m_graphGroupRanges[m_graphClassMap.value(propername).groupName].lower > value)
-                {
-                    m_graphGroupRanges[m_graphClassMap.value(propername).groupName].lower = value;
-                }
-                else if (m_graphGroupRanges[m_graphClassMap.value(propername).groupName].upper < value)
-                {
-                    m_graphGroupRanges[m_graphClassMap.value(propername).groupName].upper = value;
-                }
-                for (int i=0;i<m_graphGrouping[m_graphClassMap.value(propername).groupName].size();i++)
+                groupRange.expand(batchRange);
+                for (int j=0;j<m_graphGrouping[graph.groupName].size();j++)
                 {
-                    m_graphClassMap.value(m_graphGrouping[m_graphClassMap.value(propername).groupName][i]).axis->setRange(m_graphGroupRanges[m_graphClassMap.value(propername).groupName]);
+                    m_graphClassMap.value(m_graphGrouping[graph.groupName][j]).axis->setRange(groupRange);
                 }
                 if (m_axisGroupingDialog)
                 {
-                    m_axisGroupingDialog->updateAxis(propername,m_graphClassMap.value(propername).axis->range().lower,m_graphClassMap.value(propername).axis->range().upper);
+                    m_axisGroupingDialog->updateAxis(i.key(),graph.axis->range().lower,graph.axis->range().upper);
                 }
             }
         }
-        else if (!m_graphClassMap.value(propername).graph->keyAxis()->range().contains(value) && !m_graphClassMap.value(propername).isManualRange)
+        else if ((!graph.axis->range().contains(batchRange.lower) || !graph.axis->range().contains(batchRange.upper)) && !graph.isManualRange)
         {
-            m_graphClassMap.value(propername).graph->rescaleValueAxis();
+            graph.graph->rescaleValueAxis();
             if (m_axisGroupingDialog)
             {
-                m_axisGroupingDialog->updateAxis(propername,m_graphClassMap.value(propername).axis->range().lower,m_graphClassMap.value(propername).axis->range().upper);
+                m_axisGroupingDialog->updateAxis(i.key(),graph.axis->range().lower,graph.axis->range().upper);
             }
         }
-        if (integer)
+        if (series.integer)
+        {
+            graph.axis->setNumberPrecision(0);
+        }
+    }
+
+    // Series that are not graphed only keep the retention window
+    for (int i=0;i<m_onlineSeries.size();i++)
+    {
+        m_onlineSeries[i].removeBefore(cutoff);
+        m_onlineSeries[i].pending = qMin(m_onlineSeries[i].pending,m_onlineSeries[i].count);
+    }
+
+    if (graphUpdated)
+    {
+        m_scrollEndIndex = newmsec / 1000.0;
+        ui.horizontalScrollBar->setMaximum(m_scrollEndIndex);
+        if (m_graphCount > 0 && ui.autoScrollCheckBox->isChecked())
+        {
+            double diff = (newmsec / 1000.0) - m_wideAxisRect->axis(QCPAxis::atBottom,0)->range().upper;
+            m_wideAxisRect->axis(QCPAxis::atBottom,0)->setRangeLower(m_wideAxisRect->axis(QCPAxis::atBottom,0)->range().lower + diff);
+            m_wideAxisRect->axis(QCPAxis::atBottom,0)->setRangeUpper((newmsec / 1000.0));
+        }
+    }
+    m_plot->replot();
+}
+
+void AP2DataPlot2D::setOnlineRetention(int seconds)
+{
+    m_onlineRetention = qMax(1,seconds);
+}
+
+void AP2DataPlot2D::OnlineSeries::append(double key,double value)
+{
+    if (count < keys.size())
+    {
+        int index = (head + count) % keys.size();
+        keys[index] = key;
+        values[index] = value;
+        count++;
+    }
+    else if (keys.size() < OnlineSeriesCapacity)
+    {
+        // Still growing, keep the samples in order so the ring stays simple
+        if (head != 0)
         {
-            m_graphClassMap.value(propername).axis->setNumberPrecision(0);
+            QVector<double> keyList;
+            QVector<double> valueList;
+            copy(0,keyList,valueList);
+            keys = keyList;
+            values = valueList;
+            head = 0;
         }
+        keys.append(key);
+        values.append(value);
+        count++;
+    }
+    else
+    {
+        // Full, overwrite the oldest sample
+        keys[head] = key;
+        values[head] = value;
+        head = (head + 1) % keys.size();
+    }
+    pending = qMin(pending + 1,count);
+}
+
+void AP2DataPlot2D::OnlineSeries::removeBefore(double key)
+{
+    while (count > 0 && keyAt(0) < key)
+    {
+        head = (head + 1) % keys.size();
+        count--;
+    }
+}
+
+void AP2DataPlot2D::OnlineSeries::copy(int from,QVector<double> &keyList,QVector<double> &valueList) const
+{
+    keyList.resize(count - from);
+    valueList.resize(count - from);
+    for (int i=from;i<count;i++)
+    {
+        keyList[i - from] = keyAt(i);
+        valueList[i - from] = valueAt(i);
     }
-    m_onlineValueMap[propername].append(QPair<double,double>(newmsec / 1000.0,value));
 }
 
 void AP2DataPlot2D::valueChanged(const int uasId, const QString& name, const QString& unit, const QVariant& value,const quint64 msec)
@@ -910,30 +1030,35 @@ void AP2DataPlot2D::itemEnabled(QString name)
         QList<QPair<double,QString> > strlist;
         QVector<double> xlist;
         QVector<double> ylist;
-        QMap<quint64,QVariant> values = m_tableModel->getValues(parent,child);
-        if (values.size() == 0)
+        // Numeric fields are shared straight out of the model, only text
+        // fields need the per value conversion
+        if (!m_tableModel->getNumericValues(parent,child,xlist,ylist))
+        {
+            QMap<quint64,QVariant> values = m_tableModel->getValues(parent,child);
+            for (QMap<quint64,QVariant>::const_iterator i = values.constBegin();i!=values.constEnd();i++)
+            {
+                if (i.value().type() == QVariant::String)
+                {
+                    QString graphvaluestr = i.value().toString();
+                    strlist.append(QPair<double,QString>(i.key(),graphvaluestr));
+                    isstr = true;
+                }
+                else
+                {
+                    double graphvalue = i.value().toDouble();
+                    ylist.append(graphvalue);
+                }
+                xlist.append(i.key());
+
+            }
+        }
+        if (xlist.size() == 0)
         {
             //No values!
             m_graphCount++; //Prevent crash when it tries to disable
             ui.dataSelectionScreen->disableItem(name);
             return;
         }
-        for (QMap<quint64,QVariant>::const_iterator i = values.constBegin();i!=values.constEnd();i++)
-        {
-            if (i.value().type() == QVariant::String)
-            {
-                QString graphvaluestr = i.value().toString();
-                strlist.append(QPair<double,QString>(i.key(),graphvaluestr));
-                isstr = true;
-            }
-            else
-            {
-                double graphvalue = i.value().toDouble();
-                ylist.append(graphvalue);
-            }
-            xlist.append(i.key());
-
-        }
         QCPAxis *axis = m_wideAxisRect->addAxis(QCPAxis::atLeft);
         axis->setLabel(name);
 
@@ -945,7 +1070,17 @@ void AP2DataPlot2D::itemEnabled(QString name)
         axis->setLabelColor(color);
         axis->setTickLabelColor(color);
         axis->setTickLabelColor(color); // add an extra axis on the left and color its numbers
-        QCPGraph *mainGraph1 = m_plot->addGraph(m_wideAxisRect->axis(QCPAxis::atBottom), m_wideAxisRect->axis(QCPAxis::atLeft,m_graphCount++));
+        QCPGraph *mainGraph1 = 0;
+        if (isstr)
+        {
+            mainGraph1 = m_plot->addGraph(m_wideAxisRect->axis(QCPAxis::atBottom), m_wideAxisRect->axis(QCPAxis::atLeft,m_graphCount++));
+        }
+        else
+        {
+            // Plots straight from the model's vectors, with level of detail
+            mainGraph1 = new AP2DataPlotGraph(m_wideAxisRect->axis(QCPAxis::atBottom), m_wideAxisRect->axis(QCPAxis::atLeft,m_graphCount++),xlist,ylist);
+            m_plot->addPlottable(mainGraph1);
+        }
         m_graphNameList.append(name);
         QCPAxis *xAxis = m_wideAxisRect->axis(QCPAxis::atBottom);
 
@@ -989,42 +1124,26 @@ void AP2DataPlot2D::itemEnabled(QString name)
 
             }
         }
-        else
-        {
-            mainGraph1->setData(xlist, ylist);
-        }
         mainGraph1->rescaleValueAxis();
         if (m_graphCount <= 2)
         {
             mainGraph1->rescaleKeyAxis();
             m_wideAxisRect->axis(QCPAxis::atBottom)->setRangeLower(xlist.at(0));
         }
-
+        // Nothing else marks a loaded log dirty, draw the new graph on the next tick
+        m_onlineDirty = true;
         return;
     } //if (m_logLoaded)
     else
     {
-        if (m_onlineValueMap.contains(name))
+        int id = m_onlineSeriesNames.value(name,-1);
+        if (id >= 0)
         {
+            OnlineSeries &series = m_onlineSeries[id];
             QVector<double> xlist;
             QVector<double> ylist;
-
-            float min = m_onlineValueMap[name][0].second;
-            float max = m_onlineValueMap[name][0].second;
-            for (int j=0;j<m_onlineValueMap[name].size();j++)
-            {
-                xlist.append(m_onlineValueMap[name][j].first);
-                double val = m_onlineValueMap[name][j].second;
-                if (val > max)
-                {
-                    max = val;
-                }
-                if (val < min)
-                {
-                    min = val;
-                }
-                ylist.append(val);
-            }
+            series.copy(0,xlist,ylist);
+            series.pending = 0;
             QCPAxis *axis = m_wideAxisRect->addAxis(QCPAxis::atLeft);
             axis->setLabel(name);
             QColor color = QColor::fromRgb(rand()%255,rand()%255,rand()%255);
@@ -1054,9 +1173,12 @@ void AP2DataPlot2D::itemEnabled(QString name)
             graph.graph=  mainGraph1;
             graph.isInGroup = false;
             graph.isManualRange = false;
+            graph.seriesId = id;
             m_graphClassMap[name] = graph;
 
             mainGraph1->setPen(QPen(color, 1));
+            // Show the history now, even if no new samples arrive
+            m_onlineDirty = true;
         }
     }
 }
@@ -1121,7 +1243,9 @@ void AP2DataPlot2D::clearGraph()
     }
     m_currentIndex = QDateTime::currentMSecsSinceEpoch();
     m_startIndex = m_currentIndex;
-    m_onlineValueMap.clear();
+    m_onlineSeries.clear();
+    m_onlineSeriesIds.clear();
+    m_onlineSeriesNames.clear();
     m_plot->replot();
 }
 
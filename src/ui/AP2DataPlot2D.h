@@ -34,6 +34,7 @@ This file is part of the APM_PLANNER project
 #include "MAVLinkDecoder.h"
 #include "kmlcreator.h"
 #include "qcustomplot.h"
+#include "AP2DataPlotGraph.h"
 #include "DroneshareUploadDialog.h"
 
 #include "AP2DataPlotThread.h"
@@ -59,6 +60,9 @@ public:
     explicit AP2DataPlot2D(QWidget *parent = 0,bool isIndependant = false);
     ~AP2DataPlot2D();
     void loadLog(QString filename);
+    //How long live telemetry is kept on the graph, in seconds
+    void setOnlineRetention(int seconds);
+    int getOnlineRetention() const { return m_onlineRetention; }
 
 public slots:
     void showLogDownloadDialog();
@@ -103,6 +107,8 @@ private slots:
     void valueChanged(const int uasid, const QString& name, const QString& unit, const QVariant& value,const quint64 msecs);
     //Called by every valueChanged function to actually save the value/graph it.
     void updateValue(const int uasId, const QString& name, const QString& unit, const double value, const quint64 msec,bool integer = true);
+    //Frame timer, hands the samples received since the last frame to the graphs
+    void updateTimerTick();
 
     void navModeChanged(int uasid, int mode, const QString& text);
 
@@ -165,6 +171,7 @@ private:
     class Graph
     {
     public:
+        Graph() : isManualRange(false),isInGroup(false),axisIndex(0),axis(0),graph(0),seriesId(-1) {}
         bool isManualRange;
         QString groupName;
         bool isInGroup;
@@ -173,8 +180,34 @@ private:
         QCPGraph *graph;
         QList<QCPAbstractItem*> itemList;
         QMap<double,QString> modeMap;
+        int seriesId; //Index into m_onlineSeries for live graphs, -1 otherwise
     };
 
+    //Fixed capacity ring of the samples of one live telemetry field
+    class OnlineSeries
+    {
+    public:
+        OnlineSeries() : head(0),count(0),pending(0),integer(true) {}
+        explicit OnlineSeries(const QString& seriesName) : name(seriesName),head(0),count(0),pending(0),integer(true) {}
+        void append(double key,double value);
+        //Drop samples older than key
+        void removeBefore(double key);
+        double keyAt(int i) const { return keys.at((head + i) % keys.size()); }
+        double valueAt(int i) const { return values.at((head + i) % values.size()); }
+        //Copy samples [from,count) out of the ring
+        void copy(int from,QVector<double> &keyList,QVector<double> &valueList) const;
+
+        QString name;
+        QVector<double> keys;
+        QVector<double> values;
+        int head; //Oldest sample
+        int count;
+        int pending; //Samples not yet added to the graph
+        bool integer;
+    };
+    static const int OnlineSeriesCapacity = 65536; //Samples kept per live field
+    static const int FrameInterval = 100; //Msecs between batched graph updates
+
     QMap<QString,Graph> m_graphClassMap;
 
     bool m_showOnlyActive;
@@ -184,8 +217,15 @@ private:
     QMap<QString,QCPRange> m_graphGroupRanges;
     //Map from the spreadsheet view row name (ATT,GPS,etc), to the header names (roll,pitch,yaw or long,lat,alt)
     QMap<QString,QString> m_tableHeaderNameMap;
-    //Graph name to list of values for "online" mode
-    QMap<QString,QList<QPair<double,double> > > m_onlineValueMap;
+    //Values for "online" mode, one ring per field. Fields are interned to an
+    //index, so a sample costs one hash lookup
+    QVector<OnlineSeries> m_onlineSeries;
+    //Value name as received from the UAS, to series index
+    QHash<QString,int> m_onlineSeriesIds;
+    //Graph name to series index
+    QHash<QString,int> m_onlineSeriesNames;
+    int m_onlineRetention; //Seconds
+    bool m_onlineDirty; //New samples or items since the last replot
     //Map from graph name to list of values for "offline" mode
     QMap<QString,QList<QPair<int,QVariantMap> > > m_dataList;
     QList<QString> loglines;
@@ -194,8 +234,6 @@ private:
 
     QList<QWidget*> m_childGraphList;
 
-    QList<QPair<qint64,double> > m_onlineValueTimeoutList;
-
     //List of graph names, used in m_axisList, m_graphMap,m_graphToGroupMap and the like as the graph name
     QList<QString> m_graphNameList;
     int m_graphCount;
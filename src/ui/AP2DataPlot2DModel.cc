@@ -28,41 +28,27 @@ This file is part of the APM_PLANNER project
 
 
 #include "AP2DataPlot2DModel.h"
-#include <QSqlQuery>
 #include <QDebug>
-#include <QSqlRecord>
-#include <QSqlField>
-#include <QSqlError>
-#include <QUuid>
 #include <QsLog.h>
+#include <qmath.h>
 
 /*
- * This model holds everything in memory in a sqlite database.
- * There are two system tables, then unlimited number of message tables.
+ * This model holds everything in memory in a columnar store.
  *
- * System Tables:
+ * Every message type (ATT, GPS, ...) defined by a FMT message gets a Table.
+ * A table holds one index column, the position of each row in the log, and
+ * one contiguous column per field of the message. Numbers are stored as
+ * doubles, so a field can be handed to the graph without conversion or
+ * copying; string fields are stored as strings.
  *
- * FMT (idx integer PRIMARY KEY, typeid integer,length integer,name varchar(200),format varchar(6000),val varchar(6000));
- *  idx: Index - Position in the file in relation to other values
- *  typeid: typeid, this is unused in most cases
- *  length: length, this is unused in most cases
- *  name: Name of the type defined by the format: ATUN
- *  format: format of the message: BBfffff
- *  val: Comma deliminted field with names of the message fields: Axis,TuneStep,RateMin,RateMax,RPGain,RDGain,SPGain
+ * The table view still sees the log row by row: m_rows maps every model row
+ * to its table and the row inside that table, in the order they were added.
  *
- * INDEX (idx integer PRIMARY KEY, value varchar(200));
- *  idx: Index: Index on graph/table
- *  value: The table name (message type name) that the index points to
- *
- * Message tables are formatted as such:
- *
- * ATUN (idx integer PRIMARY KEY, Axis integer, TuneStep integer, RateMin real, RateMax real, RPGain real, RDGain real, SPGain real);
- *  The types are defined by the format (in this case, BBfffff)
- *  inside AP2DataPlot2DModel::makeCreateTableString.
+ * The FMT messages themselves are kept in m_fmtStringList and the Table
+ * members typeId, length, format and labels.
  */
 AP2DataPlot2DModel::AP2DataPlot2DModel(QObject *parent) :
     QAbstractTableModel(parent),
-    m_databaseName(QUuid::createUuid().toString()),
     m_rowCount(0),
     m_columnCount(0),
     m_currentRow(0),
@@ -70,106 +56,38 @@ AP2DataPlot2DModel::AP2DataPlot2DModel(QObject *parent) :
     m_firstIndex(0),
     m_lastIndex(0)
 {
-    m_sharedDb = QSqlDatabase::addDatabase("QSQLITE",m_databaseName);
-    m_sharedDb.setDatabaseName(":memory:");
-
-    //  Open DB and start transaction
-    if (!m_sharedDb.open())
-    {
-        setError("Error opening shared database " + m_sharedDb.lastError().text());
-        return;
-    }
-    if (!m_sharedDb.transaction())
-    {
-        setError("Unable to start database transaction "  + m_sharedDb.lastError().text());
-        return;
-    }
-
-    // Create FMT Table and prepare insert query
-    if (!createFMTTable())
-    {
-        return; //Error already emitted.
-    }
-    m_fmtInsertQuery = queryPtr(new QSqlQuery(m_sharedDb));
-    if (!createFMTInsert(m_fmtInsertQuery))
-    {
-        return;  //Error already emitted.
-    }
-
-    // Create index table and prepare insert query
-    if (!createIndexTable())
-    {
-        return;   //Error already emitted.
-    }
-    m_indexinsertquery = queryPtr(new QSqlQuery(m_sharedDb));
-    if (!createIndexInsert(m_indexinsertquery))
-    {
-        return;  //Error already emitted.
-    }
-
-    if (!m_sharedDb.commit())
-    {
-        setError("Unable to commit database transaction "  + m_sharedDb.lastError().text());
-        return;
-    }
 }
 
 AP2DataPlot2DModel::~AP2DataPlot2DModel()
 {
-    QSqlDatabase::removeDatabase(m_databaseName);
 }
 
 QMap<QString,QList<QString> > AP2DataPlot2DModel::getFmtValues()
 {
     QMap<QString,QList<QString> > retval;
-    QSqlQuery fmtquery(m_sharedDb);
-    fmtquery.prepare("SELECT * FROM 'FMT';");
-    fmtquery.exec();
-    while (fmtquery.next())
-    {
-        QSqlRecord record = fmtquery.record();
-        QString name = record.value(3).toString();
-        QSqlQuery indexquery(m_sharedDb);
-        if (!indexquery.prepare("SELECT * FROM 'INDEX' WHERE value = '" + name + "';"))
-        {
-            continue;
-        }
-        if (!indexquery.exec())
-        {
-            continue;
-        }
-        if (!indexquery.next())
+    foreach (const Table &table, m_tables)
+    {
+        if (table.index.isEmpty())
         {
             //No records
             continue;
         }
-        if (!m_headerStringList.contains(name))
+        if (!m_headerStringList.contains(table.name))
         {
             continue;
         }
-        retval.insert(name,QList<QString>());
-        for (int i=0;i<m_headerStringList[name].size();i++)
-        {
-            retval[name].append(m_headerStringList[name].at(i));
-        }
+        retval.insert(table.name,m_headerStringList.value(table.name));
     }
     return retval;
 }
 QString AP2DataPlot2DModel::getFmtLine(const QString& name)
 {
-    QSqlQuery fmtquery(m_sharedDb);
-    fmtquery.prepare("SELECT * FROM 'FMT' WHERE name = '" + name + "';");
-    if (!fmtquery.exec())
-    {
-        //QMessageBox::information(0,"Error","Error selecting from table 'FMT' " + m_sharedDb.lastError().text());
-        //return;
-    }
-    if (fmtquery.next())
+    int tableIndex = m_tableIndex.value(name,-1);
+    if (tableIndex >= 0)
     {
-        QSqlRecord record = fmtquery.record();
-        QString name = record.value(3).toString();
-        QString vars = record.value(5).toString();
-        QString format = record.value(4).toString();
+        const Table &table = m_tables.at(tableIndex);
+        QString vars = table.labels.join(",");
+        QString format = table.format;
         int size = 0;
         for (int i=0;i<format.size();i++)
         {
@@ -212,7 +130,7 @@ QString AP2DataPlot2DModel::getFmtLine(const QString& name)
                 QLOG_DEBUG() << "Unknown format character (" << format.at(i).toLatin1() << "); export will be bad";
             }
         }
-        QString formatline = "FMT, " + QString::number(record.value(1).toInt()) + ", " + QString::number(size+3) + ", " + name + ", " + format + ", " + vars;
+        QString formatline = "FMT, " + QString::number(table.typeId) + ", " + QString::number(size+3) + ", " + name + ", " + format + ", " + vars;
         return formatline;
     }
     return "";
@@ -220,38 +138,42 @@ QString AP2DataPlot2DModel::getFmtLine(const QString& name)
 QMap<quint64,QString> AP2DataPlot2DModel::getModeValues()
 {
     QMap<quint64,QString> retval;
-    QSqlQuery modequery(m_sharedDb);
-    modequery.prepare("SELECT * FROM 'MODE';");
-    if (!modequery.exec())
+    int tableIndex = m_tableIndex.value("MODE",-1);
+    if (tableIndex < 0)
     {
         //No mode?
         QLOG_DEBUG() << "Graph loaded with no mode table. Running anyway, but text modes will not be available";
-        modequery.prepare("SELECT * FROM 'HEARTBEAT';");
-        if (!modequery.exec())
+        tableIndex = m_tableIndex.value("HEARTBEAT",-1);
+        if (tableIndex < 0)
         {
             QLOG_DEBUG() << "Graph loaded with no heartbeat either. No modes available";
+            return retval;
         }
     }
+    const Table &table = m_tables.at(tableIndex);
+    const bool hasMode = table.columnIndex.contains("Mode");
+    const bool hasCustomMode = table.columnIndex.contains("custom_mode");
+    const bool hasModeNum = table.columnIndex.contains("ModeNum");
+
     QString lastmode = "";
     MAV_TYPE foundtype = MAV_TYPE_GENERIC;
     bool custom_mode = false;
 
-    while (modequery.next())
+    for (int row=0;row<table.index.size();row++)
     {
-        QSqlRecord record = modequery.record();
-        quint64 index = record.value(0).toLongLong();
+        quint64 index = static_cast<quint64>(table.index.at(row));
         QString mode = "";
-        if (record.contains("Mode"))
+        if (hasMode)
         {
-            mode = record.value("Mode").toString();
+            mode = value(table,"Mode",row).toString();
         }
-        else if (record.contains("custom_mode"))
+        else if (hasCustomMode)
         {
             custom_mode = true;
-            int modeint = record.value("custom_mode").toString().toInt();
+            int modeint = value(table,"custom_mode",row).toString().toInt();
             if (foundtype == MAV_TYPE_GENERIC)
             {
-                int type = record.value("type").toString().toInt();
+                int type = value(table,"type",row).toString().toInt();
                 foundtype = static_cast<MAV_TYPE>(type);
             }
             if (foundtype == MAV_TYPE_FIXED_WING)
@@ -276,14 +198,14 @@ QMap<quint64,QString> AP2DataPlot2DModel::getModeValues()
 
         if (!ok && !custom_mode)
         {
-            if (record.contains("ModeNum"))
+            if (hasModeNum)
             {
-                mode = record.value("ModeNum").toString();
+                mode = value(table,"ModeNum",row).toString();
             }
             else
             {
-                QLOG_DEBUG() << "Unable to determine Mode number in log" << record.value("Mode").toString();
-                mode = record.value("Mode").toString();
+                QLOG_DEBUG() << "Unable to determine Mode number in log" << value(table,"Mode",row).toString();
+                mode = value(table,"Mode",row).toString();
             }
         }
         if (lastmode != mode)
@@ -300,19 +222,18 @@ QMap<quint64,QString> AP2DataPlot2DModel::getModeValues()
 QMap<quint64,ErrorType> AP2DataPlot2DModel::getErrorValues()
 {
     QMap<quint64,ErrorType> retval;
-    QSqlQuery errorquery(m_sharedDb);
-    errorquery.prepare("SELECT * FROM 'ERR';");
-    if (errorquery.exec())
+    int tableIndex = m_tableIndex.value("ERR",-1);
+    if (tableIndex >= 0)
     {
-        while (errorquery.next())
+        const Table &table = m_tables.at(tableIndex);
+        for (int row=0;row<table.index.size();row++)
         {
-            QSqlRecord record = errorquery.record();
-            quint64 index = static_cast<quint64>(record.value(0).toLongLong());
+            quint64 index = static_cast<quint64>(table.index.at(row));
             ErrorType error;
 
-            if (!error.setFromSqlRecord(record))
+            if (!error.setFromVariantMap(record(table,row)))
             {
-                QLOG_DEBUG() << "Not all data could be read from SQL-Record. Schema mismatch?!";
+                QLOG_DEBUG() << "Not all data could be read from ERR record. Format mismatch?!";
             }
 
             retval.insert(index, error);
@@ -320,7 +241,7 @@ QMap<quint64,ErrorType> AP2DataPlot2DModel::getErrorValues()
     }
     else
     {
-        //Errorquery returned no result - No error?
+        //No error table - No error?
         QLOG_DEBUG() << "Graph loaded with no error table. This is perfect!";
     }
 
@@ -377,58 +298,27 @@ QVariant AP2DataPlot2DModel::data ( const QModelIndex & index, int role) const
     }
     if (index.row() >= m_rowCount)
     {
-        QLOG_ERROR() << "Accessing a Database row that does not exist! Row was: " << index.row();
+        QLOG_ERROR() << "Accessing a model row that does not exist! Row was: " << index.row();
         return QVariant();
     }
 
+    const RowRef &ref = m_rows.at(index.row());
+    const Table &table = m_tables.at(ref.table);
     if (index.column() == 0)
     {
-        // Column 0 is the DB index of the log data
-        return QVariant(QString::number(m_rowIndexToDBIndex[index.row()].first));
+        // Column 0 is the index of the log data
+        return QVariant(QString::number(static_cast<quint64>(table.index.at(ref.row))));
     }
     if (index.column() == 1)
     {
         // Column 1 is the name of the log data (ATT,ATUN...)
-        return QVariant(m_rowIndexToDBIndex[index.row()].second);
+        return QVariant(table.name);
     }
-
-    // The data is mostly read row by row. This means first all columns of row 1 are read and then
-    // all columns of row 2 and than all colums of row 3 and so on.
-    // This cache reads a whole row from DB and caches it internally. All consecutive accesses to this
-    // row will be answered from the cache.
-    if (index.row() != m_prefetchedRowIndex.row())
-    {
-        m_prefetchedRowData.clear();
-        QString tableIndex = QString::number(m_rowIndexToDBIndex[index.row()].first);
-        QString tableName  = m_rowIndexToDBIndex[index.row()].second;
-
-        queryPtr selectRowQuery = m_msgNameToPrepearedSelectQuery.value(tableName);
-        selectRowQuery->bindValue(":val", tableIndex);
-        if (selectRowQuery->exec())
-        {
-            int recordCount = selectRowQuery->record().count();
-            if (!selectRowQuery->next())
-            {
-                return QVariant();
-            }
-            for (int i = 0; i < recordCount; ++i)
-            {
-                m_prefetchedRowData.push_back(selectRowQuery->value(i));
-            }
-            m_prefetchedRowIndex = index;
-            selectRowQuery->finish();   // must be called because we will reuse this query
-        }
-        else
-        {
-            qDebug() << "Unable to exec table query:" << selectRowQuery->lastError().text();
-        }
-    }
-
-    if ((index.column()-1) >= m_prefetchedRowData.size())
+    if ((index.column()-2) >= table.columns.size())
     {
         return QVariant();
     }
-    return m_prefetchedRowData[index.column()-1];
+    return value(table.columns.at(index.column()-2),ref.row);
 }
 
 void AP2DataPlot2DModel::selectedRowChanged(QModelIndex current,QModelIndex previous)
@@ -453,7 +343,7 @@ void AP2DataPlot2DModel::selectedRowChanged(QModelIndex current,QModelIndex prev
 
     if (current.row() < m_rowCount)
     {
-        m_currentHeaderItems = m_headerStringList.value(m_rowIndexToDBIndex[current.row()].second);
+        m_currentHeaderItems = m_headerStringList.value(m_tables.at(m_rows.at(current.row()).table).name);
     }
     else
     {
@@ -464,160 +354,127 @@ void AP2DataPlot2DModel::selectedRowChanged(QModelIndex current,QModelIndex prev
 
 bool AP2DataPlot2DModel::hasType(const QString& name)
 {
-    return m_msgNameToPrepearedInsertQuery.contains(name);
+    return m_tableIndex.contains(name);
 }
 
 bool AP2DataPlot2DModel::addType(QString name,int type,int length,QString types,QStringList names)
 {
-    if (!m_msgNameToPrepearedInsertQuery.contains(name))
+    if (!m_tableIndex.contains(name))
     {
-        QString createstring = makeCreateTableString(name,types,names);
-        QString variablenames = "";
-        for (int i=0;i<names.size();i++)
-        {
-            variablenames += names.at(i) + ((i < names.size()-1) ? "," : "");
-        }
-        QString insertstring = makeInsertTableString(name,names);
-
-        //if (!query->prepare("INSERT INTO 'FMT' (idx,typeid,length,name,format,val) values (:idx,:typeid,:length,:name,:format,:val);"))
-        m_fmtInsertQuery->bindValue(":idx",m_fmtIndex++);
-        m_fmtInsertQuery->bindValue(":typeid",type);
-        m_fmtInsertQuery->bindValue(":length",length);
-        m_fmtInsertQuery->bindValue(":name",name);
-        m_fmtInsertQuery->bindValue(":format",types);
-        m_fmtInsertQuery->bindValue(":val",variablenames);
+        QString variablenames = names.join(",");
         QList<QString> list;
         list.append("FMT");
-        list.append(QString::number(m_fmtIndex-1));
+        list.append(QString::number(m_fmtIndex++));
         list.append(QString::number(type));
         list.append(QString::number(length));
         list.append(types);
         list.append(variablenames);
         m_fmtStringList.append(list);
-        if (!m_fmtInsertQuery->exec())
-        {
-            setError("FAILED TO FMT: " + m_fmtInsertQuery->lastError().text());
-            return false;
-        }
-        m_indexinsertquery->bindValue(":idx",m_fmtIndex-1);
-        m_indexinsertquery->bindValue(":value","FMT");
-        if (!m_indexinsertquery->exec())
-        {
-            setError("Error execing index: " + name + " " + m_indexinsertquery->lastError().text());
-            return false;
-        }
 
-        // Create table for measurement of type "name"
-        QSqlQuery create(m_sharedDb);
-        if (!create.prepare(createstring))
-        {
-            setError("Unable to create: " + create.lastError().text());
-            return false;
-        }
-        if (!create.exec())
-        {
-            setError("Unable to exec create: " + create.lastError().text());
-            return false;
-        }
-        // Prepare an insert query for the created table above and store it to speed up the inserting process later
-        queryPtr prepQuery = queryPtr(new QSqlQuery(m_sharedDb));
-        if (!prepQuery->prepare(insertstring.replace("insert or replace","insert")))
-        {
-            setError("Error preparing insertquery: " + name + " " + prepQuery->lastError().text());
-            return false;
-        }
-        m_msgNameToPrepearedInsertQuery.insert(name, prepQuery);
-        // And prepare a select query for rows of this table
-        prepQuery = queryPtr(new QSqlQuery(m_sharedDb));
-        if (!prepQuery->prepare("SELECT * FROM " + name + " WHERE idx = :val"))
-        {
-            setError("Error preparing select query: " + name + " " + prepQuery->lastError().text());
-            return false;
+        // Create the columns for measurement of type "name"
+        Table table;
+        table.name = name;
+        table.typeId = type;
+        table.length = length;
+        table.format = types;
+        table.labels = names;
+        table.columns.resize(names.size());
+        for (int j=0;j<names.size();j++)
+        {
+            Column &column = table.columns[j];
+            column.name = names.at(j);
+            char typeCode = (j < types.size()) ? types.at(j).toLatin1() : '\0';
+            switch (typeCode)
+            {
+            case 'b': case 'B': case 'h': case 'H': case 'i': case 'I':
+            case 'L': case 'M': case 'q': case 'Q':
+                column.isInteger = true;
+                break;
+            case 'n': case 'N': case 'Z':
+                column.isString = true;
+                break;
+            case 'f': case 'd': case 'c': case 'C': case 'e': case 'E':
+                break;
+            default:
+                QLOG_DEBUG() << "AP2DataPlot2DModel::addType(): NEW UNKNOWN VALUE" << typeCode;
+                break;
+            }
+            table.columnIndex.insert(column.name,j);
         }
-        m_msgNameToPrepearedSelectQuery.insert(name, prepQuery);
-
+        m_tableIndex.insert(name,m_tables.size());
+        m_tables.append(table);
     }
     if (!m_headerStringList.contains(name))
     {
-        m_headerStringList.insert(name,QList<QString>());
-        foreach (QString val,names)
-        {
-            m_headerStringList[name].append(val);
-        }
+        m_headerStringList.insert(name,names);
     }
     return true;
 }
 QMap<quint64,QVariant> AP2DataPlot2DModel::getValues(const QString& parent,const QString& child)
 {
-    int index = getChildIndex(parent,child);
-    QSqlQuery itemquery(m_sharedDb);
-    itemquery.prepare("SELECT * FROM '" + parent + "';");
-    itemquery.exec();
     QMap<quint64,QVariant> retval;
-    while (itemquery.next())
+    int tableIndex = m_tableIndex.value(parent,-1);
+    int index = getChildIndex(parent,child);
+    if (tableIndex < 0 || index < 0)
+    {
+        return retval;
+    }
+    const Table &table = m_tables.at(tableIndex);
+    const Column &column = table.columns.at(index);
+    for (int row=0;row<table.index.size();row++)
     {
-        QSqlRecord record = itemquery.record();
-        quint64 graphindex = record.value(0).toLongLong();
-        QVariant graphvalue= record.value(index+1);
-        retval.insert(graphindex,graphvalue);
+        retval.insert(static_cast<quint64>(table.index.at(row)),value(column,row));
     }
     return retval;
 }
 
-int AP2DataPlot2DModel::getChildIndex(const QString& parent,const QString& child)
+bool AP2DataPlot2DModel::getNumericValues(const QString& parent,const QString& child,QVector<double> &index,QVector<double> &values)
 {
-
-    QSqlQuery tablequery(m_sharedDb);
-    //tablequery.prepare("SELECT * FROM '" + parent + "';");
-    if (!tablequery.prepare("SELECT * FROM 'FMT' WHERE name = '" + parent + "';"))
-    {
-        QLOG_DEBUG() << "Error preparing select:" + tablequery.lastError().text();
-        return -1;
-    }
-    if (!tablequery.exec())
-    {
-        QLOG_DEBUG() << "Error execing select:" + tablequery.lastError().text();
-        return -1;
-    }
-    if (!tablequery.next())
+    int tableIndex = m_tableIndex.value(parent,-1);
+    int columnIndex = getChildIndex(parent,child);
+    if (tableIndex < 0 || columnIndex < 0)
     {
-        return -1;
+        return false;
     }
-    QSqlRecord record = tablequery.record();
-    QStringList valuessplit = record.value(5).toString().split(","); //comma delimited list of names
-    bool found = false;
-    int index = 0;
-    for (int i=0;i<valuessplit.size();i++)
+    const Table &table = m_tables.at(tableIndex);
+    const Column &column = table.columns.at(columnIndex);
+    if (column.isString)
     {
-        if (valuessplit.at(i) == child)
-        {
-            found = true;
-            index = i;
-            i = valuessplit.size();
-        }
+        return false;
     }
-    if (!found)
+    index = table.index;
+    values = column.numbers;
+    return true;
+}
+
+int AP2DataPlot2DModel::getChildIndex(const QString& parent,const QString& child)
+{
+    int tableIndex = m_tableIndex.value(parent,-1);
+    if (tableIndex < 0)
     {
         return -1;
     }
-    return index;
+    return m_tables.at(tableIndex).columnIndex.value(child,-1);
 }
 bool AP2DataPlot2DModel::startTransaction()
 {
-    if (!m_sharedDb.transaction())
-    {
-        setError("Unable to start transaction to database: " + m_sharedDb.lastError().text());
-        return false;
-    }
+    // Nothing to prepare, the store is only written by the loader thread
     return true;
 }
 bool AP2DataPlot2DModel::endTransaction()
 {
-    if (!m_sharedDb.commit())
+    // Loading is done, give back the slack of the growing vectors
+    for (int i=0;i<m_tables.size();i++)
     {
-        setError("Unable to commit to database: " + m_sharedDb.lastError().text());
-        return false;
+        Table &table = m_tables[i];
+        table.index.squeeze();
+        for (int j=0;j<table.columns.size();j++)
+        {
+            table.columns[j].numbers.squeeze();
+            table.columns[j].strings.squeeze();
+        }
     }
+    m_rows.squeeze();
     return true;
 }
 
@@ -629,32 +486,45 @@ bool AP2DataPlot2DModel::addRow(QString name,QList<QPair<QString,QVariant> >  va
     }
     m_lastIndex = index;
 
-    //Add a row to a previously defined message type using the already prepared insert query
-    queryPtr insertQuery = m_msgNameToPrepearedInsertQuery.value(name);
-    if (!insertQuery)
+    //Add a row to a previously defined message type
+    int tableIndex = m_tableIndex.value(name,-1);
+    if (tableIndex < 0)
     {
-        setError("No prepared insert query available for message: " + name);
+        setError("No table available for message: " + name);
         return false;
     }
-    insertQuery->bindValue(":idx", index);
+    Table &table = m_tables[tableIndex];
+    const int row = table.index.size();
+    table.index.append(index);
     for (int i=0;i<values.size();i++)
     {
-        insertQuery->bindValue(":" + values.at(i).first, values.at(i).second);
-    }
-    if (!insertQuery->exec())
-    {
-        setError("Error execing insert query: " + insertQuery->lastError().text());
-        return false;
+        // Values normally arrive in field order, only search if they do not
+        int col = i;
+        if (col >= table.columns.size() || table.columns.at(col).name != values.at(i).first)
+        {
+            col = table.columnIndex.value(values.at(i).first,-1);
+            if (col < 0)
+            {
+                continue;
+            }
+        }
+        Column &column = table.columns[col];
+        if ((column.isString ? column.strings.size() : column.numbers.size()) == row)
+        {
+            appendValue(column,values.at(i).second);
+        }
     }
-    else
+    // Fields missing from this row are empty
+    for (int j=0;j<table.columns.size();j++)
     {
-        insertQuery->finish();  // must be called in case of a reusage of this query
-        m_indexinsertquery->bindValue(":idx", index);
-        m_indexinsertquery->bindValue(":value", name);
-        if (!m_indexinsertquery->exec())
+        Column &column = table.columns[j];
+        if (column.isString && column.strings.size() == row)
+        {
+            column.strings.append(QString());
+        }
+        else if (!column.isString && column.numbers.size() == row)
         {
-            setError("Error execing:" + m_indexinsertquery->executedQuery() + " error was " + m_indexinsertquery->lastError().text());
-            return false;
+            column.numbers.append(qQNaN());
         }
     }
 
@@ -666,162 +536,84 @@ bool AP2DataPlot2DModel::addRow(QString name,QList<QPair<QString,QVariant> >  va
         m_columnCount = values.size() +2;
     }
 
-    m_rowIndexToDBIndex.push_back(QPair<quint64,QString>(index,name));
+    RowRef ref;
+    ref.table = tableIndex;
+    ref.row = row;
+    m_rows.append(ref);
     m_rowCount++;
     return true;
 }
-QString AP2DataPlot2DModel::makeCreateTableString(QString tablename, QString formatstr,QStringList variablestr)
+
+void AP2DataPlot2DModel::appendValue(Column &column, const QVariant &value)
 {
-    QString mktable = "CREATE TABLE '" + tablename + "' (idx integer PRIMARY KEY";
-    for (int j=0;j<variablestr.size();j++)
+    if (column.isString)
     {
-        QString name = variablestr[j].trimmed();
-        //name = "\"" + name + "\"";
-        QChar typeCode = formatstr.at(j);
-        if (typeCode == 'b') //int8_t
-        {
-            mktable.append("," + name + " integer");
-        }
-        else if (typeCode == 'B') //uint8_t
-        {
-            mktable.append("," + name + " integer");
-        }
-        else if (typeCode == 'h') //int16_t
-        {
-            mktable.append("," + name + " integer");
-        }
-        else if (typeCode == 'H') //uint16_t
-        {
-            mktable.append("," + name + " integer");
-        }
-        else if (typeCode == 'i') //int32_t
-        {
-            mktable.append("," + name + " integer");
-        }
-        else if (typeCode == 'I') //uint32_t
-        {
-            mktable.append("," + name + " integer");
-        }
-        else if (typeCode == 'f') //float
-        {
-            mktable.append("," + name + " real");
-        }
-        else if (typeCode == 'd') //double
-        {
-            mktable.append("," + name + " real");
-        }
-        else if (typeCode == 'N') //char(16)
-        {
-            mktable.append("," + name + " text");
-        }
-        else if (typeCode == 'Z') //char(64)
-        {
-            mktable.append("," + name + " text");
-        }
-        else if (typeCode == 'c') //int16_t * 100
-        {
-            mktable.append("," + name + " real");
-        }
-        else if (typeCode == 'C') //uint16_t * 100
-        {
-            mktable.append("," + name + " real");
-        }
-        else if (typeCode == 'e') //int32_t * 100
-        {
-            mktable.append("," + name + " real");
-        }
-        else if (typeCode == 'E') //uint32_t * 100
-        {
-            mktable.append("," + name + " real");
-        }
-        else if (typeCode == 'L') //uint32_t lon/lat
-        {
-            mktable.append("," + name + " integer");
-        }
-        else if (typeCode == 'M') //uint8_t
-        {
-            mktable.append("," + name + " integer");
-        }
-        else if (typeCode == 'q') //int64_t
-        {
-            mktable.append("," + name + " integer");
-        }
-        else if (typeCode == 'Q') //uint64_t
-        {
-            mktable.append("," + name + " integer");
-        }
-        else
-        {
-            QLOG_DEBUG() << "AP2DataPlotThread::makeCreateTableString(): NEW UNKNOWN VALUE" << typeCode;
-        }
+        column.strings.append(value.toString());
+        return;
     }
-    mktable.append(");");
-    return mktable;
-}
-QString AP2DataPlot2DModel::makeInsertTableString(QString tablename, QStringList variablestr)
-{
-    QString inserttable = "insert or replace into '" + tablename + "' (idx";
-    QString insertvalues = "(:idx,";
-    for (int j=0;j<variablestr.size();j++)
-    {
-        QString name = variablestr[j].trimmed();
-        inserttable.append("," + name + "");
-        insertvalues.append(":" + name + ((j < variablestr.size()-1) ? "," : ""));
-    }
-    inserttable.append(")");
-    insertvalues.append(")");
-    QString final = inserttable + " values " + insertvalues + ";";
-    return final;
-}
-bool AP2DataPlot2DModel::createFMTTable()
-{
-    QSqlQuery fmttablecreate(m_sharedDb);
-    if (!fmttablecreate.prepare("CREATE TABLE 'FMT' (idx integer PRIMARY KEY, typeid integer,length integer,name varchar(200),format varchar(6000),val varchar(6000));"))
+    bool ok = false;
+    double number = value.toDouble(&ok);
+    if (ok)
     {
-        setError("Prapre create FMT table failed: " + fmttablecreate.lastError().text());
-        return false;
+        column.numbers.append(number);
+        return;
     }
-    if (!fmttablecreate.exec())
+    if (value.type() != QVariant::String)
     {
-        QLOG_ERROR() << "Error creating FMT table: " + fmttablecreate.lastError().text();
-        setError("Exec create FMT table failed: " + fmttablecreate.lastError().text());
-        return false;
+        column.numbers.append(qQNaN());
+        return;
     }
-    return true;
-}
-bool AP2DataPlot2DModel::createFMTInsert(queryPtr &query)
-{
-    if (!query->prepare("INSERT INTO 'FMT' (idx,typeid,length,name,format,val) values (:idx,:typeid,:length,:name,:format,:val);"))
+    // Text in a numeric field, e.g. the mode name of an ASCII log. Keep
+    // the field as strings from now on.
+    column.strings.reserve(column.numbers.capacity());
+    for (int row=0;row<column.numbers.size();row++)
     {
-        setError("Insert into FMT prepare failed: " + query->lastError().text());
-        return false;
+        column.strings.append(this->value(column,row).toString());
     }
-    return true;
+    column.numbers = QVector<double>();
+    column.isString = true;
+    column.strings.append(value.toString());
 }
-bool AP2DataPlot2DModel::createIndexTable()
+
+QVariant AP2DataPlot2DModel::value(const Column &column, int row) const
 {
-    QSqlQuery indextablecreate(m_sharedDb);
-    if (!indextablecreate.prepare("CREATE TABLE 'INDEX' (idx integer PRIMARY KEY, value varchar(200));"))
+    if (column.isString)
     {
-        setError("Error preparing INDEX table: " + m_sharedDb.lastError().text());
-        return false;
+        const QString &str = column.strings.at(row);
+        return str.isNull() ? QVariant() : QVariant(str);
     }
-    if (!indextablecreate.exec())
+    double number = column.numbers.at(row);
+    if (qIsNaN(number))
     {
-        setError("Error creating INDEX table: " + m_sharedDb.lastError().text());
-        return false;
+        return QVariant();
     }
-    return true;
+    if (column.isInteger && number == qFloor(number))
+    {
+        return QVariant(static_cast<qlonglong>(number));
+    }
+    return QVariant(number);
 }
-bool AP2DataPlot2DModel::createIndexInsert(queryPtr &query)
+
+QVariant AP2DataPlot2DModel::value(const Table &table, const QString& name, int row) const
 {
-    if (!query->prepare("INSERT INTO 'INDEX' (idx,value) values (:idx,:value);"))
+    int col = table.columnIndex.value(name,-1);
+    if (col < 0)
     {
-        setError("Insert into Index prepare failed: " + query->lastError().text());
-        return false;
+        return QVariant();
     }
-    return true;
+    return value(table.columns.at(col),row);
 }
+
+QVariantMap AP2DataPlot2DModel::record(const Table &table, int row) const
+{
+    QVariantMap retval;
+    foreach (const Column &column, table.columns)
+    {
+        retval.insert(column.name,value(column,row));
+    }
+    return retval;
+}
+
 void AP2DataPlot2DModel::setError(QString error)
 {
     QLOG_ERROR() << error;
@@ -31,7 +31,10 @@ This file is part of the APM_PLANNER project
 #define AP2DATAPLOT2DMODEL_H
 
 #include <QAbstractTableModel>
-#include <QSqlDatabase>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+#include <QVariantMap>
 #include <ArduPilotMegaMAV.h>
 
 
@@ -54,6 +57,15 @@ public:
     QMap<quint64, ErrorType> getErrorValues();
     bool hasType(const QString& name);
     QMap<quint64,QVariant> getValues(const QString& parent,const QString& child);
+    /**
+     * @brief getNumericValues
+     *        Hands out the index column and one value column of a message type
+     *        for graphing. Both vectors are implicitly shared with the model,
+     *        so this does not copy any data.
+     *
+     * @return false if the field does not exist or does not hold numbers
+     */
+    bool getNumericValues(const QString& parent,const QString& child,QVector<double> &index,QVector<double> &values);
     int getChildIndex(const QString& parent,const QString& child);
     QString getError() { return m_error; }
     bool endTransaction();
@@ -69,29 +81,62 @@ signals:
 private slots:
 
 private: //helpers
-    typedef QSharedPointer<QSqlQuery> queryPtr;              /// Shared pointer type for QSqlQueries
+    /**
+     * @brief One field of a message type. Values are stored as doubles, which
+     *        holds every DataFlash number type exactly except 64 bit integers
+     *        above 2^53. A column switches to string storage when it receives
+     *        a value that is not a number (e.g. mode names in ASCII logs).
+     */
+    struct Column
+    {
+        Column() : isInteger(false), isString(false) {}
+        QString name;
+        bool isInteger;             /// Integer format type, values are reported as qlonglong
+        bool isString;              /// Values are held in strings instead of numbers
+        QVector<double> numbers;
+        QVector<QString> strings;
+    };
+
+    /**
+     * @brief All rows of one message type, stored column by column
+     */
+    struct Table
+    {
+        Table() : typeId(0), length(0) {}
+        QString name;
+        int typeId;
+        int length;
+        QString format;
+        QStringList labels;
+        QVector<double> index;          /// Shared index column of all fields
+        QVector<Column> columns;
+        QHash<QString,int> columnIndex; /// Field name to position in columns
+    };
+
+    /**
+     * @brief Position of a model row in the tables
+     */
+    struct RowRef
+    {
+        int table;
+        int row;
+    };
 
-    bool createFMTTable();
-    bool createFMTInsert(queryPtr &query);
-    bool createIndexTable();
-    bool createIndexInsert(queryPtr &query);
     void setError(QString error);
-    QString makeCreateTableString(QString tablename, QString formatstr,QStringList variablestr);
-    QString makeInsertTableString(QString tablename, QStringList variablestr);
+    void appendValue(Column &column, const QVariant &value);
+    QVariant value(const Column &column, int row) const;
+    QVariant value(const Table &table, const QString& name, int row) const;
+    QVariantMap record(const Table &table, int row) const;
 
 private:
     QString m_error;
-    QString m_databaseName;
-    QSqlDatabase m_sharedDb;
-    QVector<QPair<quint64,QString> > m_rowIndexToDBIndex;   /// stores relation between Table row index
-                                                            /// and DB index and DB table name
+    QVector<Table> m_tables;
+    QHash<QString,int> m_tableIndex;    /// Message name to position in m_tables
+    QVector<RowRef> m_rows;             /// Table and row of every model row, in log order
     QMap<QString,QList<QString> > m_headerStringList;
     QList<QString> m_currentHeaderItems;
     QList<QList<QString> > m_fmtStringList;
 
-    QMap<QString,queryPtr> m_msgNameToPrepearedInsertQuery;  /// Map holding prepared insert queries to speed up inserts
-    QMap<QString,queryPtr> m_msgNameToPrepearedSelectQuery;  /// Map holding prepared select queries to speed up selects
-
     int m_rowCount;         /// Stores the number of rows held in model.
     int m_columnCount;
     int m_currentRow;
@@ -99,17 +144,6 @@ private:
 
     quint64 m_firstIndex;
     quint64 m_lastIndex;
-
-    queryPtr m_indexinsertquery;
-    queryPtr m_fmtInsertQuery;
-
-    mutable QVector<QVariant> m_prefetchedRowData;  /// holds the cached data used in data(...) method
-    mutable QModelIndex m_prefetchedRowIndex;       /// Stores the index which which is actually in cache
-
-
-
-
-
 };
 
 
@@ -0,0 +1,288 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2015 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+/**
+ * @file
+ *   @brief AP2DataPlot graph with level of detail
+ *
+ */
+
+#include "AP2DataPlotGraph.h"
+#include <algorithm>
+#include <limits>
+
+AP2DataPlotGraph::AP2DataPlotGraph(QCPAxis *keyAxis, QCPAxis *valueAxis, const QVector<double> &keys, const QVector<double> &values) :
+    QCPGraph(keyAxis,valueAxis),
+    m_keys(keys),
+    m_values(values),
+    m_validValueRange(false),
+    m_valueMin(0),
+    m_valueMax(0)
+{
+    if (m_values.size() < m_keys.size())
+    {
+        m_keys.resize(m_values.size());
+    }
+    buildLevels();
+}
+
+void AP2DataPlotGraph::buildLevels()
+{
+    m_levels.clear();
+    m_validValueRange = minMax(0,m_keys.size(),m_valueMin,m_valueMax);
+    if (m_keys.size() < FirstBucketSize * 2)
+    {
+        return;
+    }
+
+    // The first level is built from the samples, every other one from the
+    // level below, until a level has fewer than two buckets
+    Level level;
+    level.bucketSize = FirstBucketSize;
+    int buckets = m_keys.size() / FirstBucketSize;
+    level.min.resize(buckets);
+    level.max.resize(buckets);
+    for (int i=0;i<buckets;i++)
+    {
+        double min;
+        double max;
+        if (!minMax(i * FirstBucketSize,(i + 1) * FirstBucketSize,min,max))
+        {
+            min = std::numeric_limits<double>::quiet_NaN();
+            max = min;
+        }
+        level.min[i] = min;
+        level.max[i] = max;
+    }
+    m_levels.append(level);
+
+    while (m_levels.last().min.size() >= BucketGrowth * 2)
+    {
+        const Level &lower = m_levels.last();
+        Level upper;
+        upper.bucketSize = lower.bucketSize * BucketGrowth;
+        buckets = lower.min.size() / BucketGrowth;
+        upper.min.resize(buckets);
+        upper.max.resize(buckets);
+        for (int i=0;i<buckets;i++)
+        {
+            double min = std::numeric_limits<double>::quiet_NaN();
+            double max = min;
+            for (int j=i*BucketGrowth;j<(i+1)*BucketGrowth;j++)
+            {
+                // Buckets without a single valid sample are NaN
+                if (qIsNaN(lower.min.at(j)))
+                {
+                    continue;
+                }
+                if (qIsNaN(min) || lower.min.at(j) < min)
+                {
+                    min = lower.min.at(j);
+                }
+                if (qIsNaN(max) || lower.max.at(j) > max)
+                {
+                    max = lower.max.at(j);
+                }
+            }
+            upper.min[i] = min;
+            upper.max[i] = max;
+        }
+        m_levels.append(upper);
+    }
+}
+
+bool AP2DataPlotGraph::minMax(int from, int to, double &min, double &max) const
+{
+    bool found = false;
+    int i = from;
+    while (i < to)
+    {
+        // Use the largest bucket that starts here and ends in range
+        int level = m_levels.size() - 1;
+        while (level >= 0 && (i % m_levels.at(level).bucketSize != 0 || i + m_levels.at(level).bucketSize > to))
+        {
+            level--;
+        }
+        double low;
+        double high;
+        if (level < 0)
+        {
+            low = m_values.at(i);
+            high = low;
+            i++;
+        }
+        else
+        {
+            const Level &bucket = m_levels.at(level);
+            low = bucket.min.at(i / bucket.bucketSize);
+            high = bucket.max.at(i / bucket.bucketSize);
+            i += bucket.bucketSize;
+        }
+        if (qIsNaN(low) || qIsNaN(high))
+        {
+            continue;
+        }
+        if (!found || low < min)
+        {
+            min = low;
+        }
+        if (!found || high > max)
+        {
+            max = high;
+        }
+        found = true;
+    }
+    return found;
+}
+
+bool AP2DataPlotGraph::valueAt(double key, double &value) const
+{
+    QVector<double>::const_iterator it = std::lower_bound(m_keys.constBegin(),m_keys.constEnd(),key);
+    if (it == m_keys.constEnd())
+    {
+        return false;
+    }
+    value = m_values.at(it - m_keys.constBegin());
+    return true;
+}
+
+void AP2DataPlotGraph::clearData()
+{
+    QCPGraph::clearData();
+    m_keys.clear();
+    m_values.clear();
+    buildLevels();
+}
+
+void AP2DataPlotGraph::draw(QCPPainter *painter)
+{
+    if (!mKeyAxis || !mValueAxis || m_keys.isEmpty())
+    {
+        return;
+    }
+    QCPRange range = mKeyAxis.data()->range();
+    if (range.size() <= 0 || mLineStyle == lsNone)
+    {
+        return;
+    }
+
+    // Samples in view, plus one on each side so lines run off the edges
+    int begin = std::lower_bound(m_keys.constBegin(),m_keys.constEnd(),range.lower) - m_keys.constBegin();
+    int end = std::upper_bound(m_keys.constBegin(),m_keys.constEnd(),range.upper) - m_keys.constBegin();
+    begin = qMax(0,begin - 1);
+    end = qMin(m_keys.size(),end + 1);
+    if (end <= begin)
+    {
+        return;
+    }
+
+    int columns = qMax(1,mKeyAxis.data()->axisRect()->width());
+    QVector<QPointF> lineData;
+    if (end - begin <= columns * 2)
+    {
+        // Few enough samples to draw every one of them
+        lineData.reserve(end - begin);
+        for (int i=begin;i<end;i++)
+        {
+            if (!qIsNaN(m_values.at(i)))
+            {
+                lineData.append(coordsToPixels(m_keys.at(i),m_values.at(i)));
+            }
+        }
+    }
+    else
+    {
+        // One min/max pair per pixel column keeps every spike visible
+        lineData.reserve(columns * 2 + 2);
+        double columnWidth = range.size() / columns;
+        int i = begin;
+        for (int column=0;column<=columns+1 && i<end;column++)
+        {
+            double columnEnd = range.lower + columnWidth * column;
+            int next = std::upper_bound(m_keys.constBegin() + i,m_keys.constBegin() + end,columnEnd) - m_keys.constBegin();
+            if (next == i)
+            {
+                continue;
+            }
+            double min;
+            double max;
+            if (minMax(i,next,min,max))
+            {
+                lineData.append(coordsToPixels(m_keys.at(i),min));
+                if (max != min)
+                {
+                    lineData.append(coordsToPixels(m_keys.at(i),max));
+                }
+            }
+            i = next;
+        }
+        // Whatever is right of the last column, the sample after the view
+        double min;
+        double max;
+        if (i < end && minMax(i,end,min,max))
+        {
+            lineData.append(coordsToPixels(m_keys.at(i),min));
+        }
+    }
+
+    if (mLineStyle == lsImpulse)
+    {
+        drawImpulsePlot(painter,&lineData);
+    }
+    else
+    {
+        drawLinePlot(painter,&lineData);
+    }
+}
+
+QCPRange AP2DataPlotGraph::getKeyRange(bool &validRange, SignDomain inSignDomain) const
+{
+    return getKeyRange(validRange,inSignDomain,false);
+}
+
+QCPRange AP2DataPlotGraph::getValueRange(bool &validRange, SignDomain inSignDomain) const
+{
+    return getValueRange(validRange,inSignDomain,false);
+}
+
+QCPRange AP2DataPlotGraph::getKeyRange(bool &validRange, SignDomain inSignDomain, bool includeErrors) const
+{
+    Q_UNUSED(includeErrors)
+    Q_UNUSED(inSignDomain)
+    validRange = !m_keys.isEmpty();
+    if (!validRange)
+    {
+        return QCPRange();
+    }
+    return QCPRange(m_keys.first(),m_keys.last());
+}
+
+QCPRange AP2DataPlotGraph::getValueRange(bool &validRange, SignDomain inSignDomain, bool includeErrors) const
+{
+    Q_UNUSED(includeErrors)
+    Q_UNUSED(inSignDomain)
+    validRange = m_validValueRange;
+    if (!validRange)
+    {
+        return QCPRange();
+    }
+    return QCPRange(m_valueMin,m_valueMax);
+}
@@ -0,0 +1,89 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2015 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+/**
+ * @file
+ *   @brief AP2DataPlot graph with level of detail
+ *
+ *          A QCPGraph for log fields that plots straight from the model's
+ *          column vectors instead of a QCPDataMap. A min/max pyramid is built
+ *          once per series, and draw() only emits the extremes of each pixel
+ *          column in view, so the cost of a replot follows the plot width,
+ *          not the length of the log.
+ */
+
+#ifndef AP2DATAPLOTGRAPH_H
+#define AP2DATAPLOTGRAPH_H
+
+#include "qcustomplot.h"
+#include <QVector>
+
+class AP2DataPlotGraph : public QCPGraph
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Create a graph over a series, keys must be ascending
+     * The vectors are implicitly shared with the model, not copied
+     */
+    AP2DataPlotGraph(QCPAxis *keyAxis, QCPAxis *valueAxis, const QVector<double> &keys, const QVector<double> &values);
+
+    int dataCount() const { return m_keys.size(); }
+    /** @brief Value at key, or at the first key after it. Returns false past the end */
+    bool valueAt(double key, double &value) const;
+
+    virtual void clearData();
+
+protected:
+    virtual void draw(QCPPainter *painter);
+    virtual QCPRange getKeyRange(bool &validRange, SignDomain inSignDomain=sdBoth) const;
+    virtual QCPRange getValueRange(bool &validRange, SignDomain inSignDomain=sdBoth) const;
+    virtual QCPRange getKeyRange(bool &validRange, SignDomain inSignDomain, bool includeErrors) const;
+    virtual QCPRange getValueRange(bool &validRange, SignDomain inSignDomain, bool includeErrors) const;
+
+private:
+    class Level
+    {
+    public:
+        int bucketSize;         ///< Samples per bucket
+        // Double, as float rounding shows up as an offset once the axis is
+        // zoomed onto a small range around a large value (e.g. GPS time)
+        QVector<double> min;
+        QVector<double> max;
+    };
+
+    void buildLevels();
+    /** @brief Min and max of the samples in [from,to), false if all are NaN */
+    bool minMax(int from, int to, double &min, double &max) const;
+
+private:
+    static const int FirstBucketSize = 16;
+    static const int BucketGrowth = 4;
+
+    QVector<double> m_keys;
+    QVector<double> m_values;
+    QVector<Level> m_levels;
+    bool m_validValueRange;
+    double m_valueMin;
+    double m_valueMax;
+};
+
+#endif // AP2DATAPLOTGRAPH_H
@@ -32,14 +32,15 @@ This file is part of the APM_PLANNER project
 #include <QDebug>
 #include <QStringList>
 #include <QDateTime>
-#include <QSqlDatabase>
-#include <QSqlRecord>
-#include <QSqlQuery>
-#include <QSqlField>
-#include <QSqlError>
 #include <QByteArray>
 #include <QDataStream>
+#include <QSet>
+#include <QHash>
+#include <QRunnable>
+#include <QtEndian>
 #include "MAVLinkDecoder.h"
+#include "TLogIndex.h"
+#include "MAVLinkFrameScanner.h"
 #include "QsLog.h"
 #include "QGC.h"
 
@@ -71,332 +72,457 @@ bool AP2DataPlotThread::isMainThread()
     return QThread::currentThread() == QCoreApplication::instance()->thread();
 }
 
+// Header of every DataFlash packet: 0xA3 0x95 followed by the message type
+static const int DATAFLASH_HEADER_SIZE = 3;
+// FMT packet: header, type, length, name[4], format[16], labels[64]
+static const int DATAFLASH_FMT_SIZE = 89;
+static const unsigned char DATAFLASH_FMT_TYPE = 0x80;
+
+// Logs are scanned, decoded and merged one window at a time. This bounds the
+// memory held by decoded rows and sets the granularity of loadProgress().
+static const qint64 LOAD_WINDOW_SIZE = 4 * 1024 * 1024;
+static const int LOAD_WINDOW_RECORDS = 65536;
+
+/**
+ * @brief Decodes a range of records of one window in a pool thread
+ */
+class AP2DataPlotDecodeTask : public QRunnable
+{
+public:
+    AP2DataPlotDecodeTask(const AP2DataPlotThread *thread, AP2DataPlotThread::RecordDecoder decoder,
+                          const uchar *data, AP2DataPlotThread::LogRecord *begin, AP2DataPlotThread::LogRecord *end) :
+        m_thread(thread),
+        m_decoder(decoder),
+        m_data(data),
+        m_begin(begin),
+        m_end(end)
+    {
+    }
+
+    void run()
+    {
+        for (AP2DataPlotThread::LogRecord *record = m_begin; record != m_end && !m_thread->stopRequested(); ++record)
+        {
+            (m_thread->*m_decoder)(m_data, *record);
+        }
+    }
+
+private:
+    const AP2DataPlotThread *m_thread;
+    AP2DataPlotThread::RecordDecoder m_decoder;
+    const uchar *m_data;
+    AP2DataPlotThread::LogRecord *m_begin;
+    AP2DataPlotThread::LogRecord *m_end;
+};
+
+/**
+ * @brief Size in bytes of a DataFlash format character, -1 if unknown.
+ *        See https://github.com/diydrones/ardupilot/blob/master/libraries/DataFlash/DataFlash.h
+ */
+static int dataFlashFieldSize(char typeCode)
+{
+    switch (typeCode)
+    {
+    case 'b': case 'B': case 'M':
+        return 1;
+    case 'h': case 'H': case 'c': case 'C':
+        return 2;
+    case 'i': case 'I': case 'f': case 'e': case 'E': case 'L': case 'n':
+        return 4;
+    case 'q': case 'Q':
+        return 8;
+    case 'N':
+        return 16;
+    case 'Z':
+        return 64;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * @brief Fixed size, NUL padded string field of a DataFlash packet
+ */
+static QString dataFlashString(const uchar *data, int size)
+{
+    const char *str = reinterpret_cast<const char*>(data);
+    return QString::fromLatin1(str, qstrnlen(str, size));
+}
+
+static QVariant dataFlashValue(char typeCode, const uchar *data)
+{
+    switch (typeCode)
+    {
+    case 'b': //int8_t
+    case 'M':
+        return static_cast<qint8>(data[0]);
+    case 'B': //uint8_t
+        return static_cast<quint8>(data[0]);
+    case 'h': //int16_t
+        return qFromLittleEndian<qint16>(data);
+    case 'H': //uint16_t
+        return qFromLittleEndian<quint16>(data);
+    case 'i': //int32_t
+        return qFromLittleEndian<qint32>(data);
+    case 'I': //uint32_t
+        return qFromLittleEndian<quint32>(data);
+    case 'f': //float
+    {
+        quint32 bits = qFromLittleEndian<quint32>(data);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+    case 'n': //char(4)
+        return dataFlashString(data, 4);
+    case 'N': //char(16)
+        return dataFlashString(data, 16);
+    case 'Z': //char(64)
+        return dataFlashString(data, 64);
+    case 'c': //int16_t * 100
+        return qFromLittleEndian<qint16>(data) / 100.0;
+    case 'C': //uint16_t * 100
+        return qFromLittleEndian<quint16>(data) / 100.0;
+    case 'e': //int32_t * 100
+        return qFromLittleEndian<qint32>(data) / 100.0;
+    case 'E': //uint32_t * 100
+        return qFromLittleEndian<quint32>(data) / 100.0;
+    case 'L': //int32_t GPS Lon/Lat * 10000000
+        return qFromLittleEndian<qint32>(data) / 10000000.0;
+    case 'q':
+        return qFromLittleEndian<qint64>(data);
+    case 'Q':
+        return qFromLittleEndian<quint64>(data);
+    default:
+        return QVariant();
+    }
+}
+
+void AP2DataPlotThread::compileDataFlashFormat(const uchar *packet, DataFlashFormat &format) const
+{
+    // packet points behind the 3 byte header
+    format.type = packet[0];
+    format.length = packet[1];
+    format.name = dataFlashString(packet + 2, 4);
+    format.format = QByteArray(reinterpret_cast<const char*>(packet + 6), qstrnlen(reinterpret_cast<const char*>(packet + 6), 16));
+    QString labels = dataFlashString(packet + 22, 64);
+    format.labels = labels.split(",");
+
+    if (format.format.isEmpty() || labels.isEmpty())
+    {
+        format.error = format.name + " format data: Corrupt or missing. Message type is:0x" + QString::number(format.type, 16);
+        return;
+    }
+    if (format.labels.size() < format.format.size())
+    {
+        format.error = format.name + " format data: Missing labels. Message type is:0x" + QString::number(format.type, 16);
+        return;
+    }
+
+    format.offsets.reserve(format.format.size());
+    int offset = 0;
+    for (int j=0;j<format.format.size();j++)
+    {
+        int size = dataFlashFieldSize(format.format.at(j));
+        format.offsets.append(size < 0 ? -1 : offset);
+        if (size > 0)
+        {
+            offset += size;
+        }
+    }
+    if (offset > format.length - DATAFLASH_HEADER_SIZE)
+    {
+        format.error = format.name + " format data: Fields exceed the message length. Message type is:0x" + QString::number(format.type, 16);
+        format.offsets.clear();
+    }
+}
+
+void AP2DataPlotThread::decodeDataFlashRecord(const uchar *data, LogRecord &record) const
+{
+    if (record.kind != LogRecord::DataRecord)
+    {
+        return;
+    }
+    const DataFlashFormat &format = m_dataFlashFormats.at(record.format);
+    if (!format.error.isEmpty())
+    {
+        return;
+    }
+    const uchar *packet = data + record.offset;
+    record.values.reserve(format.format.size());
+    for (int j=0;j<format.format.size();j++)
+    {
+        char typeCode = format.format.at(j);
+        int offset = format.offsets.at(j);
+        if (offset < 0)
+        {
+            //Unknown!
+            QLOG_DEBUG() << "AP2DataPlotThread::run(): ERROR UNKNOWN DATA TYPE" << typeCode;
+            record.errors.append("Unknown data type: " + QString(QChar(typeCode)) + " when decoding " + format.name);
+            continue;
+        }
+        QVariant value = dataFlashValue(typeCode, packet + offset);
+        if (typeCode == 'f' && value.toFloat() != value.toFloat()) // This tests for not a number
+        {
+            QLOG_WARN() << "Corrupted log data found - Graphing may not work as expected for data of type" << format.name;
+            record.status = LogRecord::Corrupt;
+            record.errors.append("Corrupt data element found when decoding " + format.name + " data.");
+            continue;
+        }
+        record.values.append(QPair<QString,QVariant>(format.labels.at(j),value));
+    }
+}
+
+void AP2DataPlotThread::decodeRecords(const uchar *data, QVector<LogRecord> &records, RecordDecoder decoder)
+{
+    if (records.isEmpty())
+    {
+        return;
+    }
+    // One chunk per core, the pool deletes the tasks when they are done
+    int chunks = qMax(1, m_threadPool.maxThreadCount());
+    int chunkSize = (records.size() + chunks - 1) / chunks;
+    LogRecord *first = records.data();
+    for (int start = 0; start < records.size(); start += chunkSize)
+    {
+        int end = qMin(start + chunkSize, records.size());
+        m_threadPool.start(new AP2DataPlotDecodeTask(this, decoder, data, first + start, first + end));
+    }
+    m_threadPool.waitForDone();
+}
+
 void AP2DataPlotThread::loadBinaryLog(QFile &logfile)
 {
-    QByteArray block;
     int paramtype = -1;
-    QMap<unsigned char,unsigned char> typeToLengthMap;
-    QMap<unsigned char,QString > typeToNameMap;
-    QMap<unsigned char,QString > typeToFormatMap;
-    QMap<unsigned char,QString > typeToLabelMap;
-    QStringList tables;
+    int formatOfType[256];  // Compiled format currently describing each message type, -1 if none
+    for (int i=0;i<256;i++)
+    {
+        formatOfType[i] = -1;
+    }
+    m_dataFlashFormats.clear();
+    QSet<QString> tables;
 
     int index = 0;
     m_loadedLogType = MAV_TYPE_GENERIC;
 
+    // Parse straight out of the mapped file, no intermediate buffers
+    const qint64 size = logfile.size();
+    QByteArray fallback;
+    const uchar *data = logfile.map(0, size);
+    const bool mapped = (data != NULL);
+    if (!mapped && size > 0)
+    {
+        QLOG_WARN() << "AP2DataPlotThread::loadBinaryLog(): unable to map log file, reading it instead:" << logfile.errorString();
+        fallback = logfile.readAll();
+        data = reinterpret_cast<const uchar*>(fallback.constData());
+    }
+
     if (!m_dataModel->startTransaction())
     {
         emit error(m_dataModel->getError());
         return;
     }
 
-    while (!logfile.atEnd() && !m_stop)
+    QVector<LogRecord> records;
+    qint64 pos = 0;
+    int nonpacketcounter = 0;
+    bool truncated = false;
+    while (pos + DATAFLASH_HEADER_SIZE <= size && !truncated && !stopRequested())
     {
-        int nonpacketcounter = 0;
-        emit loadProgress(logfile.pos(),logfile.size());
-        block.append(logfile.read(8192));
-        for (int i=0;i<block.size();i++)
+        emit loadProgress(pos,size);
+
+        // Boundary scan of the next window. This is sequential, as every FMT
+        // changes how the packets behind it are framed.
+        records.clear();
+        const qint64 windowEnd = pos + LOAD_WINDOW_SIZE;
+        while (pos + DATAFLASH_HEADER_SIZE <= size && pos < windowEnd && records.size() < LOAD_WINDOW_RECORDS)
         {
-            if (i+3 < block.size()) //Enough room for a header
+            const uchar *header = data + pos;
+            if (header[0] != 0xA3 || header[1] != 0x95)
+            {
+                //Non packet
+                nonpacketcounter++;
+                pos++;
+                continue;
+            }
+            LogRecord record;
+            if (nonpacketcounter > 0)
             {
-                if (static_cast<unsigned char>(block.at(i)) == 0xA3 && static_cast<unsigned char>(block.at(i+1)) == 0x95)
+                record.kind = LogRecord::GarbageRecord;
+                record.length = nonpacketcounter;
+                records.append(record);
+                nonpacketcounter = 0;
+            }
+
+            //It's a valid header.
+            unsigned char type = header[2];
+            if (type == DATAFLASH_FMT_TYPE)
+            {
+                //Message format packet
+                if (pos + DATAFLASH_FMT_SIZE > size)
                 {
-                    //It's a valid header.
-                    unsigned char type = static_cast<unsigned char>(block.at(i+2));
-                    if (type == 0x80)
-                    {
-                        //Message format packet
-                        if (i+92 >= block.size())
-                        {
-                            //Not enough data in the block
-                            break; //Break out of the for loop to let the file load more
-                        }
+                    //Truncated at the end of the log
+                    truncated = true;
+                    break;
+                }
+                const uchar *packet = header + DATAFLASH_HEADER_SIZE;
+                pos += DATAFLASH_FMT_SIZE;
+                if (packet[0] == DATAFLASH_FMT_TYPE)
+                {
+                    //Message is a format type, we don't want to include it
+                    continue;
+                }
+                DataFlashFormat format;
+                compileDataFlashFormat(packet, format);
+                formatOfType[format.type] = m_dataFlashFormats.size();
+                m_dataFlashFormats.append(format);
+                record.kind = LogRecord::FormatRecord;
+                record.format = formatOfType[format.type];
+                records.append(record);
+                continue;
+            }
 
-                        QByteArray packet = block.mid(i+3,86);
-                        block = block.remove(i,89); //Remove both the 3 byte header and the packet
-                        i--;
+            //Data packet
+            record.format = formatOfType[type];
+            if (record.format < 0 || m_dataFlashFormats.at(record.format).length < DATAFLASH_HEADER_SIZE)
+            {
+                // Most likely a false header inside corrupt data, resynchronise.
+                // The byte is reported here, so it is not a non packet byte too.
+                record.kind = LogRecord::UnknownTypeRecord;
+                record.length = type;
+                records.append(record);
+                pos++;
+                continue;
+            }
+            const int length = m_dataFlashFormats.at(record.format).length;
+            if (pos + length > size)
+            {
+                //Truncated at the end of the log
+                truncated = true;
+                break;
+            }
+            record.offset = pos + DATAFLASH_HEADER_SIZE;
+            record.length = length;
+            records.append(record);
+            pos += length;
+        }
 
-                        unsigned char msg_type = packet.at(0); //Message type defined in the format struct
-                        unsigned char msg_length = packet.at(1);  //Message length
-                        QString name = packet.mid(2,4); //Name of the message
-                        QString format = packet.mid(6,16); //Format of the variables
-                        QString labels = packet.mid(22,64); //comma delimited list of variable names.
-                        if (name == "PARM")
-                        {
-                            paramtype = msg_type;
-                        }
-                        typeToFormatMap[msg_type] = format;
-                        typeToLabelMap[msg_type] = labels;
-                        typeToLengthMap[msg_type] = msg_length;
-                        typeToNameMap[msg_type] = name;
+        decodeRecords(data, records, &AP2DataPlotThread::decodeDataFlashRecord);
+        if (stopRequested())
+        {
+            break;
+        }
 
-                        if (msg_type == 0x80)
-                        {
-                            //Message is a format type, we don't want to include it
-                            continue;
-                        }
-                        if (format == "" || labels == "")
-                        {
-                            QLOG_DEBUG() << "AP2DataPlotThread::run(): empty format string or labels string for type" << msg_type << name;
-                            m_plotState.corruptFMTRead(index, name + " format data: Corrupt or missing. Message type is:0x" +
-                                                       QString::number(msg_type, 16));
-                            continue;
-                        }
-                        if (!tables.contains(name)) {
-                            if (!m_dataModel->addType(name,msg_type,msg_length,format,labels.split(",")))
-                            {
-                                QString actualerror = m_dataModel->getError();
-                                m_dataModel->endTransaction(); //endTransaction can re-set the error if it errors, but we should try it anyway.
-                                emit error(actualerror);
-                                return;
-                            }
-                            tables.append(name);
-                        }
-                        index++;
+        // Merge the window into the model in file order
+        for (int i=0;i<records.size();i++)
+        {
+            LogRecord &record = records[i];
+            if (record.kind == LogRecord::GarbageRecord)
+            {
+                QLOG_DEBUG() << "AP2DataPlotThread::run(): Non packet bytes found in log file" << record.length << "bytes filtered out. This may be a corrupt log";
+                m_plotState.corruptDataRead(index, "Non packet bytes found in log file " + QString::number(record.length) + " bytes filtered out");
+            }
+            else if (record.kind == LogRecord::UnknownTypeRecord)
+            {
+                QLOG_DEBUG() << "AP2DataPlotThread::run(): No format information for type:" << record.length;
+                m_plotState.corruptDataRead(index, "No length information for message type:0x" + QString::number(record.length, 16));
+            }
+            else if (record.kind == LogRecord::FormatRecord)
+            {
+                DataFlashFormat &format = m_dataFlashFormats[record.format];
+                if (format.name == "PARM")
+                {
+                    paramtype = format.type;
+                }
+                if (!format.error.isEmpty())
+                {
+                    QLOG_DEBUG() << "AP2DataPlotThread::run():" << format.error;
+                    m_plotState.corruptFMTRead(index, format.error);
+                    continue;
+                }
+                if (!tables.contains(format.name))
+                {
+                    if (!m_dataModel->addType(format.name,format.type,format.length,QString::fromLatin1(format.format),format.labels))
+                    {
+                        QString actualerror = m_dataModel->getError();
+                        m_dataModel->endTransaction(); //endTransaction can re-set the error if it errors, but we should try it anyway.
+                        emit error(actualerror);
+                        return;
                     }
-                    else
+                    tables.insert(format.name);
+                }
+                format.hasTable = true;
+                index++;
+            }
+            else
+            {
+                const DataFlashFormat &format = m_dataFlashFormats.at(record.format);
+                if (!format.hasTable)
+                {
+                    QLOG_DEBUG() << "AP2DataPlotThread::run(): No query available for param category" << format.name;
+                    m_plotState.corruptDataRead(index, "No format information available for message type:0x" + QString::number(format.type, 16));
+                    continue;
+                }
+                index++;
+                foreach (const QString &errorText, record.errors)
+                {
+                    m_plotState.corruptDataRead(index, errorText);
+                }
+                const QList<QPair<QString,QVariant> > &valuepairlist = record.values;
+                if (record.status == LogRecord::Valid && (valuepairlist.size() >= 1))
+                {
+                    if (!m_dataModel->addRow(format.name,valuepairlist,index))
                     {
-                        //Data packet
-                        if (!typeToLengthMap.contains(type))
-                        {
-                            QLOG_DEBUG() << "AP2DataPlotThread::run(): No entry in typeToLengthMap for type:" << type;
-                            m_plotState.corruptDataRead(index, "No length information for message type:0x" + QString::number(type, 16));
-                            break;
-                        }
-                        if (i+3+typeToLengthMap.value(type) >= block.size())
-                        {
-                            //Not enough data yet, read more from the file
-                            break;
-                        }
-                        QByteArray packet = block.mid(i+3,typeToLengthMap.value(type)-3);
-                        block.remove(i,packet.size()+3); //Remove both the 3 byte header and the packet
-                        i--;
-                        QDataStream packetstream(packet);
-                        packetstream.setByteOrder(QDataStream::LittleEndian);
-                        packetstream.setFloatingPointPrecision(QDataStream::SinglePrecision);
-
-                        QString name = typeToNameMap.value(type);
-                        if (tables.contains(name))
-                        {
-                            index++;
-                            QList<QPair<QString,QVariant> > valuepairlist;
-                            QString formatstr = typeToFormatMap.value(type);
-                            QString labelstr = typeToLabelMap.value(type);
-                            QStringList labelstrsplit = labelstr.split(",");
-                            bool noCorruptDataFound = true;
-
-                            for (int j=0;j<formatstr.size();j++)
-                            {
-                                QChar typeCode = formatstr.at(j);
-                                if (typeCode == 'b') //int8_t
-                                {
-                                    qint8 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val));
-                                }
-                                else if (typeCode == 'B') //uint8_t
-                                {
-                                    quint8 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val));
-                                }
-                                else if (typeCode == 'h') //int16_t
-                                {
-                                    qint16 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val));
-                                }
-                                else if (typeCode == 'H') //uint16_t
-                                {
-                                    quint16 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val));
-                                }
-                                else if (typeCode == 'i') //int32_t
-                                {
-                                    qint32 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val));
-                                }
-                                else if (typeCode == 'I') //uint32_t
-                                {
-                                    quint32 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val));
-                                }
-                                else if (typeCode == 'f') //float
-                                {
-                                    float f;
-                                    packetstream >> f;
-                                    if (f != f) // This tests for not a number
-                                    {
-                                        QLOG_WARN() << "Corrupted log data found - Graphing may not work as expected for data of type" << name;
-                                        noCorruptDataFound = false;
-                                        m_plotState.corruptDataRead(index, "Corrupt data element found when decoding " + name + " data.");
-                                    }
-                                    else
-                                    {
-                                        valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),f));
-                                    }
-                                }
-                                else if (typeCode == 'n') //char(4)
-                                {
-
-                                    QString val = "";
-                                    for (int i=0;i<4;i++)
-                                    {
-                                        quint8 ch;
-                                        packetstream >> ch;
-                                        if (ch)
-                                        {
-                                            val += static_cast<char>(ch);
-                                        }
-                                    }
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val));
-                                }
-                                else if (typeCode == 'N') //char(16)
-                                {
-                                    QString val = "";
-                                    for (int i=0;i<16;i++)
-                                    {
-                                        quint8 ch;
-                                        packetstream >> ch;
-                                        if (ch)
-                                        {
-                                            val += static_cast<char>(ch);
-                                        }
-                                    }
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val));
-                                }
-                                else if (typeCode == 'Z') //char(64)
-                                {
-                                    QString val = "";
-                                    for (int i=0;i<64;i++)
-                                    {
-                                        quint8 ch;
-                                        packetstream >> ch;
-                                        if (ch)
-                                        {
-                                            val += static_cast<char>(ch);
-                                        }
-                                    }
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val));
-                                }
-                                else if (typeCode == 'c') //int16_t * 100
-                                {
-                                    qint16 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val / 100.0));
-                                }
-                                else if (typeCode == 'C') //uint16_t * 100
-                                {
-                                    quint16 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val / 100.0));
-                                }
-                                else if (typeCode == 'e') //int32_t * 100
-                                {
-                                    qint32 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val / 100.0));
-                                }
-                                else if (typeCode == 'E') //uint32_t * 100
-                                {
-                                    quint32 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val / 100.0));
-                                }
-                                else if (typeCode == 'L') //uint32_t GPS Lon/Lat * 10000000
-                                {
-                                    qint32 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val / 10000000.0));
-                                }
-                                else if (typeCode == 'M')
-                                {
-                                    qint8 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val));
-                                }
-                                else if (typeCode == 'q')
-                                {
-                                    qint64 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val));
-                                }
-                                else if (typeCode == 'Q')
-                                {
-                                    quint64 val;
-                                    packetstream >> val;
-                                    valuepairlist.append(QPair<QString,QVariant>(labelstrsplit.at(j),val));
-                                }
-                                else
-                                {
-                                    //Unknown!
-                                    QLOG_DEBUG() << "AP2DataPlotThread::run(): ERROR UNKNOWN DATA TYPE" << typeCode;
-                                    m_plotState.corruptDataRead(index, "Unknown data type: " + QString(typeCode) + " when decoding " + name);
-                                }
-                            }
-                            if (noCorruptDataFound && (valuepairlist.size() >= 1))
-                            {
-                                if (!m_dataModel->addRow(name,valuepairlist,index))
-                                {
-                                    QString actualerror = m_dataModel->getError();
-                                    m_dataModel->endTransaction(); //endTransaction can re-set the error if it errors, but we should try it anyway.
-                                    emit error(actualerror);
-                                    return;
-                                }
-                                m_plotState.validDataRead();
-                            }
+                        QString actualerror = m_dataModel->getError();
+                        m_dataModel->endTransaction(); //endTransaction can re-set the error if it errors, but we should try it anyway.
+                        emit error(actualerror);
+                        return;
+                    }
+                    m_plotState.validDataRead();
+                }
 
-                            if (type == paramtype && m_loadedLogType == MAV_TYPE_GENERIC)
-                            {
-                                // Name field is not always on same Index. So first search for the right position...
-                                int nameIndex = 0;
-                                for (int i = 0; i < valuepairlist.size(); ++i)
-                                {
-                                    if (valuepairlist[i].first == "Name")
-                                    {
-                                        nameIndex = i;
-                                        break;
-                                    }
-                                }
-                                //...and then use it to check the values.
-                                if (valuepairlist[nameIndex].second == "RATE_RLL_P" || valuepairlist[nameIndex].second == "H_SWASH_PLATE")
-                                {
-                                    m_loadedLogType = MAV_TYPE_QUADROTOR;
-                                }
-                                else if (valuepairlist[nameIndex].second == "PTCH2SRV_P")
-                                {
-                                    m_loadedLogType = MAV_TYPE_FIXED_WING;
-                                }
-                                else if (valuepairlist[nameIndex].second == "SKID_STEER_OUT")
-                                {
-                                    m_loadedLogType = MAV_TYPE_GROUND_ROVER;
-                                }
-                            }
-                        }
-                        else
+                if (format.type == paramtype && m_loadedLogType == MAV_TYPE_GENERIC && !valuepairlist.isEmpty())
+                {
+                    // Name field is not always on same Index. So first search for the right position...
+                    int nameIndex = 0;
+                    for (int i = 0; i < valuepairlist.size(); ++i)
+                    {
+                        if (valuepairlist[i].first == "Name")
                         {
-                            QLOG_DEBUG() << "AP2DataPlotThread::run(): No query available for param category" << name;
-                            m_plotState.corruptDataRead(index, "No format information available for message type:0x" + QString::number(type, 16));
+                            nameIndex = i;
+                            break;
                         }
                     }
-
-                }
-                else
-                {
-                    //Non packet
-                    nonpacketcounter++;
+                    //...and then use it to check the values.
+                    if (valuepairlist[nameIndex].second == "RATE_RLL_P" || valuepairlist[nameIndex].second == "H_SWASH_PLATE")
+                    {
+                        m_loadedLogType = MAV_TYPE_QUADROTOR;
+                    }
+                    else if (valuepairlist[nameIndex].second == "PTCH2SRV_P")
+                    {
+                        m_loadedLogType = MAV_TYPE_FIXED_WING;
+                    }
+                    else if (valuepairlist[nameIndex].second == "SKID_STEER_OUT")
+                    {
+                        m_loadedLogType = MAV_TYPE_GROUND_ROVER;
+                    }
                 }
             }
         }
-        if (nonpacketcounter > 0)
-        {
-            QLOG_DEBUG() << "AP2DataPlotThread::run(): Non packet bytes found in log file" << nonpacketcounter << "bytes filtered out. This may be a corrupt log";
-            m_plotState.corruptDataRead(index, "Non packet bytes found in log file " + QString::number(nonpacketcounter) + " bytes filtered out");
-        }
     }
+    if (nonpacketcounter > 0)
+    {
+        QLOG_DEBUG() << "AP2DataPlotThread::run(): Non packet bytes found in log file" << nonpacketcounter << "bytes filtered out. This may be a corrupt log";
+        m_plotState.corruptDataRead(index, "Non packet bytes found in log file " + QString::number(nonpacketcounter) + " bytes filtered out");
+    }
+    emit loadProgress(pos,size);
+    // Keep the file position meaningful for the load statistics in run()
+    logfile.seek(pos);
+    if (mapped)
+    {
+        logfile.unmap(const_cast<uchar*>(data));
+    }
+
     if (!m_dataModel->endTransaction())
     {
         emit error(m_dataModel->getError());
@@ -404,229 +530,331 @@ void AP2DataPlotThread::loadBinaryLog(QFile &logfile)
     }
 }
 
-void AP2DataPlotThread::loadAsciiLog(QFile &logfile)
+void AP2DataPlotThread::detectLogType(const QString& line)
 {
-    m_loadedLogType = MAV_TYPE_GENERIC;
-    int index = 500;
-    QMap<QString,QString> nameToTypeString;
-    QMap<QString,QStringList> nameToValueList;
+    if ((line.contains(APM_COPTER_REXP) || (line.contains("PARM") && (line.contains("RATE_RLL_P") || line.contains("H_SWASH_PLATE")))))
+    {
+        m_loadedLogType = MAV_TYPE_QUADROTOR;
+    }
+    if (line.contains(APM_PLANE_REXP) || (line.contains("PARM") && line.contains("PTCH2SRV_P")))
+    {
+        m_loadedLogType = MAV_TYPE_FIXED_WING;
+    }
+    if (line.contains(APM_ROVER_REXP) || (line.contains("PARM") && line.contains("SKID_STEER_OUT")))
+    {
+        m_loadedLogType = MAV_TYPE_GROUND_ROVER;
+    }
+}
 
-    if (!m_dataModel->startTransaction())
+void AP2DataPlotThread::decodeAsciiRecord(const uchar *data, LogRecord &record) const
+{
+    if (record.kind != LogRecord::DataRecord)
     {
-        emit error(m_dataModel->getError());
         return;
     }
-    while (!logfile.atEnd() && !m_stop)
+    record.line = QString::fromUtf8(reinterpret_cast<const char*>(data + record.offset), record.length);
+    QStringList linesplit = QString(record.line).replace("\r","").replace("\n","").split(",");
+    if (linesplit.size() <= 1)
+    {
+        record.kind = LogRecord::IgnoredRecord;
+        return;
+    }
+    QString name = linesplit[0].trimmed();
+    if (record.format < 0)
     {
-        emit loadProgress(logfile.pos(),logfile.size());
-        QString line = logfile.readLine();
-        emit lineRead(line);
-        if (m_loadedLogType == MAV_TYPE_GENERIC)
+        QLOG_DEBUG() << "Found line with unknown command " << name << ", skipping...";
+        record.status = LogRecord::Corrupt;
+        record.errors.append(name + " data: Found line with unknown command");
+        return;
+    }
+    /* from https://github.com/diydrones/ardupilot/blob/master/libraries/DataFlash/DataFlash.h#L737
+    Format characters in the format string for binary log messages
+      b   : int8_t
+      B   : uint8_t
+      h   : int16_t
+      H   : uint16_t
+      i   : int32_t
+      I   : uint32_t
+      f   : float
+      n   : char[4]
+      N   : char[16]
+      Z   : char[64]
+      c   : int16_t * 100
+      C   : uint16_t * 100
+      e   : int32_t * 100
+      E   : uint32_t * 100
+      L   : int32_t latitude/longitude
+      M   : uint8_t flight mode
+      q   : int64_t
+      Q   : uint64_t
+    */
+    const AsciiFormat &format = m_asciiFormats.at(record.format);
+    const QString &typestr = format.types;
+    static const QString intdef("bBhHiI"); // 32 bit max types.
+    static const QString floatdef("cCeEfL");
+    static const QString chardef("nNZM");
+    if (typestr.size() != linesplit.size() - 1)
+    {
+        record.status = LogRecord::Mismatch;
+        return;
+    }
+
+    const QStringList &valuestrlist = format.labels;
+    QList<QPair<QString,QVariant> > &valuepairlist = record.values;
+    for (int i = 1; i < linesplit.size(); i++)
+    {
+        QString subname = "";
+        if (valuestrlist.size() > i-1)
+        {
+            subname = valuestrlist.at(i-1);
+        }
+        else
+        {
+            continue;
+        }
+        bool ok;
+        QChar typeCode = typestr.at(i - 1);
+        QString valStr = linesplit[i].trimmed();
+        if (intdef.contains(typeCode))
         {
-            if ((line.contains(APM_COPTER_REXP) || (line.contains("PARM") && (line.contains("RATE_RLL_P") || line.contains("H_SWASH_PLATE")))))
+            int val = valStr.toInt(&ok);
+            if (ok)
+            {
+                valuepairlist.append(QPair<QString,QVariant>(subname,val));
+            }
+            else
             {
-                m_loadedLogType = MAV_TYPE_QUADROTOR;
+                QLOG_DEBUG() << "Failed to convert " << valStr << " to an integer number.";
+                record.errors.append(name + " data: Failed to convert " + valStr + " to an integer number.");
+                record.status = LogRecord::Corrupt;
             }
-            if (line.contains(APM_PLANE_REXP) || (line.contains("PARM") && line.contains("PTCH2SRV_P")))
+        }
+        else if (chardef.contains(typeCode))
+        {
+            valuepairlist.append(QPair<QString,QVariant>(subname,valStr));
+        }
+        else if (floatdef.contains(typeCode))
+        {
+            double val = valStr.toDouble(&ok);
+            if (ok && !isinf(val) && !isnan(val))
+            {
+                valuepairlist.append(QPair<QString,QVariant>(subname,val));
+            }
+            else
+            {
+                QLOG_DEBUG() << "Failed to convert " << valStr << " to a floating point number.";
+                record.errors.append(name + " data: Failed to convert " + valStr + " to a floating point number.");
+                record.status = LogRecord::Corrupt;
+            }
+        }
+        else if (QString('q').contains(typeCode) )
+        {
+            quint64 val = valStr.toLongLong(&ok);
+            if (ok)
+            {
+                valuepairlist.append(QPair<QString,QVariant>(subname,val));
+            }
+            else
+            {
+                QLOG_DEBUG() << "Failed to convert " << valStr << " to an qint64 number.";
+                record.errors.append(name + " data: Failed to convert " + valStr + " to an qint64 number.");
+                record.status = LogRecord::Corrupt;
+            }
+        }
+        else if (QString('Q').contains(typeCode) )
+        {
+            quint64 val = valStr.toULongLong(&ok);
+            if (ok)
             {
-                m_loadedLogType = MAV_TYPE_FIXED_WING;
+                valuepairlist.append(QPair<QString,QVariant>(subname,val));
             }
-            if (line.contains(APM_ROVER_REXP) || (line.contains("PARM") && line.contains("SKID_STEER_OUT")))
+            else
             {
-                m_loadedLogType = MAV_TYPE_GROUND_ROVER;
+                QLOG_DEBUG() << "Failed to convert " << valStr << " to an quint64 number.";
+                record.errors.append(name + " data: Failed to convert " + valStr + " to an quint64 number.");
+                record.status = LogRecord::Corrupt;
             }
         }
-        QStringList linesplit = line.replace("\r","").replace("\n","").split(",");
-        if (linesplit.size() > 0)
+        else
+        {
+            QLOG_DEBUG() << "AP2DataPlotThread::run(): Unknown data value found" << typeCode;
+            record.errors.append(name + " data: Unknown data value found: %1" + QString(typeCode));
+            record.status = LogRecord::Fatal;
+            return;
+        }
+    }
+}
+
+void AP2DataPlotThread::loadAsciiLog(QFile &logfile)
+{
+    m_loadedLogType = MAV_TYPE_GENERIC;
+    int index = 500;
+    QHash<QString,int> formatOfName;    // Current format of each message name
+    m_asciiFormats.clear();
+
+    const qint64 size = logfile.size();
+    QByteArray fallback;
+    const uchar *data = logfile.map(0, size);
+    const bool mapped = (data != NULL);
+    if (!mapped && size > 0)
+    {
+        QLOG_WARN() << "AP2DataPlotThread::loadAsciiLog(): unable to map log file, reading it instead:" << logfile.errorString();
+        fallback = logfile.readAll();
+        data = reinterpret_cast<const uchar*>(fallback.constData());
+    }
+
+    if (!m_dataModel->startTransaction())
+    {
+        emit error(m_dataModel->getError());
+        return;
+    }
+
+    QVector<LogRecord> records;
+    qint64 pos = 0;
+    while (pos < size && !stopRequested())
+    {
+        emit loadProgress(pos,size);
+
+        // Boundary scan of the next window. FMT lines are parsed right away,
+        // as they define how the lines behind them are decoded.
+        records.clear();
+        const qint64 windowEnd = pos + LOAD_WINDOW_SIZE;
+        while (pos < size && pos < windowEnd && records.size() < LOAD_WINDOW_RECORDS)
         {
-            if (line.startsWith("FMT"))
+            const char *start = reinterpret_cast<const char*>(data + pos);
+            const char *newline = static_cast<const char*>(memchr(start, '\n', size - pos));
+            LogRecord record;
+            record.offset = pos;
+            record.length = newline ? (newline - start + 1) : (size - pos);
+            pos += record.length;
+
+            if (record.length >= 3 && start[0] == 'F' && start[1] == 'M' && start[2] == 'T')
             {
                 //Format line
+                record.kind = LogRecord::FormatRecord;
+                record.line = QString::fromUtf8(start, record.length);
+                QStringList linesplit = QString(record.line).replace("\r","").replace("\n","").split(",");
                 if (linesplit.size() > 4)
                 {
                     QString type = linesplit[3].trimmed();
-                    if (type != "FMT")
+                    if (type == "FMT")
                     {
-                        QString descstr = linesplit[4].trimmed();
-                        nameToTypeString[type] = descstr;
-                        if (descstr == "")
-                        {
-                            continue;
-                        }
-                        QStringList valuestr;
-                        for (int i=5;i<linesplit.size();i++)
+                        record.kind = LogRecord::IgnoredRecord;
+                    }
+                    else
+                    {
+                        // An empty format keeps the labels of an earlier FMT
+                        int previous = formatOfName.value(type,-1);
+                        AsciiFormat format;
+                        format.name = type;
+                        format.types = linesplit[4].trimmed();
+                        if (!format.types.isEmpty())
                         {
-                            QString name = linesplit[i].trimmed();
-                            valuestr += name;
+                            for (int i=5;i<linesplit.size();i++)
+                            {
+                                format.labels += linesplit[i].trimmed();
+                            }
+                            format.typeId = linesplit[1].trimmed().toInt();
+                            format.length = linesplit[2].trimmed().toInt();
                         }
-                        nameToValueList[type] = valuestr;
-                        int type_id = linesplit[1].trimmed().toInt();
-                        int length = linesplit[2].trimmed().toInt();
-                        if (!m_dataModel->addType(type,type_id,length,descstr,valuestr))
+                        else if (previous >= 0)
                         {
-                            QString actualerror = m_dataModel->getError();
-                            m_dataModel->endTransaction(); //endTransaction can re-set the error if it errors, but we should try it anyway.
-                            emit error(actualerror);
-                            return;
+                            format.labels = m_asciiFormats.at(previous).labels;
                         }
+                        record.format = m_asciiFormats.size();
+                        formatOfName.insert(type,record.format);
+                        m_asciiFormats.append(format);
                     }
                 }
-                else
+                records.append(record);
+                continue;
+            }
+
+            // Data line, the decoder only needs to know which format applies
+            const char *comma = static_cast<const char*>(memchr(start, ',', record.length));
+            if (comma)
+            {
+                QString name = QString::fromUtf8(start, comma - start).trimmed();
+                record.format = formatOfName.value(name,-1);
+            }
+            records.append(record);
+        }
+
+        decodeRecords(data, records, &AP2DataPlotThread::decodeAsciiRecord);
+        if (stopRequested())
+        {
+            break;
+        }
+
+        // Merge the window into the model in file order
+        for (int i=0;i<records.size();i++)
+        {
+            LogRecord &record = records[i];
+            emit lineRead(record.line);
+            if (m_loadedLogType == MAV_TYPE_GENERIC)
+            {
+                detectLogType(record.line);
+            }
+            if (record.kind == LogRecord::FormatRecord)
+            {
+                if (record.format < 0)
                 {
+                    QString line = QString(record.line).replace("\r","").replace("\n","");
                     QLOG_ERROR() << "Error with line in plot log file:" << line;
                     m_plotState.corruptFMTRead(index, "Too short FMT line in log file: " + line);
+                    continue;
+                }
+                const AsciiFormat &format = m_asciiFormats.at(record.format);
+                if (format.types.isEmpty())
+                {
+                    continue;
+                }
+                if (!m_dataModel->addType(format.name,format.typeId,format.length,format.types,format.labels))
+                {
+                    QString actualerror = m_dataModel->getError();
+                    m_dataModel->endTransaction(); //endTransaction can re-set the error if it errors, but we should try it anyway.
+                    emit error(actualerror);
+                    return;
                 }
             }
-            else
+            else if (record.kind == LogRecord::DataRecord)
             {
-                if (linesplit.size() > 1)
+                foreach (const QString &errorText, record.errors)
                 {
-                    QString name = linesplit[0].trimmed();
-                    if (nameToTypeString.contains(name))
-                    {
-                        /* from https://github.com/diydrones/ardupilot/blob/master/libraries/DataFlash/DataFlash.h#L737
-                        Format characters in the format string for binary log messages
-                          b   : int8_t
-                          B   : uint8_t
-                          h   : int16_t
-                          H   : uint16_t
-                          i   : int32_t
-                          I   : uint32_t
-                          f   : float
-                          n   : char[4]
-                          N   : char[16]
-                          Z   : char[64]
-                          c   : int16_t * 100
-                          C   : uint16_t * 100
-                          e   : int32_t * 100
-                          E   : uint32_t * 100
-                          L   : int32_t latitude/longitude
-                          M   : uint8_t flight mode
-                          q   : int64_t
-                          Q   : uint64_t
-                        */
-                        QString typestr = nameToTypeString[name];
-                        static QString intdef("bBhHiI"); // 32 bit max types.
-                        static QString floatdef("cCeEfL");
-                        static QString chardef("nNZM");
-                        if (typestr.size() != linesplit.size() - 1)
-                        {
-                            QLOG_DEBUG() << "Error in line:" << index << "param" << name << "parameter mismatch";
-                            m_plotState.corruptDataRead(index, "Error in line:" + QString::number(index) +  " parameter mismatch for " + name + " data.");
-                        }
-                        else
-                        {
-                            QList<QPair<QString,QVariant> > valuepairlist;
-                            QStringList valuestrlist = nameToValueList.value(name);
-
-                            bool foundError = false;
-                            for (int i = 1; i < linesplit.size(); i++)
-                            {
-                                QString subname = "";
-                                if (valuestrlist.size() > i-1)
-                                {
-                                    subname = valuestrlist.at(i-1);
-                                }
-                                else
-                                {
-                                    continue;
-                                }
-                                bool ok;
-                                QChar typeCode = typestr.at(i - 1);
-                                QString valStr = linesplit[i].trimmed();
-                                if (intdef.contains(typeCode))
-                                {
-                                    int val = valStr.toInt(&ok);
-                                    if (ok)
-                                    {
-                                        valuepairlist.append(QPair<QString,QVariant>(subname,val));
-                                    }
-                                    else
-                                    {
-                                        QLOG_DEBUG() << "Failed to convert " << valStr << " to an integer number.";
-                                        m_plotState.corruptDataRead(index, name + " data: Failed to convert " + valStr + " to an integer number.");
-                                        foundError = true;
-                                    }
-                                }
-                                else if (chardef.contains(typeCode))
-                                {
-                                    valuepairlist.append(QPair<QString,QVariant>(subname,valStr));
-                                }
-                                else if (floatdef.contains(typeCode))
-                                {
-                                    double val = valStr.toDouble(&ok);
-                                    if (ok && !isinf(val) && !isnan(val))
-                                    {
-                                        valuepairlist.append(QPair<QString,QVariant>(subname,val));
-                                    }
-                                    else
-                                    {
-                                        QLOG_DEBUG() << "Failed to convert " << valStr << " to a floating point number.";
-                                        m_plotState.corruptDataRead(index, name + " data: Failed to convert " + valStr + " to a floating point number.");
-                                        foundError = true;
-                                    }
-                                }
-                                else if (QString('q').contains(typeCode) )
-                                {
-                                    quint64 val = valStr.toLongLong(&ok);
-                                    if (ok)
-                                    {
-                                        valuepairlist.append(QPair<QString,QVariant>(subname,val));
-                                    }
-                                    else
-                                    {
-                                        QLOG_DEBUG() << "Failed to convert " << valStr << " to an qint64 number.";
-                                        m_plotState.corruptDataRead(index, name + " data: Failed to convert " + valStr + " to an qint64 number.");
-                                        foundError = true;
-                                    }
-                                }
-                                else if (QString('Q').contains(typeCode) )
-                                {
-                                    quint64 val = valStr.toULongLong(&ok);
-                                    if (ok)
-                                    {
-                                        valuepairlist.append(QPair<QString,QVariant>(subname,val));
-                                    }
-                                    else
-                                    {
-                                        QLOG_DEBUG() << "Failed to convert " << valStr << " to an quint64 number.";
-                                        m_plotState.corruptDataRead(index, name + " data: Failed to convert " + valStr + " to an quint64 number.");
-                                        foundError = true;
-                                    }
-                                }
-                                else
-                                {
-                                    QLOG_DEBUG() << "AP2DataPlotThread::run(): Unknown data value found" << typeCode;
-                                    m_plotState.corruptDataRead(index, name + " data: Unknown data value found: %1" + QString(typeCode));
-                                    return;
-                                }
-                            }
-                            if (!foundError)
-                            {
-                                if (valuepairlist.size() >= 1)
-                                {
-                                    if (!m_dataModel->addRow(name,valuepairlist,index++))
-                                    {
-                                        QString actualerror = m_dataModel->getError();
-                                        m_dataModel->endTransaction(); //endTransaction can re-set the error if it errors, but we should try it anyway.
-                                        emit error(actualerror);
-                                        return;
-                                    }
-                                    m_plotState.validDataRead();
-                                }
-                            }
-                        }
-                    }
-                    else
+                    m_plotState.corruptDataRead(index, errorText);
+                }
+                if (record.status == LogRecord::Fatal)
+                {
+                    return;
+                }
+                if (record.status == LogRecord::Mismatch)
+                {
+                    const QString &name = m_asciiFormats.at(record.format).name;
+                    QLOG_DEBUG() << "Error in line:" << index << "param" << name << "parameter mismatch";
+                    m_plotState.corruptDataRead(index, "Error in line:" + QString::number(index) +  " parameter mismatch for " + name + " data.");
+                }
+                else if (record.status == LogRecord::Valid && record.values.size() >= 1)
+                {
+                    if (!m_dataModel->addRow(m_asciiFormats.at(record.format).name,record.values,index++))
                     {
-                        QLOG_DEBUG() << "Found line " << index << " with unknown command " << name << ", skipping...";
-                        m_plotState.corruptDataRead(index, name + " data: Found line with unknown command");
+                        QString actualerror = m_dataModel->getError();
+                        m_dataModel->endTransaction(); //endTransaction can re-set the error if it errors, but we should try it anyway.
+                        emit error(actualerror);
+                        return;
                     }
+                    m_plotState.validDataRead();
                 }
-
             }
         }
     }
+    emit loadProgress(pos,size);
+    // Keep the file position meaningful for the load statistics in run()
+    logfile.seek(pos);
+    if (mapped)
+    {
+        logfile.unmap(const_cast<uchar*>(data));
+    }
+
     if (!m_dataModel->endTransaction())
     {
         emit error(m_dataModel->getError());
@@ -638,149 +866,169 @@ void AP2DataPlotThread::loadTLog(QFile &logfile)
 {
     m_loadedLogType = MAV_TYPE_GENERIC;
     int nrOfEmptyMsg = 0;
-    int bytesize = 0;
     int index = 100;
     mavlink_message_t message;
-    mavlink_status_t status;
     m_decoder = QSharedPointer<MAVLinkDecoder>(new MAVLinkDecoder());
 
+    const qint64 size = logfile.size();
+    QByteArray fallback;
+    const uchar *data = logfile.map(0, size);
+    const bool mapped = (data != NULL);
+    if (!mapped && size > 0)
+    {
+        QLOG_WARN() << "AP2DataPlotThread::loadTLog(): unable to map log file, reading it instead:" << logfile.errorString();
+        fallback = logfile.readAll();
+        data = reinterpret_cast<const uchar*>(fallback.constData());
+    }
+
+    // The index is the boundary scan: it holds the offset of every frame
+    // with a valid CRC, and is cached for the next load or replay of the file
+    TLogIndex tlogIndex;
+    tlogIndex.load(m_fileName, data, size);
+
     if (!m_dataModel->startTransaction())
     {
         emit error(m_dataModel->getError());
         return;
     }
-    while (!logfile.atEnd() && !m_stop)
+    qint64 pos = 0;
+    for (int packet=0;packet<tlogIndex.size() && !stopRequested();packet++)
     {
-        emit loadProgress(logfile.pos(),logfile.size());
-        QByteArray bytes = logfile.read(8192);
-        bytesize += bytes.size();
+        const qint64 offset = tlogIndex.offset(packet);
+        if ((packet % 1000) == 0)
+        {
+            emit loadProgress(offset,size);
+        }
+        // Every frame follows its 8 byte timestamp, anything else was dropped
+        // by the scan
+        if (offset - static_cast<qint64>(sizeof(quint64)) > pos)
+        {
+            m_plotState.corruptDataRead(index, "Bad CRC, " + QString::number(offset - sizeof(quint64) - pos) + " bytes skipped");
+        }
+        MAVLinkFrameScanner::decodeFrame(data + offset, &message);
+        pos = offset + MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len;
 
-        for (int i=0;i<bytes.size();i++)
+        // Good decode. Now check message name. If its "EMPTY" we cannot insert it into datamodel
+        // We will count those messages and inform the user.
+        QString name = m_decoder->getMessageName(message.msgid);
+        if (name != "EMPTY")
         {
-            unsigned int decodeState = mavlink_parse_char(14, static_cast<uint8_t>(bytes[i]), &message, &status);
-            if (decodeState == MAVLINK_FRAMING_OK)
+            if (message.sysid != 255) // [TODO] GCS packet is not always 255 sysid.
             {
-                // Good decode. Now check message name. If its "EMPTY" we cannot insert it into datamodel
-                // We will count those messages and inform the user.
-                QString name = m_decoder->getMessageName(message.msgid);
-                if (name != "EMPTY")
+                QList<QPair<QString,QVariant> > retvals = m_decoder->receiveMessage(0,message);
+                if (!m_dataModel->hasType(name))
                 {
-                    if (message.sysid != 255) // [TODO] GCS packet is not always 255 sysid.
+                    QList<QString> fieldnames = m_decoder->getFieldList(name);
+                    QStringList variablenames;
+                    QString typechars;
+                    for (int i=0;i<fieldnames.size();i++)
                     {
-                        QList<QPair<QString,QVariant> > retvals = m_decoder->receiveMessage(0,message);
-                        if (!m_dataModel->hasType(name))
+                        mavlink_field_info_t fieldinfo = m_decoder->getFieldInfo(name,fieldnames.at(i));
+                        variablenames <<  QString(fieldinfo.name);
+                        switch (fieldinfo.type)
                         {
-                            QList<QString> fieldnames = m_decoder->getFieldList(name);
-                            QStringList variablenames;
-                            QString typechars;
-                            for (int i=0;i<fieldnames.size();i++)
+                            case MAVLINK_TYPE_CHAR:
                             {
-                                mavlink_field_info_t fieldinfo = m_decoder->getFieldInfo(name,fieldnames.at(i));
-                                variablenames <<  QString(fieldinfo.name);
-                                switch (fieldinfo.type)
-                                {
-                                    case MAVLINK_TYPE_CHAR:
-                                    {
-                                        typechars += "b";
-                                    }
-                                    break;
-                                    case MAVLINK_TYPE_UINT8_T:
-                                    {
-                                        typechars += "B";
-                                    }
-                                    break;
-                                    case MAVLINK_TYPE_INT8_T:
-                                    {
-                                        typechars += "b";
-                                    }
-                                    break;
-                                    case MAVLINK_TYPE_UINT16_T:
-                                    {
-                                        typechars += "H";
-                                    }
-                                    break;
-                                    case MAVLINK_TYPE_INT16_T:
-                                    {
-                                        typechars += "h";
-                                    }
-                                    break;
-                                    case MAVLINK_TYPE_UINT32_T:
-                                    {
-                                        typechars += "I";
-                                    }
-                                        break;
-                                    case MAVLINK_TYPE_INT32_T:
-                                    {
-                                        typechars += "i";
-                                    }
-                                    break;
-                                    case MAVLINK_TYPE_FLOAT:
-                                    {
-                                        typechars += "f";
-                                    }
-                                    break;
-                                    case MAVLINK_TYPE_UINT64_T:
-                                    {
-                                        typechars += "Q";
-                                    }
-                                    break;
-                                    case MAVLINK_TYPE_INT64_T:
-                                    {
-                                        typechars += "q";
-                                    }
-                                    break;
-                                    default:
-                                    {
-                                        QLOG_ERROR() << "Unknown type:" << QString::number(fieldinfo.type);
-                                        m_plotState.corruptDataRead(i, name + " data: Unknown data type:" + QString::number(fieldinfo.type));
-                                    }
-                                    break;
-                                }
+                                typechars += "b";
                             }
-
-                            if (!m_dataModel->addType(name,0,0,typechars,variablenames))
+                            break;
+                            case MAVLINK_TYPE_UINT8_T:
                             {
-                                QString actualerror = m_dataModel->getError();
-                                m_dataModel->endTransaction(); //endTransaction can re-set the error if it errors, but we should try it anyway.
-                                emit error(actualerror);
-                                return;
+                                typechars += "B";
                             }
-                        }
-
-                        QList<QPair<QString,QVariant> > valuepairlist;
-                        for (int i=0;i<retvals.size();i++)
-                        {
-                            valuepairlist.append(QPair<QString,QVariant>(retvals.at(i).first.split(".")[1],retvals.at(i).second));
-                        }
-                        if (valuepairlist.size() >= 1)
-                        {
-                            if (!m_dataModel->addRow(name,valuepairlist, index++))
+                            break;
+                            case MAVLINK_TYPE_INT8_T:
+                            {
+                                typechars += "b";
+                            }
+                            break;
+                            case MAVLINK_TYPE_UINT16_T:
+                            {
+                                typechars += "H";
+                            }
+                            break;
+                            case MAVLINK_TYPE_INT16_T:
+                            {
+                                typechars += "h";
+                            }
+                            break;
+                            case MAVLINK_TYPE_UINT32_T:
+                            {
+                                typechars += "I";
+                            }
+                                break;
+                            case MAVLINK_TYPE_INT32_T:
+                            {
+                                typechars += "i";
+                            }
+                            break;
+                            case MAVLINK_TYPE_FLOAT:
+                            {
+                                typechars += "f";
+                            }
+                            break;
+                            case MAVLINK_TYPE_UINT64_T:
+                            {
+                                typechars += "Q";
+                            }
+                            break;
+                            case MAVLINK_TYPE_INT64_T:
+                            {
+                                typechars += "q";
+                            }
+                            break;
+                            default:
                             {
-                                QString actualerror = m_dataModel->getError();
-                                m_dataModel->endTransaction(); //endTransaction can re-set the error if it errors, but we should try it anyway.
-                                emit error(actualerror);
-                                return;
+                                QLOG_ERROR() << "Unknown type:" << QString::number(fieldinfo.type);
+                                m_plotState.corruptDataRead(i, name + " data: Unknown data type:" + QString::number(fieldinfo.type));
                             }
-                            m_plotState.validDataRead();    // tell plot state that we have a valid message
+                            break;
                         }
                     }
+
+                    if (!m_dataModel->addType(name,0,0,typechars,variablenames))
+                    {
+                        QString actualerror = m_dataModel->getError();
+                        m_dataModel->endTransaction(); //endTransaction can re-set the error if it errors, but we should try it anyway.
+                        emit error(actualerror);
+                        return;
+                    }
                 }
-                else
+
+                QList<QPair<QString,QVariant> > valuepairlist;
+                for (int i=0;i<retvals.size();i++)
                 {
-                    nrOfEmptyMsg++;
+                    valuepairlist.append(QPair<QString,QVariant>(retvals.at(i).first.split(".")[1],retvals.at(i).second));
+                }
+                if (valuepairlist.size() >= 1)
+                {
+                    if (!m_dataModel->addRow(name,valuepairlist, index++))
+                    {
+                        QString actualerror = m_dataModel->getError();
+                        m_dataModel->endTransaction(); //endTransaction can re-set the error if it errors, but we should try it anyway.
+                        emit error(actualerror);
+                        return;
+                    }
+                    m_plotState.validDataRead();    // tell plot state that we have a valid message
                 }
             }
-            else if (decodeState == MAVLINK_FRAMING_BAD_CRC)
-            {
-                m_plotState.corruptDataRead(index, "Bad CRC");
-            }
-
+        }
+        else
+        {
+            nrOfEmptyMsg++;
         }
     }
     if (nrOfEmptyMsg != 0) // Did we have messages named "EMPTY" ?
     {
         m_plotState.corruptDataRead(0, "Found " + QString::number(nrOfEmptyMsg) +" 'EMPTY' messages wich could not be processed");
     }
+    emit loadProgress(pos,size);
+    // Keep the file position meaningful for the load statistics in run()
+    logfile.seek(pos);
+    if (mapped)
+    {
+        logfile.unmap(const_cast<uchar*>(data));
+    }
     if (!m_dataModel->endTransaction())
     {
         emit error(m_dataModel->getError());
@@ -792,7 +1040,7 @@ void AP2DataPlotThread::run()
 {
     Q_ASSERT(!isMainThread());
     emit startLoad();
-    m_stop = false;
+    m_stop.storeRelease(0);
     qint64 msecs = QDateTime::currentMSecsSinceEpoch();
 
     QFile logfile(m_fileName);
@@ -826,7 +1074,7 @@ void AP2DataPlotThread::run()
     }
 
 
-    if (m_stop)
+    if (stopRequested())
     {
         QLOG_ERROR() << "Plot Log loading was canceled after" << (QDateTime::currentMSecsSinceEpoch() - msecs) / 1000.0 << "seconds -" << logfile.pos() << "of" << logfile.size() << "bytes";
         emit error("Log loading Canceled");
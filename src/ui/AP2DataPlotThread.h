@@ -31,8 +31,11 @@ This file is part of the APM_PLANNER project
 #define AP2DATAPLOTTHREAD_H
 
 #include <QThread>
+#include <QThreadPool>
+#include <QAtomicInt>
 #include <QVariantMap>
-#include <QSqlDatabase>
+#include <QVector>
+#include <QStringList>
 #include "MAVLinkDecoder.h"
 #include "AP2DataPlot2DModel.h"
 #include "libs/mavlink/include/mavlink/v1.0/ardupilotmega/mavlink.h"
@@ -131,7 +134,7 @@ public:
     ~AP2DataPlotThread();
 
     void loadFile(const QString& file);
-    void stopLoad() { m_stop = true; }
+    void stopLoad() { m_stop.storeRelease(1); }
 
 signals:
     void startLoad();
@@ -145,18 +148,99 @@ private:
     void run(); // from QThread;
     bool isMainThread();
 
+    /**
+     * @brief The DataFlashFormat struct
+     *        A FMT message compiled for decoding. Built once per FMT packet,
+     *        so every data packet decodes with direct reads at fixed offsets.
+     */
+    struct DataFlashFormat
+    {
+        DataFlashFormat() : type(0), length(0), hasTable(false) {}
+        unsigned char type;     /// Message type the format describes
+        int length;             /// Packet length including the 3 byte header
+        QString name;
+        QByteArray format;
+        QStringList labels;
+        QVector<int> offsets;   /// Payload offset of each field, -1 for unknown type codes
+        QString error;          /// Why the format is unusable, empty if it is fine
+        bool hasTable;          /// Whether the model holds a table for name
+    };
+
+    /**
+     * @brief The AsciiFormat struct
+     *        Format of a message in an ASCII log, taken from its FMT line.
+     */
+    struct AsciiFormat
+    {
+        AsciiFormat() : typeId(0), length(0) {}
+        QString name;
+        QString types;
+        QStringList labels;
+        int typeId;
+        int length;
+    };
+
+    /**
+     * @brief The LogRecord struct
+     *        One message of a log. The boundary scan finds it, a decode worker
+     *        fills in the values and the merge adds it to the model in file
+     *        order. Every worker only touches the records of its own chunk.
+     */
+    struct LogRecord
+    {
+        enum Kind
+        {
+            DataRecord,         /// Message to decode
+            FormatRecord,       /// FMT message, format holds the compiled format or -1 if corrupt
+            GarbageRecord,      /// length bytes that are not part of any message
+            UnknownTypeRecord,  /// Header of a type without format, length holds the type
+            IgnoredRecord       /// Nothing to add to the model
+        };
+        enum Status
+        {
+            Valid,
+            Corrupt,            /// Row must not be added, errors tell why
+            Mismatch,           /// Field count does not match the format
+            Fatal               /// Loading can not continue
+        };
+        LogRecord() : kind(DataRecord), status(Valid), format(-1), offset(0), length(0) {}
+        Kind kind;
+        Status status;
+        int format;             /// Index into the compiled formats
+        qint64 offset;          /// Start of the payload (DataFlash) or line (ASCII) in the file
+        int length;
+        QString line;           /// Text of an ASCII line
+        QList<QPair<QString,QVariant> > values;
+        QStringList errors;     /// Errors found while decoding, in field order
+    };
+    typedef void (AP2DataPlotThread::*RecordDecoder)(const uchar *data, LogRecord &record) const;
+    friend class AP2DataPlotDecodeTask;
+
     void loadDataFieldsFromValues();
     void loadBinaryLog(QFile &logfile);
     void loadAsciiLog(QFile &logfile);
     void loadTLog(QFile &logfile);
 
+    void compileDataFlashFormat(const uchar *packet, DataFlashFormat &format) const;
+    void decodeDataFlashRecord(const uchar *data, LogRecord &record) const;
+    void decodeAsciiRecord(const uchar *data, LogRecord &record) const;
+    /**
+     * @brief Decode a window of records on all cores and wait for the result.
+     */
+    void decodeRecords(const uchar *data, QVector<LogRecord> &records, RecordDecoder decoder);
+    void detectLogType(const QString& line);
+    bool stopRequested() const { return m_stop.loadAcquire() != 0; }
+
 private:
     QString m_fileName;
-    bool m_stop;
+    QAtomicInt m_stop;  ///< Set from the GUI thread, polled by the loader and decode workers
     MAV_TYPE m_loadedLogType;
     QSharedPointer<MAVLinkDecoder> m_decoder;
     AP2DataPlot2DModel *m_dataModel;
     QMap<QString,QString> m_msgNameToInsertQuery;
+    QThreadPool m_threadPool;
+    QVector<DataFlashFormat> m_dataFlashFormats;    /// All FMTs of the current log, in file order
+    QVector<AsciiFormat> m_asciiFormats;
 
     AP2DataPlotStatus m_plotState;
 };
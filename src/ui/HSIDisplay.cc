@@ -46,6 +46,13 @@ This file is part of the QGROUNDCONTROL project
 #include <QDoubleSpinBox>
 #include <qmath.h>
 
+// Smallest changes that cause a repaint, below the resolution of the displayed numbers
+static const float HSI_ANGLE_REPAINT_THRESHOLD = 0.005f;    // radians
+static const float HSI_POSITION_REPAINT_THRESHOLD = 0.01f;  // meters and m/s
+static const float HSI_GLOBAL_REPAINT_THRESHOLD = 0.005f;   // degrees
+// Sensor and controller flags are not tracked, they are refreshed at least this often (ms)
+static const int HSI_KEEPALIVE_INTERVAL = 1000;
+
 HSIDisplay::HSIDisplay(QWidget *parent) :
     HDDisplay(NULL, "HSI", parent),
     dragStarted(false),
@@ -149,9 +156,24 @@ HSIDisplay::HSIDisplay(QWidget *parent) :
     userSetPointSet(false),
     userXYSetPointSet(false),
     userZSetPointSet(false),
-    userYawSetPointSet(false)
+    userYawSetPointSet(false),
+    refreshInterval(updateInterval),
+    repaintRequested(true),
+    paintedYaw(0.0f),
+    paintedX(0.0f),
+    paintedY(0.0f),
+    paintedZ(0.0f),
+    paintedLat(0.0f),
+    paintedLon(0.0f),
+    paintedAlt(0.0f),
+    paintedSpeed(0.0f),
+    ringLabelsMetricWidth(0.0)
 {
-    refreshTimer->setInterval(updateInterval);
+    // Only repaint on timer ticks where something changed
+    disconnect(refreshTimer, SIGNAL(timeout()), this, SLOT(triggerUpdate()));
+    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(refreshIfChanged()));
+    refreshTimer->setInterval(refreshInterval);
+    lastPaint.start();
 
     columns = 1;
     this->setAutoFillBackground(true);
@@ -232,12 +254,51 @@ void HSIDisplay::paintEvent(QPaintEvent * event)
     renderOverlay();
 }
 
+void HSIDisplay::setMaxRefreshRate(int rate)
+{
+    if (rate <= 0)
+    {
+        return;
+    }
+    refreshInterval = 1000 / rate;
+    refreshTimer->setInterval(refreshInterval);
+}
+
+void HSIDisplay::refreshIfChanged()
+{
+    if (repaintRequested
+            || lastPaint.elapsed() >= HSI_KEEPALIVE_INTERVAL
+            || qAbs(yaw - paintedYaw) >= HSI_ANGLE_REPAINT_THRESHOLD
+            || qAbs(x - paintedX) >= HSI_POSITION_REPAINT_THRESHOLD
+            || qAbs(y - paintedY) >= HSI_POSITION_REPAINT_THRESHOLD
+            || qAbs(z - paintedZ) >= HSI_POSITION_REPAINT_THRESHOLD
+            || qAbs(speed - paintedSpeed) >= HSI_POSITION_REPAINT_THRESHOLD
+            || qAbs(lat - paintedLat) >= HSI_GLOBAL_REPAINT_THRESHOLD
+            || qAbs(lon - paintedLon) >= HSI_GLOBAL_REPAINT_THRESHOLD
+            || qAbs(alt - paintedAlt) >= HSI_POSITION_REPAINT_THRESHOLD)
+    {
+        triggerUpdate();
+    }
+}
+
 void HSIDisplay::renderOverlay()
 {
     if (!isVisible()) return;
 #if (QGC_EVENTLOOP_DEBUG)
     QLOG_DEBUG() << "EVENTLOOP:" << __FILE__ << __LINE__;
 #endif
+    // Remember what this frame shows, refreshIfChanged() compares against it
+    repaintRequested = false;
+    lastPaint.restart();
+    paintedYaw = yaw;
+    paintedX = x;
+    paintedY = y;
+    paintedZ = z;
+    paintedSpeed = speed;
+    paintedLat = lat;
+    paintedLon = lon;
+    paintedAlt = alt;
+
     // Center location of the HSI gauge items
 
     //float bottomMargin = 3.0f;
@@ -266,12 +327,29 @@ void HSIDisplay::renderOverlay()
     pen.setColor(ringColor);
     pen.setWidth(refLineWidthToPen(1.0f));
     painter.setPen(pen);
-    const int ringCount = 2;
+    const QSize viewportSize = viewport()->size();
+    const bool updateRingLabels = ringLabelsViewport != viewportSize || ringLabelsMetricWidth != metricWidth
+            || ringLabels[0].devicePixelRatio() != devicePixelRatio();
+    ringLabelsViewport = viewportSize;
+    ringLabelsMetricWidth = metricWidth;
     for (int i = 0; i < ringCount; i++)
     {
         float radius = (vwidth - (topMargin + bottomMargin)*0.3f) / (1.35f * i+1) / 2.0f - bottomMargin / 2.0f;
         drawCircle(xCenterPos, yCenterPos, radius, 1.0f, ringColor, &painter);
-        paintText(tr("%1 m").arg(refToMetric(radius), 5, 'f', 1, ' '), QGC::colorCyan, 1.6f, vwidth/2-4, vheight/2+radius+2.2, &painter);
+        if (updateRingLabels)
+        {
+            // paintText() starts the line slightly above refY, leave room for it
+            const float labelY = vheight/2+radius+2.2;
+            const int lineHeight = qMax(5, (int)(1.6f*scalingFactor*1.26f)) * 2;
+            ringLabelOrigins[i] = QPoint(0, static_cast<int>(floor(refToScreenY(labelY) - 1.6f*scalingFactor*0.212f)) - 1);
+            ringLabels[i] = QPixmap(QSize(viewportSize.width(), lineHeight) * devicePixelRatio());
+            ringLabels[i].setDevicePixelRatio(devicePixelRatio());
+            ringLabels[i].fill(Qt::transparent);
+            QPainter labelPainter(&ringLabels[i]);
+            labelPainter.translate(-ringLabelOrigins[i]);
+            paintText(tr("%1 m").arg(refToMetric(radius), 5, 'f', 1, ' '), QGC::colorCyan, 1.6f, vwidth/2-4, labelY, &labelPainter);
+        }
+        painter.drawPixmap(ringLabelOrigins[i], ringLabels[i]);
     }
 
     // Draw orientation labels
@@ -660,6 +738,7 @@ QPointF HSIDisplay::metricBodyToScreen(QPointF metric)
 
 void HSIDisplay::mouseDoubleClickEvent(QMouseEvent * event)
 {
+    repaintRequested = true;
     if (event->type() == QMouseEvent::MouseButtonDblClick)
     {
         QPointF p = screenToMetricBody(event->pos());
@@ -674,6 +753,7 @@ void HSIDisplay::mouseDoubleClickEvent(QMouseEvent * event)
 
 void HSIDisplay::mouseReleaseEvent(QMouseEvent * event)
 {
+    repaintRequested = true;
     // FIXME hardcode yaw to current value
     //setBodySetpointCoordinateYaw(0);
     if (mouseHasMoved)
@@ -700,6 +780,7 @@ void HSIDisplay::mouseReleaseEvent(QMouseEvent * event)
 
 void HSIDisplay::mousePressEvent(QMouseEvent * event)
 {
+    repaintRequested = true;
     if (event->type() == QMouseEvent::MouseButtonPress)
     {
         if (event->button() == Qt::RightButton)
@@ -719,6 +800,7 @@ void HSIDisplay::mousePressEvent(QMouseEvent * event)
 
 void HSIDisplay::mouseMoveEvent(QMouseEvent * event)
 {
+    repaintRequested = true;
     if (event->type() == QMouseEvent::MouseMove)
     {
         if (dragStarted) uiYawSet -= 0.06f*(startX - event->x()) / this->frameSize().width();
@@ -735,6 +817,7 @@ void HSIDisplay::mouseMoveEvent(QMouseEvent * event)
 
 void HSIDisplay::keyPressEvent(QKeyEvent* event)
 {
+    repaintRequested = true;
     QPointF bodySP = metricWorldToBody(QPointF(uiXSetCoordinate, uiYSetCoordinate));
 
     if ((event->key() == Qt::Key_Enter || event->key() == Qt::Key_Return) && actionPending)
@@ -846,6 +929,7 @@ void HSIDisplay::setMetricWidth(double width)
 {
     if (width != metricWidth) {
         metricWidth = width;
+        repaintRequested = true;
         emit metricWidthChanged(metricWidth);
     }
 }
@@ -924,6 +1008,7 @@ void HSIDisplay::setActiveUAS(UASInterface* uas)
     this->uas = uas;
 
     resetMAVState();
+    repaintRequested = true;
 }
 
 void HSIDisplay::updateSpeed(UASInterface* uas, double vx, double vy, double vz, quint64 time)
@@ -1474,6 +1559,7 @@ void HSIDisplay::drawAltitudeSetpoint(float xRef, float yRef, float radius, cons
 
 void HSIDisplay::wheelEvent(QWheelEvent* event)
 {
+    repaintRequested = true;
     double zoomScale = 0.005; // Scaling of zoom value
     if(event->delta() > 0) {
         // Reduce width -> Zoom in
@@ -1491,7 +1577,7 @@ void HSIDisplay::showEvent(QShowEvent* event)
     // React only to internal (pre-display)
     // events
     Q_UNUSED(event) {
-        refreshTimer->start(updateInterval);
+        refreshTimer->start(refreshInterval);
     }
 }
 
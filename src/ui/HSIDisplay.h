@@ -39,6 +39,8 @@ This file is part of the QGROUNDCONTROL project
 #include <QPair>
 #include <QMouseEvent>
 #include <cmath>
+#include <QElapsedTimer>
+#include <QPixmap>
 
 #include "HDDisplay.h"
 #include "MG.h"
@@ -54,6 +56,8 @@ public slots:
     void setActiveUAS(UASInterface* uas);
     /** @brief Set the width in meters this widget shows from top */
     void setMetricWidth(double width);
+    /** @brief Limit the number of frames painted per second */
+    void setMaxRefreshRate(int rate);
     void updateSatellite(int uasid, int satid, float azimuth, float direction, float snr, bool used);
     void updateAttitudeSetpoints(UASInterface*, double rollDesired, double pitchDesired, double yawDesired, double thrustDesired, quint64 usec);
     void updateAttitude(UASInterface* uas, double roll, double pitch, double yaw, quint64 time);
@@ -172,6 +176,7 @@ public slots:
         statusClearTimer.start();
         userSetPointSet = false;
         actionPending = false;
+        repaintRequested = true;
     }
 
 signals:
@@ -218,7 +223,10 @@ protected slots:
     {
         statusMessage = message;
         statusClearTimer.start();
+        repaintRequested = true;
     }
+    /** @brief Repaint if the vehicle moved by more than the thresholds or the view was changed */
+    void refreshIfChanged();
 
 protected:
 
@@ -418,6 +426,27 @@ protected:
     bool userZSetPointSet;   ///< User set the Z position already
     bool userYawSetPointSet;   ///< User set the YAW position already
 
+    // Repaint control
+    int refreshInterval;       ///< Minimum time between two frames in milliseconds
+    bool repaintRequested;     ///< The view changed in a way the thresholds do not cover
+    QElapsedTimer lastPaint;   ///< Time since the last frame, sensor flags are refreshed at least every HSI_KEEPALIVE_INTERVAL
+    float paintedYaw;          ///< Values shown by the last painted frame
+    float paintedX;
+    float paintedY;
+    float paintedZ;
+    float paintedLat;
+    float paintedLon;
+    float paintedAlt;
+    float paintedSpeed;
+
+    // The range ring labels only change with size and zoom. Each is rendered
+    // once into a strip just tall enough for its line of text.
+    static const int ringCount = 2;
+    QPixmap ringLabels[ringCount];
+    QPoint ringLabelOrigins[ringCount];
+    QSize ringLabelsViewport;
+    double ringLabelsMetricWidth;
+
 private:
 };
 
@@ -79,6 +79,8 @@ This file is part of the QGROUNDCONTROL project
 #include <QMessageBox>
 
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QVBoxLayout>
 #include <QHostInfo>
 #include <QSplashScreen>
 #include <QGCHilLink.h>
@@ -143,6 +145,7 @@ MainWindow::MainWindow(QWidget *parent):
     centerStackActionGroup(new QActionGroup(this)),
     styleFileName(QCoreApplication::applicationDirPath() + "/style-outdoor.css"),
     m_heartbeatEnabled(true),
+    m_firstUASLogged(false),
     m_droneshareDialog(NULL),
     m_terminalDialog(NULL)
 {
@@ -214,6 +217,7 @@ MainWindow::MainWindow(QWidget *parent):
 
     buildCommonWidgets();
     connectCommonWidgets();
+    QLOG_INFO() << "Startup: common widgets built after" << QGC::applicationUptimeMilliseconds() << "ms";
 
     emit initStatusChanged("Building common actions.");
 
@@ -292,6 +296,7 @@ MainWindow::MainWindow(QWidget *parent):
 
     // Restore the window setup
     loadViewState();
+    QLOG_INFO() << "Startup: view state restored after" << QGC::applicationUptimeMilliseconds() << "ms";
 
     emit initStatusChanged("Restoring last window size.");
     // Restore the window position and size
@@ -581,12 +586,12 @@ void MainWindow::buildCommonWidgets()
     connect(logPlayer,SIGNAL(logFinished()),statusBar(),SLOT(hide()));
     customStatusBar->setLogPlayer(logPlayer);
 
-    // Center widgets
+    // Center widgets. Only the empty view shells are created here, their contents are
+    // built by prepareView() the first time each view is selected.
     if (!plannerView)
     {
         plannerView = new SubMainWindow(this);
         plannerView->setObjectName("VIEW_MISSION");
-        plannerView->setCentralWidget(new QGCMapTool(this));
         addToCentralStackedWidget(plannerView, VIEW_MISSION, "Maps");
     }
 
@@ -595,7 +600,6 @@ void MainWindow::buildCommonWidgets()
     {
         pilotView = new SubMainWindow(this);
         pilotView->setObjectName("VIEW_FLIGHT");
-        pilotView->setCentralWidget(new QGCMapTool(this));
         addToCentralStackedWidget(pilotView, VIEW_FLIGHT, "Pilot");
     }
 
@@ -603,32 +607,20 @@ void MainWindow::buildCommonWidgets()
     {
         configView = new SubMainWindow(this);
         configView->setObjectName("VIEW_HARDWARE_CONFIG");
-        ApmHardwareConfig* aphw = new ApmHardwareConfig(this);
-        configView->setCentralWidget(aphw);
         addToCentralStackedWidget(configView,VIEW_HARDWARE_CONFIG, tr("Hardware"));
-        connect(ui.actionAdvanced_Mode, SIGNAL(toggled(bool)), aphw, SLOT(advModeChanged(bool)));
     }
 
     if (!softwareConfigView)
     {
         softwareConfigView = new SubMainWindow(this);
         softwareConfigView->setObjectName("VIEW_SOFTWARE_CONFIG");
-        ApmSoftwareConfig* apsw = new ApmSoftwareConfig(this);
-        softwareConfigView->setCentralWidget(apsw);
         addToCentralStackedWidget(softwareConfigView, VIEW_SOFTWARE_CONFIG, tr("Software"));
-        connect(ui.actionAdvanced_Mode, SIGNAL(toggled(bool)), apsw, SLOT(advModeChanged(bool)));
     }
 
-     AP2DataPlot2D *plot = NULL;
     if (!engineeringView)
     {
         engineeringView = new SubMainWindow(this);
         engineeringView->setObjectName("VIEW_ENGINEER");
-        //engineeringView->setCentralWidget(new QGCDataPlot2D(this));
-        plot = new AP2DataPlot2D(this);
-        connect(logPlayer,SIGNAL(logLoaded()),plot,SLOT(clearGraph()));
-        engineeringView->setCentralWidget(plot);
-
         addToCentralStackedWidget(engineeringView, VIEW_ENGINEER, tr("Logfile Plot"));
     }
 
@@ -644,7 +636,6 @@ void MainWindow::buildCommonWidgets()
     {
         simView = new SubMainWindow(this);
         simView->setObjectName("VIEW_SIMULATOR");
-        simView->setCentralWidget(new QGCMapTool(this));
         addToCentralStackedWidget(simView, VIEW_SIMULATION, tr("Simulation View"));
     }
 
@@ -654,14 +645,28 @@ void MainWindow::buildCommonWidgets()
         QsLogging::Logger::instance().addDestination(QsLogging::DestinationPtr(debugOutput));
     }
 
-    // Dock widgets
-    QAction* tempAction = ui.menuTools->addAction(tr("Control"));
-    tempAction->setCheckable(true);
-    connect(tempAction,SIGNAL(triggered(bool)),this, SLOT(showTool(bool)));
+    // Tools menu entries. The docks of the default layouts are created with their view,
+    // so their entries are added up front to keep the menu complete.
+    {
+        QAction* tempAction = ui.menuTools->addAction(tr("Control"));
+        tempAction->setCheckable(true);
+        connect(tempAction,SIGNAL(triggered(bool)),this, SLOT(showTool(bool)));
+        menuToDockNameMap[tempAction] = "UNMANNED_SYSTEM_CONTROL_DOCKWIDGET";
+    }
 
-    createDockWidget(simView,new UASControlWidget(this),tr("Control"),"UNMANNED_SYSTEM_CONTROL_DOCKWIDGET",VIEW_SIMULATION,Qt::LeftDockWidgetArea);
-    createDockWidget(plannerView,new UASListWidget(this),tr("Unmanned Systems"),"UNMANNED_SYSTEM_LIST_DOCKWIDGET",VIEW_MISSION,Qt::LeftDockWidgetArea);
-    createDockWidget(plannerView,new QGCWaypointListMulti(this),tr("Mission Plan"),"WAYPOINT_LIST_DOCKWIDGET",VIEW_MISSION,Qt::BottomDockWidgetArea);
+    {
+        QAction* tempAction = ui.menuTools->addAction(tr("Unmanned Systems"));
+        tempAction->setCheckable(true);
+        connect(tempAction,SIGNAL(triggered(bool)),this, SLOT(showTool(bool)));
+        menuToDockNameMap[tempAction] = "UNMANNED_SYSTEM_LIST_DOCKWIDGET";
+    }
+
+    {
+        QAction* tempAction = ui.menuTools->addAction(tr("Mission Plan"));
+        tempAction->setCheckable(true);
+        connect(tempAction,SIGNAL(triggered(bool)),this, SLOT(showTool(bool)));
+        menuToDockNameMap[tempAction] = "WAYPOINT_LIST_DOCKWIDGET";
+    }
 
     {   // Widget that shows the elevation changes over a mission.
         QAction* tempAction = ui.menuTools->addAction(tr("Mission Elevation"));
@@ -670,9 +675,12 @@ void MainWindow::buildCommonWidgets()
         menuToDockNameMap[tempAction] = "MISSION_ELEVATION_DOCKWIDGET";
     }
 
-    createDockWidget(simView,new QGCWaypointListMulti(this),tr("Mission Plan"),"WAYPOINT_LIST_DOCKWIDGET",VIEW_SIMULATION,Qt::BottomDockWidgetArea);
-    createDockWidget(simView,new ParameterInterface(this),tr("Parameters"),"PARAMETER_INTERFACE_DOCKWIDGET",VIEW_SIMULATION,Qt::RightDockWidgetArea);
-
+    {
+        QAction* tempAction = ui.menuTools->addAction(tr("Parameters"));
+        tempAction->setCheckable(true);
+        connect(tempAction,SIGNAL(triggered(bool)),this, SLOT(showTool(bool)));
+        menuToDockNameMap[tempAction] = "PARAMETER_INTERFACE_DOCKWIDGET";
+    }
 
     /*{ //Status details disabled until such a point that we can ensure it's completly operational
         QAction* tempAction = ui.menuTools->addAction(tr("Status Details"));
@@ -716,12 +724,18 @@ void MainWindow::buildCommonWidgets()
     //HUD disabled until such a point that we can ensure it's completly operational
     //createDockWidget(engineeringView,new HUD(320,240,this),tr("Video Downlink"),"HEAD_UP_DISPLAY_DOCKWIDGET",VIEW_ENGINEER,Qt::RightDockWidgetArea,this->width()/1.5);
 
+    {
+        QAction* tempAction = ui.menuTools->addAction(tr("Primary Flight Display"));
+        tempAction->setCheckable(true);
+        connect(tempAction,SIGNAL(triggered(bool)),this, SLOT(showTool(bool)));
 #ifndef PFD_QML
-    createDockWidget(simView,new PrimaryFlightDisplay(320,240,this),tr("Primary Flight Display"),
-                     "PRIMARY_FLIGHT_DISPLAY_DOCKWIDGET",VIEW_SIMULATION,Qt::RightDockWidgetArea);
-    createDockWidget(pilotView,new PrimaryFlightDisplay(320,240,this),tr("Primary Flight Display"),
-                     "PRIMARY_FLIGHT_DISPLAY_DOCKWIDGET",VIEW_FLIGHT,Qt::LeftDockWidgetArea);
+        menuToDockNameMap[tempAction] = "PRIMARY_FLIGHT_DISPLAY_DOCKWIDGET";
+#else
+        menuToDockNameMap[tempAction] = "PRIMARY_FLIGHT_DISPLAY_QML_DOCKWIDGET";
+#endif
+    }
 
+#ifndef PFD_QML
     { //This is required since we don't show the new PFD in full yet
         QAction* tempAction = ui.menuTools->addAction(tr("Primary Flight Display (2)"));
         tempAction->setCheckable(true);
@@ -729,11 +743,6 @@ void MainWindow::buildCommonWidgets()
         menuToDockNameMap[tempAction] = "PRIMARY_FLIGHT_DISPLAY_QML_DOCKWIDGET";
     }
 #else
-    createDockWidget(simView,new PrimaryFlightDisplayQML(this),tr("Primary Flight Display"),
-                     "PRIMARY_FLIGHT_DISPLAY_QML_DOCKWIDGET",VIEW_SIMULATION,Qt::RightDockWidgetArea);
-    createDockWidget(pilotView,new PrimaryFlightDisplayQML(this),tr("Primary Flight Display"),
-                     "PRIMARY_FLIGHT_DISPLAY_QML_DOCKWIDGET",VIEW_FLIGHT,Qt::LeftDockWidgetArea);
-
     { //This is required since we don't show the old PFD in any view
         QAction* tempAction = ui.menuTools->addAction(tr("Primary Flight Display (old)"));
         tempAction->setCheckable(true);
@@ -742,6 +751,13 @@ void MainWindow::buildCommonWidgets()
     }
 #endif
 
+    {
+        QAction* tempAction = ui.menuTools->addAction(tr("Info View"));
+        tempAction->setCheckable(true);
+        connect(tempAction,SIGNAL(triggered(bool)),this, SLOT(showTool(bool)));
+        menuToDockNameMap[tempAction] = "UAS_INFO_INFOVIEW_DOCKWIDGET";
+    }
+
     { // Adds the Vibration Monitor Tool
         QAction* tempAction = ui.menuTools->addAction(tr("Vibration Monitor"));
         tempAction->setCheckable(true);
@@ -756,10 +772,6 @@ void MainWindow::buildCommonWidgets()
         menuToDockNameMap[tempAction] = "EKF_MONITOR_DOCKWIDGET";
     }
 
-    QGCTabbedInfoView *infoview = new QGCTabbedInfoView(this);
-    infoview->addSource(mavlinkDecoder);
-    createDockWidget(pilotView,infoview,tr("Info View"),"UAS_INFO_INFOVIEW_DOCKWIDGET",VIEW_FLIGHT,Qt::LeftDockWidgetArea);
-
     //connect(ui.actionLoad_tlog,SIGNAL(triggered()),this,SLOT(loadTlogMenuClicked()));
 
     // Custom widgets, added last to all menus and layouts
@@ -786,6 +798,132 @@ void MainWindow::buildCommonWidgets()
 #endif
 }
 
+void MainWindow::prepareView(VIEW_SECTIONS view)
+{
+    if (!builtViews.contains(view))
+    {
+        builtViews.insert(view);
+        QElapsedTimer buildTimer;
+        buildTimer.start();
+
+        switch (view)
+        {
+        case VIEW_MISSION:
+            createMapHost(plannerView);
+            createDockWidget(plannerView,new UASListWidget(this),tr("Unmanned Systems"),"UNMANNED_SYSTEM_LIST_DOCKWIDGET",VIEW_MISSION,Qt::LeftDockWidgetArea);
+            createDockWidget(plannerView,new QGCWaypointListMulti(this),tr("Mission Plan"),"WAYPOINT_LIST_DOCKWIDGET",VIEW_MISSION,Qt::BottomDockWidgetArea);
+            break;
+
+        case VIEW_FLIGHT:
+        {
+            createMapHost(pilotView);
+#ifndef PFD_QML
+            createDockWidget(pilotView,new PrimaryFlightDisplay(320,240,this),tr("Primary Flight Display"),
+                             "PRIMARY_FLIGHT_DISPLAY_DOCKWIDGET",VIEW_FLIGHT,Qt::LeftDockWidgetArea);
+#else
+            createDockWidget(pilotView,new PrimaryFlightDisplayQML(this),tr("Primary Flight Display"),
+                             "PRIMARY_FLIGHT_DISPLAY_QML_DOCKWIDGET",VIEW_FLIGHT,Qt::LeftDockWidgetArea);
+#endif
+            QGCTabbedInfoView *infoview = new QGCTabbedInfoView(this);
+            infoview->addSource(mavlinkDecoder);
+            createDockWidget(pilotView,infoview,tr("Info View"),"UAS_INFO_INFOVIEW_DOCKWIDGET",VIEW_FLIGHT,Qt::LeftDockWidgetArea);
+            break;
+        }
+
+        case VIEW_SIMULATION:
+            createMapHost(simView);
+            createDockWidget(simView,new UASControlWidget(this),tr("Control"),"UNMANNED_SYSTEM_CONTROL_DOCKWIDGET",VIEW_SIMULATION,Qt::LeftDockWidgetArea);
+            createDockWidget(simView,new QGCWaypointListMulti(this),tr("Mission Plan"),"WAYPOINT_LIST_DOCKWIDGET",VIEW_SIMULATION,Qt::BottomDockWidgetArea);
+            createDockWidget(simView,new ParameterInterface(this),tr("Parameters"),"PARAMETER_INTERFACE_DOCKWIDGET",VIEW_SIMULATION,Qt::RightDockWidgetArea);
+#ifndef PFD_QML
+            createDockWidget(simView,new PrimaryFlightDisplay(320,240,this),tr("Primary Flight Display"),
+                             "PRIMARY_FLIGHT_DISPLAY_DOCKWIDGET",VIEW_SIMULATION,Qt::RightDockWidgetArea);
+#else
+            createDockWidget(simView,new PrimaryFlightDisplayQML(this),tr("Primary Flight Display"),
+                             "PRIMARY_FLIGHT_DISPLAY_QML_DOCKWIDGET",VIEW_SIMULATION,Qt::RightDockWidgetArea);
+#endif
+            break;
+
+        case VIEW_HARDWARE_CONFIG:
+        {
+            ApmHardwareConfig* aphw = new ApmHardwareConfig(this);
+            configView->setCentralWidget(aphw);
+            connect(ui.actionAdvanced_Mode, SIGNAL(toggled(bool)), aphw, SLOT(advModeChanged(bool)));
+            aphw->advModeChanged(ui.actionAdvanced_Mode->isChecked());
+            break;
+        }
+
+        case VIEW_SOFTWARE_CONFIG:
+        {
+            ApmSoftwareConfig* apsw = new ApmSoftwareConfig(this);
+            softwareConfigView->setCentralWidget(apsw);
+            connect(ui.actionAdvanced_Mode, SIGNAL(toggled(bool)), apsw, SLOT(advModeChanged(bool)));
+            apsw->advModeChanged(ui.actionAdvanced_Mode->isChecked());
+            break;
+        }
+
+        case VIEW_ENGINEER:
+        {
+            //engineeringView->setCentralWidget(new QGCDataPlot2D(this));
+            AP2DataPlot2D *plot = new AP2DataPlot2D(this);
+            connect(logPlayer,SIGNAL(logLoaded()),plot,SLOT(clearGraph()));
+            engineeringView->setCentralWidget(plot);
+            break;
+        }
+
+        default:
+            break;
+        }
+        QLOG_INFO() << "Built view" << view << "in" << buildTimer.elapsed() << "ms";
+    }
+
+    // The map views share a single map tool, which follows the view being shown
+    switch (view)
+    {
+    case VIEW_MISSION:
+        attachMapTool(plannerView);
+        break;
+    case VIEW_FLIGHT:
+        attachMapTool(pilotView);
+        break;
+    case VIEW_SIMULATION:
+        attachMapTool(simView);
+        break;
+    default:
+        break;
+    }
+}
+
+void MainWindow::createMapHost(SubMainWindow *view)
+{
+    QWidget *host = new QWidget(view);
+    QVBoxLayout *layout = new QVBoxLayout(host);
+    layout->setContentsMargins(0, 0, 0, 0);
+    view->setCentralWidget(host);
+}
+
+void MainWindow::attachMapTool(SubMainWindow *view)
+{
+    QWidget *host = view->centralWidget();
+    if (!host || !host->layout())
+    {
+        return;
+    }
+    if (!sharedMapTool)
+    {
+        QElapsedTimer buildTimer;
+        buildTimer.start();
+        sharedMapTool = new QGCMapTool(host);
+        QLOG_INFO() << "Built map tool in" << buildTimer.elapsed() << "ms";
+    }
+    if (host->layout()->indexOf(sharedMapTool) == -1)
+    {
+        // Reparenting removes the map from the layout of the view it was shown in
+        host->layout()->addWidget(sharedMapTool);
+        sharedMapTool->show();
+    }
+}
+
 void MainWindow::addTool(SubMainWindow *parent,VIEW_SECTIONS view,QDockWidget* widget, const QString& title, Qt::DockWidgetArea area)
 {
     QList<QAction*> actionlist = ui.menuTools->actions();
@@ -964,6 +1102,12 @@ void MainWindow::loadDockWidget(QString name)
     {
         createDockWidget(centerStack->currentWidget(),new UASQuickView(this),tr("Quick View"),"UAS_INFO_QUICKVIEW_DOCKWIDGET",currentView,Qt::LeftDockWidgetArea);
     }
+    else if (name == "UAS_INFO_INFOVIEW_DOCKWIDGET")
+    {
+        QGCTabbedInfoView *infoview = new QGCTabbedInfoView(this);
+        infoview->addSource(mavlinkDecoder);
+        createDockWidget(centerStack->currentWidget(),infoview,tr("Info View"),"UAS_INFO_INFOVIEW_DOCKWIDGET",currentView,Qt::LeftDockWidgetArea);
+    }
     else
     {
         if (customWidgetNameToFilenameMap.contains(name))
@@ -1966,6 +2110,11 @@ void MainWindow::UASSpecsChanged(int uas)
 
 void MainWindow::UASCreated(UASInterface* uas)
 {
+    if (!m_firstUASLogged)
+    {
+        m_firstUASLogged = true;
+        QLOG_INFO() << "Startup: first vehicle connected after" << QGC::applicationUptimeMilliseconds() << "ms";
+    }
 
         // The pilot, operator and engineer views were not available on startup, enable them now
     ui.actionFlightView->setEnabled(true);
@@ -2173,6 +2322,9 @@ void MainWindow::storeViewState()
 
 void MainWindow::loadViewState()
 {
+    // Create the contents of the view on first use
+    prepareView(currentView);
+
     // Restore center stack state
     int index = settings.value(getWindowStateKey()+"CENTER_WIDGET", -1).toInt();
     // The offline plot view is usually the consequence of a logging run, always show the realtime view first
@@ -37,6 +37,7 @@ This file is part of the QGROUNDCONTROL project
 #include <QStatusBar>
 #include <QStackedWidget>
 #include <QSettings>
+#include <QSet>
 #include <qlist.h>
 #include <QNetworkProxy>
 
@@ -346,6 +347,12 @@ protected:
 
     void buildCustomWidget();
     void buildCommonWidgets();
+    /** @brief Build the central widget and default docks of a view the first time it is shown */
+    void prepareView(VIEW_SECTIONS view);
+    /** @brief Give a map view an empty central widget the shared map tool can be placed in */
+    void createMapHost(SubMainWindow *view);
+    /** @brief Move the shared map tool into the given map view, creating it on first use */
+    void attachMapTool(SubMainWindow *view);
     void connectCommonWidgets();
     void connectCommonActions();
 	void connectSenseSoarActions();
@@ -373,6 +380,8 @@ protected:
     QPointer<SubMainWindow> simView;
     QPointer<SubMainWindow> terminalView;
     QPointer<DebugOutput> debugOutput;
+    QPointer<QGCMapTool> sharedMapTool; ///< Map shared by the mission, flight and simulation views
+    QSet<int> builtViews;               ///< Views whose contents have been created by prepareView()
 
     // Center widgets
     //QPointer<HUD> hudWidget;
@@ -479,6 +488,7 @@ private slots:
 
 private:
     bool m_heartbeatEnabled;
+    bool m_firstUASLogged;
     QList<QObject*> commsWidgetList;
     QMap<QString,QString> customWidgetNameToFilenameMap;
     QMap<QAction*,QString > menuToDockNameMap;
@@ -87,6 +87,15 @@ static const int AIRSPEED_LINEAR_SPAN = 15;
 static const int AIRSPEED_LINEAR_RESOLUTION = 1;
 static const int AIRSPEED_LINEAR_MAJOR_RESOLUTION = 5;
 
+// Smallest changes that cause a repaint. Smaller changes are not visible at usual sizes.
+static const float ATTITUDE_REPAINT_THRESHOLD = 0.1f;  // degrees
+static const float ALTITUDE_REPAINT_THRESHOLD = 0.05f; // meters
+static const float SPEED_REPAINT_THRESHOLD = 0.05f;    // m/s
+
+// Airframe symbol, relative to the AI width
+static const float AIRFRAME_LINE_LENGTH = 0.15f;
+static const float AIRFRAME_SIDE = 0.5f;
+
 static const int UNKNOWN_ATTITUDE = -1000;
 static const int UNKNOWN_ALTITUDE = -1000;
 static const int UNKNOWN_SPEED = -1;
@@ -161,7 +170,23 @@ PrimaryFlightDisplay::PrimaryFlightDisplay(int width, int height, QWidget *paren
     instrumentOpagueBackground(QColor::fromHsvF(0, 0, 0.3, 1.0)),
 
     font("Bitstream Vera Sans"),
-    refreshTimer(new QTimer(this))
+    refreshTimer(new QTimer(this)),
+    refreshInterval(updateInterval),
+    repaintRequested(true),
+
+    paintedRoll(UNKNOWN_ATTITUDE),
+    paintedPitch(UNKNOWN_ATTITUDE),
+    paintedHeading(UNKNOWN_ATTITUDE),
+    paintedAltitudeRelative(UNKNOWN_ALTITUDE),
+    paintedAltitudeAMSL(UNKNOWN_ALTITUDE),
+    paintedGroundspeed(UNKNOWN_SPEED),
+    paintedAirspeed(UNKNOWN_SPEED),
+    paintedClimbRate(UNKNOWN_ALTITUDE),
+
+    airframeLayerDpr(0),
+
+    compassLabelsRadius(0),
+    compassLabelsDpr(0)
 {
     Q_UNUSED(width);
     Q_UNUSED(height);
@@ -181,10 +206,10 @@ PrimaryFlightDisplay::PrimaryFlightDisplay(int width, int height, QWidget *paren
     connect(UASManager::instance(), SIGNAL(UASDeleted(UASInterface*)), this, SLOT(forgetUAS(UASInterface*)));
     connect(UASManager::instance(), SIGNAL(activeUASSet(UASInterface*)), this, SLOT(setActiveUAS(UASInterface*)));
 
-    // Refresh timer
-    refreshTimer->setInterval(updateInterval);
+    // Refresh timer, caps the frame rate. Frames are only painted if something changed.
+    refreshTimer->setInterval(refreshInterval);
     //    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(paintHUD()));
-    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(update()));
+    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(refreshIfChanged()));
 }
 
 PrimaryFlightDisplay::~PrimaryFlightDisplay()
@@ -203,7 +228,7 @@ void PrimaryFlightDisplay::showEvent(QShowEvent* event)
     // React only to internal (pre-display)
     // events
     QWidget::showEvent(event);
-    refreshTimer->start(updateInterval);
+    refreshTimer->start(refreshInterval);
     emit visibilityChanged(true);
 }
 
@@ -232,6 +257,9 @@ void PrimaryFlightDisplay::resizeEvent(QResizeEvent *e) {
     mediumTextSize = size * MEDIUM_TEXT_SIZE;
     largeTextSize = size * LARGE_TEXT_SIZE;
 
+    // The text sizes changed, render the compass labels again
+    compassLabelsRadius = 0;
+
     /*
      * Try without layout Change-O-Matic. It was too complicated.
     qreal aspect = e->size().width() / e->size().height();
@@ -249,6 +277,32 @@ void PrimaryFlightDisplay::paintEvent(QPaintEvent *event)
     doPaint();
 }
 
+void PrimaryFlightDisplay::setMaxRefreshRate(int rate)
+{
+    if (rate <= 0)
+    {
+        return;
+    }
+    refreshInterval = 1000 / rate;
+    refreshTimer->setInterval(refreshInterval);
+}
+
+void PrimaryFlightDisplay::refreshIfChanged()
+{
+    if (repaintRequested
+            || qAbs(roll - paintedRoll) >= ATTITUDE_REPAINT_THRESHOLD
+            || qAbs(pitch - paintedPitch) >= ATTITUDE_REPAINT_THRESHOLD
+            || qAbs(heading - paintedHeading) >= ATTITUDE_REPAINT_THRESHOLD
+            || qAbs(m_altitudeRelative - paintedAltitudeRelative) >= ALTITUDE_REPAINT_THRESHOLD
+            || qAbs(m_altitudeAMSL - paintedAltitudeAMSL) >= ALTITUDE_REPAINT_THRESHOLD
+            || qAbs(m_climbRate - paintedClimbRate) >= SPEED_REPAINT_THRESHOLD
+            || qAbs(m_groundspeed - paintedGroundspeed) >= SPEED_REPAINT_THRESHOLD
+            || qAbs(m_airspeed - paintedAirspeed) >= SPEED_REPAINT_THRESHOLD)
+    {
+        update();
+    }
+}
+
 ///*
 // * Interface towards qgroundcontrol
 // */
@@ -332,6 +386,7 @@ void PrimaryFlightDisplay::setActiveUAS(UASInterface* uas)
 
         // Set new UAS
         this->uas = uas;
+        repaintRequested = true;
     }
 }
 void PrimaryFlightDisplay::uasTextMessage(int uasid, int componentid, int severity, QString text)
@@ -346,6 +401,7 @@ void PrimaryFlightDisplay::uasTextMessage(int uasid, int componentid, int severi
         preArmCheckMessage =  QString("M%1:%2").arg(uasid).arg(text);
         preArmCheckFailure = true;
         preArmMessageTimer->start(4000);
+        repaintRequested = true;
     }
 }
 
@@ -406,6 +462,10 @@ void PrimaryFlightDisplay::updateNavigationControllerErrors(UASInterface* uas, d
     Q_UNUSED(uas);
     this->navigationAltitudeError = altitudeError;
     this->navigationSpeedError = speedError;
+    if (this->navigationCrosstrackError != xtrackError)
+    {
+        repaintRequested = true;
+    }
     this->navigationCrosstrackError = xtrackError;
 }
 
@@ -542,15 +602,44 @@ qreal pitchAngleToTranslation(qreal viewHeight, float pitch) {
 }
 
 void PrimaryFlightDisplay::drawAIAirframeFixedFeatures(QPainter& painter, QRectF area) {
+    // The airframe symbol does not move. Render it once per size into a pixmap
+    // covering only the symbol, the rest of the AI stays unblended.
+    if (airframeLayer.isNull() || airframeLayerArea != area || airframeLayerDpr != devicePixelRatio()) {
+        qreal w = area.width();
+        qreal h = area.height();
+        qreal pad = lineWidth * 1.5f + 1;
+        qreal halfWidth = qMax((qreal)(AIRFRAME_SIDE*w), h*ROLL_SCALE_MARKERWIDTH/2) + pad;
+        qreal top = -w*ROLL_SCALE_RADIUS - pad;
+        qreal bottom = AIRFRAME_LINE_LENGTH/qSqrt(2.0f)*w/2 + pad;
+
+        // Blit at whole pixels and keep the fraction inside the pixmap
+        airframeLayerOrigin = QPoint(qFloor(area.center().x() - halfWidth), qFloor(area.center().y() + top));
+        QSize layerSize(qCeil(area.center().x() + halfWidth) - airframeLayerOrigin.x(),
+                        qCeil(area.center().y() + bottom) - airframeLayerOrigin.y());
+
+        airframeLayerArea = area;
+        airframeLayerDpr = devicePixelRatio();
+        airframeLayer = QPixmap(layerSize * airframeLayerDpr);
+        airframeLayer.setDevicePixelRatio(airframeLayerDpr);
+        airframeLayer.fill(Qt::transparent);
+
+        QPainter layerPainter(&airframeLayer);
+        layerPainter.setRenderHint(QPainter::Antialiasing, true);
+        layerPainter.setRenderHint(QPainter::HighQualityAntialiasing, true);
+        layerPainter.translate(area.center() - airframeLayerOrigin);
+        renderAIAirframeFixedFeatures(layerPainter, area);
+    }
+    painter.resetTransform();
+    painter.drawPixmap(airframeLayerOrigin, airframeLayer);
+}
+
+void PrimaryFlightDisplay::renderAIAirframeFixedFeatures(QPainter& painter, QRectF area) {
     // red line from -7/10 to -5/10 half-width
     // red line from 7/10 to 5/10 half-width
     // red slanted line from -2/10 half-width to 0
     // red slanted line from 2/10 half-width to 0
     // red arrow thing under roll scale
-    // prepareTransform(painter, width, height);
-    painter.resetTransform();
-    painter.translate(area.center());
-
+    // Drawn around the origin, the caller translates to the AI center.
     qreal w = area.width();
     qreal h = area.height();
 
@@ -559,8 +648,8 @@ void PrimaryFlightDisplay::drawAIAirframeFixedFeatures(QPainter& painter, QRectF
     pen.setColor(redColor);
     painter.setPen(pen);
 
-    float length = 0.15f;
-    float side = 0.5f;
+    float length = AIRFRAME_LINE_LENGTH;
+    float side = AIRFRAME_SIDE;
     // The 2 lines at sides.
     painter.drawLine(QPointF(-side*w, 0), QPointF(-(side-length)*w, 0));
     painter.drawLine(QPointF(side*w, 0), QPointF((side-length)*w, 0));
@@ -805,6 +894,47 @@ void PrimaryFlightDisplay::drawAIAttitudeScales(
     drawPitchScale(painter, area, intrusion, true, true);
 }
 
+void PrimaryFlightDisplay::updateCompassLabels(float innerRadius) {
+    compassLabelsRadius = innerRadius;
+    compassLabelsDpr = devicePixelRatio();
+
+    for (int i = 0; i < 360 / COMPASS_DISK_RESOLUTION; i++) {
+        int tick = i * COMPASS_DISK_RESOLUTION;
+        QString text;
+        float pixelSize;
+        if (tick % 90 == 0) {
+            text = compassWindNames[tick / 45];
+            pixelSize = mediumTextSize;
+        } else if (tick % 30 == 0) {
+            text.sprintf("%d", tick/10);
+            pixelSize = smallTextSize;
+        } else {
+            compassLabels[i] = QPixmap();
+            continue;
+        }
+
+        font.setPixelSize(pixelSize);
+        QFontMetrics metrics = QFontMetrics(font);
+        QRect bounds = metrics.boundingRect(text);
+        // drawTextCenter() does not clip, the bounds rect is too small for the glyphs
+        QSize labelSize(bounds.width() + 4, bounds.height() + 4);
+
+        compassLabels[i] = QPixmap(labelSize * compassLabelsDpr);
+        compassLabels[i].setDevicePixelRatio(compassLabelsDpr);
+        compassLabels[i].fill(Qt::transparent);
+        QPainter labelPainter(&compassLabels[i]);
+        labelPainter.setPen(Qt::black);
+        labelPainter.setFont(font);
+        labelPainter.drawText(QRect(QPoint(0, 0), labelSize), Qt::AlignCenter | Qt::TextDontClip, text);
+    }
+}
+
+void PrimaryFlightDisplay::drawCompassLabel(QPainter& painter, int displayTick, float y) {
+    const QPixmap &label = compassLabels[displayTick / COMPASS_DISK_RESOLUTION];
+    QSizeF size = QSizeF(label.size()) / label.devicePixelRatio();
+    painter.drawPixmap(QPointF(-size.width()/2, y - size.height()/2), label);
+}
+
 void PrimaryFlightDisplay::drawAICompassDisk(QPainter& painter, QRectF area, float halfspan) {
     float displayHeading = this->heading;
     if(displayHeading == UNKNOWN_ATTITUDE)
@@ -818,6 +948,10 @@ void PrimaryFlightDisplay::drawAICompassDisk(QPainter& painter, QRectF area, flo
 
     float radius = area.width()/2;
     float innerRadius = radius * 0.96;
+    if (compassLabelsRadius != innerRadius || compassLabelsDpr != devicePixelRatio())
+        updateCompassLabels(innerRadius);
+    // The labels are small, smooth rotation of them is cheaper than laying out the text
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
     painter.resetTransform();
     painter.setBrush(instrumentBackground);
     painter.setPen(instrumentEdgePen);
@@ -850,10 +984,7 @@ void PrimaryFlightDisplay::drawAICompassDisk(QPainter& painter, QRectF area, flo
                 displayTick==300 || displayTick==330)
         ) {
             // draw a number
-            QString s_number;
-            s_number.sprintf("%d", displayTick/10);
-            painter.setPen(scalePen);
-            drawTextCenter(painter, s_number, smallTextSize, 0, -innerRadius*0.75);
+            drawCompassLabel(painter, displayTick, -innerRadius*0.75);
         } else {
             if (displayTick % COMPASS_DISK_ARROWTICK == 0) {
                 if (displayTick!=0) {
@@ -870,9 +1001,7 @@ void PrimaryFlightDisplay::drawAICompassDisk(QPainter& painter, QRectF area, flo
                 // If heading unknown, still draw marks but no N S E W.
                 if (this->heading != UNKNOWN_ATTITUDE && displayTick%90 == 0) {
                     // Also draw a label
-                    QString name = compassWindNames[displayTick / 45];
-                    painter.setPen(scalePen);
-                    drawTextCenter(painter, name, mediumTextSize, 0, -innerRadius*0.75);
+                    drawCompassLabel(painter, displayTick, -innerRadius*0.75);
                 }
             }
         }
@@ -1248,6 +1377,17 @@ inline qreal tapesGaugeWidthFor(qreal containerWidth, qreal preferredAIWidth) {
 }
 
 void PrimaryFlightDisplay::doPaint() {
+    // Remember what this frame shows, refreshIfChanged() compares against it
+    repaintRequested = false;
+    paintedRoll = roll;
+    paintedPitch = pitch;
+    paintedHeading = heading;
+    paintedAltitudeRelative = m_altitudeRelative;
+    paintedAltitudeAMSL = m_altitudeAMSL;
+    paintedGroundspeed = m_groundspeed;
+    paintedAirspeed = m_airspeed;
+    paintedClimbRate = m_climbRate;
+
     QPainter painter;
     painter.begin(this);
     painter.setRenderHint(QPainter::Antialiasing, true);
@@ -1550,6 +1690,7 @@ void PrimaryFlightDisplay::preArmMessageTimeout()
 {
     preArmMessageTimer->stop();
     preArmCheckFailure = false;
+    repaintRequested = true;
 
 }
 
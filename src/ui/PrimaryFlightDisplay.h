@@ -3,6 +3,7 @@
 
 #include <QWidget>
 #include <QPen>
+#include <QPixmap>
 #include "UASInterface.h"
 
 class PrimaryFlightDisplay : public QWidget
@@ -31,6 +32,13 @@ public slots:
     void forgetUAS(UASInterface* uas);
     void setActiveUAS(UASInterface* uas);
 
+    /** @brief Limit the number of frames painted per second */
+    void setMaxRefreshRate(int rate);
+
+private slots:
+    /** @brief Repaint if a displayed value moved by more than its threshold */
+    void refreshIfChanged();
+
 protected:
     enum Layout {
         COMPASS_INTEGRATED,
@@ -96,10 +104,13 @@ private:
     void drawTextCenterTop(QPainter& painter, QString text, float fontSize, float x, float y);
     void drawAIGlobalFeatures(QPainter& painter, QRectF mainArea, QRectF paintArea);
     void drawAIAirframeFixedFeatures(QPainter& painter, QRectF area);
+    void renderAIAirframeFixedFeatures(QPainter& painter, QRectF area);
     void drawPitchScale(QPainter& painter, QRectF area, float intrusion, bool drawNumbersLeft, bool drawNumbersRight);
     void drawRollScale(QPainter& painter, QRectF area, bool drawTicks, bool drawNumbers);
     void drawAIAttitudeScales(QPainter& painter, QRectF area, float intrusion);
     void drawAICompassDisk(QPainter& painter, QRectF area, float halfspan);
+    void updateCompassLabels(float innerRadius);
+    void drawCompassLabel(QPainter& painter, int displayTick, float y);
     void drawSeparateCompassDisk(QPainter& painter, QRectF area);
 
     void drawAltimeter(QPainter& painter, QRectF area, float altitudeRelative, float altitudeAMSL, float vv);
@@ -176,6 +187,30 @@ private:
     QFont font;
 
     QTimer* refreshTimer;       ///< The main timer, controls the update rate
+    int refreshInterval;        ///< Minimum time between two frames in milliseconds
+    bool repaintRequested;      ///< A value without change threshold was updated
+
+    // Values shown by the last painted frame
+    float paintedRoll;
+    float paintedPitch;
+    float paintedHeading;
+    float paintedAltitudeRelative;
+    float paintedAltitudeAMSL;
+    float paintedGroundspeed;
+    float paintedAirspeed;
+    float paintedClimbRate;
+
+    // The airframe symbol only changes with the widget size, rendered once per size
+    QPixmap airframeLayer;
+    QRectF airframeLayerArea;
+    QPoint airframeLayerOrigin;
+    qreal airframeLayerDpr;
+
+    // The compass rose labels only change with the widget size. Each one is
+    // rendered once into a pixmap the size of its text and rotated into place.
+    QPixmap compassLabels[36];  // one per COMPASS_DISK_RESOLUTION tick, null where the rose has no label
+    float compassLabelsRadius;
+    qreal compassLabelsDpr;
 
     static const int tickValues[];
     static const QString compassWindNames[];
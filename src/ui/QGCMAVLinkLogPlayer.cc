@@ -32,6 +32,7 @@ QGCMAVLinkLogPlayer::QGCMAVLinkLogPlayer(QWidget *parent):
     connect(ui->speedButton200,SIGNAL(clicked()),this,SLOT(speed200Clicked()));
     connect(ui->speedButton500,SIGNAL(clicked()),this,SLOT(speed500Clicked()));
     connect(ui->speedButton1000,SIGNAL(clicked()),this,SLOT(speed1000Clicked()));
+    connect(ui->speedButtonMax,SIGNAL(clicked()),this,SLOT(speedMaxClicked()));
 
     ui->speedButton75->setEnabled(false);
     ui->speedButton100->setEnabled(false);
@@ -39,6 +40,7 @@ QGCMAVLinkLogPlayer::QGCMAVLinkLogPlayer(QWidget *parent):
     ui->speedButton200->setEnabled(false);
     ui->speedButton500->setEnabled(false);
     ui->speedButton1000->setEnabled(false);
+    ui->speedButtonMax->setEnabled(false);
 }
 void QGCMAVLinkLogPlayer::speed75Clicked()
 {
@@ -48,6 +50,7 @@ void QGCMAVLinkLogPlayer::speed75Clicked()
     ui->speedButton200->setChecked(false);
     ui->speedButton500->setChecked(false);
     ui->speedButton1000->setChecked(false);
+    ui->speedButtonMax->setChecked(false);
 }
 
 void QGCMAVLinkLogPlayer::speed100Clicked()
@@ -58,6 +61,7 @@ void QGCMAVLinkLogPlayer::speed100Clicked()
     ui->speedButton200->setChecked(false);
     ui->speedButton500->setChecked(false);
     ui->speedButton1000->setChecked(false);
+    ui->speedButtonMax->setChecked(false);
 }
 
 void QGCMAVLinkLogPlayer::speed150Clicked()
@@ -68,6 +72,7 @@ void QGCMAVLinkLogPlayer::speed150Clicked()
     ui->speedButton200->setChecked(false);
     ui->speedButton500->setChecked(false);
     ui->speedButton1000->setChecked(false);
+    ui->speedButtonMax->setChecked(false);
 }
 
 void QGCMAVLinkLogPlayer::speed200Clicked()
@@ -78,6 +83,7 @@ void QGCMAVLinkLogPlayer::speed200Clicked()
     m_logLink->setSpeed(200);
     ui->speedButton500->setChecked(false);
     ui->speedButton1000->setChecked(false);
+    ui->speedButtonMax->setChecked(false);
 }
 
 void QGCMAVLinkLogPlayer::speed500Clicked()
@@ -88,6 +94,7 @@ void QGCMAVLinkLogPlayer::speed500Clicked()
     ui->speedButton200->setChecked(false);
     m_logLink->setSpeed(500);
     ui->speedButton1000->setChecked(false);
+    ui->speedButtonMax->setChecked(false);
 }
 void QGCMAVLinkLogPlayer::speed1000Clicked()
 {
@@ -97,6 +104,18 @@ void QGCMAVLinkLogPlayer::speed1000Clicked()
     ui->speedButton200->setChecked(false);
     ui->speedButton500->setChecked(false);
     m_logLink->setSpeed(1000);
+    ui->speedButtonMax->setChecked(false);
+}
+
+void QGCMAVLinkLogPlayer::speedMaxClicked()
+{
+    ui->speedButton75->setChecked(false);
+    ui->speedButton100->setChecked(false);
+    ui->speedButton150->setChecked(false);
+    ui->speedButton200->setChecked(false);
+    ui->speedButton500->setChecked(false);
+    ui->speedButton1000->setChecked(false);
+    m_logLink->setSpeed(0);
 }
 
 void QGCMAVLinkLogPlayer::positionSliderReleased()
@@ -156,6 +175,8 @@ void QGCMAVLinkLogPlayer::loadLogButtonClicked()
                 ui->speedButton150->setEnabled(false);
                 ui->speedButton200->setEnabled(false);
                 ui->speedButton500->setEnabled(false);
+                ui->speedButton1000->setEnabled(false);
+                ui->speedButtonMax->setEnabled(false);
             }
         }
         else
@@ -204,6 +225,7 @@ void QGCMAVLinkLogPlayer::loadLogDialogAccepted()
     ui->speedButton200->setEnabled(true);
     ui->speedButton500->setEnabled(true);
     ui->speedButton1000->setEnabled(true);
+    ui->speedButtonMax->setEnabled(true);
 }
 void QGCMAVLinkLogPlayer::logProgress(qint64 pos,qint64 total)
 {
@@ -254,6 +276,8 @@ void QGCMAVLinkLogPlayer::logLinkTerminated()
         ui->speedButton150->setEnabled(false);
         ui->speedButton200->setEnabled(false);
         ui->speedButton500->setEnabled(false);
+        ui->speedButton1000->setEnabled(false);
+        ui->speedButtonMax->setEnabled(false);
         emit logFinished();
     }
 }
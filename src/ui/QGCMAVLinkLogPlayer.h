@@ -52,6 +52,7 @@ public slots:
     void speed200Clicked();
     void speed500Clicked();
     void speed1000Clicked();
+    void speedMaxClicked();
 private slots:
     void logProgress(qint64 pos,qint64 total);
     void positionSliderReleased();
@@ -143,11 +143,15 @@ QGCParamWidget::QGCParamWidget(UASInterface* uas, QWidget *parent) :
 
     // New parameters from UAS
     connect(uas, SIGNAL(parameterChanged(int,int,int,int,QString,QVariant)), this, SLOT(addParameter(int,int,int,int,QString,QVariant)));
+    // The parameter cache can only be picked once the vehicle is identified
+    connect(uas, SIGNAL(autopilotVersionChanged(int)), this, SLOT(autopilotVersionChanged()));
 
     // Connect retransmission guard
     connect(this, SIGNAL(requestParameter(int,QString)), uas, SLOT(requestParameter(int,QString)));
     connect(this, SIGNAL(requestParameter(int,int)), uas, SLOT(requestParameter(int,int)));
     connect(&retransmissionTimer, SIGNAL(timeout()), this, SLOT(retransmissionGuardTick()));
+    statusTimer.setInterval(200);
+    connect(&statusTimer, SIGNAL(timeout()), this, SLOT(updateTransmissionStatus()));
     initialParamTimer = new QTimer(this);
     connect(initialParamTimer,SIGNAL(timeout()),this,SLOT(initialParamCheckTick()));
 
@@ -529,6 +533,7 @@ void QGCParamWidget::addComponent(int uas, int component, QString componentName)
         components->insert(component, comp);
         // Create grouping and update maps
         paramGroups.insert(component, new QMap<QString, QTreeWidgetItem*>());
+        paramItems.insert(component, new QMap<QString, QTreeWidgetItem*>());
         tree->addTopLevelItem(comp);
         tree->update();
         // Create map in parameters
@@ -549,31 +554,30 @@ void QGCParamWidget::addComponent(int uas, int component, QString componentName)
  */
 void QGCParamWidget::addParameter(int uas, int component, int paramCount, int paramId, QString parameterName, QVariant value)
 {
-    addParameter(uas, component, parameterName, value);
-
-    // Missing packets list has to be instantiated for all components
-    if (!transmissionMissingPackets.contains(component)) {
-        transmissionMissingPackets.insert(component, new QList<int>());
+    // The MAV sent it, so the value is no longer only from the cache
+    if (cachedParameters.contains(component))
+    {
+        cachedParameters[component].remove(parameterName);
     }
+    addParameter(uas, component, parameterName, value);
 
     // List mode is different from single parameter transfers
     if (transmissionListMode) {
         // Only accept the list size once on the first packet from
         // each component
-        if (!transmissionListSizeKnown.contains(component))
+        if (!transmissionReceivedPackets.contains(component) && paramCount > 0)
         {
-            // Mark list size as known
-            transmissionListSizeKnown.insert(component, true);
-
-            // Mark all parameters as missing
-            for (int i = 0; i < paramCount; ++i)
+            if (cachedParameterCounts.contains(component) && cachedParameterCounts.value(component) != paramCount)
             {
-                if (!transmissionMissingPackets.value(component)->contains(i))
-                {
-                    transmissionMissingPackets.value(component)->append(i);
-                }
+                QLOG_INFO() << "Parameter cache of component" << component << "is outdated:"
+                            << cachedParameterCounts.value(component) << "!=" << paramCount << "parameters";
             }
 
+            // Mark all parameters as missing
+            transmissionReceivedPackets.insert(component, QBitArray(paramCount));
+            transmissionMissingCount.insert(component, paramCount);
+            transmissionRequestCursor.insert(component, 0);
+
             // There is only one transmission timeout for all components
             // since components do not manage their transmission,
             // the longest timeout is safe for all components.
@@ -583,6 +587,10 @@ void QGCParamWidget::addParameter(int uas, int component, int paramCount, int pa
                 transmissionTimeout = thisTransmissionTimeout;
             }
         }
+        if (transmissionFirstLatency < 0)
+        {
+            transmissionFirstLatency = transmissionStart.elapsed();
+        }
 
         // Start retransmission guard
         // or reset timer
@@ -590,9 +598,20 @@ void QGCParamWidget::addParameter(int uas, int component, int paramCount, int pa
     }
 
     // Mark this parameter as received in read list
-    int index = transmissionMissingPackets.value(component)->indexOf(paramId);
-    // If the MAV sent the parameter without request, it wont be in missing list
-    if (index != -1) transmissionMissingPackets.value(component)->removeAt(index);
+    // If the MAV sent the parameter without request, it is not tracked
+    QMap<int, QBitArray>::iterator receivedPackets = transmissionReceivedPackets.find(component);
+    if (receivedPackets != transmissionReceivedPackets.end() && paramId >= 0
+            && paramId < receivedPackets.value().size() && !receivedPackets.value().testBit(paramId))
+    {
+        receivedPackets.value().setBit(paramId);
+        transmissionMissingCount[component]--;
+        transmissionReceivedCount++;
+        if (transmissionBurstPending > 0 && --transmissionBurstPending == 0)
+        {
+            // The last burst was answered, don't wait for the guard timer
+            requestMissingParameters();
+        }
+    }
 
     bool justWritten = false;
     bool writeMismatch = false;
@@ -611,9 +630,9 @@ void QGCParamWidget::addParameter(int uas, int component, int paramCount, int pa
     }
 
     int missCount = 0;
-    foreach (int key, transmissionMissingPackets.keys())
+    foreach (int count, transmissionMissingCount)
     {
-        missCount +=  transmissionMissingPackets.value(key)->count();
+        missCount += count;
     }
 
     int missWriteCount = 0;
@@ -643,46 +662,37 @@ void QGCParamWidget::addParameter(int uas, int component, int paramCount, int pa
         statusLabel->setPalette(pal);
         statusLabel->setText(tr("FAILURE: Wrote %1: sent %2 != onboard %3").arg(parameterName).arg(map->value(parameterName).toDouble()).arg(value.toDouble()));
     }
-    else
+    else if (missCount == 0)
     {
-        if (missCount > 0)
-        {
-            QPalette pal = statusLabel->palette();
-            pal.setColor(backgroundRole(), QGC::colorOrange);
-            statusLabel->setPalette(pal);
-        }
-        else
-        {
-            QPalette pal = statusLabel->palette();
-            pal.setColor(backgroundRole(), QGC::colorGreen);
-            statusLabel->setPalette(pal);
-        }
-        QString val = QString("%1").arg(value.toFloat(), 5, 'f', 1, QChar(' '));
-        //statusLabel->setText(tr("OK: %1 %2 #%3/%4, %5 miss").arg(parameterName).arg(val).arg(paramId+1).arg(paramCount).arg(missCount));
-        if (missCount == 0)
-        {
-            // Transmission done
-            QTime time = QTime::currentTime();
-            QString timeString = time.toString();
-            statusLabel->setText(tr("All received. (updated at %1)").arg(timeString));
-        }
-        else
-        {
-            // Transmission in progress
-            statusLabel->setText(tr("OK: %1 %2 (%3/%4)").arg(parameterName).arg(val).arg(paramCount-missCount).arg(paramCount));
-        }
+        // Transmission done
+        QPalette pal = statusLabel->palette();
+        pal.setColor(backgroundRole(), QGC::colorGreen);
+        statusLabel->setPalette(pal);
+        QTime time = QTime::currentTime();
+        QString timeString = time.toString();
+        statusLabel->setText(tr("All received. (updated at %1)").arg(timeString));
     }
+    // A transmission in progress is shown by updateTransmissionStatus()
 
     // Check if last parameter was received
     if (missCount == 0 && missWriteCount == 0)
     {
-        this->transmissionActive = false;
-        this->transmissionListMode = false;
-        transmissionListSizeKnown.clear();
-        foreach (int key, transmissionMissingPackets.keys())
+        if (transmissionListMode && transmissionReceivedCount > 0)
         {
-            transmissionMissingPackets.value(key)->clear();
+            double seconds = transmissionStart.elapsed() / 1000.0;
+            QLOG_INFO() << "Parameter list received:" << transmissionReceivedCount << "parameters in"
+                        << seconds << "s (" << (seconds > 0 ? transmissionReceivedCount / seconds : 0)
+                        << "params/s), first parameter after" << transmissionFirstLatency << "ms,"
+                        << transmissionRetransmitCount << "re-requested";
+            finishCachedParameters();
         }
+        statusTimer.stop();
+        this->transmissionActive = false;
+        this->transmissionListMode = false;
+        transmissionReceivedPackets.clear();
+        transmissionMissingCount.clear();
+        transmissionRequestCursor.clear();
+        transmissionBurstPending = 0;
 
         // Expand visual tree
         tree->expandItem(tree->topLevelItem(0));
@@ -732,96 +742,59 @@ void QGCParamWidget::addParameter(int uas, int component, QString parameterName,
     parameters.value(component)->insert(parameterName, value);
 
 
-    QString splitToken = "_";
-    // Check if auto-grouping can work
-    if (parameterName.contains(splitToken))
-    {
-        QString parent = parameterName.section(splitToken, 0, 0, QString::SectionSkipEmpty);
-        QMap<QString, QTreeWidgetItem*>* compParamGroups = paramGroups.value(component);
-        if (!compParamGroups->contains(parent))
-        {
-            // Insert group item
-            QStringList glist;
-            glist.append(parent);
-            QTreeWidgetItem* item = new QTreeWidgetItem(glist);
-            compParamGroups->insert(parent, item);
-            components->value(component)->addChild(item);
-        }
-
-        // Append child to group
-        bool found = false;
-        QTreeWidgetItem* parentItem = compParamGroups->value(parent);
-        for (int i = 0; i < parentItem->childCount(); i++) {
-            QTreeWidgetItem* child = parentItem->child(i);
-            QString key = child->data(0, Qt::DisplayRole).toString();
-            if (key == parameterName)
-            {
-                //QLOG_DEBUG() << "UPDATED CHILD";
-                parameterItem = child;
-                if (value.type() == QVariant::Char)
-                {
-                    parameterItem->setData(1, Qt::DisplayRole, value.toUInt());
-                }
-                else
-                {
-                    parameterItem->setData(1, Qt::DisplayRole, value);
-                }
-                found = true;
-            }
-        }
-
-        if (!found)
-        {
-            // Insert parameter into map
-            QStringList plist;
-            plist.append(parameterName);
-            // CREATE PARAMETER ITEM
-            parameterItem = new QTreeWidgetItem(plist);
-            // CONFIGURE PARAMETER ITEM
-            if (value.type() == QVariant::Char)
-            {
-                parameterItem->setData(1, Qt::DisplayRole, value.toUInt());
-            }
-            else
-            {
-                parameterItem->setData(1, Qt::DisplayRole, value);
-            }
+    // Look the item up by name instead of searching the tree
+    QMap<QString, QTreeWidgetItem*>* compParamItems = paramItems.value(component);
+    parameterItem = compParamItems->value(parameterName, NULL);
+    QVariant displayValue = (value.type() == QVariant::Char) ? QVariant(value.toUInt()) : value;
 
-            compParamGroups->value(parent)->addChild(parameterItem);
-            parameterItem->setFlags(parameterItem->flags() | Qt::ItemIsEditable);
-        }
+    if (parameterItem)
+    {
+        parameterItem->setData(1, Qt::DisplayRole, displayValue);
     }
     else
     {
-        bool found = false;
-        QTreeWidgetItem* parent = components->value(component);
-        for (int i = 0; i < parent->childCount(); i++)
+        // Insert parameter into map
+        QStringList plist;
+        plist.append(parameterName);
+        // CREATE PARAMETER ITEM
+        parameterItem = new QTreeWidgetItem(plist);
+        // CONFIGURE PARAMETER ITEM
+        parameterItem->setData(1, Qt::DisplayRole, displayValue);
+        parameterItem->setFlags(parameterItem->flags() | Qt::ItemIsEditable);
+        compParamItems->insert(parameterName, parameterItem);
+
+        QString splitToken = "_";
+        // Check if auto-grouping can work
+        if (parameterName.contains(splitToken))
         {
-            QTreeWidgetItem* child = parent->child(i);
-            QString key = child->data(0, Qt::DisplayRole).toString();
-            if (key == parameterName)
+            QString parent = parameterName.section(splitToken, 0, 0, QString::SectionSkipEmpty);
+            QMap<QString, QTreeWidgetItem*>* compParamGroups = paramGroups.value(component);
+            if (!compParamGroups->contains(parent))
             {
-                //QLOG_DEBUG() << "UPDATED CHILD";
-                parameterItem = child;
-                parameterItem->setData(1, Qt::DisplayRole, value);
-                found = true;
+                // Insert group item
+                QStringList glist;
+                glist.append(parent);
+                QTreeWidgetItem* item = new QTreeWidgetItem(glist);
+                compParamGroups->insert(parent, item);
+                components->value(component)->addChild(item);
             }
-        }
 
-        if (!found)
+            // Append child to group
+            compParamGroups->value(parent)->addChild(parameterItem);
+        }
+        else
         {
-            // Insert parameter into map
-            QStringList plist;
-            plist.append(parameterName);
-            // CREATE PARAMETER ITEM
-            parameterItem = new QTreeWidgetItem(plist);
-            // CONFIGURE PARAMETER ITEM
-            parameterItem->setData(1, Qt::DisplayRole, value);
-
             components->value(component)->addChild(parameterItem);
-            parameterItem->setFlags(parameterItem->flags() | Qt::ItemIsEditable);
         }
-        //tree->expandAll();
+    }
+    // Cached values are greyed out and read-only until the MAV confirms them
+    bool unverified = cachedParameters.contains(component) && cachedParameters.value(component).contains(parameterName);
+    if (unverified == ((parameterItem->flags() & Qt::ItemIsEditable) != 0))
+    {
+        parameterItem->setFlags(unverified ? parameterItem->flags() & ~Qt::ItemIsEditable : parameterItem->flags() | Qt::ItemIsEditable);
+        QBrush foreground = unverified ? QBrush(Qt::gray) : QBrush();
+        parameterItem->setForeground(0, foreground);
+        parameterItem->setForeground(1, foreground);
     }
     // Reset background color
     parameterItem->setBackground(0, Qt::NoBrush);
@@ -837,6 +810,10 @@ void QGCParamWidget::addParameter(int uas, int component, QString parameterName,
     {
         tooltipFormat = paramToolTips.value(parameterName, "");
     }
+    if (unverified)
+    {
+        tooltipFormat = tr("Cached value, not yet confirmed by the MAV. %1").arg(tooltipFormat);
+    }
     parameterItem->setToolTip(0, tooltipFormat);
     parameterItem->setToolTip(1, tooltipFormat);
 
@@ -862,17 +839,31 @@ void QGCParamWidget::requestParameterList()
     clear();
     parameters.clear();
     received.clear();
-    // Clear transmission state
-    transmissionListMode = true;
-    transmissionListSizeKnown.clear();
-    foreach (int key, transmissionMissingPackets.keys())
+    showCachedParameters();
+    if (parameterCacheFileName().isEmpty())
     {
-        transmissionMissingPackets.value(key)->clear();
+        // Shown as soon as the answer arrives, see autopilotVersionChanged()
+        mav->requestAutopilotVersion();
     }
+    // Clear transmission state
+    transmissionListMode = true;
+    transmissionReceivedPackets.clear();
+    transmissionMissingCount.clear();
+    transmissionRequestCursor.clear();
+    transmissionBurstPending = 0;
+    transmissionReceivedCount = 0;
+    transmissionRetransmitCount = 0;
+    transmissionFirstLatency = -1;
+    transmissionStart.start();
     transmissionActive = true;
+    statusTimer.start();
 
     // Set status text
-    statusLabel->setText(tr("Requested param list.. waiting"));
+    if (cachedParameters.isEmpty()) {
+        statusLabel->setText(tr("Requested param list.. waiting"));
+    } else {
+        statusLabel->setText(tr("Showing cached parameters, verifying.."));
+    }
 
     mav->requestParameters();
     initialParamTimer->start(10000); //Give it 10 seconds to start getting parameters
@@ -994,11 +985,14 @@ void QGCParamWidget::retransmissionGuardTick()
             // Empty read retransmission list
             // Empty write retransmission list
             int missingReadCount = 0;
-            QList<int> readKeys = transmissionMissingPackets.keys();
-            foreach (int component, readKeys) {
-                missingReadCount += transmissionMissingPackets.value(component)->count();
-                transmissionMissingPackets.value(component)->clear();
+            foreach (int count, transmissionMissingCount) {
+                missingReadCount += count;
             }
+            transmissionReceivedPackets.clear();
+            transmissionMissingCount.clear();
+            transmissionRequestCursor.clear();
+            transmissionBurstPending = 0;
+            statusTimer.stop();
 
             // Empty write retransmission list
             int missingWriteCount = 0;
@@ -1010,28 +1004,8 @@ void QGCParamWidget::retransmissionGuardTick()
             statusLabel->setText(tr("TIMEOUT! MISSING: %1 read, %2 write.").arg(missingReadCount).arg(missingWriteCount));
         }
 
-        // Re-request at maximum retransmissionBurstRequestSize parameters at once
-        // to prevent link flooding
-        QMap<int, QMap<QString, QVariant>*>::iterator i;
-        for (i = parameters.begin(); i != parameters.end(); ++i) {
-            // Iterate through the parameters of the component
-            int component = i.key();
-            // Request n parameters from this component (at maximum)
-            QList<int> * paramList = transmissionMissingPackets.value(component, NULL);
-            if (paramList) {
-                int count = 0;
-                foreach (int id, *paramList) {
-                    if (count < retransmissionBurstRequestSize) {
-                        //QLOG_DEBUG() << __FILE__ << __LINE__ << "RETRANSMISSION GUARD REQUESTS RETRANSMISSION OF PARAM #" << id << "FROM COMPONENT #" << component;
-                        emit requestParameter(component, id);
-                        statusLabel->setText(tr("Requested retransmission of #%1").arg(id+1));
-                        count++;
-                    } else {
-                        break;
-                    }
-                }
-            }
-        }
+        // The link was quiet for retransmissionTimeout, request the next burst
+        requestMissingParameters();
 
         // Re-request at maximum retransmissionBurstRequestSize parameters at once
         // to prevent write-request link flooding
@@ -1083,6 +1057,131 @@ void QGCParamWidget::retransmissionGuardTick()
 }
 
 
+/**
+ * Re-requests at maximum retransmissionBurstRequestSize parameters per
+ * component at once to prevent link flooding. The received bitmap is walked
+ * round robin, so each burst continues after the parameters of the last one.
+ */
+void QGCParamWidget::requestMissingParameters()
+{
+    transmissionBurstPending = 0;
+    QMap<int, QBitArray>::const_iterator i;
+    for (i = transmissionReceivedPackets.constBegin(); i != transmissionReceivedPackets.constEnd(); ++i) {
+        int component = i.key();
+        const QBitArray& receivedPackets = i.value();
+        if (transmissionMissingCount.value(component) <= 0) {
+            continue;
+        }
+        int id = transmissionRequestCursor.value(component);
+        int count = 0;
+        for (int checked = 0; checked < receivedPackets.size() && count < retransmissionBurstRequestSize; ++checked) {
+            if (!receivedPackets.testBit(id)) {
+                //QLOG_DEBUG() << __FILE__ << __LINE__ << "RETRANSMISSION GUARD REQUESTS RETRANSMISSION OF PARAM #" << id << "FROM COMPONENT #" << component;
+                emit requestParameter(component, id);
+                count++;
+            }
+            id = (id + 1) % receivedPackets.size();
+        }
+        transmissionRequestCursor.insert(component, id);
+        transmissionBurstPending += count;
+        transmissionRetransmitCount += count;
+    }
+}
+
+void QGCParamWidget::showCachedParameters()
+{
+    cachedParameters.clear();
+    cachedParameterCounts.clear();
+
+    QMap<int, QMap<QString, QVariant> > cache;
+    if (!loadParameterCache(cache, cachedParameterCounts))
+    {
+        return;
+    }
+
+    int count = 0;
+    QMap<int, QMap<QString, QVariant> >::const_iterator i;
+    for (i = cache.constBegin(); i != cache.constEnd(); ++i)
+    {
+        QMap<QString, QVariant>::const_iterator j;
+        for (j = i.value().constBegin(); j != i.value().constEnd(); ++j)
+        {
+            // Anything the MAV already sent is newer than the cache
+            if (parameters.contains(i.key()) && parameters.value(i.key())->contains(j.key()))
+            {
+                continue;
+            }
+            cachedParameters[i.key()].insert(j.key());
+            addParameter(mav->getUASID(), i.key(), j.key(), j.value());
+            count++;
+        }
+    }
+    tree->expandItem(tree->topLevelItem(0));
+    QLOG_INFO() << "Showing" << count << "cached parameters from" << parameterCacheFileName();
+}
+
+void QGCParamWidget::autopilotVersionChanged()
+{
+    // The list was requested before the vehicle was identified, show the
+    // cache now if the download is still running
+    if (transmissionListMode && cachedParameters.isEmpty())
+    {
+        showCachedParameters();
+    }
+}
+
+void QGCParamWidget::finishCachedParameters()
+{
+    // Whatever is left was not sent by the MAV, e.g. after a firmware change
+    QMap<int, QSet<QString> >::const_iterator i;
+    for (i = cachedParameters.constBegin(); i != cachedParameters.constEnd(); ++i)
+    {
+        foreach (const QString& parameterName, i.value())
+        {
+            if (parameters.contains(i.key()))
+            {
+                parameters.value(i.key())->remove(parameterName);
+            }
+            if (paramItems.contains(i.key()))
+            {
+                delete paramItems.value(i.key())->take(parameterName);
+            }
+        }
+    }
+    cachedParameters.clear();
+
+    QMap<int, int> counts;
+    QMap<int, QBitArray>::const_iterator j;
+    for (j = transmissionReceivedPackets.constBegin(); j != transmissionReceivedPackets.constEnd(); ++j)
+    {
+        counts.insert(j.key(), j.value().size());
+    }
+    cachedParameterCounts = counts;
+    saveParameterCache(counts);
+}
+
+void QGCParamWidget::updateTransmissionStatus()
+{
+    int paramCount = 0;
+    int missCount = 0;
+    QMap<int, QBitArray>::const_iterator i;
+    for (i = transmissionReceivedPackets.constBegin(); i != transmissionReceivedPackets.constEnd(); ++i) {
+        paramCount += i.value().size();
+        missCount += transmissionMissingCount.value(i.key());
+    }
+    if (paramCount == 0 || missCount == 0) {
+        return;
+    }
+    QPalette pal = statusLabel->palette();
+    pal.setColor(backgroundRole(), QGC::colorOrange);
+    statusLabel->setPalette(pal);
+    if (transmissionRetransmitCount > 0) {
+        statusLabel->setText(tr("Received %1/%2, %3 re-requested").arg(paramCount-missCount).arg(paramCount).arg(transmissionRetransmitCount));
+    } else {
+        statusLabel->setText(tr("Received %1/%2").arg(paramCount-missCount).arg(paramCount));
+    }
+}
+
 /**
  * The .. signal is emitted
  */
@@ -1098,6 +1197,11 @@ void QGCParamWidget::requestParameterUpdate(int component, const QString& parame
  */
 void QGCParamWidget::setParameter(int component, QString parameterName, QVariant value)
 {
+    if (cachedParameters.contains(component) && cachedParameters.value(component).contains(parameterName))
+    {
+        statusLabel->setText(tr("REJ. %1 not confirmed by the MAV yet").arg(parameterName));
+        return;
+    }
     if (paramMin.contains(parameterName) && value.toDouble() < paramMin.value(parameterName))
     {
         statusLabel->setText(tr("REJ. %1 < min").arg(value.toDouble()));
@@ -1283,6 +1387,10 @@ void QGCParamWidget::clear()
 {
     tree->clear();
     components->clear();
+    qDeleteAll(paramGroups);
+    paramGroups.clear();
+    qDeleteAll(paramItems);
+    paramItems.clear();
 }
 void QGCParamWidget::initialParamCheckTick()
 {
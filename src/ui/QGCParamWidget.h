@@ -34,6 +34,7 @@ This file is part of the QGROUNDCONTROL project
 #include <QTreeWidget>
 #include <QTreeWidgetItem>
 #include <QMap>
+#include <QSet>
 #include <QLabel>
 #include <QTimer>
 
@@ -110,6 +111,10 @@ protected:
     QTimer *initialParamTimer;
     QMap<int, QTreeWidgetItem*>* components; ///< The list of components
     QMap<int, QMap<QString, QTreeWidgetItem*>* > paramGroups; ///< Parameter groups
+    QMap<int, QMap<QString, QTreeWidgetItem*>* > paramItems; ///< Parameter items by name
+    QTimer statusTimer; ///< Refreshes the status line while a parameter list is received
+    QMap<int, QSet<QString> > cachedParameters; ///< Parameters shown from the cache and not yet confirmed by the MAV, read-only until then
+    QMap<int, int> cachedParameterCounts; ///< List sizes stored with the cache
 
     // Tooltip data structures
     QMap<QString, QString> paramToolTips; ///< Tooltip values
@@ -120,6 +125,12 @@ protected:
 
     /** @brief Activate / deactivate parameter retransmission */
     void setRetransmissionGuardEnabled(bool enabled);
+    /** @brief Request the next burst of missing parameters by index */
+    void requestMissingParameters();
+    /** @brief Show the parameters cached for this vehicle until the MAV confirms them */
+    void showCachedParameters();
+    /** @brief Drop cached parameters the MAV did not send and store the new cache */
+    void finishCachedParameters();
     /** @brief Load  settings */
     void loadSettings();
     /** @brief Load meta information from CSV */
@@ -127,6 +138,9 @@ protected:
 
 private slots:
     void initialParamCheckTick();
+    void updateTransmissionStatus();
+    /** @brief Show the cache of a vehicle that was identified during the list download */
+    void autopilotVersionChanged();
 };
 
 #endif // QGCPARAMWIDGET_H
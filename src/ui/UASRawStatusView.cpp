@@ -8,6 +8,7 @@
 UASRawStatusView::UASRawStatusView(QWidget *parent) : QWidget(parent)
 {
     m_uas = 0;
+    m_tableDirty = false;
     ui.setupUi(this);
     ui.tableWidget->setColumnCount(2);
     ui.tableWidget->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
@@ -16,8 +17,16 @@ UASRawStatusView::UASRawStatusView(QWidget *parent) : QWidget(parent)
     m_tableRefreshTimer = new QTimer(this);
     connect(m_tableRefreshTimer,SIGNAL(timeout()),this,SLOT(updateTableTimerTick()));
 
-    m_updateTimer = new QTimer(this);
-    connect(m_updateTimer,SIGNAL(timeout()),this,SLOT(updateTimerTick()));
+    //Every value is pulled from the bus, only while the view is visible
+    m_subscriber = new TelemetrySubscriber(500,this);
+    m_subscriber->stop();
+    connect(m_subscriber,SIGNAL(updated()),this,SLOT(telemetryUpdated()));
+    TelemetryBus *bus = TelemetryBus::instance();
+    connect(bus,SIGNAL(channelRegistered(int,QString,QString)),this,SLOT(channelRegistered(int,QString,QString)));
+    for (int i=0;i<bus->channelCount();i++)
+    {
+        channelRegistered(i,bus->channelName(i),bus->channelUnit(i));
+    }
 
     // FIXME reinstate once fixed.
 
@@ -31,43 +40,56 @@ void UASRawStatusView::activeUASSet(UASInterface* uas)
     {
         return;
     }
-    if (m_uas)
-    {
-        disconnect(m_uas,SIGNAL(valueChanged(int,QString,QString,QVariant,quint64)),this,SLOT(valueChanged(int,QString,QString,QVariant,quint64)));
-    }
     m_uas = uas;
-    connect(m_uas,SIGNAL(valueChanged(int,QString,QString,QVariant,quint64)),this,SLOT(valueChanged(int,QString,QString,QVariant,quint64)));
-
 }
 
 void UASRawStatusView::showEvent(QShowEvent *event)
 {
     Q_UNUSED(event)
     //Check every 2 seconds to see if we need an update
-    m_updateTimer->start(500);
+    m_subscriber->start();
     m_tableRefreshTimer->start(2000);
 }
 
 void UASRawStatusView::hideEvent(QHideEvent *event)
 {
     Q_UNUSED(event)
-    m_updateTimer->stop();
+    m_subscriber->stop();
     m_tableRefreshTimer->stop();
 }
-void UASRawStatusView::updateTimerTick()
+void UASRawStatusView::channelRegistered(int channel, const QString& name, const QString& unit)
+{
+    Q_UNUSED(unit)
+    m_channelNames[channel] = name;
+    m_subscriber->watch(channel);
+}
+
+void UASRawStatusView::telemetryUpdated()
 {
-    for (QMap<QString,double>::const_iterator i=valueMap.constBegin();i!=valueMap.constEnd();i++)
+    if (!m_uas)
+    {
+        return;
+    }
+    TelemetryBus *bus = TelemetryBus::instance();
+    const QList<int> &changed = m_subscriber->changedChannels();
+    for (int i=0;i<changed.size();i++)
     {
-        if (nameToUpdateWidgetMap.contains(i.key()))
+        TelemetryBus::Sample sample;
+        if (!bus->latest(changed[i],&sample) || sample.uasId != m_uas->getUASID())
         {
-            nameToUpdateWidgetMap[i.key()]->setText(QString::number(i.value(),'f',4));
+            continue;
+        }
+        const QString &name = m_channelNames[changed[i]];
+        valueMap[name] = sample.value;
+        if (nameToUpdateWidgetMap.contains(name))
+        {
+            nameToUpdateWidgetMap[name]->setText(QString::number(sample.value,'f',4));
         }
         else
         {
             m_tableDirty = true;
         }
     }
-    return;
 }
 
 void UASRawStatusView::addSource(MAVLinkDecoder *decoder)
@@ -75,25 +97,6 @@ void UASRawStatusView::addSource(MAVLinkDecoder *decoder)
     Q_UNUSED(decoder)
    // connect(decoder,SIGNAL(valueChanged(int,QString,QString,QVariant,quint64)),this,SLOT(valueChanged(int,QString,QString,QVariant,quint64)));
 }
-void UASRawStatusView::valueChanged(const int uasId, const QString& name, const QString& unit, const QVariant value, const quint64 msec)
-{
-    if (value.type() == QVariant::Double)
-    {
-        valueChanged(uasId,name,unit,value.toDouble(),msec);
-    }
-    else
-    {
-        valueChanged(uasId,name,unit,static_cast<double>(value.toInt()),msec);
-    }
-}
-
-void UASRawStatusView::valueChanged(const int uasId, const QString& name, const QString& unit, const double value, const quint64 msec)
-{
-    Q_UNUSED(uasId)
-    Q_UNUSED(unit)
-    Q_UNUSED(msec)
-    valueMap[name] = value;
-}
 void UASRawStatusView::resizeEvent(QResizeEvent *event)
 {
     Q_UNUSED(event)
@@ -5,6 +5,7 @@
 #include "MAVLinkDecoder.h"
 #include "ui_UASRawStatusView.h"
 #include "UASInterface.h"
+#include "TelemetryBus.h"
 class UASRawStatusView : public QWidget
 {
     Q_OBJECT
@@ -15,9 +16,8 @@ public:
     void addSource(MAVLinkDecoder *decoder);
 private slots:
     void updateTableTimerTick();
-    void updateTimerTick();
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const double value, const quint64 msec);
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const QVariant value, const quint64 msec);
+    void telemetryUpdated();
+    void channelRegistered(int channel, const QString& name, const QString& unit);
     void activeUASSet(UASInterface* uas);
 protected:
     void resizeEvent(QResizeEvent *event);
@@ -27,8 +27,9 @@ private:
     UASInterface *m_uas;
     QMap<QString,double> valueMap;
     QMap<QString,QTableWidgetItem*> nameToUpdateWidgetMap;
+    QHash<int,QString> m_channelNames; //Bus channel to value name
     Ui::UASRawStatusView ui;
-    QTimer *m_updateTimer;
+    TelemetrySubscriber *m_subscriber;
     QTimer *m_tableRefreshTimer; //This time triggers a reorganization of the cells, for when new cells are added
     bool m_tableDirty;
 };
@@ -48,6 +48,30 @@ private:
 
 public:
 
+    /**
+     * @brief Part of the path leading to one waypoint.
+     *
+     * Segment i starts where segment i-1 ended, so a path can be
+     * updated piecewise when a single waypoint moves.
+     */
+    struct Segment
+    {
+        QPainterPath path;      ///< Lines drawn for this segment, empty if the waypoint is not on the path
+        QPointF end;            ///< Where the next segment starts
+        QPointF exitVelocity;   ///< Spline velocity handed on to the next segment
+    };
+
+    /**
+     * @brief Returns the segment leading to waypoints[i], given
+     *        the end point and exit velocity of segment i-1.
+     *        Segment 0 is the home position.
+     */
+    static Segment segment(const QList<Waypoint*>& waypoints,
+                           int i,
+                           const QPointF& start,
+                           const QPointF& entryVelocity,
+                           mapcontrol::MapGraphicItem& map);
+
     /**
      * @brief Returns a QPainterPath (in the map coordinates)
      *        the UAS would take between the waypoints.
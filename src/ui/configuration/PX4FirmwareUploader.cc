@@ -24,6 +24,11 @@
 #define PROTO_DEVICE_BOARD_REV 0x03
 #define PROTO_DEVICE_FW_SIZE 0x04
 #define PROTO_DEVICE_VEC_AREA 0x05
+#define PROTO_PROG_MULTI 0x27
+
+#define PROG_MULTI_MAX 252 // Largest PROG_MULTI payload, protocol max is 255 and must be a multiple of 4
+#define PROG_MULTI_MAX_OLD_BL 60 // Bootloaders before rev 3 only buffer 60 bytes
+#define PROG_MULTI_DEFAULT_IN_FLIGHT 4 // PROG_MULTI packets sent ahead of their INSYNC/OK reply
 
 static const quint32 crctab[] =
 {
@@ -61,9 +66,8 @@ static const quint32 crctab[] =
     0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 };
 
-static quint32 crc32(const QByteArray src)
+static quint32 crc32(const QByteArray& src, quint32 state = 0)
 {
-    quint32 state = 0;
     for (int i = 0; i < src.size(); i++) //Limited to half of 32bits, since QByteArray::size() is an integer. Shouldn't ever be larger anyway
     {
         state = crctab[(state ^ static_cast<unsigned char>(src[i])) & 0xff] ^ (state >> 8);
@@ -71,6 +75,16 @@ static quint32 crc32(const QByteArray src)
     return state;
 }
 
+// Continue a crc32 over count bytes of erased (0xFF) flash
+static quint32 crc32Padding(qint64 count, quint32 state)
+{
+    for (qint64 i = 0; i < count; i++)
+    {
+        state = crctab[(state ^ 0xFF) & 0xff] ^ (state >> 8);
+    }
+    return state;
+}
+
 PX4FirmwareUploader::PX4FirmwareUploader(QObject *parent) :
     QThread(parent),
     m_port(NULL),
@@ -78,10 +92,18 @@ PX4FirmwareUploader::PX4FirmwareUploader(QObject *parent) :
     m_checkTimer(NULL),
     m_currentOtpAddress(0),
     m_currentSNAddress(0),
+    m_bootloaderRev(0),
+    m_fwPacketsInFlight(0),
+    m_maxFwPacketsInFlight(PROG_MULTI_DEFAULT_IN_FLIGHT),
     m_eraseTimeoutTimer(NULL)
 {
 }
 
+void PX4FirmwareUploader::setMaxPacketsInFlight(int packets)
+{
+    m_maxFwPacketsInFlight = qMax(1, packets);
+}
+
 void PX4FirmwareUploader::loadFile(QString filename)
 {
     foreach (QSerialPortInfo info,QSerialPortInfo::availablePorts())
@@ -223,11 +245,8 @@ bool PX4FirmwareUploader::readChecksum()
         m_checksum += static_cast<unsigned char>(infobuf[1]) << 8;
         m_checksum += static_cast<unsigned char>(infobuf[2]) << 16;
         m_checksum += static_cast<unsigned char>(infobuf[3]) << 24;
-        for (int i=m_toflashbytes.size();i<m_flashSize;i++)
-        {
-            m_toflashbytes.append((char)0xFF);
-        }
-        m_localChecksum = crc32(m_toflashbytes);
+        //The bootloader checksums the whole flash, the unwritten rest reads as 0xFF
+        m_localChecksum = crc32Padding(m_flashSize - m_fwBytesSent, m_fwCrc);
         return true;
     }
     return false;
@@ -247,15 +266,11 @@ void PX4FirmwareUploader::checkForPort()
             m_portToUse = info.portName();
             //Found a port!
             QLOG_INFO() << "Port found!" << m_portToUse;
-            m_devInfoList.append(PROTO_DEVICE_BL_REV);
-            m_devInfoList.append(PROTO_DEVICE_BOARD_ID);
-            m_devInfoList.append(PROTO_DEVICE_BOARD_REV);
-            m_devInfoList.append(PROTO_DEVICE_FW_SIZE);
-            emit devicePlugDetected();
-            emit kickOff();
             m_checkTimer->stop();
             m_checkTimer->deleteLater();
             m_checkTimer = 0;
+            emit devicePlugDetected();
+            emit kickOff();
             break;
 #ifdef Q_OS_LINUX
             }
@@ -275,31 +290,46 @@ void PX4FirmwareUploader::checkForPort()
 }
 void PX4FirmwareUploader::kickOffTriggered()
 {
-    if (m_port)
-    {
-        m_port->close();
-        delete m_port;
-        m_port = NULL;
-    }
-    m_waitingForSync = false;
-    m_currentState = INIT;
-    m_port = new QSerialPort();
-    connect(m_port,SIGNAL(readyRead()),this,SLOT(portReadyRead()));
+    QSerialPort *port = new QSerialPort();
 
 #if defined(Q_OS_MACX) && ((QT_VERSION == 0x050402)||(QT_VERSION == 0x0500401))
     // temp fix Qt5.4.1 issue on OSX
     // http://code.qt.io/cgit/qt/qtserialport.git/commit/?id=687dfa9312c1ef4894c32a1966b8ac968110b71e
-    m_port->setPortName("/dev/cu." + m_portToUse);
+    port->setPortName("/dev/cu." + m_portToUse);
 #else
-    m_port->setPortName(m_portToUse);
+    port->setPortName(m_portToUse);
 #endif
 
-    if (!m_port->open(QIODevice::ReadWrite))
+    if (!port->open(QIODevice::ReadWrite))
+    {
+        QLOG_ERROR() << "Unable to open port:" << port->errorString();
+    }
+    startOnDevice(port);
+}
+void PX4FirmwareUploader::startOnDevice(QIODevice *device)
+{
+    if (m_checkTimer)
     {
-        QLOG_ERROR() << "Unable to open port:" << m_port->errorString();
+        m_checkTimer->stop();
+        m_checkTimer->deleteLater();
+        m_checkTimer = 0;
     }
+    if (m_port)
+    {
+        m_port->close();
+        delete m_port;
+        m_port = NULL;
+    }
+    m_waitingForSync = false;
+    m_currentState = INIT;
+    m_devInfoList.clear();
+    m_devInfoList.append(PROTO_DEVICE_BL_REV);
+    m_devInfoList.append(PROTO_DEVICE_BOARD_ID);
+    m_devInfoList.append(PROTO_DEVICE_BOARD_REV);
+    m_devInfoList.append(PROTO_DEVICE_FW_SIZE);
+    m_port = device;
+    connect(m_port,SIGNAL(readyRead()),this,SLOT(portReadyRead()));
     m_port->write(QByteArray().append(0x21).append(0x20));
-
 }
 void PX4FirmwareUploader::getDeviceInfo(unsigned char infobyte)
 {
@@ -354,7 +384,11 @@ void PX4FirmwareUploader::reqReboot()
         return;
     }
     m_port->write(QByteArray().append(0x30).append(0x20));
-    m_port->flush();
+    QSerialPort *serial = qobject_cast<QSerialPort*>(m_port);
+    if (serial)
+    {
+        serial->flush();
+    }
 }
 void PX4FirmwareUploader::reqFlash()
 {
@@ -364,7 +398,24 @@ void PX4FirmwareUploader::reqFlash()
     m_currentState = SEND_FW;
     m_waitingForSync = true;
     m_fwBytesCounter = 0;
-    sendNextFwBytes();
+    m_fwBytesSent = 0;
+    m_fwCrc = 0;
+    m_fwPacketsInFlight = 0;
+    m_fwChunkSize = (m_bootloaderRev >= 3) ? PROG_MULTI_MAX : PROG_MULTI_MAX_OLD_BL;
+    QLOG_INFO() << "Flashing with" << m_fwChunkSize << "byte packets," << m_maxFwPacketsInFlight << "in flight";
+    fillFwPipeline();
+}
+void PX4FirmwareUploader::fillFwPipeline()
+{
+    //Keep the bootloader busy: queue packets up to the limit instead of waiting for each reply
+    while (tempFile && m_fwPacketsInFlight < m_maxFwPacketsInFlight)
+    {
+        if (!sendNextFwBytes())
+        {
+            break;
+        }
+        m_fwPacketsInFlight++;
+    }
 }
 bool PX4FirmwareUploader::sendNextFwBytes()
 {
@@ -390,11 +441,12 @@ bool PX4FirmwareUploader::sendNextFwBytes()
         emit flashProgress(tempFile->pos(),tempFile->size());
         QLOG_INFO() << "flashing:" << tempFile->pos() << "/" << tempFile->size();
     }
-    QByteArray bytes = tempFile->read(60);
-    m_toflashbytes.append(bytes);
+    QByteArray bytes = tempFile->read(m_fwChunkSize);
+    m_fwCrc = crc32(bytes, m_fwCrc);
+    m_fwBytesSent += bytes.size();
     QByteArray tosend;
-    tosend.append(0x27);
-    tosend.append(bytes.size());
+    tosend.append(PROTO_PROG_MULTI);
+    tosend.append(static_cast<char>(bytes.size()));
     tosend.append(bytes);
     tosend.append(0x20);
     m_port->write(tosend);
@@ -493,6 +545,27 @@ bool PX4FirmwareUploader::getSync()
     }
     return false;
 }
+int PX4FirmwareUploader::readFwSyncs()
+{
+    if (!m_port)
+    {
+        QLOG_ERROR() << "Called readFwSyncs with a null port!";
+        return -1;
+    }
+    //Several program packets are in flight, so replies can arrive back to back
+    int count = 0;
+    while (m_port->bytesAvailable() >= 2 && count < m_fwPacketsInFlight)
+    {
+        QByteArray infobuf = m_port->read(2);
+        if (infobuf[0] != (char)0x12  || infobuf[1] != (char)0x10)
+        {
+            QLOG_INFO() << "Bad sync return:" << QString::number(infobuf[0],16) << QString::number(infobuf[1],16);
+            return -1;
+        }
+        count++;
+    }
+    return count;
+}
 bool PX4FirmwareUploader::readOtp()
 {
     if (!m_port)
@@ -523,6 +596,12 @@ bool PX4FirmwareUploader::readDeviceInfo()
         emit gotDeviceInfo(m_waitingDeviceInfoVar,reply);
         switch (m_waitingDeviceInfoVar)
         {
+            case PROTO_DEVICE_BL_REV:
+            {
+                emit bootloaderRev(reply);
+                m_bootloaderRev = reply;
+            }
+                break;
             case PROTO_DEVICE_BOARD_ID:
             {
                 emit statusUpdate("Requesting Board ID");
@@ -746,22 +825,27 @@ void PX4FirmwareUploader::portReadyRead()
     }
     else if (m_currentState == SEND_FW)
     {
-        if (m_waitingForSync)
+        int acked = readFwSyncs();
+        if (acked < 0)
         {
-            if (getSync())
-            {
-                m_waitingForSync = false;
-                if (!sendNextFwBytes())
-                {
-                    //At end
-                    QLOG_INFO() << "finished writing firmware";
-                    emit statusUpdate("Flashing complete, verifying firmware");
-                    m_waitingForSync = false;
-                    reqChecksum();
-                    return;
-                }
-                m_waitingForSync = true;
-            }
+            emit error("Bootloader rejected firmware data! Firmware write failed, please try again");
+            emit statusUpdate("Bootloader rejected firmware data! Firmware write failed, please try again");
+            m_port->close();
+            m_port->deleteLater();
+            m_port = 0;
+            emit complete();
+            return;
+        }
+        m_fwPacketsInFlight -= acked;
+        fillFwPipeline();
+        if (!tempFile && m_fwPacketsInFlight == 0)
+        {
+            //At end
+            QLOG_INFO() << "finished writing firmware";
+            emit statusUpdate("Flashing complete, verifying firmware");
+            m_waitingForSync = false;
+            reqChecksum();
+            return;
         }
     }
     else if (m_currentState == REQ_CHECKSUM)
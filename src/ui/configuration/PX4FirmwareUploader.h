@@ -21,6 +21,10 @@ public:
     };
     void stop();
     void loadFile(QString filename);
+    /** @brief Number of firmware packets sent before waiting for a reply, 1 waits for every packet */
+    void setMaxPacketsInFlight(int packets);
+    /** @brief Talk to the bootloader over an open device instead of waiting for a serial port, takes ownership */
+    void startOnDevice(QIODevice *device);
 
 private:
     bool checkCOA(const QByteArray& serial, const QByteArray& signature, const QString& publicKey);
@@ -28,7 +32,7 @@ private:
 private:
     QList<QString> m_portlist;
     QString m_portToUse;
-    QSerialPort *m_port;
+    QIODevice *m_port;
 
     bool m_waitingForSync;
 
@@ -37,6 +41,7 @@ private:
     State m_currentState;
 
     bool getSync();
+    int readFwSyncs();
     bool verifyOtp();
 
     bool reqNextOtpAddress();
@@ -58,6 +63,13 @@ private:
     int m_waitingDeviceInfoVar;
 
     bool sendNextFwBytes();
+    void fillFwPipeline();
+    int m_bootloaderRev;
+    int m_fwChunkSize;
+    int m_fwPacketsInFlight;
+    int m_maxFwPacketsInFlight;
+    qint64 m_fwBytesSent;
+    quint32 m_fwCrc;
 
     void reqReboot();
 
@@ -66,7 +78,6 @@ private:
     quint32 m_checksum;
     quint32 m_localChecksum;
     int m_flashSize;
-    QByteArray m_toflashbytes;
 
 
 
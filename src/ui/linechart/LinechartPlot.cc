@@ -273,6 +273,13 @@ void LinechartPlot::setZeroValue(QString id, double zeroValue)
 
 void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
 {
+    // NaN and Inf can't be drawn or scaled to, drop them before they reach
+    // the curve and its statistics
+    if (!qIsFinite(value))
+    {
+        return;
+    }
+
     /* Lock resource to ensure data integrity */
     datalock.lock();
 
@@ -806,10 +813,11 @@ TimeSeriesData::TimeSeriesData(QwtPlot* plot, QString friendlyName, quint64 plot
     maxValue(DBL_MIN),
     zeroValue(0),
     count(0),
+    dataStart(0),
     mean(0.0),
     median(0.0),
     variance(0.0),
-    averageWindow(50)
+    statistics(50)
 {
     this->plot = plot;
     this->friendlyName = friendlyName;
@@ -836,7 +844,9 @@ void TimeSeriesData::setInterval(quint64 ms)
 
 void TimeSeriesData::setAverageWindowSize(int windowSize)
 {
-    this->averageWindow = windowSize;
+    dataMutex.lock();
+    statistics.setWindowSize(windowSize);
+    dataMutex.unlock();
 }
 
 /**
@@ -848,75 +858,59 @@ void TimeSeriesData::setAverageWindowSize(int windowSize)
 void TimeSeriesData::append(quint64 ms, double value)
 {
     dataMutex.lock();
-    // Pre- allocate new space
-    // FIXME Check this for validity
-    if(static_cast<quint64>(size()) < (count + 100)) {
-        this->ms.resize(size() + 10000);
-        this->value.resize(size() + 10000);
+    if(static_cast<quint64>(size()) <= dataStart + count) {
+        if(dataStart >= count) {
+            // At least half of the array has been trimmed, move the points
+            // to the front instead of growing. Each point is moved at most
+            // once per trimmed point, so trimming stays O(1) amortized
+            qCopy(this->ms.begin() + dataStart, this->ms.begin() + dataStart + count, this->ms.begin());
+            qCopy(this->value.begin() + dataStart, this->value.begin() + dataStart + count, this->value.begin());
+            dataStart = 0;
+        } else {
+            // Pre-allocate new space, doubling keeps appends O(1) amortized
+            this->ms.resize(qMax(size() * 2, 10000));
+            this->value.resize(qMax(size() * 2, 10000));
+        }
     }
-    this->ms[count] = ms;
-    this->value[count] = value;
+    this->ms[dataStart + count] = ms;
+    this->value[dataStart + count] = value;
     this->lastValue = value;
-    this->mean = 0;
-    //QList<double> medianList = QList<double>();
-    for (unsigned int i = 0; (i < averageWindow) && (((int)count - (int)i) >= 0); ++i) {
-        this->mean += this->value[count-i];
-        //medianList.append(this->value[count-i]);
-    }
-    this->mean = mean / static_cast<double>(qMin(averageWindow,static_cast<unsigned int>(count)));
-
-    this->variance = 0;
-    for (unsigned int i = 0; (i < averageWindow) && (((int)count - (int)i) >= 0); ++i) {
-        this->variance += (this->value[count-i] - mean) * (this->value[count-i] - mean);
-    }
-    this->variance = this->variance / static_cast<double>(qMin(averageWindow,static_cast<unsigned int>(count)));
-
-//    qSort(medianList);
-
-//    if (medianList.count() > 2)
-//    {
-//        if (medianList.count() % 2 == 0)
-//        {
-//            median = (medianList.at(medianList.count()/2) + medianList.at(medianList.count()/2+1)) / 2.0;
-//        }
-//        else
-//        {
-//            median = medianList.at(medianList.count()/2+1);
-//        }
-//    }
 
     // Update statistical values
-    if(ms < startTime) startTime = ms;
-    if(ms > stopTime) stopTime = ms;
-    interval = stopTime - startTime;
+    statistics.append(value);
+    this->mean = statistics.mean();
+    this->median = statistics.median();
+    this->variance = statistics.variance();
 
-    if (interval > plotInterval) {
-        while (this->ms[count - plotCount] < stopTime - plotInterval) {
-            plotCount--;
-        }
-    }
+    if(ms > stopTime) stopTime = ms;
 
     count++;
     plotCount++;
 
+    // Only plot the points within the plot interval
+    while (plotCount > 1 && this->ms[dataStart + count - plotCount] < static_cast<double>(stopTime) - plotInterval) {
+        plotCount--;
+    }
+
     if(minValue > value) minValue = value;
     if(maxValue < value) maxValue = value;
 
     // Trim dataset if necessary
     if(maxInterval > 0) {
         // maxInterval = 0 means infinite
-
-        if(interval > maxInterval && !this->ms.isEmpty() && !this->value.isEmpty()) {
-            // The time at which this time series should be cut
-            double minTime = stopTime - maxInterval;
-            // Delete elements from the start of the list as long the time
-            // value of this elements is before the cut time
-            while(this->ms.first() < minTime) {
-                this->ms.pop_front();
-                this->value.pop_front();
-            }
+        // The time at which this time series should be cut
+        double minTime = static_cast<double>(stopTime) - maxInterval;
+        // Drop points from the start as long their time is before the cut
+        // time, this only moves the start index
+        while(count > 1 && this->ms[dataStart] < minTime) {
+            dataStart++;
+            count--;
         }
+        plotCount = qMin(plotCount, count);
     }
+
+    startTime = this->ms[dataStart];
+    interval = stopTime - startTime;
     dataMutex.unlock();
 }
 
@@ -1041,12 +1035,12 @@ int TimeSeriesData::size() const
  **/
 const double* TimeSeriesData::getX() const
 {
-    return ms.data();
+    return ms.data() + dataStart;
 }
 
 const double* TimeSeriesData::getPlotX() const
 {
-    return ms.data() + (count - plotCount);
+    return ms.data() + dataStart + (count - plotCount);
 }
 
 /**
@@ -1056,10 +1050,10 @@ const double* TimeSeriesData::getPlotX() const
  **/
 const double* TimeSeriesData::getY() const
 {
-    return value.data();
+    return value.data() + dataStart;
 }
 
 const double* TimeSeriesData::getPlotY() const
 {
-    return value.data() + (count - plotCount);
+    return value.data() + dataStart + (count - plotCount);
 }
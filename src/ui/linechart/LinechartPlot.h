@@ -49,6 +49,7 @@ This file is part of the PIXHAWK project
 #include <qwt_plot.h>
 #include <ScrollZoomer.h>
 #include "MG.h"
+#include "RollingStatistics.h"
 
 class TimeScaleDraw: public QwtScaleDraw
 {
@@ -163,13 +164,14 @@ protected:
     void updateScaleMap();
 
 private:
-    quint64 count;
+    quint64 count;      ///< Number of stored points
+    quint64 dataStart;  ///< Array index of the oldest stored point
     QwtArray<double> ms;
     QwtArray<double> value;
     double mean;
     double median;
     double variance;
-    unsigned int averageWindow;
+    RollingStatistics statistics;
     QwtArray<double> outputMs;
     QwtArray<double> outputValue;
 };
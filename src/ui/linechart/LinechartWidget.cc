@@ -94,8 +94,8 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
     curvesWidgetLayout->setColumnStretch(3, 50);
     curvesWidgetLayout->setColumnStretch(4, 50);
     curvesWidgetLayout->setColumnStretch(5, 50);
-//    horizontalLayout->setColumnStretch(median, 50);
     curvesWidgetLayout->setColumnStretch(6, 50);
+    curvesWidgetLayout->setColumnStretch(7, 50);
 
     curvesWidget->setLayout(curvesWidgetLayout);
 
@@ -103,6 +103,7 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
     QLabel* label;
     QLabel* value;
     QLabel* mean;
+    QLabel* median;
     QLabel* variance;
 
     connect(ui.recolorButton, SIGNAL(clicked()), this, SLOT(recolor()));
@@ -131,10 +132,15 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
     mean->setText("Mean");
     curvesWidgetLayout->addWidget(mean, labelRow, 5);
 
+    // Median
+    median = new QLabel(this);
+    median->setText("Median");
+    curvesWidgetLayout->addWidget(median, labelRow, 6);
+
     // Variance
     variance = new QLabel(this);
     variance->setText("Variance");
-    curvesWidgetLayout->addWidget(variance, labelRow, 6);
+    curvesWidgetLayout->addWidget(variance, labelRow, 7);
 
     // Create the layout
     createLayout();
@@ -510,13 +516,22 @@ void LinechartWidget::refresh()
         }
         j.value()->setText(str);
     }
-//    QMap<QString, QLabel*>::iterator k;
-//    for (k = curveMedians->begin(); k != curveMedians->end(); ++k)
-//    {
-//        // Median
-//        str.sprintf("%+.2f", activePlot->getMedian(k.key()));
-//        k.value()->setText(str);
-//    }
+    // Median
+    QMap<QString, QLabel*>::iterator k;
+    for (k = curveMedians->begin(); k != curveMedians->end(); ++k) {
+        double val = activePlot->getMedian(k.key());
+        int intval = static_cast<int>(val);
+        if (intval >= 100000 || intval <= -100000) {
+            str.sprintf("% 11i", intval);
+        } else if (intval >= 10000 || intval <= -10000) {
+            str.sprintf("% 11.2f", val);
+        } else if (intval >= 1000 || intval <= -1000) {
+            str.sprintf("% 11.4f", val);
+        } else {
+            str.sprintf("% 11.6f", val);
+        }
+        k.value()->setText(str);
+    }
     QMap<QString, QLabel*>::iterator l;
     for (l = curveVariances->begin(); l != curveVariances->end(); ++l) {
         // Variance
@@ -653,6 +668,7 @@ void LinechartWidget::addCurve(const QString& curve, const QString& unit)
     QLabel* value;
     QLabel* unitLabel;
     QLabel* mean;
+    QLabel* median;
     QLabel* variance;
 
     curveNames.insert(curve+unit, curve);
@@ -717,11 +733,14 @@ void LinechartWidget::addCurve(const QString& curve, const QString& unit)
     curveMeans->insert(curve+unit, mean);
     curvesWidgetLayout->addWidget(mean, labelRow, 5);
 
-//    // Median
-//    median = new QLabel(form);
-//    value->setNum(0.00);
-//    curveMedians->insert(curve, median);
-//    horizontalLayout->addWidget(median);
+    // Median
+    median = new QLabel(this);
+    median->setNum(0.00);
+    median->setStyleSheet(QString("QLabel {font-family:\"Courier\"; font-weight: bold;}"));
+    median->setToolTip(tr("Median of %1 in %2 units").arg(curve, unit));
+    median->setWhatsThis(tr("Median of %1 in %2 units").arg(curve, unit));
+    curveMedians->insert(curve+unit, median);
+    curvesWidgetLayout->addWidget(median, labelRow, 6);
 
     // Variance
     variance = new QLabel(this);
@@ -730,7 +749,7 @@ void LinechartWidget::addCurve(const QString& curve, const QString& unit)
     variance->setToolTip(tr("Variance of %1 in (%2)^2 units").arg(curve, unit));
     variance->setWhatsThis(tr("Variance of %1 in (%2)^2 units").arg(curve, unit));
     curveVariances->insert(curve+unit, variance);
-    curvesWidgetLayout->addWidget(variance, labelRow, 6);
+    curvesWidgetLayout->addWidget(variance, labelRow, 7);
 
     /* Color picker
     QColor color = QColorDialog::getColor(Qt::green, this);
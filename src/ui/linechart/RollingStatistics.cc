@@ -0,0 +1,205 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2015 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Exact statistics over a sliding window of samples
+ *
+ */
+
+#include "RollingStatistics.h"
+#include <QtGlobal>
+#include <qnumeric.h>
+
+RollingStatistics::RollingStatistics(int windowSize) :
+    m_windowSize(qMax(1,windowSize)),
+    m_head(0),
+    m_count(0),
+    m_nonFiniteCount(0),
+    m_mean(0.0),
+    m_m2(0.0)
+{
+    m_window.resize(m_windowSize);
+}
+
+void RollingStatistics::setWindowSize(int windowSize)
+{
+    windowSize = qMax(1,windowSize);
+    if (windowSize == m_windowSize)
+    {
+        return;
+    }
+    while (m_count > windowSize)
+    {
+        removeOldest();
+    }
+    // Unroll the ring into the new storage
+    QVector<double> window(windowSize);
+    for (int i=0;i<m_count;i++)
+    {
+        window[i] = m_window.at((m_head + i) % m_windowSize);
+    }
+    m_window = window;
+    m_head = 0;
+    m_windowSize = windowSize;
+}
+
+void RollingStatistics::clear()
+{
+    m_head = 0;
+    m_count = 0;
+    m_nonFiniteCount = 0;
+    m_mean = 0.0;
+    m_m2 = 0.0;
+    m_lower.clear();
+    m_upper.clear();
+}
+
+void RollingStatistics::append(double value)
+{
+    // A NaN breaks the ordering of the sorted halves and would stick in the
+    // running sums forever, as it can never be subtracted out again
+    if (!qIsFinite(value))
+    {
+        m_nonFiniteCount++;
+        return;
+    }
+    if (m_count == m_windowSize)
+    {
+        removeOldest();
+    }
+    m_window[(m_head + m_count) % m_windowSize] = value;
+    m_count++;
+
+    double delta = value - m_mean;
+    m_mean += delta / m_count;
+    m_m2 += delta * (value - m_mean);
+
+    insertSorted(value);
+}
+
+void RollingStatistics::removeOldest()
+{
+    double value = m_window.at(m_head);
+    m_head = (m_head + 1) % m_windowSize;
+    m_count--;
+
+    if (m_count == 0)
+    {
+        m_mean = 0.0;
+        m_m2 = 0.0;
+    }
+    else
+    {
+        // Welford's update run backwards
+        double mean = m_mean - (value - m_mean) / m_count;
+        m_m2 -= (value - m_mean) * (value - mean);
+        m_mean = mean;
+    }
+
+    removeSorted(value);
+}
+
+void RollingStatistics::insertSorted(double value)
+{
+    if (m_lower.empty() || value <= *m_lower.rbegin())
+    {
+        m_lower.insert(value);
+    }
+    else
+    {
+        m_upper.insert(value);
+    }
+    balance();
+}
+
+void RollingStatistics::removeSorted(double value)
+{
+    std::multiset<double>::iterator it = m_lower.find(value);
+    if (it != m_lower.end())
+    {
+        m_lower.erase(it);
+    }
+    else
+    {
+        it = m_upper.find(value);
+        if (it != m_upper.end())
+        {
+            m_upper.erase(it);
+        }
+    }
+    balance();
+}
+
+void RollingStatistics::balance()
+{
+    // The lower half holds as many samples as the upper one, or one more
+    if (m_lower.size() > m_upper.size() + 1)
+    {
+        std::multiset<double>::iterator it = --m_lower.end();
+        m_upper.insert(*it);
+        m_lower.erase(it);
+    }
+    else if (m_upper.size() > m_lower.size())
+    {
+        std::multiset<double>::iterator it = m_upper.begin();
+        m_lower.insert(*it);
+        m_upper.erase(it);
+    }
+}
+
+double RollingStatistics::variance() const
+{
+    if (m_count == 0)
+    {
+        return 0.0;
+    }
+    // Rounding in the removal step can leave a tiny negative sum
+    return qMax(0.0,m_m2) / m_count;
+}
+
+double RollingStatistics::median() const
+{
+    if (m_lower.empty())
+    {
+        return 0.0;
+    }
+    if (m_lower.size() > m_upper.size())
+    {
+        return *m_lower.rbegin();
+    }
+    return (*m_lower.rbegin() + *m_upper.begin()) / 2.0;
+}
+
+double RollingStatistics::min() const
+{
+    return m_lower.empty() ? 0.0 : *m_lower.begin();
+}
+
+double RollingStatistics::max() const
+{
+    if (!m_upper.empty())
+    {
+        return *m_upper.rbegin();
+    }
+    return m_lower.empty() ? 0.0 : *m_lower.rbegin();
+}
@@ -0,0 +1,82 @@
+/*===================================================================
+APM_PLANNER Open Source Ground Control Station
+
+(c) 2015 APM_PLANNER PROJECT <http://www.diydrones.com>
+
+This file is part of the APM_PLANNER project
+
+    APM_PLANNER is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    APM_PLANNER is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with APM_PLANNER. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Exact statistics over a sliding window of samples
+ *
+ *          Mean and variance are kept with Welford's update, extended to
+ *          remove the sample that leaves the window. The window is also kept
+ *          in two sorted halves, which gives the median, minimum and maximum
+ *          without sorting. Every append is O(log n) in the window size.
+ *
+ */
+
+#ifndef ROLLINGSTATISTICS_H
+#define ROLLINGSTATISTICS_H
+
+#include <QVector>
+#include <set>
+
+class RollingStatistics
+{
+public:
+    explicit RollingStatistics(int windowSize = 50);
+
+    /** @brief Change the number of samples in the window, dropping the oldest if it shrinks */
+    void setWindowSize(int windowSize);
+    int getWindowSize() const { return m_windowSize; }
+    /** @brief Add a sample to the window, NaN and Inf are counted but not added */
+    void append(double value);
+    void clear();
+
+    int count() const { return m_count; }
+    /** @brief Number of NaN or Inf samples skipped since the last clear() */
+    int nonFiniteCount() const { return m_nonFiniteCount; }
+    double mean() const { return m_mean; }
+    /** @brief Population variance of the window */
+    double variance() const;
+    double median() const;
+    double min() const;
+    double max() const;
+
+private:
+    void removeOldest();
+    void insertSorted(double value);
+    void removeSorted(double value);
+    void balance();
+
+private:
+    int m_windowSize;
+    QVector<double> m_window;   ///< Ring of the samples in the window
+    int m_head;                 ///< Oldest sample in m_window
+    int m_count;
+    int m_nonFiniteCount;
+
+    double m_mean;
+    double m_m2;                ///< Sum of squared differences from the mean
+
+    std::multiset<double> m_lower;  ///< Smaller half, holds the extra sample
+    std::multiset<double> m_upper;  ///< Larger half
+};
+
+#endif // ROLLINGSTATISTICS_H
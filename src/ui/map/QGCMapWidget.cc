@@ -9,10 +9,12 @@
 #include "ArduPilotMegaMAV.h"
 #include "WaypointNavigation.h"
 #include <QInputDialog>
+#include <QSet>
 
 QGCMapWidget::QGCMapWidget(QWidget *parent) :
     mapcontrol::OPMapWidget(parent),
     firingWaypointChange(NULL),
+    pathGroup(NULL),
     maxUpdateInterval(2.1f), // 2 seconds
     followUAVEnabled(false),
     trailType(mapcontrol::UAVTrailType::ByTimeElapsed),
@@ -679,7 +681,7 @@ void QGCMapWidget::cacheVisibleRegion()
 void QGCMapWidget::shiftOtherSelectedWaypoints(mapcontrol::WayPointItem* selectedWaypoint,
                                                double shiftLong, double shiftLat)
 {
-    QMap<mapcontrol::WayPointItem*, Waypoint*>::iterator i;
+    QHash<mapcontrol::WayPointItem*, Waypoint*>::iterator i;
     for (i = iconsToWaypoints.begin(); i != iconsToWaypoints.end(); ++i) {
         mapcontrol::WayPointItem* waypoint = i.key();
 
@@ -754,7 +756,6 @@ void QGCMapWidget::updateWaypoint(int uas, Waypoint* wp)
     }
     // Currently only accept waypoint updates from the UAS in focus
     // this has to be changed to accept read-only updates from other systems as well.
-    UASInterface* uasInstance = UASManager::instance()->getUASForId(uas);
     if (currWPManager)
     {
         // Only accept waypoints in global coordinate frame
@@ -771,52 +772,8 @@ void QGCMapWidget::updateWaypoint(int uas, Waypoint* wp)
 
             QLOG_DEBUG() << "UPDATING WAYPOINT" << wpindex << "IN 2D MAP";
 
-            // Check if wp exists yet in map
-            if (!waypointsToIcons.contains(wp))
-            {
-                QLOG_TRACE() << "UPDATING NEW WAYPOINT" << wpindex << "IN 2D MAP";
-                // Create icon for new WP
-                QColor wpColor(Qt::red);
-                if (uasInstance) wpColor = uasInstance->getColor();
-                Waypoint2DIcon* icon = new Waypoint2DIcon(map, this, wp, wpColor, wpindex);
-                ConnectWP(icon);
-                icon->setParentItem(map);
-                // Update maps to allow inverse data association
-                waypointsToIcons.insert(wp, icon);
-                iconsToWaypoints.insert(icon, wp);
-            }
-            else
-            {
-                QLOG_TRACE() << "UPDATING EXISTING WAYPOINT" << wpindex << "IN 2D MAP";
-                // Waypoint exists, block it's signals and update it
-                mapcontrol::WayPointItem* icon = waypointsToIcons.value(wp);
-                // Make sure we don't die on a null pointer
-                // this should never happen, just a precaution
-                if (!icon) return;
-                // Block outgoing signals to prevent an infinite signal loop
-                // should not happen, just a precaution
-                this->blockSignals(true);
-                // Update the WP
-                Waypoint2DIcon* wpicon = dynamic_cast<Waypoint2DIcon*>(icon);
-                if (wpicon)
-                {
-                    // Let icon read out values directly from waypoint
-                    icon->SetNumber(wpindex);
-                    wpicon->updateWaypoint();
-                }
-                else
-                {
-                    // Use safe standard interfaces for non Waypoint-class based wps
-                    icon->SetCoord(internals::PointLatLng(wp->getLatitude(), wp->getLongitude()));
-                    icon->SetAltitude(wp->getAltitude());
-                    icon->SetHeading(wp->getYaw());
-                    icon->SetNumber(wpindex);
-                }
-                // Re-enable signals again
-                this->blockSignals(false);
-            }
-
-            redrawWaypointLines(uas);
+            updateWaypointIcon(uas, wp, wpindex);
+            updateWaypointLines(uas, wp);
 
             firingWaypointChange = NULL;
         }
@@ -834,11 +791,63 @@ void QGCMapWidget::updateWaypoint(int uas, Waypoint* wp)
     }
 }
 
+void QGCMapWidget::updateWaypointIcon(int uas, Waypoint* wp, int wpindex)
+{
+    mapcontrol::WayPointItem* icon = waypointsToIcons.value(wp, NULL);
+
+    // Check if wp exists yet in map
+    if (!icon)
+    {
+        QLOG_TRACE() << "UPDATING NEW WAYPOINT" << wpindex << "IN 2D MAP";
+        // Create icon for new WP
+        QColor wpColor(Qt::red);
+        UASInterface* uasInstance = UASManager::instance()->getUASForId(uas);
+        if (uasInstance) wpColor = uasInstance->getColor();
+        Waypoint2DIcon* newIcon = new Waypoint2DIcon(map, this, wp, wpColor, wpindex);
+        ConnectWP(newIcon);
+        newIcon->setParentItem(map);
+        // Update maps to allow inverse data association
+        waypointsToIcons.insert(wp, newIcon);
+        iconsToWaypoints.insert(newIcon, wp);
+    }
+    else
+    {
+        QLOG_TRACE() << "UPDATING EXISTING WAYPOINT" << wpindex << "IN 2D MAP";
+        // Waypoint exists, block it's signals and update it
+        // Block outgoing signals to prevent an infinite signal loop
+        // should not happen, just a precaution
+        this->blockSignals(true);
+        // Update the WP
+        Waypoint2DIcon* wpicon = dynamic_cast<Waypoint2DIcon*>(icon);
+        if (wpicon)
+        {
+            // Let icon read out values directly from waypoint
+            icon->SetNumber(wpindex);
+            wpicon->updateWaypoint();
+        }
+        else
+        {
+            // Use safe standard interfaces for non Waypoint-class based wps
+            icon->SetCoord(internals::PointLatLng(wp->getLatitude(), wp->getLongitude()));
+            icon->SetAltitude(wp->getAltitude());
+            icon->SetHeading(wp->getYaw());
+            icon->SetNumber(wpindex);
+        }
+        // Re-enable signals again
+        this->blockSignals(false);
+    }
+}
+
 void QGCMapWidget::redrawWaypointLines()
 {
     redrawWaypointLines(uas ? uas->getUASID() : 0);
 }
 
+/**
+ * Redraw the whole mission line, e.g. because the map moved or the list of
+ * waypoints changed. The line is drawn as one item per waypoint so that
+ * updateWaypointLines() can later replace only the pieces that changed.
+ */
 void QGCMapWidget::redrawWaypointLines(int uas)
 {
 //    QLOG_DEBUG() << "REDRAW WAYPOINT LINES FOR UAS" << uas;
@@ -851,33 +860,108 @@ void QGCMapWidget::redrawWaypointLines(int uas)
         return;
     Q_ASSERT(group->parentItem() == map);
 
-    // Delete existing waypoint lines
-    foreach (QGraphicsItem* item, group->childItems())
+    if (!waypointLinesValid(group))
     {
-        QLOG_TRACE() << "DELETE EXISTING WAYPOINT LINES" << item;
-        delete item;
+        // Delete existing waypoint lines
+        foreach (QGraphicsItem* item, group->childItems())
+        {
+            QLOG_TRACE() << "DELETE EXISTING WAYPOINT LINES" << item;
+            delete item;
+        }
+        pathItems.clear();
+        pathGroup = group;
     }
 
-    QList<Waypoint*> wps = currWPManager->getGlobalFrameAndNavTypeWaypointList(true);
-    if (wps.size() > 1)
+    pathWaypoints = currWPManager->getGlobalFrameAndNavTypeWaypointList(true);
+    pathIndex.clear();
+    pathIndex.reserve(pathWaypoints.size());
+    pathSegments.clear();
+    pathSegments.reserve(pathWaypoints.size());
+
+    while (pathItems.size() > pathWaypoints.size())
+        delete pathItems.takeLast();
+
+    QColor color(Qt::red);
+    UASInterface* uasInstance = UASManager::instance()->getUASForId(uas);
+    if (uasInstance) color = uasInstance->getColor();
+    QPen pen(color);
+    pen.setWidth(2);
+
+    for (int i = 0; i < pathWaypoints.size(); ++i)
     {
-        QPainterPath path = WaypointNavigation::path(wps, *map);
-        if (path.elementCount() > 1)
+        pathIndex.insert(pathWaypoints[i], i);
+        pathSegments.append(waypointLineSegment(i));
+        if (i == pathItems.size())
         {
             QGraphicsPathItem* gpi = new QGraphicsPathItem(map);
-            gpi->setPath(path);
-
-            QColor color(Qt::red);
-            UASInterface* uasInstance = UASManager::instance()->getUASForId(uas);
-            if (uasInstance) color = uasInstance->getColor();
-            QPen pen(color);
-            pen.setWidth(2);
-            gpi->setPen(pen);
-
             QLOG_TRACE() << "ADDING WAYPOINT LINES" << gpi;
             group->addToGroup(gpi);
+            pathItems.append(gpi);
         }
+        if (pathItems[i]->pen() != pen)
+            pathItems[i]->setPen(pen);
+        pathItems[i]->setPath(pathSegments[i].path);
+    }
+}
+
+/**
+ * A moved waypoint only changes the line pieces next to it (splines look at
+ * two waypoints on either side), so recompute those and continue only as
+ * long as the end point or spline velocity handed to the next piece changes.
+ */
+void QGCMapWidget::updateWaypointLines(int uas, Waypoint* wp)
+{
+    if (!currWPManager)
+        return;
+
+    QGraphicsItemGroup* group = waypointLine(uas);
+    if (!group)
+        return;
+
+    if (!waypointLinesValid(group) || currWPManager->getGlobalFrameAndNavTypeWaypointList(true) != pathWaypoints)
+    {
+        redrawWaypointLines(uas);
+        return;
+    }
+
+    int changed = pathIndex.value(wp, -1);
+    if (changed < 0)
+        return;
+
+    for (int i = qMax(0, changed - 1); i < pathWaypoints.size(); ++i)
+    {
+        WaypointNavigation::Segment segment = waypointLineSegment(i);
+        bool settled = (i >= changed + 2)
+                && (segment.end == pathSegments[i].end)
+                && (segment.exitVelocity == pathSegments[i].exitVelocity);
+        pathSegments[i] = segment;
+        pathItems[i]->setPath(segment.path);
+        if (settled)
+            break;
+    }
+}
+
+WaypointNavigation::Segment QGCMapWidget::waypointLineSegment(int index)
+{
+    if (index == 0)
+        return WaypointNavigation::segment(pathWaypoints, 0, QPointF(), QPointF(), *map);
+    const WaypointNavigation::Segment& previous = pathSegments[index - 1];
+    return WaypointNavigation::segment(pathWaypoints, index, previous.end, previous.exitVelocity, *map);
+}
+
+bool QGCMapWidget::waypointLinesValid(QGraphicsItemGroup* group)
+{
+    if (group != pathGroup)
+        return false;
+    QList<QGraphicsItem*> children = group->childItems();
+    if (children.size() != pathItems.size())
+        return false;
+    for (int i = 0; i < children.size(); ++i)
+    {
+        if (children[i] != pathItems[i])
+            return false;
     }
+    return true;
 }
 
 /**
@@ -892,38 +976,36 @@ void QGCMapWidget::updateWaypointList(int uas)
     // this has to be changed to accept read-only updates from other systems as well.
     if (currWPManager)
     {
-        // Delete first all old waypoints
-        // this is suboptimal (quadratic, but wps should stay in the sub-100 range anyway)
         QList<Waypoint* > wps = currWPManager->getGlobalFrameAndNavTypeWaypointList(false);
-        foreach (Waypoint* wp, waypointsToIcons.keys())
+        QSet<Waypoint*> listed = wps.toSet();
+
+        // Delete first all waypoints no longer in the list
+        QHash<Waypoint*, mapcontrol::WayPointItem*>::iterator i = waypointsToIcons.begin();
+        while (i != waypointsToIcons.end())
         {
-            if (!wps.contains(wp))
+            if (listed.contains(i.key()))
             {
-                QLOG_TRACE() << "DELETE EXISTING WP" << wp->getId();
-                // Get icon to work on
-                mapcontrol::WayPointItem* icon = waypointsToIcons.value(wp);
-                waypointsToIcons.remove(wp);
-                iconsToWaypoints.remove(icon);
-                WPDelete(icon);
+                ++i;
+                continue;
             }
+            QLOG_TRACE() << "DELETE EXISTING WP" << i.key()->getId();
+            mapcontrol::WayPointItem* icon = i.value();
+            i = waypointsToIcons.erase(i);
+            iconsToWaypoints.remove(icon);
+            WPDelete(icon);
         }
 
-        // Update all existing waypoints
-        foreach (Waypoint* wp, waypointsToIcons.keys())
-        {
-            QLOG_TRACE() << "UPDATING EXISTING WP" << wp->getId();
-            updateWaypoint(uas, wp);
-        }
-
-        // Update all potentially new waypoints
+        // Add new waypoints and refresh the existing ones, the line is drawn once afterwards
         foreach (Waypoint* wp, wps)
         {
-            // Update / add only if new
-            if (!waypointsToIcons.contains(wp))
-            {
-                QLOG_TRACE() << "UPDATING NEW WP" << wp->getId();
-                updateWaypoint(uas, wp);
-            }
+            if (firingWaypointChange == wp)
+                continue;
+            int wpindex = currWPManager->getIndexOf(wp);
+            if (wpindex < 0)
+                continue;
+            firingWaypointChange = wp;
+            updateWaypointIcon(uas, wp, wpindex);
+            firingWaypointChange = NULL;
         }
 
         redrawWaypointLines(uas);
@@ -1,9 +1,10 @@
 #ifndef QGCMAPWIDGET_H
 #define QGCMAPWIDGET_H
 
-#include <QMap>
+#include <QHash>
 #include <QTimer>
 #include "../../../libs/opmapcontrol/opmapcontrol.h"
+#include "WaypointNavigation.h"
 
 class UASInterface;
 class UASWaypointManager;
@@ -147,11 +148,24 @@ protected:
     void mousePressEvent(QMouseEvent *event);
     void mouseReleaseEvent(QMouseEvent *event);
     void mouseDoubleClickEvent(QMouseEvent* event);
+    /** @brief Create or refresh the map icon of a single waypoint */
+    void updateWaypointIcon(int uas, Waypoint* wp, int wpindex);
+    /** @brief Redraw only the line segments affected by a change of this waypoint */
+    void updateWaypointLines(int uas, Waypoint* wp);
+    /** @brief Compute the line segment leading to the waypoint at this index of pathWaypoints */
+    WaypointNavigation::Segment waypointLineSegment(int index);
+    /** @brief Check that the cached line items are still the ones shown in this group */
+    bool waypointLinesValid(QGraphicsItemGroup* group);
 
     UASWaypointManager* currWPManager; ///< The current waypoint manager
     bool offlineMode;
-    QMap<Waypoint* , mapcontrol::WayPointItem*> waypointsToIcons;
-    QMap<mapcontrol::WayPointItem*, Waypoint*> iconsToWaypoints;
+    QHash<Waypoint* , mapcontrol::WayPointItem*> waypointsToIcons;
+    QHash<mapcontrol::WayPointItem*, Waypoint*> iconsToWaypoints;
+    QList<Waypoint*> pathWaypoints;                     ///< Waypoints the mission line was last drawn for
+    QHash<Waypoint*, int> pathIndex;                    ///< Index of each waypoint in pathWaypoints
+    QList<WaypointNavigation::Segment> pathSegments;    ///< Mission line pieces, one per entry of pathWaypoints
+    QList<QGraphicsPathItem*> pathItems;                ///< Items drawing pathSegments
+    QGraphicsItemGroup* pathGroup;                      ///< Group holding pathItems
     Waypoint* firingWaypointChange;
     QTimer updateTimer;
     float maxUpdateInterval;
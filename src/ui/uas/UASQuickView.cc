@@ -7,6 +7,7 @@
 #include <QInputDialog>
 UASQuickView::UASQuickView(QWidget *parent) : QWidget(parent)
 {
+    uas=0;
     quickViewSelectDialog=0;
     m_columnCount=2;
     m_currentColumn=0;
@@ -26,10 +27,21 @@ UASQuickView::UASQuickView(QWidget *parent) : QWidget(parent)
     }
     this->setContextMenuPolicy(Qt::ActionsContextMenu);
 
+    // Values are pulled from the bus once a second, instead of receiving every sample
+    m_subscriber = new TelemetrySubscriber(1000,this);
+    connect(m_subscriber,SIGNAL(updated()),this,SLOT(telemetryUpdated()));
+
+    TelemetryBus *bus = TelemetryBus::instance();
+    connect(bus,SIGNAL(channelRegistered(int,QString,QString)),this,SLOT(channelRegistered(int,QString,QString)));
+    for (int i=0;i<bus->channelCount();i++)
+    {
+        channelRegistered(i,bus->channelName(i),bus->channelUnit(i));
+    }
+
     loadSettings();
 
     //If we don't have any predefined settings, set some defaults.
-    if (uasPropertyValueMap.size() == 0)
+    if (uasPropertyToLabelMap.size() == 0)
     {
         m_columnCount = 2;
         valueEnabled("GCS Status.Altitude (GPS) (m)");
@@ -56,11 +68,6 @@ UASQuickView::UASQuickView(QWidget *parent) : QWidget(parent)
     columnaction->setCheckable(false);
     connect(columnaction,SIGNAL(triggered()),this,SLOT(columnActionTriggered()));
     this->addAction(columnaction);
-
-    updateTimer = new QTimer(this);
-    connect(updateTimer,SIGNAL(timeout()),this,SLOT(updateTimerTick()));
-    updateTimer->start(1000);
-
 }
 UASQuickView::~UASQuickView()
 {
@@ -143,6 +150,8 @@ void UASQuickView::replaceSingleItemSelected(QString newitem,QString olditem)
 
         uasEnabledPropertyList.removeOne(olditem);
         uasEnabledPropertyList.append(newitem);
+        watchProperty(olditem,false);
+        watchProperty(newitem,true);
         saveSettings();
     }
 
@@ -228,6 +237,7 @@ void UASQuickView::valueEnabled(const QString &value)
     }
     uasPropertyToLabelMap[value] = item;
     uasEnabledPropertyList.append(value);
+    watchProperty(value,true);
 
     if (!uasPropertyValueMap.contains(value))
     {
@@ -318,6 +328,7 @@ void UASQuickView::valueDisabled(const QString& value)
         //layout->removeWidget(item);
         m_verticalLayoutList[m_PropertyToLayoutIndexMap[value]]->removeWidget(item);
         uasEnabledPropertyList.removeOne(value);
+        watchProperty(value,false);
         sortItems(m_columnCount);
         item->deleteLater();
         saveSettings();
@@ -329,14 +340,65 @@ void UASQuickView::selectDialogClosed()
     quickViewSelectDialog = 0;
 }
 
-void UASQuickView::updateTimerTick()
+void UASQuickView::telemetryUpdated()
+{
+    if (!uas)
+    {
+        return;
+    }
+    TelemetryBus *bus = TelemetryBus::instance();
+    const QList<int> &changed = m_subscriber->changedChannels();
+    for (int i=0;i<changed.size();i++)
+    {
+        TelemetryBus::Sample sample;
+        if (!bus->latest(changed[i],&sample) || sample.uasId != uas->getUASID())
+        {
+            //Nothing published yet, or the value is for the non active UAS
+            continue;
+        }
+        const QString &property = m_channelToPropertyMap[changed[i]];
+        uasPropertyValueMap[property] = sample.value;
+        UASQuickViewItem *item = uasPropertyToLabelMap.value(property);
+        if (item)
+        {
+            item->setValue(sample.value);
+        }
+    }
+}
+
+void UASQuickView::channelRegistered(int channel, const QString& name, const QString& unit)
+{
+    QString property = name.mid(name.indexOf(":")+1) +" ("+unit+")";
+    m_channelToPropertyMap[channel] = property;
+    if (!uasPropertyValueMap.contains(property))
+    {
+        uasPropertyValueMap[property] = 0;
+        if (quickViewSelectDialog)
+        {
+            quickViewSelectDialog->addItem(property);
+        }
+    }
+    if (uasPropertyToLabelMap.contains(property))
+    {
+        m_subscriber->watch(channel);
+    }
+}
+
+void UASQuickView::watchProperty(const QString& property, bool watch)
 {
-    //uasPropertyValueMap
-    for (QMap<QString,UASQuickViewItem*>::const_iterator i = uasPropertyToLabelMap.constBegin(); i != uasPropertyToLabelMap.constEnd();i++)
+    for (QHash<int,QString>::const_iterator i = m_channelToPropertyMap.constBegin();i!=m_channelToPropertyMap.constEnd();i++)
     {
-        if (uasPropertyValueMap.contains(i.key()))
+        if (i.value() != property)
+        {
+            continue;
+        }
+        if (watch)
+        {
+            m_subscriber->watch(i.key());
+        }
+        else
         {
-            i.value()->setValue(uasPropertyValueMap[i.key()]);
+            m_subscriber->unwatch(i.key());
         }
     }
 }
@@ -359,8 +421,6 @@ void UASQuickView::setActiveUAS(UASInterface* uas)
         return;
     }
     this->uas = uas;
-    connect(uas,SIGNAL(valueChanged(int,QString,QString,QVariant,quint64)),this,
-            SLOT(valueChanged(int,QString,QString,QVariant,quint64)));
 
 }
 void UASQuickView::addSource(MAVLinkDecoder *decoder)
@@ -368,30 +428,6 @@ void UASQuickView::addSource(MAVLinkDecoder *decoder)
     Q_UNUSED(decoder);
     //connect(decoder,SIGNAL(valueChanged(int,QString,QString,QVariant,quint64)),this,SLOT(valueChanged(int,QString,QString,QVariant,quint64)));
 }
-void UASQuickView::valueChanged(const int uasId, const QString& name, const QString& unit, const QVariant& value, const quint64 msec)
-{
-    Q_UNUSED(msec);
-
-    if (this->uas->getUASID() != uasId)
-    {
-        //This message is for the non active UAS
-        return;
-    }
-    QString propername = name.mid(name.indexOf(":")+1);
-    if (!uasPropertyValueMap.contains(propername +" ("+unit+")"))
-    {
-        if (quickViewSelectDialog)
-        {
-            quickViewSelectDialog->addItem(propername +" ("+unit+")");
-        }
-    }
-    bool ok = false;
-    uasPropertyValueMap[propername +" ("+unit+")"] = value.toDouble(&ok);
-    if (!ok){
-        QLOG_ERROR() << "Quick View: Error Converting QuickView Item Value: " << propername;
-    }
-}
-
 void UASQuickView::actionTriggered(bool checked)
 {
     QAction *senderlabel = qobject_cast<QAction*>(sender());
@@ -10,6 +10,7 @@
 #include "UASQuickViewItem.h"
 #include "MAVLinkDecoder.h"
 #include "UASQuickViewItemSelect.h"
+#include "TelemetryBus.h"
 class UASQuickView : public QWidget
 {
     Q_OBJECT
@@ -31,8 +32,11 @@ private:
     QMap<QString,UASQuickViewItem*> uasPropertyToLabelMap;
 
 
-    /** Timer for updating the UI */
-    QTimer *updateTimer;
+    /** Pulls changed values of the displayed properties from the TelemetryBus */
+    TelemetrySubscriber *m_subscriber;
+
+    /** Maps from TelemetryBus channel to property name */
+    QHash<int,QString> m_channelToPropertyMap;
 
     /** Selection dialog for selectin/deselecting gauge items */
     UASQuickViewItemSelect *quickViewSelectDialog;
@@ -47,6 +51,9 @@ private:
 
     void valueUpdate(const int uasId,const QString &name,const QString &unit,const double value,const quint64 msec);
 
+    /** Start or stop pulling every bus channel that feeds a property */
+    void watchProperty(const QString& property, bool watch);
+
     /** Column Count */
     int m_columnCount;
 
@@ -63,11 +70,11 @@ protected:
 signals:
     
 public slots:
-    void valueChanged(const int uasid, const QString& name, const QString& unit, const QVariant& value,const quint64 msecs);
+    void channelRegistered(int channel, const QString& name, const QString& unit);
+    void telemetryUpdated();
 
     void actionTriggered(bool checked);
     void actionTriggered();
-    void updateTimerTick();
     void addUAS(UASInterface* uas);
     void setActiveUAS(UASInterface* uas);
     void valChanged(double val,QString type);